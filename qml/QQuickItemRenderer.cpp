@@ -25,6 +25,12 @@
 #include <QtQuick/QQuickWindow>
 #include <QtQuick/QSGFlatColorMaterial>
 #include <QtQuick/QSGSimpleTextureNode>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+#include <QtQuick/QSGRendererInterface>
+#endif
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QScreen>
 #include <QtAV/AVPlayer.h>
 #include <QtAV/OpenGLVideo.h>
 #include "QtAV/private/mkid.h"
@@ -37,6 +43,114 @@ namespace QtAV {
 static const VideoRendererId VideoRendererId_QQuickItem = mkid::id32base36_6<'Q','Q','I','t','e','m'>::value;
 FACTORY_REGISTER(VideoRenderer, QQuickItem, "QQuickItem")
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+/*!
+ * RGB texture of the non-OpenGL mode if scene graph uses OpenGL. The texture object is kept and updated
+ * by glTexSubImage2D in render thread, and the image is uploaded from the frame bits directly if possible.
+ * The owner node deletes it in render thread.
+ */
+class SGImageTexture : public QSGTexture
+{
+public:
+    SGImageTexture() : QSGTexture(), m_id(0), m_fmt(0), m_alpha(false), m_dirty(false) {}
+    ~SGImageTexture() {
+        QOpenGLContext *ctx = QOpenGLContext::currentContext();
+        if (m_id && ctx)
+            ctx->functions()->glDeleteTextures(1, &m_id);
+    }
+    void setImage(const QImage& image) {
+        m_image = image;
+        m_size = image.size();
+        m_alpha = image.hasAlphaChannel();
+        m_dirty = true;
+    }
+    int textureId() const Q_DECL_OVERRIDE { return m_id;}
+    QSize textureSize() const Q_DECL_OVERRIDE { return m_size;}
+    bool hasAlphaChannel() const Q_DECL_OVERRIDE { return m_alpha;}
+    bool hasMipmaps() const Q_DECL_OVERRIDE { return false;}
+    void bind() Q_DECL_OVERRIDE {
+        QOpenGLContext *ctx = QOpenGLContext::currentContext();
+        QOpenGLFunctions *f = ctx->functions();
+        if (!m_id)
+            f->glGenTextures(1, &m_id);
+        f->glBindTexture(GL_TEXTURE_2D, m_id);
+        bool allocated = false;
+        if (m_dirty) {
+            allocated = upload(ctx);
+            m_dirty = false;
+            m_image = QImage(); // release the frame
+        }
+        updateBindOptions(allocated);
+    }
+private:
+    // return true if texture storage is (re)allocated
+    bool upload(QOpenGLContext *ctx) {
+        QOpenGLFunctions *f = ctx->functions();
+        QImage img(m_image);
+        GLenum fmt = GL_RGBA;
+        int bpp = 4;
+        switch (img.format()) {
+        case QImage::Format_RGB888:
+            fmt = GL_RGB;
+            bpp = 3;
+            break;
+        case QImage::Format_RGBX8888:
+        case QImage::Format_RGBA8888:
+        case QImage::Format_RGBA8888_Premultiplied:
+            break;
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+                    && (!ctx->isOpenGLES() || ctx->hasExtension(QByteArrayLiteral("GL_EXT_texture_format_BGRA8888")))) {
+                fmt = GL_BGRA;
+                break;
+            }
+            // fall through
+        default:
+            img = img.convertToFormat(img.hasAlphaChannel() ? QImage::Format_RGBA8888_Premultiplied : QImage::Format_RGBX8888);
+            break;
+        }
+        // frame lines are padded by decoder. QImage lines are 4 bytes aligned
+        const bool row_length = !ctx->isOpenGLES() || ctx->format().majorVersion() >= 3;
+        const bool padded = img.bytesPerLine() != ((img.width()*bpp + 3) & ~3);
+        if (padded && (!row_length || img.bytesPerLine() % bpp))
+            img = img.copy();
+        if (padded && img.constBits() == m_image.constBits())
+            f->glPixelStorei(GL_UNPACK_ROW_LENGTH, img.bytesPerLine()/bpp);
+        f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        bool allocated = false;
+        if (m_allocated != img.size() || m_fmt != fmt) {
+            // ES requires the same internal format as format
+            const GLint internal_fmt = ctx->isOpenGLES() ? fmt : (fmt == GL_RGB ? GL_RGB : GL_RGBA);
+            f->glTexImage2D(GL_TEXTURE_2D, 0, internal_fmt, img.width(), img.height(), 0, fmt, GL_UNSIGNED_BYTE, img.constBits());
+            m_allocated = img.size();
+            m_fmt = fmt;
+            allocated = true;
+        } else {
+            f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, img.width(), img.height(), fmt, GL_UNSIGNED_BYTE, img.constBits());
+        }
+        if (padded && img.constBits() == m_image.constBits())
+            f->glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        return allocated;
+    }
+
+    GLuint m_id;
+    GLenum m_fmt;
+    bool m_alpha;
+    bool m_dirty;
+    QSize m_size;
+    QSize m_allocated;
+    QImage m_image;
+};
+#endif //QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+
 class QQuickItemRendererPrivate : public VideoRendererPrivate
 {
 public:
@@ -45,16 +159,10 @@ public:
       , opengl(true)
       , frame_changed(false)
       , fill_mode(QQuickItemRenderer::PreserveAspectFit)
-      , texture(0)
       , node(0)
       , source(0)
     {
-    }
-    virtual ~QQuickItemRendererPrivate() {
-        if (texture) {
-            delete texture;
-            texture = 0;
-        }
+        use_mailbox = true;
     }
     virtual void setupQuality() {
         if (!node)
@@ -71,10 +179,10 @@ public:
     bool opengl;
     bool frame_changed;
     QQuickItemRenderer::FillMode fill_mode;
-    QSGTexture* texture;
     QSGNode *node;
     QObject *source;
     QImage image;
+    QRect image_roi; // source rect of image
     QList<QuickVideoFilter*> filters;
 };
 
@@ -139,15 +247,23 @@ bool QQuickItemRenderer::receiveFrame(const VideoFrame &frame)
     d.video_frame = frame;
     if (!isOpenGL()) {
         d.image = QImage((uchar*)frame.constBits(), frame.width(), frame.height(), frame.bytesPerLine(), frame.imageFormat());
-        QRect r = realROI();
-        if (r != QRect(0, 0, frame.width(), frame.height()))
-            d.image = d.image.copy(r);
+        d.image_roi = realROI();
+#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
+        if (d.image_roi != d.image.rect()) {
+            d.image = d.image.copy(d.image_roi);
+            d.image_roi = d.image.rect();
+        }
+#endif
     }
     d.frame_changed = true;
+    return true;
+}
+
+void QQuickItemRenderer::updateUi()
+{
 //    update();  // why update slow? because of calling in a different thread?
     //QMetaObject::invokeMethod(this, "update"); // slower than directly postEvent
     QCoreApplication::postEvent(this, new QEvent(QEvent::User));
-    return true;
 }
 
 QObject* QQuickItemRenderer::source() const
@@ -361,27 +477,55 @@ void QQuickItemRenderer::drawFrame()
         sgvn->setTexturedRectGeometry(d.out_rect, normalizedROI(), d.rotation());
         return;
     }
+    QSGSimpleTextureNode *stn = static_cast<QSGSimpleTextureNode*>(d.node);
     if (!d.frame_changed) {
-        static_cast<QSGSimpleTextureNode*>(d.node)->setRect(d.out_rect);
+        stn->setRect(d.out_rect);
         d.node->markDirty(QSGNode::DirtyGeometry);
         return;
     }
     if (d.image.isNull()) {
         d.image = QImage(rendererSize(), QImage::Format_RGB32);
         d.image.fill(Qt::black);
+        d.image_roi = d.image.rect();
     }
-    static_cast<QSGSimpleTextureNode*>(d.node)->setRect(d.out_rect);
-
-    if (d.texture)
-        delete d.texture;
-
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    bool sg_gl = true;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    sg_gl = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL;
+#endif
+    // the node owns the texture and deletes it in render thread
+    stn->setOwnsTexture(true);
+    if (sg_gl) {
+        // reuse the texture and update in place. setTexture() deletes the old texture even if they are the same
+        SGImageTexture *t = static_cast<SGImageTexture*>(stn->texture());
+        if (!t) {
+            t = new SGImageTexture();
+            t->setImage(d.image);
+            stn->setTexture(t);
+        } else {
+            t->setImage(d.image);
+        }
+    } else {
+        // software and other backends copy the image to their own texture
+        stn->setTexture(window()->createTextureFromImage(d.image));
+    }
+    // roi and orientation are texture coordinates, no copy
+    stn->setSourceRect(d.image_roi);
+    stn->setTextureCoordinatesTransform(d.rotation() == 180 ?
+                                            QSGSimpleTextureNode::MirrorHorizontally|QSGSimpleTextureNode::MirrorVertically
+                                          : QSGSimpleTextureNode::NoTransform);
+    stn->setRect(d.out_rect);
+    d.node->markDirty(QSGNode::DirtyGeometry|QSGNode::DirtyMaterial);
+#else
+    stn->setRect(d.out_rect);
+    stn->setOwnsTexture(true);
     if (d.rotation() == 0) {
-        d.texture = window()->createTextureFromImage(d.image);
+        stn->setTexture(window()->createTextureFromImage(d.image));
     } else if (d.rotation() == 180) {
-        d.texture = window()->createTextureFromImage(d.image.mirrored(true, true));
+        stn->setTexture(window()->createTextureFromImage(d.image.mirrored(true, true)));
     }
-    static_cast<QSGSimpleTextureNode*>(d.node)->setTexture(d.texture);
     d.node->markDirty(QSGNode::DirtyGeometry);
+#endif //QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
     d.frame_changed = false;
 }
 
@@ -389,7 +533,7 @@ QSGNode *QQuickItemRenderer::updatePaintNode(QSGNode *node, QQuickItem::UpdatePa
 {
     Q_UNUSED(data);
     DPTR_D(QQuickItemRenderer);
-    if (d.frame_changed) {
+    if (d.frame_changed || d.mailbox.hasFrame()) {
         if (!node) {
             if (isOpenGL()) {
                 node = new SGVideoNode();
@@ -414,6 +558,9 @@ void QQuickItemRenderer::handleWindowChange(QQuickWindow *win)
         return;
     connect(win, SIGNAL(beforeRendering()), this, SLOT(beforeRendering()), Qt::DirectConnection);
     connect(win, SIGNAL(afterRendering()), this, SLOT(afterRendering()), Qt::DirectConnection);
+    connect(win, SIGNAL(frameSwapped()), this, SLOT(frameSwapped()), Qt::DirectConnection);
+    if (win->screen())
+        d_func().scheduler.setRefreshRate(win->screen()->refreshRate());
 }
 
 void QQuickItemRenderer::beforeRendering()
@@ -427,6 +574,12 @@ void QQuickItemRenderer::afterRendering()
     d_func().img_mutex.unlock();
 }
 
+// called in render thread
+void QQuickItemRenderer::frameSwapped()
+{
+    d_func().frameSwapped();
+}
+
 bool QQuickItemRenderer::onSetOrientation(int value)
 {
     Q_UNUSED(value);
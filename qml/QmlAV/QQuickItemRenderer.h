@@ -101,12 +101,14 @@ protected:
 
     bool receiveFrame(const VideoFrame &frame) Q_DECL_OVERRIDE;
     void drawFrame() Q_DECL_OVERRIDE;
+    void updateUi() Q_DECL_OVERRIDE;
     // QQuickItem interface
     QSGNode *updatePaintNode(QSGNode *node, UpdatePaintNodeData *data) Q_DECL_OVERRIDE;
 private slots:
     void handleWindowChange(QQuickWindow *win);
     void beforeRendering();
     void afterRendering();
+    void frameSwapped();
 private:
     bool onSetOrientation(int value) Q_DECL_OVERRIDE;
 
@@ -42,7 +42,7 @@ AVClock::AVClock(AVClock::ClockType c, QObject *parent):
   , nb_sync(0)
   , sync_id(0)
 {
-    last_pts = pts_ = pts_v = delay_ = 0;
+    last_pts = pts_ = pts_v = delay_ = latency_v = 0;
 }
 
 AVClock::AVClock(QObject *parent):
@@ -57,7 +57,7 @@ AVClock::AVClock(QObject *parent):
   , nb_sync(0)
   , sync_id(0)
 {
-    last_pts = pts_ = pts_v = delay_ = 0;
+    last_pts = pts_ = pts_v = delay_ = latency_v = 0;
 }
 
 void AVClock::setClockType(ClockType ct)
@@ -195,7 +195,7 @@ void AVClock::reset()
 {
     nb_sync = 0;
     sync_id = 0;
-    // keep mSpeed
+    // keep mSpeed and latency_v. latency_v is measured by renderer
     m_state = kStopped;
     value0 = 0;
     pts_ = pts_v = delay_ = 0;
@@ -21,12 +21,16 @@
 
 #include "AVDemuxThread.h"
 #include <limits>
+#include "QtAV/private/ActivityDetector.h"
 #include "QtAV/AVClock.h"
 #include "QtAV/AVDemuxer.h"
 #include "QtAV/AVDecoder.h"
+#include "QtAV/Statistics.h"
+#include "QtAV/private/AVCompat.h"
 #include "VideoThread.h"
 #include "AudioThread.h"
 #include <QtCore/QTime>
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 #include <QTimer>
 #include "SPSCQueue.h"
@@ -292,6 +296,7 @@ void AVDemuxThread::seekInternal(qint64 pos, SeekType type, qint64 external_pos)
 {
     AVThread* av[] = { audio_thread, video_thread};
     qDebug("seek to %s %lld ms (%f%%)", QTime(0, 0, 0).addMSecs(pos).toString().toUtf8().constData(), pos, double(pos - demuxer->startTime())/double(demuxer->duration())*100.0);
+    QTAV_TRACE(Seek, statistics, double(pos)/1000.0);
     demuxer->setSeekType(type);
     demuxer->seek(pos);
     if (ademuxer) {
@@ -377,6 +382,194 @@ qint64 AVDemuxThread::lastSeekPos()
     return last_seek_pos;
 }
 
+void AVDemuxThread::setAutoReconnect(bool value)
+{
+    auto_reconnect = value;
+}
+
+bool AVDemuxThread::autoReconnect() const
+{
+    return auto_reconnect;
+}
+
+void AVDemuxThread::requestReconnect()
+{
+    if (!auto_reconnect || reconnect_requested || reconnecting)
+        return;
+    reconnect_requested = true;
+    // abort a blocking read on the dead connection
+    if (demuxer)
+        demuxer->setInterruptStatus(-1);
+}
+
+QVariantMap AVDemuxThread::reconnectStatistics() const
+{
+    QMutexLocker lock(&reconnect_mutex);
+    Q_UNUSED(lock);
+    QVariantMap stats;
+    stats[QStringLiteral("reconnects")] = reconnects;
+    stats[QStringLiteral("reconnectAttempts")] = reconnect_attempts;
+    stats[QStringLiteral("lastReconnectTime")] = last_reconnect_time;
+    stats[QStringLiteral("lastOutageDuration")] = last_outage;
+    return stats;
+}
+
+/*!
+ * The last read timed out or the io context has an error. A user interrupt, e.g. stop(), is not a failure.
+ */
+bool AVDemuxThread::isReadFailed() const
+{
+    const int interrupt = demuxer->getInterruptStatus();
+    if (interrupt < 0)
+        return false;
+    if (interrupt > 0) // AVError::ReadTimedout etc.
+        return true;
+    AVFormatContext *ctx = demuxer->formatContext();
+    return ctx && ctx->pb && ctx->pb->error < 0 && ctx->pb->error != AVERROR_EOF;
+}
+
+/*!
+ * End of a network source is a dropped connection if the source is live, i.e. a live protocol or no duration,
+ * or if reading failed. A VOD file over http ends normally.
+ */
+bool AVDemuxThread::isDisconnectedAtEnd() const
+{
+    AVFormatContext *ctx = demuxer->formatContext();
+    if (!ctx)
+        return false;
+    if (isReadFailed())
+        return true;
+    if (ctx->duration == AV_NOPTS_VALUE || ctx->duration <= 0)
+        return true;
+    static const char* kLiveProtocols[] = { "rtsp", "rtsps", "rtmp", "rtmps", "rtmpt", "rtmpe", "rtp", "udp", "srt", "mms", "mmsh", "mmst" };
+    const QString url(demuxer->fileName());
+    const QString protocol(url.left(url.indexOf(QLatin1Char(':'))).toLower());
+    for (size_t i = 0; i < sizeof(kLiveProtocols)/sizeof(kLiveProtocols[0]); ++i) {
+        if (protocol == QLatin1String(kLiveProtocols[i]))
+            return true;
+    }
+    return false;
+}
+
+bool AVDemuxThread::reconnectInternal()
+{
+    reconnecting = true;
+    // the interrupt of requestReconnect() aborted the read. an interrupt of stop() comes with end
+    if (reconnect_requested && !end)
+        demuxer->setInterruptStatus(0);
+    int backoff = 500;
+    QElapsedTimer timer;
+    while (!end) {
+        {
+            QMutexLocker lock(&reconnect_mutex);
+            Q_UNUSED(lock);
+            ++reconnect_attempts;
+        }
+        timer.start();
+        bool same = false;
+        if (demuxer->reconnect(&same)) {
+            qDebug("reconnected in %lld ms. codec parameters %s", timer.elapsed(), same ? "unchanged" : "changed");
+            {
+                QMutexLocker lock(&reconnect_mutex);
+                Q_UNUSED(lock);
+                ++reconnects;
+                last_reconnect_time = timer.elapsed();
+            }
+            reconnect_requested = false;
+            reconnecting = false;
+            resync_pending = same; // otherwise the player reloads
+            outage_pending = true;
+            Q_EMIT reconnected(same);
+            return true;
+        }
+        qDebug("reconnect failed. retry in %d ms", backoff);
+        // sleep in small steps to respond to stop()
+        for (int t = 0; t < backoff && !end; t += 50)
+            msleep(50);
+        backoff = qMin(backoff*2, 10000);
+    }
+    reconnect_requested = false;
+    reconnecting = false;
+    return false;
+}
+
+void AVDemuxThread::setStatistics(Statistics *statistics)
+{
+    this->statistics = statistics;
+}
+
+void AVDemuxThread::setActivityDetector(ActivityDetector *detector)
+{
+    activity = detector;
+}
+
+void AVDemuxThread::setKeyFramesOnly(bool value)
+{
+    key_frames_only = value;
+}
+
+void AVDemuxThread::setPacketSignalsEnabled(bool value)
+{
+    packet_signals = value;
+}
+
+bool AVDemuxThread::acceptVideoPacket(const Packet &pkt)
+{
+    ActivityDetector *detector = activity.load(std::memory_order_relaxed);
+    if (detector)
+        detector->addPacket(pkt);
+    if (pkt.isEOF())
+        return true;
+    // after skipping, the next decoded packet must be a key frame, otherwise it references frames never decoded
+    if (pkt.hasKeyFrame) {
+        skip_to_key_frame = key_frames_only.load(std::memory_order_relaxed);
+        return true;
+    }
+    if (key_frames_only.load(std::memory_order_relaxed))
+        skip_to_key_frame = true;
+    return !skip_to_key_frame;
+}
+
+void AVDemuxThread::resyncInternal(qreal pts)
+{
+    // the same as seek: drop queued packets of the old connection and flush decoders
+    AVThread* av[] = { audio_thread, video_thread};
+    int sync_id = 0;
+    for (size_t i = 0; i < sizeof(av)/sizeof(av[0]); ++i) {
+        AVThread *t = av[i];
+        if (!t)
+            continue;
+        if (!sync_id)
+            sync_id = t->clock()->syncStart(!!audio_thread + (!!video_thread && !demuxer->hasAttacedPicture()));
+        t->packetQueue()->clear();
+        t->clock()->updateValue(pts);
+        t->requestSeek();
+        t->packetQueue()->setBlocking(false);
+        Packet pkt;
+        pkt.pts = pts;
+        pkt.position = sync_id;
+        t->packetQueue()->put(pkt);
+        t->packetQueue()->setBlocking(true);
+    }
+}
+
+void AVDemuxThread::onPacketRead(bool resync)
+{
+    if (!auto_reconnect)
+        return;
+    if (outage_pending) {
+        outage_pending = false;
+        QMutexLocker lock(&reconnect_mutex);
+        Q_UNUSED(lock);
+        last_outage = last_packet_timer.isValid() ? last_packet_timer.elapsed() : -1;
+    }
+    if (resync && resync_pending) {
+        resync_pending = false;
+        resyncInternal(demuxer->packet().pts);
+    }
+    last_packet_timer.start();
+}
+
 void AVDemuxThread::pauseInternal(bool value)
 {
     paused = value;
@@ -412,6 +605,7 @@ void AVDemuxThread::updateBufferState()
     if (m_buffering == m_buffer->isBuffering())
         return;
     m_buffering = m_buffer->isBuffering();
+    QTAV_TRACE_COUNTER(Buffering, statistics, m_buffering);
     Q_EMIT mediaStatusChanged(m_buffering ? QtAV::BufferingMedia : QtAV::BufferedMedia);
     // state change to buffering, report progress immediately. otherwise we have to wait to read 1 packet.
     if (m_buffering) {
@@ -628,6 +822,10 @@ void AVDemuxThread::run()
         vqueue->clear();
         vqueue->setBlocking(true);
     }
+    AVPlayer *player = qobject_cast<AVPlayer*>(parent());
+    // skip undecodable packets before the 1st key frame, and let video thread take it without buffering
+    bool fast_first_frame = vqueue && player->fastFirstFrame();
+    bool first_packet = true;
     connect(thread, SIGNAL(seekFinished(qint64)), this, SIGNAL(seekFinished(qint64)), Qt::DirectConnection);
     seek_tasks.clear();
     int was_end = 0;
@@ -641,10 +839,15 @@ void AVDemuxThread::run()
     AutoSem as(&sem);
     Q_UNUSED(as);
 
-    bool realtimeDecode = qobject_cast<AVPlayer*>(parent())->realtimeDecode();
+    bool realtimeDecode = player->realtimeDecode();
+    if (fast_first_frame && !realtimeDecode)
+        vqueue->setFastStart(true);
 
     if(realtimeDecode) {
         rigtorp::SPSCQueue<Packet> packets(audio_thread ? 100 : 30);
+        // packets before the 1st key frame are dropped by the reader. the 1st frame is not paced
+        bool skip_to_key_frame = fast_first_frame;
+        bool first_frame = true;
         Q_EMIT mediaStatusChanged(QtAV::BufferedMedia);
         Q_EMIT bufferProgressChanged(1);
 
@@ -657,10 +860,36 @@ void AVDemuxThread::run()
         elapsedTimer.start();
         auto t = std::thread([&] {
           while (!end) {
+              if (auto_reconnect && demuxer->isNetwork()
+                      && (reconnect_requested || (demuxer->mediaStatus() == StalledMedia && isReadFailed()) || (demuxer->atEnd() && isDisconnectedAtEnd()))) {
+                  reconnectInternal();
+                  continue;
+              }
+              QTAV_TRACE_BEGIN(PacketRead, statistics);
               if (!demuxer->readFrame()) {
+                  QTAV_TRACE_END(PacketRead, statistics, -1);
                   QThread::msleep(10);
                   continue;
               }
+              QTAV_TRACE_END(PacketRead, statistics, demuxer->packet().pts);
+              onPacketRead(false);
+              // decoders are fed in the loop below. an invalid packet tells it to drop the old connection's state
+              if (resync_pending) {
+                  resync_pending = false;
+                  while(!end && !packets.try_push(Packet()))
+                      QThread::msleep(1);
+              }
+              if (first_packet && statistics) {
+                  first_packet = false;
+                  QMutexLocker lock(&statistics->mutex);
+                  Q_UNUSED(lock);
+                  statistics->timeline.mark(&statistics->timeline.first_packet);
+              }
+              if (skip_to_key_frame && demuxer->stream() == demuxer->videoStream()) {
+                  if (!demuxer->packet().hasKeyFrame)
+                      continue;
+                  skip_to_key_frame = false;
+              }
 
               // calculate fps using exponential moving average
               auto elapsed = elapsedTimer.elapsed();
@@ -674,8 +903,17 @@ void AVDemuxThread::run()
 
               ++totalFrames;
 
+              const bool video = demuxer->stream() == demuxer->videoStream();
+              if (video)
+                  QTAV_TRACE_BEGIN(VideoEnqueue, statistics);
+              else
+                  QTAV_TRACE_BEGIN(AudioEnqueue, statistics);
               while(!end && !packets.try_push(demuxer->packet()))
                 QThread::msleep(1);
+              if (video)
+                  QTAV_TRACE_END(VideoEnqueue, statistics, demuxer->packet().pts);
+              else
+                  QTAV_TRACE_END(AudioEnqueue, statistics, demuxer->packet().pts);
           }
         });
 
@@ -700,9 +938,34 @@ void AVDemuxThread::run()
                 continue;
             }
             pkt = *packets.front();
+            if (!pkt.isValid()) { // reconnected
+                AVThread* av[] = { audio_thread, video_thread };
+                for (size_t i = 0; i < sizeof(av)/sizeof(av[0]); ++i) {
+                    if (av[i] && av[i]->decoder())
+                        av[i]->decoder()->flush();
+                }
+                skip_to_key_frame = true;
+                packets.pop();
+                continue;
+            }
             bool ret = false;
-            if(video_thread && demuxer->videoStream()==pkt.asAVPacket()->stream_index)
-                ret = static_cast<VideoThread*>(video_thread)->decodePacket(pkt);
+            if(video_thread && demuxer->videoStream()==pkt.asAVPacket()->stream_index) {
+                if (acceptVideoPacket(pkt))
+                    ret = static_cast<VideoThread*>(video_thread)->decodePacket(pkt);
+                if (ret && first_frame) {
+                    first_frame = false;
+                    if (statistics) { // decodePacket() decodes and renders
+                        QMutexLocker lock(&statistics->mutex);
+                        Q_UNUSED(lock);
+                        statistics->timeline.mark(&statistics->timeline.first_decoded);
+                        statistics->timeline.mark(&statistics->timeline.first_rendered);
+                    }
+                    if (fast_first_frame) {
+                        packets.pop();
+                        continue;
+                    }
+                }
+            }
             else if(audio_thread && demuxer->audioStream()==pkt.asAVPacket()->stream_index)
                 ret = static_cast<AudioThread*>(audio_thread)->decodePacket(pkt);
             if(ret) {
@@ -723,6 +986,11 @@ void AVDemuxThread::run()
         processNextSeekTask();
         //vthread maybe changed by AVPlayer.setPriority() from no dec case
         vqueue = video_thread ? video_thread->packetQueue() : 0;
+        if (auto_reconnect && demuxer->isNetwork()
+                && (reconnect_requested || (demuxer->mediaStatus() == StalledMedia && isReadFailed()) || (demuxer->atEnd() && isDisconnectedAtEnd()))) {
+            reconnectInternal();
+            continue;
+        }
         if (demuxer->atEnd()) {
             // if avthread may skip 1st eof packet because of a/v sync
             const int kMaxEof = 1;//if buffer packet, we can use qMax(aqueue->bufferValue(), vqueue->bufferValue()) and not call blockEmpty(false);
@@ -780,11 +1048,21 @@ void AVDemuxThread::run()
             continue; //the queue is empty and will block
         }
         updateBufferState();
+        QTAV_TRACE_BEGIN(PacketRead, statistics);
         if (!demuxer->readFrame()) {
+            QTAV_TRACE_END(PacketRead, statistics, -1);
             continue;
         }
+        onPacketRead(true);
         stream = demuxer->stream();
         pkt = demuxer->packet();
+        QTAV_TRACE_END(PacketRead, statistics, pkt.pts);
+        if (first_packet && statistics) {
+            first_packet = false;
+            QMutexLocker lock(&statistics->mutex);
+            Q_UNUSED(lock);
+            statistics->timeline.mark(&statistics->timeline.first_packet);
+        }
         Packet apkt;
         bool audio_has_pic = demuxer->hasAttacedPicture();
         int a_ext = 0;
@@ -829,6 +1107,8 @@ void AVDemuxThread::run()
             if (a_internal && !a_ext) // internal is always read even if external audio used
                 apkt = demuxer->packet();
             last_apts = apkt.pts;
+            if (a_internal && packet_signals.load(std::memory_order_relaxed))
+                Q_EMIT internalAudioPacketRead(pkt);
             /* if vqueue if not blocked and full, and aqueue is empty, then put to
              * vqueue will block demuex thread
              */
@@ -844,19 +1124,35 @@ void AVDemuxThread::run()
                 // attached picture is cover for song, 1 frame
                 aqueue->blockFull(!video_thread || !video_thread->isRunning() || !vqueue || audio_has_pic);
                 // external audio: a_ext < 0, stream = audio_idx=>put invalid packet
-                if (a_ext >= 0)
+                if (a_ext >= 0) {
+                    QTAV_TRACE_BEGIN(AudioEnqueue, statistics);
                     aqueue->put(apkt); //affect video_thread
+                    QTAV_TRACE_END(AudioEnqueue, statistics, apkt.pts);
+                    QTAV_TRACE_COUNTER(AudioQueue, statistics, aqueue->size());
+                }
             }
         }
         // always check video stream if use external audio
         if (stream == demuxer->videoStream()) {
+            if (packet_signals.load(std::memory_order_relaxed))
+                Q_EMIT internalVideoPacketRead(pkt);
+            if (!acceptVideoPacket(pkt))
+                continue;
             if (vqueue) {
                 if (!video_thread || !video_thread->isRunning()) {
                     vqueue->clear();
                     continue;
                 }
+                if (fast_first_frame) {
+                    if (!pkt.hasKeyFrame)
+                        continue;
+                    fast_first_frame = false;
+                }
                 vqueue->blockFull(!audio_thread || !audio_thread->isRunning() || !aqueue || aqueue->isEnough());
+                QTAV_TRACE_BEGIN(VideoEnqueue, statistics);
                 vqueue->put(pkt); //affect audio_thread
+                QTAV_TRACE_END(VideoEnqueue, statistics, pkt.pts);
+                QTAV_TRACE_COUNTER(VideoQueue, statistics, vqueue->size());
                 last_vpts = pkt.pts;
             }
         } else if (demuxer->subtitleStreams().contains(stream)) { //subtitle
@@ -22,7 +22,10 @@
 #ifndef QAV_DEMUXTHREAD_H
 #define QAV_DEMUXTHREAD_H
 
+#include <atomic>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QMutex>
+#include <QtCore/QVariant>
 #include <QtCore/QSemaphore>
 #include <QtCore/QThread>
 #include <QtCore/QRunnable>
@@ -31,8 +34,10 @@
 
 namespace QtAV {
 
+class ActivityDetector;
 class AVDemuxer;
 class AVThread;
+class Statistics;
 class AVDemuxThread : public QThread
 {
     Q_OBJECT
@@ -62,6 +67,22 @@ public:
     bool waitForStarted(int msec = -1);
     qint64 lastSeekPos();
     bool hasSeekTasks();
+    /*!
+     * \brief setAutoReconnect
+     * Reopen the input of a network stream at end of stream or when requestReconnect() is called, with exponential backoff.
+     * Decoders are only flushed if codec parameters are not changed.
+     */
+    void setAutoReconnect(bool value);
+    bool autoReconnect() const;
+    void requestReconnect(); // thread safe. e.g. stream is stalled
+    /// "reconnects", "reconnectAttempts", "lastReconnectTime" (ms to open), "lastOutageDuration" (ms without packets)
+    QVariantMap reconnectStatistics() const;
+    void setStatistics(Statistics* statistics); // for timeline
+    void setActivityDetector(ActivityDetector* detector); // null to disable. thread safe
+    /// only key frames are sent to video decoder. full decoding resumes from the next key frame. thread safe
+    void setKeyFramesOnly(bool value);
+    /// internalAudioPacketRead() and internalVideoPacketRead() are emitted only if enabled. thread safe
+    void setPacketSignalsEnabled(bool value);
 Q_SIGNALS:
     void requestClockPause(bool value);
     void mediaEndActionPauseTriggered();
@@ -70,6 +91,9 @@ Q_SIGNALS:
     void seekFinished(qint64 timestamp);
     void stepFinished();
     void internalSubtitlePacketRead(int index, const QtAV::Packet& packet);
+    void internalAudioPacketRead(const QtAV::Packet& packet);
+    void internalVideoPacketRead(const QtAV::Packet& packet);
+    void reconnected(bool sameParameters);
 private slots:
     void finishedStepBackward();
     void seekOnPauseFinished();
@@ -92,6 +116,12 @@ private:
     void processNextSeekTask();
     void seekInternal(qint64 pos, SeekType type, qint64 external_pos = std::numeric_limits < qint64 >::min()); //must call in AVDemuxThread
     void pauseInternal(bool value);
+    bool reconnectInternal(); // must call in AVDemuxThread
+    bool isReadFailed() const;
+    bool isDisconnectedAtEnd() const;
+    void resyncInternal(qreal pts);
+    void onPacketRead(bool resync);
+    bool acceptVideoPacket(const Packet& pkt); // false if not decoded
 
     bool paused;
     bool user_paused;
@@ -114,6 +144,23 @@ private:
     QSemaphore sem;
     QMutex next_frame_mutex;
     int clock_type; // change happens in different threads(direct connection)
+
+    std::atomic<bool> auto_reconnect{false};
+    std::atomic<bool> reconnect_requested{false};
+    std::atomic<bool> reconnecting{false};
+    bool resync_pending = false;
+    QElapsedTimer last_packet_timer;
+    mutable QMutex reconnect_mutex;
+    qint64 reconnects = 0;
+    qint64 reconnect_attempts = 0;
+    qint64 last_reconnect_time = -1;
+    qint64 last_outage = -1;
+    bool outage_pending = false;
+    Statistics *statistics = nullptr;
+    std::atomic<ActivityDetector*> activity{nullptr};
+    std::atomic<bool> key_frames_only{false};
+    std::atomic<bool> packet_signals{false};
+    bool skip_to_key_frame = false;
     friend class SeekTask;
     friend class stepBackwardTask;
 };
@@ -22,6 +22,7 @@
 #include "QtAV/MediaIO.h"
 #include "QtAV/private/AVCompat.h"
 #include <QtCore/QMutex>
+#include <QtCore/QSignalBlocker>
 #include <QtCore/QStringList>
 #include <QtCore/QIODevice>
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
@@ -32,7 +33,9 @@ typedef QTime QElapsedTimer;
 #endif
 #include "utils/internal.h"
 #include "utils/Logger.h"
+#include "utils/ProbeCache.h"
 #include <QUrl>
+#include <atomic>
 #include <set>
 
 namespace QtAV {
@@ -68,8 +71,10 @@ public:
 #endif
     }
     void begin(Action act) {
-        if (mStatus > 0)
-            mStatus = 0;
+        // keep a user interrupt set in another thread
+        int s = mStatus;
+        if (s > 0)
+            mStatus.compare_exchange_strong(s, 0);
         mEmitError = true;
         mAction = act;
         mTimer.start();
@@ -103,6 +108,11 @@ public:
     bool isInterruptOnTimeout() const {return mTimeoutAbort;}
     int getStatus() const { return mStatus; }
     void setStatus(int status) { mStatus = status; }
+    // resets timeout errors. a user interrupt(<0) is reset only if !keepInterrupt
+    void resetStatus(bool keepInterrupt) {
+        int s = mStatus;
+        while ((s >= 0 || !keepInterrupt) && !mStatus.compare_exchange_weak(s, 0)) {}
+    }
     /*
      * metodo per interruzione loop ffmpeg
      * @param void*obj: classe attuale
@@ -167,23 +177,23 @@ public:
             } else if (handler->mAction == Read) {
                 ec = AVError::ReadTimedout;
             }
-            handler->mStatus = (int)ec;
             // maybe changed in other threads
-            //handler->mStatus.testAndSetAcquire(0, ec);
+            int s = 0;
+            handler->mStatus.compare_exchange_strong(s, (int)ec);
         }
         if (handler->mTimeoutAbort)
             return 1;
         // emit demuxer error, handleerror
         if (handler->mEmitError) {
             handler->mEmitError = false;
-            AVError::ErrorCode ec = AVError::ErrorCode(handler->mStatus); //FIXME: maybe changed in other threads
+            AVError::ErrorCode ec = AVError::ErrorCode(handler->mStatus.load()); //FIXME: maybe changed in other threads
             QString es;
             handler->mpDemuxer->handleError(AVERROR_EXIT, &ec, es);
         }
         return 0;
     }
 private:
-    int mStatus;
+    std::atomic<int> mStatus;
     qint64 mTimeout;
     bool mTimeoutAbort;
     bool mEmitError;
@@ -205,6 +215,7 @@ public:
         , max_pts(0.0)
         , eof(false)
         , media_changed(true)
+        , reconnecting(false)
         , buf_pos(0)
         , stream(-1)
         , format_ctx(0)
@@ -214,6 +225,10 @@ public:
         , seek_type(AccurateSeek)
         , dict(0)
         , interrupt_hanlder(0)
+        , probe_cache(false)
+        , probe_cache_hit(false)
+        , connect_time(-1)
+        , probe_time(-1)
     {
         lastKeyFrame.data = nullptr;
     }
@@ -287,6 +302,7 @@ public:
     qreal max_pts; // max pts read
     bool eof;
     bool media_changed;
+    bool reconnecting; // keep a user interrupt while reloading
     mutable qptrdiff buf_pos; // detect eof for dynamic size (growing) stream even if detectDynamicStreamInterval() is not set
     Packet pkt;
     int stream;
@@ -321,6 +337,9 @@ public:
 
     AVDemuxer::InterruptHandler *interrupt_hanlder;
     QMutex mutex; //TODO: remove if load, read, seek is called in 1 thread
+    bool probe_cache;
+    bool probe_cache_hit;
+    qint64 connect_time, probe_time; // ms since open started
 
     // for recording stream
     std::map<QString,AVFormatContext*> oc;
@@ -328,6 +347,12 @@ public:
     std::map<QString,AVStream*> ostreamAudio;
     std::map<QString,int64_t> videoFirstPts;
     std::map<QString,int64_t> audioFirstPts;
+    // continue recording after reconnect
+    std::map<QString,int64_t> videoLastPts;
+    std::map<QString,int64_t> audioLastPts;
+    std::map<QString,bool> videoRebase;
+    std::map<QString,bool> audioRebase;
+    std::map<QString,int> recordSegment;
     std::map<QString,QElapsedTimer> elapsed;
     std::map<QString,quint64> recordPacketCount;
     std::map<QString,quint64> recordTryCount;
@@ -605,6 +630,11 @@ bool AVDemuxer::readFrame()
                 d->ostreamAudio.erase(k);
                 d->videoFirstPts.erase(k);
                 d->audioFirstPts.erase(k);
+                d->videoLastPts.erase(k);
+                d->audioLastPts.erase(k);
+                d->videoRebase.erase(k);
+                d->audioRebase.erase(k);
+                d->recordSegment.erase(k);
                 d->restream.erase(k);
                 d->elapsed.erase(k);
                 d->recordPacketCount.erase(k);
@@ -648,8 +678,10 @@ bool AVDemuxer::readFrame()
                     ret = avformat_alloc_output_context2(&d->oc[k],nullptr,/*d->format_ctx->iformat->name*/"mpegts",nullptr);
                 else
                     ret = avformat_alloc_output_context2(&d->oc[k],nullptr,nullptr,(k+"."+d->recordFormat[k]).toLatin1());
+                // a new segment file if stream parameters changed after reconnect
+                const QString segment = d->recordSegment[k] > 0 ? QStringLiteral("_%1").arg(d->recordSegment[k]) : QString();
                 if(ret>=0 && d->oc[k]!=nullptr && !(d->oc[k]->oformat->flags & AVFMT_NOFILE))
-                    avio_open(&d->oc[k]->pb, (k+(d->restream[k] ? "" : "."+d->recordFormat[k])).toLatin1(), AVIO_FLAG_WRITE);
+                    avio_open(&d->oc[k]->pb, (k+(d->restream[k] ? "" : segment+"."+d->recordFormat[k])).toLatin1(), AVIO_FLAG_WRITE);
             }
             if(d->oc[k]!=nullptr && d->ostreamVideo[k] == nullptr && videoStream()>=0) {
                 d->ostreamVideo[k] = avformat_new_stream(d->oc[k], nullptr);
@@ -703,12 +735,20 @@ bool AVDemuxer::readFrame()
                     if(p.stream_index==videoStream()) {
                         if(d->videoFirstPts[k]<0)
                             d->videoFirstPts[k] = p.pts;
+                        else if(d->videoRebase[k]) // timestamps restarted after reconnect. continue after the last packet
+                            d->videoFirstPts[k] = p.pts - d->videoLastPts[k] - qMax<int64_t>(p.duration, 1);
+                        d->videoRebase[k] = false;
                         p.pts -= d->videoFirstPts[k];
+                        d->videoLastPts[k] = p.pts;
                     }
                     else {
                         if(d->audioFirstPts[k]<0)
                             d->audioFirstPts[k] = p.pts;
+                        else if(d->audioRebase[k])
+                            d->audioFirstPts[k] = p.pts - d->audioLastPts[k] - qMax<int64_t>(p.duration, 1);
+                        d->audioRebase[k] = false;
                         p.pts -= d->audioFirstPts[k];
+                        d->audioLastPts[k] = p.pts;
                     }
                 }
                 else {
@@ -1064,6 +1104,9 @@ bool AVDemuxer::load()
         qDebug() << "force format: " << d->format_forced;
     }
     int ret = 0;
+    QElapsedTimer open_timer;
+    open_timer.start();
+    d->connect_time = d->probe_time = -1;
     // used dict entries will be removed in avformat_open_input
     d->interrupt_hanlder->begin(InterruptHandler::Open);
     if (d->input) {
@@ -1081,6 +1124,8 @@ bool AVDemuxer::load()
         qDebug("avformat_open_input: url:'%s' ret:%d",qPrintable(d->file), ret);
     }
     d->interrupt_hanlder->end();
+    if (ret >= 0)
+        d->connect_time = open_timer.elapsed();
     if (ret < 0) {
         // d->format_ctx is 0
         AVError::ErrorCode ec = AVError::OpenError;
@@ -1094,10 +1139,23 @@ bool AVDemuxer::load()
     }
     //deprecated
     //if(av_find_stread->inputfo(d->format_ctx)<0) {
-    //TODO: avformat_find_stread->inputfo is too slow, only useful for some video format
+    // avformat_find_stream_info is too slow for network streams. cached parameters of the same stream make it return after the first packets
+    const bool use_probe_cache = d->probe_cache && d->network && !d->input;
+    QByteArray probe_fp;
+    if (use_probe_cache)
+        probe_fp = ProbeCache::fingerprint(d->format_ctx);
+    d->probe_cache_hit = use_probe_cache && ProbeCache::instance().apply(d->file, probe_fp, d->format_ctx);
+    const QByteArray probe_applied(d->probe_cache_hit ? ProbeCache::checkedParameters(d->format_ctx) : QByteArray());
     d->interrupt_hanlder->begin(InterruptHandler::FindStreamInfo);
     ret = avformat_find_stream_info(d->format_ctx, NULL);
     d->interrupt_hanlder->end();
+    d->probe_time = open_timer.elapsed();
+    if (d->probe_cache_hit && getInterruptStatus() == 0 && (ret < 0 || !ProbeCache::isConsistent(d->format_ctx, probe_applied))) {
+        qDebug("cached stream parameters do not match the first packets. full probe");
+        ProbeCache::instance().reject(d->file);
+        lock.unlock();
+        return load();
+    }
 
     if (ret < 0) {
         setMediaStatus(InvalidMedia);
@@ -1116,6 +1174,8 @@ bool AVDemuxer::load()
             setMediaStatus(InvalidMedia);
         return false;
     }
+    if (use_probe_cache && !d->probe_cache_hit)
+        ProbeCache::instance().store(d->file, probe_fp, d->format_ctx);
     d->started = false;
     setMediaStatus(LoadedMedia);
     Q_EMIT loaded();
@@ -1152,7 +1212,7 @@ bool AVDemuxer::unload()
     d->started = false;
     d->max_pts = 0.0;
     d->resetStreams();
-    d->interrupt_hanlder->setStatus(0);
+    d->interrupt_hanlder->resetStatus(d->reconnecting);
     //av_close_input_file(d->format_ctx); //deprecated
     if (d->format_ctx) {
         qDebug("closing d->format_ctx");
@@ -1167,11 +1227,106 @@ bool AVDemuxer::unload()
     return true;
 }
 
+static bool sameCodecParameters(const AVCodecParameters *a, const AVCodecParameters *b)
+{
+    if (!a || !b)
+        return a == b;
+    if (a->codec_type != b->codec_type || a->codec_id != b->codec_id || a->format != b->format)
+        return false;
+    if (a->codec_type == AVMEDIA_TYPE_VIDEO)
+        return a->width == b->width && a->height == b->height;
+    if (a->codec_type == AVMEDIA_TYPE_AUDIO)
+        return a->sample_rate == b->sample_rate && a->channels == b->channels;
+    return true;
+}
+
+bool AVDemuxer::reconnect(bool *sameParameters)
+{
+    if (sameParameters)
+        *sameParameters = false;
+    if (d->file.isEmpty()) // custom io can not be reopened
+        return false;
+    if (getInterruptStatus() < 0) // stop() is in progress
+        return false;
+    AVCodecParameters *vpar = 0, *apar = 0;
+    if (d->format_ctx) {
+        if (videoStream() >= 0) {
+            vpar = avcodec_parameters_alloc();
+            avcodec_parameters_copy(vpar, d->format_ctx->streams[videoStream()]->codecpar);
+        }
+        if (audioStream() >= 0) {
+            apar = avcodec_parameters_alloc();
+            avcodec_parameters_copy(apar, d->format_ctx->streams[audioStream()]->codecpar);
+        }
+    }
+    bool ok = false;
+    {
+        // player state is not changed by reconnecting
+        QSignalBlocker blocker(this);
+        Q_UNUSED(blocker);
+        d->reconnecting = true;
+        ok = load();
+        d->reconnecting = false;
+    }
+    if (getInterruptStatus() < 0) // interrupted after opened. the caller is stopping
+        ok = false;
+    bool same = false;
+    if (ok) {
+        same = sameCodecParameters(vpar, videoStream() >= 0 ? d->format_ctx->streams[videoStream()]->codecpar : 0)
+                && sameCodecParameters(apar, audioStream() >= 0 ? d->format_ctx->streams[audioStream()]->codecpar : 0);
+        QMutexLocker lock(&d->recordMutex);
+        Q_UNUSED(lock);
+        for (auto& [k, v] : d->oc) {
+            if (same) {
+                d->videoRebase[k] = true;
+                d->audioRebase[k] = true;
+                continue;
+            }
+            // finish current file and record to a new segment file
+            if (v != nullptr) {
+                if (d->elapsed[k].isValid())
+                    av_write_trailer(v);
+                if (v->pb)
+                    avio_close(v->pb);
+                v->pb = nullptr;
+                avformat_free_context(v);
+                v = nullptr;
+                emit recordFinished(true, d->recordFormat[k]);
+            }
+            d->ostreamVideo[k] = nullptr;
+            d->ostreamAudio[k] = nullptr;
+            d->videoFirstPts[k] = -1;
+            d->audioFirstPts[k] = -1;
+            d->elapsed[k].invalidate();
+            d->recordPacketCount[k] = 0;
+            d->recordTryCount[k] = 0;
+            d->recordSegment[k]++;
+        }
+        if (!same && d->lastKeyFrame.data != nullptr) {
+            av_packet_unref(&d->lastKeyFrame);
+            for (auto& p : d->lastNonKeyFrames)
+                av_packet_unref(&p);
+            d->lastNonKeyFrames.clear();
+            d->lastKeyFrame.data = nullptr;
+        }
+    }
+    avcodec_parameters_free(&vpar);
+    avcodec_parameters_free(&apar);
+    if (sameParameters)
+        *sameParameters = same;
+    return ok;
+}
+
 bool AVDemuxer::isLoaded() const
 {
     return d->format_ctx && (d->astream.avctx || d->vstream.avctx || d->sstream.avctx);
 }
 
+bool AVDemuxer::isNetwork() const
+{
+    return d->network;
+}
+
 bool AVDemuxer::hasAttacedPicture() const
 {
     return d->has_attached_pic;
@@ -1218,6 +1373,11 @@ AVFormatContext* AVDemuxer::formatContext()
     return d->format_ctx;
 }
 
+const AVFormatContext* AVDemuxer::formatContext() const
+{
+    return d->format_ctx;
+}
+
 QString AVDemuxer::formatName() const
 {
     if (!d->format_ctx)
@@ -1423,6 +1583,36 @@ QVariantHash AVDemuxer::options() const
     return d->options;
 }
 
+void AVDemuxer::setProbeCacheEnabled(bool value)
+{
+    d->probe_cache = value;
+}
+
+bool AVDemuxer::isProbeCacheEnabled() const
+{
+    return d->probe_cache;
+}
+
+bool AVDemuxer::isProbeCacheHit() const
+{
+    return d->probe_cache_hit;
+}
+
+qint64 AVDemuxer::connectTime() const
+{
+    return d->connect_time;
+}
+
+qint64 AVDemuxer::probeTime() const
+{
+    return d->probe_time;
+}
+
+QVariantMap AVDemuxer::probeCacheStatistics()
+{
+    return ProbeCache::instance().statistics();
+}
+
 void AVDemuxer::setMediaStatus(MediaStatus status)
 {
     if (d->media_status == status)
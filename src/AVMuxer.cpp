@@ -22,6 +22,7 @@
 #include "QtAV/AVMuxer.h"
 #include "QtAV/private/AVCompat.h"
 #include "QtAV/MediaIO.h"
+#include "QtAV/AVDemuxer.h"
 #include "QtAV/VideoEncoder.h"
 #include "QtAV/AudioEncoder.h"
 #include "utils/internal.h"
@@ -50,7 +51,12 @@ public:
         , dict(0)
         , aenc(0)
         , venc(0)
+        , apar(0)
+        , vpar(0)
     {
+        vframe_rate.num = 0;
+        vframe_rate.den = 1;
+        atb = vtb = kTB;
 #if !AVFORMAT_STATIC_REGISTER
         av_register_all();
 #endif
@@ -65,8 +71,11 @@ public:
             delete io;
             io = 0;
         }
+        avcodec_parameters_free(&apar);
+        avcodec_parameters_free(&vpar);
     }
     AVStream* addStream(AVFormatContext* ctx, const QString& codecName, AVCodecID codecId);
+    AVStream* addStream(AVFormatContext* ctx, const AVCodecParameters* par, const AVRational& tb);
     bool prepareStreams();
     void applyOptionsForDict();
     void applyOptionsForContext();
@@ -90,6 +99,10 @@ public:
     QList<int> audio_streams, video_streams, subtitle_streams;
     AudioEncoder *aenc; // not owner
     VideoEncoder *venc; // not owner
+    // stream copy
+    AVCodecParameters *apar, *vpar;
+    AVRational vframe_rate;
+    AVRational atb, vtb; // source stream time base
 };
 
 AVStream *AVMuxer::Private::addStream(AVFormatContext* ctx, const QString &codecName, AVCodecID codecId)
@@ -132,13 +145,37 @@ AVStream *AVMuxer::Private::addStream(AVFormatContext* ctx, const QString &codec
     return s;
 }
 
+AVStream *AVMuxer::Private::addStream(AVFormatContext *ctx, const AVCodecParameters *par, const AVRational &tb)
+{
+    AVStream *s = avformat_new_stream(ctx, NULL);
+    if (!s) {
+        qWarning("Can not allocate stream");
+        return 0;
+    }
+    s->id = ctx->nb_streams - 1;
+    s->time_base = tb; // a hint. avformat_write_header may change it
+    if (avcodec_parameters_copy(s->codecpar, par) < 0) {
+        qWarning("Can not copy codec parameters for %s", avcodec_get_name(par->codec_id));
+        return 0;
+    }
+    // source codec tag may be invalid for output container
+    s->codecpar->codec_tag = 0;
+    return s;
+}
+
 bool AVMuxer::Private::prepareStreams()
 {
     audio_streams.clear();
     video_streams.clear();
     subtitle_streams.clear();
     AVOutputFormat* fmt = format_ctx->oformat;
-    if (venc) {
+    if (vpar) {
+        AVStream *s = addStream(format_ctx, vpar, vtb);
+        if (s) {
+            s->avg_frame_rate = vframe_rate;
+            video_streams.push_back(s->id);
+        }
+    } else if (venc) {
         AVStream *s = addStream(format_ctx, venc->codecName(), fmt->video_codec);
         if (s) {
             AVCodecContext *c = s->codec;
@@ -154,7 +191,11 @@ bool AVMuxer::Private::prepareStreams()
             video_streams.push_back(s->id);
         }
     }
-    if (aenc) {
+    if (apar) {
+        AVStream *s = addStream(format_ctx, apar, atb);
+        if (s)
+            audio_streams.push_back(s->id);
+    } else if (aenc) {
         AVStream *s = addStream(format_ctx, aenc->codecName(), fmt->audio_codec);
         if (s) {
             AVCodecContext *c = s->codec;
@@ -502,6 +543,31 @@ bool AVMuxer::writeVideo(const QtAV::Packet& packet)
     return true;
 }
 
+bool AVMuxer::writeCopiedPacket(AVPacket *pkt, bool video)
+{
+    if (!isOpen() || !pkt)
+        return false;
+    if ((video ? d->vpar : d->apar) == NULL)
+        return false;
+    pkt->stream_index = video ? d->video_streams[0] : d->audio_streams[0];
+    AVStream *s = d->format_ctx->streams[pkt->stream_index];
+    const AVRational tb = video ? d->vtb : d->atb;
+    // stream.time_base is set in avformat_write_header
+    const AVRounding r = AVRounding(AV_ROUND_NEAR_INF|AV_ROUND_PASS_MINMAX);
+    pkt->pts = av_rescale_q_rnd(pkt->pts, tb, s->time_base, r);
+    pkt->dts = av_rescale_q_rnd(pkt->dts, tb, s->time_base, r);
+    if (pkt->duration > 0)
+        pkt->duration = av_rescale_q(pkt->duration, tb, s->time_base);
+    pkt->pos = -1;
+    const int ret = av_interleaved_write_frame(d->format_ctx, pkt);
+    d->started = true;
+    if (ret < 0) {
+        qWarning("failed to write packet to '%s': %s", qPrintable(fileName()), av_err2str(ret));
+        return false;
+    }
+    return true;
+}
+
 void AVMuxer::copyProperties(VideoEncoder *enc)
 {
     d->venc = enc;
@@ -512,6 +578,33 @@ void AVMuxer::copyProperties(AudioEncoder *enc)
     d->aenc = enc;
 }
 
+void AVMuxer::copyProperties(const AVDemuxer *demuxer)
+{
+    avcodec_parameters_free(&d->apar);
+    avcodec_parameters_free(&d->vpar);
+    d->vframe_rate.num = 0;
+    d->vframe_rate.den = 1;
+    d->atb = d->vtb = kTB;
+    if (!demuxer)
+        return;
+    const AVFormatContext *ctx = demuxer->formatContext();
+    if (!ctx)
+        return;
+    if (demuxer->videoStream() >= 0) {
+        AVStream *s = ctx->streams[demuxer->videoStream()];
+        d->vpar = avcodec_parameters_alloc();
+        avcodec_parameters_copy(d->vpar, s->codecpar);
+        d->vframe_rate = s->avg_frame_rate;
+        d->vtb = s->time_base;
+    }
+    if (demuxer->audioStream() >= 0) {
+        AVStream *s = ctx->streams[demuxer->audioStream()];
+        d->apar = avcodec_parameters_alloc();
+        avcodec_parameters_copy(d->apar, s->codecpar);
+        d->atb = s->time_base;
+    }
+}
+
 void AVMuxer::setOptions(const QVariantHash &dict)
 {
     d->options = dict;
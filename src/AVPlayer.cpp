@@ -27,6 +27,7 @@
 #include <QtCore/QEvent>
 #include <QtCore/QDir>
 #include <QtCore/QIODevice>
+#include <QtCore/QMetaMethod>
 #include <QtCore/QThreadPool>
 #include <QtCore/QTimer>
 #include "QtAV/AVDemuxer.h"
@@ -37,6 +38,7 @@
 #include "QtAV/AVClock.h"
 #include "QtAV/VideoCapture.h"
 #include "QtAV/VideoCapture.h"
+#include "QtAV/VideoFrameTap.h"
 #include "filter/FilterManager.h"
 #include "output/OutputSet.h"
 #include "AudioThread.h"
@@ -44,6 +46,8 @@
 #include "AVDemuxThread.h"
 #include "QtAV/private/AVCompat.h"
 #include "utils/internal.h"
+#include "utils/DecoderPool.h"
+#include "utils/LoadScheduler.h"
 #include "utils/Logger.h"
 #include <QUrl>
 extern "C" {
@@ -89,6 +93,7 @@ AVPlayer::AVPlayer(QObject *parent) :
     connect(&d->demuxer, SIGNAL(seekableChanged()), this, SIGNAL(seekableChanged()));
     d->read_thread = new AVDemuxThread(this);
     d->read_thread->setDemuxer(&d->demuxer);
+    d->read_thread->setStatistics(&d->statistics);
     //direct connection can not sure slot order?
     connect(d->read_thread, SIGNAL(finished()), this, SLOT(stopFromDemuxerThread()), Qt::DirectConnection);
     connect(d->read_thread, SIGNAL(requestClockPause(bool)), masterClock(), SLOT(pause(bool)), Qt::DirectConnection);
@@ -98,6 +103,14 @@ AVPlayer::AVPlayer(QObject *parent) :
     connect(d->read_thread, SIGNAL(seekFinished(qint64)), this, SLOT(onSeekFinished(qint64)), Qt::DirectConnection);
     connect(d->read_thread, SIGNAL(stepFinished()), this, SLOT(onStepFinished()), Qt::DirectConnection);
     connect(d->read_thread, SIGNAL(internalSubtitlePacketRead(int, QtAV::Packet)), this, SIGNAL(internalSubtitlePacketRead(int, QtAV::Packet)), Qt::DirectConnection);
+    connect(d->read_thread, SIGNAL(internalAudioPacketRead(QtAV::Packet)), this, SIGNAL(internalAudioPacketRead(QtAV::Packet)), Qt::DirectConnection);
+    connect(d->read_thread, SIGNAL(internalVideoPacketRead(QtAV::Packet)), this, SIGNAL(internalVideoPacketRead(QtAV::Packet)), Qt::DirectConnection);
+    connect(&d->activity, &ActivityDetector::activityChanged, this, &AVPlayer::activityChanged);
+    connect(d->read_thread, &AVDemuxThread::reconnected, this, [this](bool sameParameters) {
+        // decoders can not be reused. reload the whole pipeline
+        if (!sameParameters && isPlaying())
+            play();
+    }, Qt::QueuedConnection);
     d->vcapture = new VideoCapture(this);
 
     connect(this, SIGNAL(mediaStatusChanged(QtAV::MediaStatus)), this, SLOT(onMediaStatusChanged(QtAV::MediaStatus)));
@@ -123,6 +136,8 @@ AVPlayer::AVPlayer(QObject *parent) :
                   d->checkReceivingCounter = 0;
                   d->receivingFrames = false;
                   emit receivingFramesChanged(false);
+                  if (isPlaying())
+                      d->read_thread->requestReconnect();
               }
            }
        }
@@ -148,7 +163,8 @@ AVPlayer::AVPlayer(QObject *parent) :
     connect(&d->demuxer,&AVDemuxer::recordFinished,this,&AVPlayer::recordFinished);
 
 
-    loaderThreadPool->setMaxThreadCount(300);
+    // short tasks only. blocking open runs in LoadScheduler
+    loaderThreadPool->setMaxThreadCount(qBound(4, QThread::idealThreadCount()*2, 16));
 
     class LoadWorker : public QRunnable {
     public:
@@ -172,7 +188,10 @@ AVPlayer::AVPlayer(QObject *parent) :
 
 AVPlayer::~AVPlayer()
 {
-    stop();
+    LoadScheduler::instance().cancel(this);
+    stop(); // interrupts a running load
+    // a running load task accesses d until it returns
+    LoadScheduler::instance().cancel(this, true);
     QMutexLocker lock(&d->load_mutex);
     Q_UNUSED(lock);
     // if not uninstall here, player's qobject children filters will call uninstallFilter too late that player is almost be destroyed
@@ -184,6 +203,9 @@ AVPlayer::~AVPlayer()
     foreach (Filter* f, filters) {
         uninstallFilter(reinterpret_cast<AudioFilter*>(f));
     }
+    foreach (VideoFrameTap* tap, d->frame_taps) {
+        removeFrameTap(tap);
+    }
 }
 
 AVClock* AVPlayer::masterClock()
@@ -304,6 +326,16 @@ bool AVPlayer::isInterruptOnTimeout() const
     return d->demuxer.isInterruptOnTimeout();
 }
 
+void AVPlayer::setProbeCacheEnabled(bool value)
+{
+    d->demuxer.setProbeCacheEnabled(value);
+}
+
+bool AVPlayer::isProbeCacheEnabled() const
+{
+    return d->demuxer.isProbeCacheEnabled();
+}
+
 void AVPlayer::setFrameRate(qreal value)
 {
     d->force_fps = value;
@@ -329,6 +361,81 @@ bool AVPlayer::realtimeDecode() const
     return d->realtimeDecode;
 }
 
+void AVPlayer::setFastFirstFrame(bool value)
+{
+    d->fastFirstFrame = value;
+}
+
+bool AVPlayer::fastFirstFrame() const
+{
+    return d->fastFirstFrame;
+}
+
+void AVPlayer::setActivityDetection(bool value, bool motionVectors)
+{
+    d->activity_detection = value;
+    d->activity.setMotionVectors(value && motionVectors);
+    d->read_thread->setActivityDetector(value ? &d->activity : 0);
+    if (d->vthread)
+        d->vthread->setActivityDetector(value ? &d->activity : 0);
+}
+
+bool AVPlayer::activityDetection() const
+{
+    return d->activity_detection;
+}
+
+void AVPlayer::setActivityThreshold(qreal value)
+{
+    d->activity.setThreshold(value);
+}
+
+qreal AVPlayer::activityThreshold() const
+{
+    return d->activity.threshold();
+}
+
+qreal AVPlayer::activity() const
+{
+    return d->activity.score();
+}
+
+bool AVPlayer::isSceneActive() const
+{
+    return d->activity.isActive();
+}
+
+void AVPlayer::connectNotify(const QMetaMethod &signal)
+{
+    Q_UNUSED(signal);
+    // the player is connecting its own signals in constructor
+    if (!d->read_thread)
+        return;
+    d->read_thread->setPacketSignalsEnabled(isSignalConnected(QMetaMethod::fromSignal(&AVPlayer::internalAudioPacketRead))
+                                            || isSignalConnected(QMetaMethod::fromSignal(&AVPlayer::internalVideoPacketRead)));
+}
+
+void AVPlayer::disconnectNotify(const QMetaMethod &signal)
+{
+    connectNotify(signal); // signal is invalid if all signals are disconnected
+}
+
+void AVPlayer::setKeyFramesOnly(bool value)
+{
+    d->key_frames_only = value;
+    d->read_thread->setKeyFramesOnly(value);
+}
+
+bool AVPlayer::keyFramesOnly() const
+{
+    return d->key_frames_only;
+}
+
+const AVDemuxer* AVPlayer::demuxer() const
+{
+    return &d->demuxer;
+}
+
 const Statistics& AVPlayer::statistics() const
 {
     return d->statistics;
@@ -590,6 +697,19 @@ bool AVPlayer::receivingFrames() const
     return d->receivingFrames;
 }
 
+void AVPlayer::setAutoReconnect(bool value)
+{
+    if (d->read_thread->autoReconnect() == value)
+        return;
+    d->read_thread->setAutoReconnect(value);
+    Q_EMIT autoReconnectChanged();
+}
+
+bool AVPlayer::autoReconnect() const
+{
+    return d->read_thread->autoReconnect();
+}
+
 void AVPlayer::resetMediaData()
 {
     d->statistics.resetValues.store(true);
@@ -698,6 +818,34 @@ VideoCapture* AVPlayer::videoCapture() const
     return d->vcapture;
 }
 
+void AVPlayer::addFrameTap(VideoFrameTap *tap)
+{
+    if (!tap || d->frame_taps.contains(tap))
+        return;
+    if (tap->player())
+        tap->player()->removeFrameTap(tap);
+    d->frame_taps.append(tap);
+    tap->setPlayer(this);
+    if (d->vthread)
+        d->vthread->addFrameTap(tap);
+}
+
+bool AVPlayer::removeFrameTap(VideoFrameTap *tap)
+{
+    if (!d->frame_taps.removeOne(tap))
+        return false;
+    tap->setPlayer(0);
+    // no frame will be put after it returns
+    if (d->vthread)
+        d->vthread->removeFrameTap(tap);
+    return true;
+}
+
+QList<VideoFrameTap*> AVPlayer::frameTaps() const
+{
+    return d->frame_taps;
+}
+
 void AVPlayer::play(const QString& path)
 {
     setFile(path);
@@ -789,6 +937,32 @@ bool AVPlayer::isAsyncLoad() const
     return d->async_load;
 }
 
+void AVPlayer::setLoadLimits(int threads, int perHost)
+{
+    LoadScheduler::instance().setMaxThreadCount(threads);
+    LoadScheduler::instance().setMaxLoadsPerHost(perHost);
+}
+
+QVariantMap AVPlayer::loadStatistics()
+{
+    return LoadScheduler::instance().statistics();
+}
+
+void AVPlayer::setDecoderPoolCapacity(int value, bool hardware)
+{
+    DecoderPool::instance().setCapacity(value, hardware);
+}
+
+int AVPlayer::decoderPoolCapacity()
+{
+    return DecoderPool::instance().capacity();
+}
+
+QVariantMap AVPlayer::decoderPoolStatistics()
+{
+    return DecoderPool::instance().statistics();
+}
+
 bool AVPlayer::isLoaded() const
 {
     return d->loaded;
@@ -807,6 +981,10 @@ void AVPlayer::loadInternal()
             d->vdec->setCodecContext(0);
     }
     qDebug() << "Loading " << d->current_source << " ...";
+    d->loadTimer.start();
+    d->statistics.mutex.lock();
+    d->statistics.timeline.start();
+    d->statistics.mutex.unlock();
     if (d->current_source.type() == QVariant::String) {
         d->demuxer.setMedia(d->current_source.toString());
     } else {
@@ -816,8 +994,15 @@ void AVPlayer::loadInternal()
             d->demuxer.setMedia(d->current_source.value<QtAV::MediaIO*>());
         }
     }
+    const qint64 open_start = d->statistics.timeline.elapsed();
     d->loaded = d->demuxer.load();
     d->status = d->demuxer.mediaStatus();
+    d->statistics.mutex.lock();
+    if (d->demuxer.connectTime() >= 0)
+        d->statistics.timeline.connected = open_start + d->demuxer.connectTime();
+    if (d->demuxer.probeTime() >= 0)
+        d->statistics.timeline.probed = open_start + d->demuxer.probeTime();
+    d->statistics.mutex.unlock();
     if (!d->loaded) {
         d->statistics.reset();
         qWarning("Load failed!");
@@ -869,14 +1054,13 @@ void AVPlayer::unload()
     d->loaded = false;
     d->demuxer.setInterruptStatus(-1);
 
+    // decoders are reused by the next stream with the same parameters
     if (d->adec) { // FIXME: crash if audio external=>internal then replay
-        d->adec->setCodecContext(0);
-        delete d->adec;
+        DecoderPool::instance().park(d->adec);
         d->adec = 0;
     }
     if (d->vdec) {
-        d->vdec->setCodecContext(0);
-        delete d->vdec;
+        DecoderPool::instance().park(d->vdec);
         d->vdec = 0;
     }
     d->demuxer.unload();
@@ -1326,21 +1510,18 @@ bool AVPlayer::load()
         return d->loaded;
     }
 
-    class LoadWorker : public QRunnable {
-    public:
-        LoadWorker(AVPlayer *player) : m_player(player) {
-            setAutoDelete(true);
-        }
-        virtual void run() {
-            if (!m_player)
-                return;
-            m_player->loadInternal();
-        }
-    private:
-        AVPlayer* m_player;
-    };
-    // TODO: thread pool has a max thread limit
-    loaderThreadPool()->start(new LoadWorker(this));
+    // avformat_open_input() may block until network timeout. LoadScheduler limits threads and opens per host
+    const QString url(d->current_source.type() == QVariant::String ? d->current_source.toString() : QString());
+    LoadScheduler::instance().schedule(this, url, [this]() {
+        QElapsedTimer timer;
+        timer.start();
+        loadInternal();
+        Q_EMIT loadFinished(d->loaded, timer.elapsed());
+        if (d->loaded)
+            return LoadScheduler::Succeeded;
+        // stop() interrupts with -1, timeout and other errors are > 0
+        return d->demuxer.getInterruptStatus() < 0 ? LoadScheduler::Canceled : LoadScheduler::Failed;
+    });
     return true;
 }
 
@@ -1709,6 +1890,8 @@ void AVPlayer::stop()
         qDebug("Not playing~");
         if (mediaStatus() == LoadingMedia || mediaStatus() == LoadedMedia) {
             qDebug("loading media: %d", mediaStatus() == LoadingMedia);
+            if (LoadScheduler::instance().cancel(this)) // not started yet
+                updateMediaStatus(NoMedia);
             d->demuxer.setInterruptStatus(-1);
         }
         return;
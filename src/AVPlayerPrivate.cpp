@@ -27,6 +27,7 @@
 #include "QtAV/AudioResampler.h"
 #include "QtAV/MediaIO.h"
 #include "QtAV/VideoCapture.h"
+#include "QtAV/VideoFrameTap.h"
 #include "QtAV/private/AVCompat.h"
 #include <QtCore/QIODevice>
 #if AV_MODULE_CHECK(LIBAVFORMAT, 55, 18, 0, 39, 100)
@@ -34,6 +35,8 @@ extern "C" {
 #include <libavutil/display.h>
 }
 #endif
+#include "utils/DecoderPool.h"
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 #include <QUrl>
 
@@ -146,11 +149,11 @@ AVPlayer::Private::~Private() {
         ao = 0;
     }
     if (adec) {
-        delete adec;
+        DecoderPool::instance().park(adec);
         adec = 0;
     }
     if (vdec) {
-        delete vdec;
+        DecoderPool::instance().park(vdec);
         vdec = 0;
     }
     if (vos) {
@@ -240,6 +243,7 @@ void AVPlayer::Private::initBaseStatistics()
 {
     statistics.reset();
     statistics.url = current_source.type() == QVariant::String ? current_source.toString() : QString();
+    Trace::setStreamName(&statistics, statistics.url);
     statistics.start_time = QTime(0, 0, 0).addMSecs(int(demuxer.startTime()));
     statistics.duration = QTime(0, 0, 0).addMSecs((int)demuxer.duration());
     AVFormatContext *fmt_ctx = demuxer.formatContext();
@@ -370,26 +374,31 @@ bool AVPlayer::Private::setupAudioThread(AVPlayer *player)
         return false;
     }
     qDebug("has audio");
-    // TODO: no delete, just reset avctx and reopen
     if (adec) {
-        adec->disconnect();
-        delete adec;
+        DecoderPool::instance().park(adec);
         adec = 0;
     }
-    adec = AudioDecoder::create();
+    adec = DecoderPool::instance().takeAudioDecoder(AudioDecoderId_FFmpeg, avctx, ac_opt);
+    const bool reused = !!adec;
+    if (!adec)
+        adec = AudioDecoder::create();
     if (!adec)
     {
         qWarning("failed to create audio decoder");
         return false;
     }
     QObject::connect(adec, &AudioDecoder::error, player, &AVPlayer::error);
-    adec->setCodecContext(avctx);
-    adec->setOptions(ac_opt);
-    if (!adec->open()) {
-        AVError e(AVError::AudioCodecNotFound);
-        qWarning() << e.string();
-        emit player->error(e);
-        return false;
+    if (reused) {
+        qDebug("audio decoder reused: %p", adec);
+    } else {
+        adec->setCodecContext(avctx);
+        adec->setOptions(ac_opt);
+        if (!adec->open()) {
+            AVError e(AVError::AudioCodecNotFound);
+            qWarning() << e.string();
+            emit player->error(e);
+            return false;
+        }
     }
     correct_audio_channels(avctx);
     AudioFormat af;
@@ -530,6 +539,11 @@ bool AVPlayer::Private::tryApplyDecoderPriority(AVPlayer *player)
     VideoDecoder *vd = NULL;
     AVCodecContext *avctx = demuxer.videoCodecContext();
     foreach(VideoDecoderId vid, vc_ids) {
+        vd = DecoderPool::instance().takeVideoDecoder(vid, avctx, vc_opt);
+        if (vd) {
+            qDebug("**************Video decoder reused:%p", vd);
+            break;
+        }
         qDebug("**********trying video decoder: %s...", VideoDecoder::name(vid));
         vd = VideoDecoder::create(vid);
         if (!vd)
@@ -551,14 +565,14 @@ bool AVPlayer::Private::tryApplyDecoderPriority(AVPlayer *player)
     if (vd->id() == vdec->id()
             && vd->options() == vdec->options()) {
         qDebug("Video decoder does not change");
-        delete vd;
+        DecoderPool::instance().park(vd);
         return true;
     }
     vthread->packetQueue()->clear();
     vthread->setDecoder(vd);
-    // MUST delete decoder after video thread set the decoder to ensure the deleted vdec will not be used in vthread!
+    // MUST park decoder after video thread set the decoder to ensure the parked vdec will not be used in vthread!
     if (vdec)
-        delete vdec;
+        DecoderPool::instance().park(vdec);
     vdec = vd;
     QObject::connect(vdec, &VideoDecoder::error, player, &AVPlayer::error);
     initVideoStatistics(demuxer.videoStream());
@@ -581,11 +595,15 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
         return false;
     }
     if (vdec) {
-        vdec->disconnect();
-        delete vdec;
+        DecoderPool::instance().park(vdec);
         vdec = 0;
     }
     foreach(VideoDecoderId vid, vc_ids) {
+        vdec = DecoderPool::instance().takeVideoDecoder(vid, avctx, vc_opt);
+        if (vdec) {
+            qDebug("**************Video decoder reused:%p", vdec);
+            break;
+        }
         qDebug("**********trying video decoder: %s...", VideoDecoder::name(vid));
         VideoDecoder *vd = VideoDecoder::create(vid);
         if (!vd) {
@@ -616,6 +634,7 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
         vthread->setVideoCapture(vcapture);
         vthread->setOutputSet(vos);
         read_thread->setVideoThread(vthread);
+        vthread->setActivityDetector(activity_detection ? &activity : 0);
 
         QList<Filter*> filters = FilterManager::instance().videoFilters(player);
         if (filters.size() > 0) {
@@ -623,6 +642,9 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
                 vthread->installFilter(filter);
             }
         }
+        foreach (VideoFrameTap *tap, frame_taps) {
+            vthread->addFrameTap(tap);
+        }
         QObject::connect(vthread, SIGNAL(finished()), player, SLOT(tryClearVideoRenderers()), Qt::DirectConnection);
     }
 
@@ -630,6 +652,10 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
     // as it maybe clear after by AVDemuxThread starting
     vthread->resetState();
     vthread->setDecoder(vdec);
+    activity.reset();
+    foreach (VideoFrameTap *tap, frame_taps) {
+        tap->reset();
+    }
 
     vthread->setBrightness(brightness);
     vthread->setContrast(contrast);
@@ -753,6 +779,12 @@ void AVPlayer::Private::initMediaData()
     mediaData["decoder"] = "";
     mediaData["decoderDetails"] = "";
     mediaData["containerFormat"] = "";
+    mediaData["timeToFirstFrame"] = -1;
+    mediaData["probeCacheHit"] = false;
+    mediaData["reconnects"] = 0;
+    mediaData["reconnectAttempts"] = 0;
+    mediaData["lastReconnectTime"] = -1;
+    mediaData["lastOutageDuration"] = -1;
 }
 
 void AVPlayer::Private::updateMediaData()
@@ -772,6 +804,12 @@ void AVPlayer::Private::updateMediaData()
     mediaData["imageBufferSize"] = statistics.imageBufferSize;
     statistics.mutex.unlock();
 
+    if (read_thread) {
+        const QVariantMap reconnect = read_thread->reconnectStatistics();
+        for (QVariantMap::const_iterator it = reconnect.constBegin(); it != reconnect.constEnd(); ++it)
+            mediaData[it.key()] = it.value();
+    }
+
     if(!calcRates())
         return;
 
@@ -835,6 +873,8 @@ void AVPlayer::Private::applyMediaDataCalculation()
         lastTotalAudioBandwidth = 0;
         lastTotalFrames = 0;
         mediaData["connected"] = true;
+        mediaData["timeToFirstFrame"] = loadTimer.isValid() ? loadTimer.elapsed() : -1;
+        mediaData["probeCacheHit"] = demuxer.isProbeCacheHit();
         elapsedTimer.invalidate();
         totalElapsedTimer.start();
         mediaDataTimer.start();
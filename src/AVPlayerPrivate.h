@@ -27,6 +27,7 @@
 #include "AudioThread.h"
 #include "VideoThread.h"
 #include "AVDemuxThread.h"
+#include "QtAV/private/ActivityDetector.h"
 #include "utils/Logger.h"
 #include <QTimer>
 #include <QElapsedTimer>
@@ -162,6 +163,11 @@ public:
 
     qreal force_fps;
     std::atomic_bool realtimeDecode;
+    std::atomic_bool fastFirstFrame{false};
+    ActivityDetector activity;
+    bool activity_detection = false;
+    bool key_frames_only = false;
+    QList<VideoFrameTap*> frame_taps; // installed to vthread when it's created
     // timerEvent interval in ms. can divide 1000. depends on media duration, fps etc.
     // <0: auto compute internally, |notify_interval| is the real interval
     int notify_interval;
@@ -178,6 +184,7 @@ public:
 
     QElapsedTimer elapsedTimer;
     QElapsedTimer totalElapsedTimer;
+    QElapsedTimer loadTimer; // time to first frame
     quint64 lastTotalBandwidth = 0;
     quint64 lastTotalVideoBandwidth = 0;
     quint64 lastTotalAudioBandwidth = 0;
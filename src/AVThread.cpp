@@ -27,6 +27,7 @@
 #include "QtAV/AVOutput.h"
 #include "QtAV/Filter.h"
 #include "output/OutputSet.h"
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -366,6 +367,7 @@ void AVThread::waitAndCheck(ulong value, qreal pts)
     DPTR_D(AVThread);
     if (value <= 0 || pts < 0)
         return;
+    QTAV_TRACE_SCOPE(Wait, d.statistics);
     value += d.wait_err;
     d.wait_timer.restart();
     //qDebug("wating for %lu msecs", value);
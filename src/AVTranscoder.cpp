@@ -20,21 +20,162 @@
 ******************************************************************************/
 
 #include "QtAV/AVTranscoder.h"
+#include "QtAV/AVDemuxer.h"
 #include "QtAV/AVPlayer.h"
 #include "QtAV/AVMuxer.h"
 #include "QtAV/EncodeFilter.h"
 #include "QtAV/Statistics.h"
+#include "QtAV/private/AVCompat.h"
+#include <atomic>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QThread>
 #include "utils/BlockingQueue.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
 
+// about 20s for 25fps video + 44.1kHz aac
+static const int kMaxQueuedPackets = 1024;
+
+/*!
+ * Writes demuxed packets to 1 muxer in passthrough mode. put() is called in demux thread,
+ * muxer is opened, written and closed in this thread, so a slow output never blocks playback or other outputs.
+ * A failed output is closed and receives no more packets.
+ */
+class PassthroughOutput : public QThread
+{
+public:
+    PassthroughOutput(AVMuxer *m, bool hasVideo, const AVRational& audioTimeBase, const AVRational& videoTimeBase)
+        : muxer(m)
+        , has_video(hasVideo)
+        , wait_key(true)
+        , failed(false)
+        , dropped(0)
+        , rebased(false)
+        , offset(0)
+    {
+        time_base[0] = audioTimeBase;
+        time_base[1] = videoTimeBase;
+        last_dts[0] = last_dts[1] = -1;
+        queue.setCapacity(kMaxQueuedPackets);
+        queue.setThreshold(1); // wake up writer for every packet
+        queue.blockFull(false);
+    }
+    // demux thread
+    void put(const Packet& packet, bool video) {
+        if (failed.load(std::memory_order_relaxed))
+            return;
+        if (wait_key) {
+            // a new output or an overflowed output must start at a key frame
+            if (has_video && (!video || !packet.hasKeyFrame))
+                return;
+            wait_key = false;
+        }
+        if (queue.isFull()) {
+            wait_key = true;
+            dropped++;
+            return;
+        }
+        queue.put(Item(packet, video ? Item::Video : Item::Audio));
+    }
+    void finish() { queue.put(Item()); }
+    qint64 droppedPackets() const { return dropped; }
+
+protected:
+    void run() Q_DECL_OVERRIDE {
+        if (!muxer->open()) {
+            qWarning("AVTranscoder failed to open output '%s'", qPrintable(muxer->fileName()));
+            failed = true;
+            queue.clear();
+            return;
+        }
+        while (true) {
+            bool valid = false;
+            const Item item = queue.take(ULONG_MAX, &valid);
+            if (!valid)
+                continue;
+            if (item.type == Item::End)
+                break;
+            if (!write(item.packet, item.type == Item::Video)) {
+                qWarning("AVTranscoder stops writing output '%s'", qPrintable(muxer->fileName()));
+                failed = true;
+                queue.clear();
+                break;
+            }
+        }
+        muxer->close();
+    }
+
+private:
+    struct Item {
+        enum Type { End, Audio, Video };
+        Item(const Packet& pkt = Packet(), Type t = End) : packet(pkt), type(t) {}
+        Packet packet;
+        Type type;
+    };
+    // Packet timestamps are in seconds computed from integers in stream time base, so rounding back is exact
+    static qint64 toTimeBase(qreal t, const AVRational& tb) { return llrint(t/av_q2d(tb)); }
+    // return false if muxer failed to write
+    bool write(const Packet& src, bool video) {
+        const AVRational tb = time_base[video];
+        const qint64 pts = toTimeBase(src.pts, tb);
+        const qint64 dts = toTimeBase(src.dts, tb);
+        // offset and last_dts are in us to compare audio and video
+        const qint64 dts_us = av_rescale_q_rnd(dts, tb, AV_TIME_BASE_Q, AVRounding(AV_ROUND_NEAR_INF|AV_ROUND_PASS_MINMAX));
+        if (!rebased) {
+            offset = dts_us;
+            rebased = true;
+        }
+        qint64 &last = last_dts[video];
+        qint64 rebased_dts = dts_us - offset;
+        if (rebased_dts < last && video) {
+            // source seeked back. continue from the last video timestamp
+            const qint64 duration_us = av_rescale_q(toTimeBase(src.duration, tb), tb, AV_TIME_BASE_Q);
+            offset = dts_us - last - qMax<qint64>(duration_us, 1000);
+            rebased_dts = dts_us - offset;
+        }
+        // audio interleaved before the first key frame, or before video timestamps after a seek
+        if (rebased_dts < 0 || rebased_dts < last)
+            return true;
+        last = rebased_dts;
+        // round down, so rebased timestamps are never negative
+        const qint64 offset_tb = av_rescale_q_rnd(offset, AV_TIME_BASE_Q, tb, AV_ROUND_DOWN);
+        // data and side data are referenced. AVPacket from Packet has timestamps in ms, replace them
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        pkt.data = NULL;
+        pkt.size = 0;
+        if (av_packet_ref(&pkt, (AVPacket*)src.asAVPacket()) < 0)
+            return true;
+        pkt.pts = pts - offset_tb;
+        pkt.dts = dts - offset_tb;
+        pkt.duration = src.duration > 0 ? toTimeBase(src.duration, tb) : 0;
+        const bool ok = muxer->writeCopiedPacket(&pkt, video);
+        av_packet_unref(&pkt);
+        return ok;
+    }
+
+    AVMuxer *muxer;
+    bool has_video;
+    bool wait_key; // demux thread
+    std::atomic<bool> failed;
+    std::atomic<qint64> dropped;
+    // writer thread
+    AVRational time_base[2]; // source stream time base of audio and video
+    bool rebased;
+    qint64 offset;
+    qint64 last_dts[2];
+    BlockingQueue<Item> queue;
+};
+
 class AVTranscoder::Private
 {
 public:
     Private()
         : started(false)
         , async(false)
+        , passthrough(false)
         , encoded_frames(0)
         , start_time(0)
         , source_player(0)
@@ -43,7 +184,9 @@ public:
     {}
 
     ~Private() {
+        clearOutputs();
         muxer.close();
+        qDeleteAll(extra_muxers);
         if (afilter) {
             delete afilter;
         }
@@ -51,9 +194,21 @@ public:
             delete vfilter;
         }
     }
+    void clearOutputs() {
+        QMutexLocker lock(&outputs_mutex);
+        Q_UNUSED(lock);
+        foreach (PassthroughOutput *out, outputs) {
+            out->finish();
+            out->wait();
+            dropped.append(out->droppedPackets());
+        }
+        qDeleteAll(outputs);
+        outputs.clear();
+    }
 
     bool started;
     bool async;
+    bool passthrough;
     int encoded_frames;
     qint64 start_time;
     AVPlayer *source_player;
@@ -63,6 +218,12 @@ public:
     AVMuxer muxer;
     QString format;
     QVector<Filter*> filters;
+    // passthrough. output 0 is muxer
+    QList<AVMuxer*> extra_muxers;
+    QStringList extra_formats;
+    QMutex outputs_mutex;
+    QList<PassthroughOutput*> outputs;
+    QList<qint64> dropped; // of finished outputs
 };
 
 AVTranscoder::AVTranscoder(QObject *parent)
@@ -96,6 +257,60 @@ bool AVTranscoder::isAsync() const
     return d->async;
 }
 
+void AVTranscoder::setPassthrough(bool value)
+{
+    if (d->passthrough == value)
+        return;
+    if (isRunning()) {
+        qWarning("AVTranscoder: can not change passthrough mode while running");
+        return;
+    }
+    d->passthrough = value;
+    Q_EMIT passthroughChanged();
+}
+
+bool AVTranscoder::isPassthrough() const
+{
+    return d->passthrough;
+}
+
+int AVTranscoder::addOutputMedia(const QString &url, const QString &format, const QVariantHash &options)
+{
+    AVMuxer *m = new AVMuxer();
+    m->setMedia(url);
+    m->setOptions(options);
+    d->extra_muxers.append(m);
+    d->extra_formats.append(format);
+    return d->extra_muxers.size();
+}
+
+void AVTranscoder::clearOutputMedia()
+{
+    if (isRunning()) {
+        qWarning("AVTranscoder: can not remove outputs while running");
+        return;
+    }
+    qDeleteAll(d->extra_muxers);
+    d->extra_muxers.clear();
+    d->extra_formats.clear();
+}
+
+int AVTranscoder::outputCount() const
+{
+    return d->extra_muxers.size() + 1;
+}
+
+qint64 AVTranscoder::droppedPackets(int output) const
+{
+    QMutexLocker lock(&d->outputs_mutex);
+    Q_UNUSED(lock);
+    if (output >= 0 && output < d->outputs.size())
+        return d->outputs.at(output)->droppedPackets();
+    if (output >= 0 && output < d->dropped.size())
+        return d->dropped.at(output);
+    return 0;
+}
+
 void AVTranscoder::setMediaSource(AVPlayer *player)
 {
     if (d->source_player) {
@@ -247,6 +462,16 @@ void AVTranscoder::setStartTime(qint64 ms)
 
 void AVTranscoder::start()
 {
+    if (isPassthrough()) {
+        if (!sourcePlayer() || isRunning())
+            return;
+        d->started = true;
+        // stream parameters are available after source is loaded. otherwise start in onSourceStarted()
+        if (sourcePlayer()->isLoaded())
+            startPassthrough();
+        Q_EMIT started();
+        return;
+    }
     if (!videoEncoder())
         return;
     if (!sourcePlayer())
@@ -281,6 +506,23 @@ void AVTranscoder::stop()
 {
     if (!isRunning())
         return;
+    if (isPassthrough()) {
+        disconnect(sourcePlayer(), SIGNAL(internalAudioPacketRead(QtAV::Packet)), this, SLOT(fanOutAudio(QtAV::Packet)));
+        disconnect(sourcePlayer(), SIGNAL(internalVideoPacketRead(QtAV::Packet)), this, SLOT(fanOutVideo(QtAV::Packet)));
+        disconnect(sourcePlayer(), SIGNAL(stopped()), this, SLOT(stop()));
+        QMutexLocker lock(&d->outputs_mutex);
+        Q_UNUSED(lock);
+        if (d->outputs.isEmpty()) { // source is not started yet
+            lock.unlock();
+            stopInternal();
+            return;
+        }
+        // writers flush queued packets and write trailers. stopInternal() when all are finished
+        foreach (PassthroughOutput *out, d->outputs) {
+            out->finish();
+        }
+        return;
+    }
     if (!d->muxer.isOpen())
         return;
     // uninstall encoder filters first then encoders can be closed safely
@@ -296,6 +538,72 @@ void AVTranscoder::stop()
         d->vfilter->finish();
 }
 
+bool AVTranscoder::startPassthrough()
+{
+    QMutexLocker lock(&d->outputs_mutex);
+    Q_UNUSED(lock);
+    if (!d->outputs.isEmpty())
+        return true;
+    const AVDemuxer *demuxer = sourcePlayer()->demuxer();
+    const bool has_video = demuxer->videoStream() >= 0;
+    const AVFormatContext *ctx = demuxer->formatContext();
+    AVRational atb = {1, 1000}, vtb = {1, 1000};
+    if (demuxer->audioStream() >= 0)
+        atb = ctx->streams[demuxer->audioStream()]->time_base;
+    if (has_video)
+        vtb = ctx->streams[demuxer->videoStream()]->time_base;
+    d->dropped.clear();
+    QList<AVMuxer*> muxers;
+    muxers << &d->muxer << d->extra_muxers;
+    for (int i = 0; i < muxers.size(); ++i) {
+        AVMuxer *m = muxers.at(i);
+        m->copyProperties(demuxer);
+        const QString fmt(i == 0 ? d->format : d->extra_formats.at(i-1));
+        if (!fmt.isEmpty())
+            m->setFormat(fmt); // clear when media changed
+        PassthroughOutput *out = new PassthroughOutput(m, has_video, atb, vtb);
+        connect(out, SIGNAL(finished()), SLOT(onOutputFinished()));
+        d->outputs.append(out);
+        out->start();
+    }
+    connect(sourcePlayer(), SIGNAL(internalAudioPacketRead(QtAV::Packet)), this, SLOT(fanOutAudio(QtAV::Packet)), Qt::DirectConnection);
+    connect(sourcePlayer(), SIGNAL(internalVideoPacketRead(QtAV::Packet)), this, SLOT(fanOutVideo(QtAV::Packet)), Qt::DirectConnection);
+    connect(sourcePlayer(), SIGNAL(stopped()), this, SLOT(stop()), Qt::UniqueConnection);
+    return true;
+}
+
+void AVTranscoder::fanOutAudio(const Packet &packet)
+{
+    QMutexLocker lock(&d->outputs_mutex);
+    Q_UNUSED(lock);
+    foreach (PassthroughOutput *out, d->outputs) {
+        out->put(packet, false);
+    }
+}
+
+void AVTranscoder::fanOutVideo(const Packet &packet)
+{
+    QMutexLocker lock(&d->outputs_mutex);
+    Q_UNUSED(lock);
+    foreach (PassthroughOutput *out, d->outputs) {
+        out->put(packet, true);
+    }
+}
+
+void AVTranscoder::onOutputFinished()
+{
+    {
+        QMutexLocker lock(&d->outputs_mutex);
+        Q_UNUSED(lock);
+        foreach (PassthroughOutput *out, d->outputs) {
+            if (!out->isFinished())
+                return;
+        }
+    }
+    d->clearOutputs();
+    stopInternal();
+}
+
 void AVTranscoder::stopInternal()
 {
     d->muxer.close();
@@ -315,6 +623,11 @@ void AVTranscoder::pause(bool value)
 
 void AVTranscoder::onSourceStarted()
 {
+    if (isPassthrough()) {
+        if (isRunning())
+            startPassthrough();
+        return;
+    }
     if (d->vfilter) {
         qDebug("onSourceStarted framerate: %.3f/%.3f", videoEncoder()->frameRate(), sourcePlayer()->statistics().video.frame_rate);
         if (videoEncoder()->frameRate() <= 0) { // use source frame rate. set before install filter (so before open)
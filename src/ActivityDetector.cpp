@@ -0,0 +1,158 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/private/ActivityDetector.h"
+#include "QtAV/Packet.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+static const int kWarmupPackets = 25; // no score until the size levels are stable
+static const qreal kLevelAlpha = 0.25;
+static const qreal kFloorRise = 0.002; // a scene busy for minutes becomes the new idle level
+static const qreal kFloorFall = 0.1;
+static const qreal kActiveRatio = 3.0; // level/idle_level for score 1
+static const qreal kActiveMotion = 2.0; // pixels for score 1
+static const qreal kMotionTimeout = 1.0; // s. motion score is stale if no decoded frame
+static const qreal kIdleHold = 2.0; // s
+
+ActivityDetector::ActivityDetector(QObject *parent)
+    : QObject(parent)
+    , thres(0.3)
+    , mvs(false)
+{
+    reset();
+}
+
+void ActivityDetector::setThreshold(qreal value)
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    thres = qBound<qreal>(0.01, value, 1.0);
+}
+
+qreal ActivityDetector::threshold() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return thres;
+}
+
+void ActivityDetector::setMotionVectors(bool value)
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    mvs = value;
+    if (!mvs)
+        motion_score = 0;
+}
+
+bool ActivityDetector::motionVectors() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return mvs;
+}
+
+void ActivityDetector::reset()
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    active = false;
+    nb_packets = 0;
+    level = idle_level = 0;
+    size_score = motion_score = 0;
+    motion_pts = active_pts = last_pts = 0;
+    value = 0;
+}
+
+void ActivityDetector::addPacket(const Packet &packet)
+{
+    // key frames are large because of the period, not the scene
+    if (packet.hasKeyFrame || packet.isEOF() || packet.data.isEmpty())
+        return;
+    QMutexLocker lock(&mutex);
+    const qreal size = packet.data.size();
+    if (nb_packets++ == 0)
+        level = idle_level = size;
+    level += (size - level)*kLevelAlpha;
+    idle_level += (level - idle_level)*(level < idle_level ? kFloorFall : kFloorRise);
+    if (nb_packets < kWarmupPackets)
+        return;
+    size_score = qBound<qreal>(0, (level/qMax<qreal>(idle_level, 1) - 1)/(kActiveRatio - 1), 1);
+    const bool was_active = active;
+    update(packet.pts);
+    const bool changed = active != was_active;
+    const qreal s = value;
+    lock.unlock();
+    if (changed)
+        Q_EMIT activityChanged(!was_active, s);
+}
+
+void ActivityDetector::addMotion(qreal pts, qreal motion)
+{
+    QMutexLocker lock(&mutex);
+    if (!mvs)
+        return;
+    motion_score = qBound<qreal>(0, motion/kActiveMotion, 1);
+    motion_pts = pts;
+    const bool was_active = active;
+    update(pts);
+    const bool changed = active != was_active;
+    const qreal s = value;
+    lock.unlock();
+    if (changed)
+        Q_EMIT activityChanged(!was_active, s);
+}
+
+qreal ActivityDetector::score() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return value;
+}
+
+bool ActivityDetector::isActive() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return active;
+}
+
+void ActivityDetector::update(qreal pts)
+{
+    if (pts < last_pts) // seek or loop
+        active_pts = motion_pts = pts;
+    last_pts = pts;
+    value = size_score;
+    if (mvs && pts - motion_pts < kMotionTimeout)
+        value = qMax(value, motion_score);
+    if (value >= thres) {
+        active = true;
+        active_pts = pts;
+    } else if (active) {
+        if (value >= thres/2)
+            active_pts = pts;
+        else if (pts - active_pts > kIdleHold)
+            active = false;
+    }
+}
+} //namespace QtAV
@@ -23,7 +23,9 @@
 #include "QtAV/private/Frame_p.h"
 #include "QtAV/AudioResampler.h"
 #include "QtAV/private/AVCompat.h"
+#include "utils/AudioConvert.h"
 #include "utils/Logger.h"
+#include <QtCore/QVarLengthArray>
 
 namespace QtAV {
 namespace{
@@ -251,6 +253,20 @@ AudioFrame AudioFrame::to(const AudioFormat &fmt) const
     //if (fmt == format())
       //  return clone(); //FIXME: clone a frame from ffmpeg is not enough?
     Q_D(const AudioFrame);
+    // sample format and channel conversion only. the resampler of decoder also changes speed
+    if ((!d->conv || qFuzzyCompare(d->conv->speed(), 1.0)) && AudioConvert::canConvert(format(), fmt)) {
+        QByteArray data(fmt.bytesPerFrame()*samplesPerChannel(), Qt::Uninitialized);
+        const int nb_planes = fmt.planeCount();
+        QVarLengthArray<quint8*, 8> out(nb_planes);
+        for (int i = 0; i < nb_planes; ++i)
+            out[i] = (quint8*)data.data() + i*(data.size()/nb_planes);
+        if (AudioConvert::convert((const quint8**)d->planes.constData(), format(), out.constData(), fmt, samplesPerChannel())) {
+            AudioFrame f(fmt, data);
+            f.setTimestamp(timestamp());
+            f.d_ptr->metadata = d->metadata;
+            return f;
+        }
+    }
     // TODO: use a pool
     AudioResampler *conv = d->conv;
     QScopedPointer<AudioResampler> c;
@@ -32,6 +32,7 @@
 #include "QtAV/private/AVCompat.h"
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 #include "AVPlayer.h"
 
@@ -73,7 +74,10 @@ bool AudioThread::decodePacket(Packet &pkt)
     if (!d.outputSet->outputs().isEmpty())
         ao = static_cast<AudioOutput*>(d.outputSet->outputs().first());
 
-    if (!dec->decode(pkt))
+    QTAV_TRACE_BEGIN(AudioDecode, d.statistics);
+    const bool decoded_ok = dec->decode(pkt);
+    QTAV_TRACE_END(AudioDecode, d.statistics, pkt.pts);
+    if (!decoded_ok)
         return false;
 
     AudioFrame frame(dec->frame());
@@ -337,7 +341,10 @@ void AudioThread::run()
             break;
         }
         //qDebug("apkt: %.3f, %lld %p", pkt.pts, pkt.asAVPacket()->pts, pkt.asAVPacket()->data);
-        if (!dec->decode(pkt)) {
+        QTAV_TRACE_BEGIN(AudioDecode, d.statistics);
+        const bool decoded_ok = dec->decode(pkt);
+        QTAV_TRACE_END(AudioDecode, d.statistics, pkt.pts);
+        if (!decoded_ok) {
             qWarning("Decode audio failed. undecoded: %d", dec->undecodedSize());
             if (pkt.isEOF()) {
                 qDebug("audio decode eof done");
@@ -414,7 +421,9 @@ void AudioThread::run()
             if (has_ao && ao->isOpen()) {
                 QByteArray decodedChunk = QByteArray::fromRawData(decoded.constData() + decodedPos, chunk);
                 //qDebug("ao.timestamp: %.3f, pts: %.3f, pktpts: %.3f", ao->timestamp(), pts, pkt.pts);
+                QTAV_TRACE_BEGIN(AudioWrite, d.statistics);
                 ao->play(decodedChunk, pts);
+                QTAV_TRACE_END(AudioWrite, d.statistics, pts);
                 if (!is_external_clock && ao->timestamp() > 0) {//TODO: clear ao buffer
                    // const qreal da = qAbs(pts - ao->timestamp());
                    // if (da > 1.0) { // what if frame duration is long?
@@ -19,10 +19,15 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ******************************************************************************/
 #include "QtAV/FrameReader.h"
+#include <atomic>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtCore/QQueue>
 #include <QtCore/QThread>
 #include "QtAV/AVDemuxer.h"
 #include "QtAV/VideoDecoder.h"
+#include "QtAV/private/AVCompat.h"
+#include "VideoFrameScaler.h"
 #include "utils/BlockingQueue.h"
 #include "utils/Logger.h"
 
@@ -32,9 +37,43 @@ const int kQueueMin = 2;
 static QVariantHash dec_opt_framedrop;
 static QVariantHash dec_opt_normal;
 
+// packet or frame with its position in the stream. seq < 0: end of stream
+template<typename T>
+struct StageItem {
+    StageItem(qint64 s = -1, const T& v = T()) : seq(s), data(v) {}
+    qint64 seq;
+    T data;
+};
+typedef StageItem<Packet> PacketItem;
+typedef StageItem<VideoFrame> FrameItem;
+
 class FrameReader::Private {
 public:
-    Private() : nb_seek(0) {
+    enum PipelineState { Idle, Running, Finished };
+    typedef void (Private::*StageFunc)(int index);
+    class StageThread : public QThread {
+    public:
+        StageThread(Private *p, StageFunc f, int i) : d(p), func(f), index(i) {}
+        void run() Q_DECL_OVERRIDE { (d->*func)(index); }
+    private:
+        Private *d;
+        StageFunc func;
+        int index;
+    };
+
+    Private(FrameReader *reader)
+        : q(reader)
+        , nb_seek(0)
+        , pipelined(false)
+        , nb_decoders(1)
+        , nb_converters(1)
+        , out_fmt(VideoFormat::Format_Invalid)
+        , state(Idle)
+        , stopping(false)
+        , active_decoders(0)
+        , active_converters(0)
+        , next_seq(0)
+    {
         QVariantHash opt;
         opt[QString::fromLatin1("skip_frame")] = 8; // 8 for "avcodec", "NoRef" for "FFmpeg". see AVDiscard
         opt[QString::fromLatin1("skip_loop_filter")] = 8; //skip all?
@@ -47,16 +86,46 @@ public:
         //decs = QStringList() << "VideoToolbox" << "FFmpeg";
         vframes.setCapacity(4);
         vframes.setThreshold(kQueueMin); //
+        packets.setCapacity(16);
+        packets.setThreshold(1);
+        decoded.setCapacity(4);
+        decoded.setThreshold(1);
     }
     ~Private() {
         if (read_thread.isRunning()) {
             read_thread.quit();
             read_thread.wait();
         }
+        stopPipeline();
     }
 
+    VideoDecoder* createDecoder(const QString& name, int threads = -1);
     bool tryLoad();
     qint64 seekInternal(qint64 pos);
+    // convert to the requested format. scaler is owned by the calling thread
+    VideoFrame scale(VideoFrameScaler *scaler, const VideoFrame& frame) const {
+        if (out_fmt == VideoFormat::Format_Invalid && out_size.width() <= 0 && out_size.height() <= 0)
+            return frame;
+        const VideoFormat fmt(out_fmt == VideoFormat::Format_Invalid ? frame.format() : VideoFormat(out_fmt));
+        return scaler->convert(frame, fmt, VideoFrameScaler::outputSize(frame, out_size));
+    }
+    bool isIntraOnly() {
+        AVCodecContext *ctx = demuxer.videoCodecContext();
+        if (!ctx)
+            return false;
+        const AVCodecDescriptor *cd = avcodec_descriptor_get(ctx->codec_id);
+        return cd && (cd->props & AV_CODEC_PROP_INTRA_ONLY);
+    }
+    // pipeline functions are called in read_thread
+    bool startPipeline();
+    void stopPipeline();
+    // stages
+    void demux(int);
+    void decode(int index);
+    void convert(int index);
+    void output(qint64 seq, const VideoFrame& frame);
+
+    FrameReader *q;
     QString url;
     QStringList vdecs;
     AVDemuxer demuxer;
@@ -64,8 +133,43 @@ public:
     VideoFrameQueue vframes;
     QThread read_thread;
     int nb_seek;
+    VideoFrameScaler scaler; // used by read_thread in serial mode
+    // pipeline. options are used when the pipeline starts
+    bool pipelined;
+    int nb_decoders;
+    int nb_converters;
+    VideoFormat::PixelFormat out_fmt;
+    QSize out_size;
+    std::atomic<int> state;
+    std::atomic<bool> stopping;
+    std::atomic<int> active_decoders;
+    std::atomic<int> active_converters;
+    BlockingQueue<PacketItem> packets;
+    BlockingQueue<FrameItem> decoded;
+    QList<VideoDecoder*> stage_decoders; // decoders created for parallel decoding. empty if decoder is used
+    QList<StageThread*> stages;
+    QMutex reorder_mutex;
+    QMap<qint64, VideoFrame> reorder; // converted frames waiting for frames before them
+    qint64 next_seq;
 };
 
+VideoDecoder* FrameReader::Private::createDecoder(const QString &name, int threads)
+{
+    VideoDecoder *vd = VideoDecoder::create(name.toLatin1().constData());
+    if (!vd)
+        return 0;
+    vd->setCodecContext(demuxer.videoCodecContext());
+    if (!vdecs.isEmpty())
+        vd->setProperty("copyMode", "OptimizedCopy");
+    if (threads >= 0)
+        vd->setProperty("threads", threads); // set before open
+    if (!vd->open()) {
+        delete vd;
+        return 0;
+    }
+    return vd;
+}
+
 bool FrameReader::Private::tryLoad()
 {
     const bool loaded = demuxer.fileName() == url && demuxer.isLoaded();
@@ -88,26 +192,12 @@ bool FrameReader::Private::tryLoad()
         return false;
     }
     if (vdecs.isEmpty()) {
-        VideoDecoder *vd = VideoDecoder::create("FFmpeg");
-        if (vd) {
-            decoder.reset(vd);
-            decoder->setCodecContext(demuxer.videoCodecContext());
-            if (!decoder->open())
-                decoder.reset(0);
-        }
+        decoder.reset(createDecoder(QString::fromLatin1("FFmpeg")));
     } else {
         foreach (const QString& c, vdecs) {
-            VideoDecoder *vd = VideoDecoder::create(c.toLatin1().constData());
-            if (!vd)
-                continue;
-            decoder.reset(vd);
-            decoder->setCodecContext(demuxer.videoCodecContext());
-            decoder->setProperty("copyMode", "OptimizedCopy");
-            if (!decoder->open()) {
-                decoder.reset(0);
-                continue;
-            }
-            break;
+            decoder.reset(createDecoder(c));
+            if (decoder)
+                break;
         }
     }
     nb_seek = 0;
@@ -246,9 +336,164 @@ qint64 FrameReader::Private::seekInternal(qint64 value)
     return qint64(frame.timestamp()*1000.0);
 }
 
+bool FrameReader::Private::startPipeline()
+{
+    if (!tryLoad())
+        return false;
+    // packets of an intra-only codec can be decoded independently. a frame is decoded from every packet if decoding in 1 thread
+    const int nb_dec = isIntraOnly() ? qMax(1, nb_decoders) : 1;
+    if (nb_dec > 1) {
+        for (int i = 0; i < nb_dec; ++i) {
+            VideoDecoder *vd = createDecoder(decoder->name(), 1);
+            if (!vd)
+                break;
+            stage_decoders.append(vd);
+        }
+        if (stage_decoders.size() < 2) {
+            qWarning("FrameReader: failed to create parallel decoders. use 1 decoder");
+            qDeleteAll(stage_decoders);
+            stage_decoders.clear();
+        }
+    }
+    const int nb_dec_used = qMax(1, stage_decoders.size());
+    const int nb_conv = qMax(1, nb_converters);
+    qDebug("FrameReader pipeline: %d decoders, %d converters", nb_dec_used, nb_conv);
+    stopping = false;
+    active_decoders = nb_dec_used;
+    active_converters = nb_conv;
+    next_seq = 0;
+    vframes.setThreshold(1); // frames come one by one
+    stages.append(new StageThread(this, &Private::demux, 0));
+    for (int i = 0; i < nb_dec_used; ++i)
+        stages.append(new StageThread(this, &Private::decode, i));
+    for (int i = 0; i < nb_conv; ++i)
+        stages.append(new StageThread(this, &Private::convert, i));
+    state = Running;
+    foreach (StageThread *t, stages) {
+        t->start();
+    }
+    return true;
+}
+
+void FrameReader::Private::stopPipeline()
+{
+    if (stages.isEmpty())
+        return;
+    stopping = true;
+    packets.setBlocking(false);
+    decoded.setBlocking(false);
+    vframes.setBlocking(false);
+    foreach (StageThread *t, stages) {
+        t->wait();
+    }
+    qDeleteAll(stages);
+    stages.clear();
+    qDeleteAll(stage_decoders);
+    stage_decoders.clear();
+    packets.clear();
+    decoded.clear();
+    reorder.clear();
+    packets.setBlocking(true);
+    decoded.setBlocking(true);
+    vframes.setBlocking(true);
+    vframes.setThreshold(kQueueMin);
+    if (decoder)
+        decoder->flush();
+    state = Idle;
+}
+
+void FrameReader::Private::demux(int)
+{
+    const int vstream = demuxer.videoStream();
+    qint64 seq = 0;
+    while (!stopping && !demuxer.atEnd()) {
+        if (!demuxer.readFrame())
+            continue;
+        if (demuxer.stream() != vstream)
+            continue;
+        packets.put(PacketItem(seq++, demuxer.packet()));
+    }
+    // 1 end mark for each decoder
+    for (int i = qMax(1, stage_decoders.size()); i > 0; --i)
+        packets.put(PacketItem());
+}
+
+void FrameReader::Private::decode(int index)
+{
+    VideoDecoder *dec = stage_decoders.isEmpty() ? decoder.data() : stage_decoders.at(index);
+    // frames of 1 decoder are in order but may be delayed. parallel decoders get 1 frame from every packet
+    const bool ordered = stage_decoders.isEmpty();
+    qint64 seq = 0;
+    while (!stopping) {
+        bool valid = false;
+        const PacketItem pkt(packets.take(ULONG_MAX, &valid));
+        if (!valid)
+            continue;
+        if (pkt.seq < 0)
+            break;
+        VideoFrame frame;
+        if (dec->decode(pkt.data))
+            frame = dec->frame();
+        else
+            qDebug("dec error, continue to decoder");
+        if (ordered) {
+            if (frame)
+                decoded.put(FrameItem(seq++, frame));
+        } else {
+            decoded.put(FrameItem(pkt.seq, frame)); // an invalid frame fills the gap
+        }
+    }
+    if (ordered && !stopping) {
+        while (dec->decode(Packet::createEOF())) {
+            const VideoFrame frame(dec->frame());
+            if (!frame)
+                break;
+            decoded.put(FrameItem(seq++, frame));
+        }
+    }
+    if (--active_decoders > 0)
+        return;
+    for (int i = active_converters; i > 0; --i)
+        decoded.put(FrameItem());
+}
+
+void FrameReader::Private::convert(int)
+{
+    VideoFrameScaler sc;
+    while (!stopping) {
+        bool valid = false;
+        const FrameItem item(decoded.take(ULONG_MAX, &valid));
+        if (!valid)
+            continue;
+        if (item.seq < 0)
+            break;
+        output(item.seq, item.data ? scale(&sc, item.data) : item.data);
+    }
+    if (--active_converters > 0 || stopping)
+        return;
+    vframes.put(VideoFrame()); //make sure take() will not be blocked
+    state = Finished;
+    qDebug("eof");
+    Q_EMIT q->readEnd();
+}
+
+void FrameReader::Private::output(qint64 seq, const VideoFrame &frame)
+{
+    QMutexLocker lock(&reorder_mutex);
+    Q_UNUSED(lock);
+    reorder.insert(seq, frame);
+    while (!reorder.isEmpty() && reorder.firstKey() == next_seq) {
+        const VideoFrame f(reorder.take(next_seq++));
+        if (!f)
+            continue;
+        vframes.put(f);
+        Q_EMIT q->frameRead(f);
+    }
+}
+
 FrameReader::FrameReader(QObject *parent)
     : QObject(parent)
-    , d(new Private())
+    , d(new Private(this))
 {
     moveToThread(&d->read_thread);
     connect(this, SIGNAL(readMoreRequested()), SLOT(readMoreInternal()));
@@ -258,6 +503,12 @@ FrameReader::FrameReader(QObject *parent)
 
 FrameReader::~FrameReader()
 {
+    // stage threads emit signals of this object
+    if (d->read_thread.isRunning()) {
+        d->read_thread.quit();
+        d->read_thread.wait();
+    }
+    d->stopPipeline();
 }
 
 void FrameReader::setMedia(const QString &url)
@@ -284,6 +535,73 @@ QStringList FrameReader::videoDecoders() const
     return d->vdecs;
 }
 
+void FrameReader::setPipelined(bool value)
+{
+    d->pipelined = value;
+}
+
+bool FrameReader::isPipelined() const
+{
+    return d->pipelined;
+}
+
+void FrameReader::setPacketQueueSize(int value)
+{
+    d->packets.setCapacity(qMax(1, value));
+}
+
+int FrameReader::packetQueueSize() const
+{
+    return d->packets.capacity();
+}
+
+void FrameReader::setFrameQueueSize(int value)
+{
+    d->vframes.setCapacity(qMax(kQueueMin, value));
+    d->decoded.setCapacity(qMax(1, value));
+}
+
+int FrameReader::frameQueueSize() const
+{
+    return d->vframes.capacity();
+}
+
+void FrameReader::setDecoderThreads(int value)
+{
+    d->nb_decoders = qMax(1, value);
+}
+
+int FrameReader::decoderThreads() const
+{
+    return d->nb_decoders;
+}
+
+void FrameReader::setConverterThreads(int value)
+{
+    d->nb_converters = qMax(1, value);
+}
+
+int FrameReader::converterThreads() const
+{
+    return d->nb_converters;
+}
+
+void FrameReader::setOutputFormat(VideoFormat::PixelFormat fmt, const QSize &size)
+{
+    d->out_fmt = fmt;
+    d->out_size = size;
+}
+
+VideoFormat::PixelFormat FrameReader::outputFormat() const
+{
+    return d->out_fmt;
+}
+
+QSize FrameReader::outputSize() const
+{
+    return d->out_size;
+}
+
 VideoFrame FrameReader::getVideoFrame()
 {
     return d->vframes.take();
@@ -301,7 +619,16 @@ bool FrameReader::hasEnoughVideoFrames() const
 
 bool FrameReader::readMore()
 {
-    if (d->demuxer.isLoaded() && d->demuxer.atEnd()) {
+    const int state = d->state;
+    if (state == Private::Finished) {
+        if (d->read_thread.isRunning()) {
+            d->read_thread.quit();
+            d->read_thread.wait();
+        }
+        return false;
+    }
+    // demuxer is used by demux stage
+    if (state == Private::Idle && d->demuxer.isLoaded() && d->demuxer.atEnd()) {
         if (!d->read_thread.isRunning())
             return false;
         qDebug("wait for read thread quit");
@@ -325,6 +652,13 @@ bool FrameReader::seek(qint64 pos)
 
 void FrameReader::readMoreInternal()
 {
+    if (d->state != Private::Idle)
+        return;
+    if (d->pipelined) {
+        if (!d->startPipeline())
+            qDebug("load error");
+        return;
+    }
     if (!d->tryLoad()) {
         qDebug("load error");
         return;
@@ -345,11 +679,14 @@ void FrameReader::readMoreInternal()
         }
         pkt = d->demuxer.packet();
         if (d->decoder->decode(pkt)) {
-            const VideoFrame frame(d->decoder->frame());
+            VideoFrame frame(d->decoder->frame());
             if (!frame) {
                 qDebug("no frame got, continue to decoder");
                 continue;
             }
+            frame = d->scale(&d->scaler, frame);
+            if (!frame)
+                continue;
             d->vframes.put(frame);
             Q_EMIT frameRead(frame);
             //qDebug("frame got @%.3f, queue enough: %d", frame.timestamp(), vframes.isEnough());
@@ -364,7 +701,11 @@ void FrameReader::readMoreInternal()
         d->vframes.blockFull(false);
         while (d->decoder->decode(Packet::createEOF())) {
             qDebug("decoded buffered packets");
-            const VideoFrame frame(d->decoder->frame());
+            VideoFrame frame(d->decoder->frame());
+            if (frame)
+                frame = d->scale(&d->scaler, frame);
+            if (!frame)
+                continue;
             d->vframes.put(frame);
             Q_EMIT frameRead(frame);
             qDebug("put decoded buffered packets @%.3f", frame.timestamp());
@@ -378,6 +719,7 @@ void FrameReader::readMoreInternal()
 
 bool FrameReader::seekInternal(qint64 value)
 {
+    d->stopPipeline();
     qint64 t = !d->seekInternal(value);
     if (t < 0)
         return false;
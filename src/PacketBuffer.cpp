@@ -28,6 +28,7 @@ PacketBuffer::PacketBuffer()
     : m_mode(BufferTime)
     , m_buffering(true) // in buffering state at the beginning
     , m_max(1.5)
+    , m_fast_start(false)
     , m_buffer(0)
     , m_value0(0)
     , m_value1(0)
@@ -109,8 +110,20 @@ qreal PacketBuffer::bufferSpeedInBytes() const
     return calc_speed(true);
 }
 
+void PacketBuffer::setFastStart(bool value)
+{
+    m_fast_start = value;
+}
+
+bool PacketBuffer::isFastStart() const
+{
+    return m_fast_start;
+}
+
 bool PacketBuffer::checkEnough() const
 {
+    if (m_fast_start && !queue.isEmpty())
+        return true;
     return buffered() >= bufferValue();
 }
 
@@ -133,7 +146,7 @@ void PacketBuffer::onPut(const Packet &p)
     }
     if (!m_buffering)
         return;
-    if (checkEnough()) {
+    if (buffered() >= bufferValue()) { // fast start does not finish buffering
         m_buffering = false;
     }
     if (!m_buffering) { //buffering=>buffered
@@ -151,6 +164,7 @@ void PacketBuffer::onPut(const Packet &p)
 
 void PacketBuffer::onTake(const Packet &p)
 {
+    m_fast_start = false;
     if (checkEmpty()) {
         m_buffering = true;
     }
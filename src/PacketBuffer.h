@@ -22,6 +22,7 @@
 #ifndef QTAV_PACKETBUFFER_H
 #define QTAV_PACKETBUFFER_H
 
+#include <atomic>
 #include <QtCore/QQueue>
 #include <QtAV/Packet.h>
 #include "utils/BlockingQueue.h"
@@ -77,6 +78,13 @@ public:
      */
     qreal bufferSpeed() const;
     qreal bufferSpeedInBytes() const;
+    /*!
+     * \brief setFastStart
+     * The taker is not blocked by buffering until the first packet is taken. Used to display the first frame as soon as possible.
+     * Reset by clear() and the first take().
+     */
+    void setFastStart(bool value);
+    bool isFastStart() const;
 protected:
     bool checkEnough() const Q_DECL_OVERRIDE;
     bool checkFull() const Q_DECL_OVERRIDE;
@@ -95,6 +103,7 @@ private:
     BufferMode m_mode;
     bool m_buffering;
     qreal m_max;
+    std::atomic<bool> m_fast_start; // set by demux thread, reset by the taker
     // bytes or count
     qint64 m_buffer;
     qint64 m_value0, m_value1;
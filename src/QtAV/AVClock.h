@@ -87,6 +87,13 @@ public:
     inline double videoTime() const;
     inline double delay() const; //playing audio spends some time
     inline void updateDelay(double delay);
+    /*!
+     * \brief videoLatency
+     * Measured time from delivering a video frame to the frame on screen, in seconds.
+     * It's updated by video thread if renderer reports buffer swaps. See PresentScheduler
+     */
+    inline double videoLatency() const;
+    inline void updateVideoLatency(double latency);
     inline qreal diff() const;
 
     void setSpeed(qreal speed);
@@ -138,6 +145,7 @@ private:
     mutable double pts_;
     mutable double pts_v;
     double delay_;
+    double latency_v;
     mutable QElapsedTimer timer;
     qreal mSpeed;
     double value0;
@@ -205,6 +213,16 @@ void AVClock::updateDelay(double delay)
     delay_ = delay;
 }
 
+double AVClock::videoLatency() const
+{
+    return latency_v;
+}
+
+void AVClock::updateVideoLatency(double latency)
+{
+    latency_v = latency;
+}
+
 qreal AVClock::diff() const
 {
     return value() - videoTime();
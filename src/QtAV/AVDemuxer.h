@@ -79,7 +79,17 @@ public:
     QString formatForced() const;
     bool load();
     bool unload();
+    /*!
+     * \brief reconnect
+     * Reopen the url of a network stream, e.g. when it stalls. Signals are not emitted, active recordings continue.
+     * \param sameParameters true if the current audio and video streams have the same codec parameters as before,
+     * so opened decoders can be used for new packets. If false, recordings continue in new segment files "path_N.ext"
+     * \return false if open failed, or interrupted by setInterruptStatus(-1) before or while opening.
+     * The interrupt status is kept, while load() resets it.
+     */
+    bool reconnect(bool* sameParameters = 0);
     bool isLoaded() const;
+    bool isNetwork() const; // url of a network protocol
     /*!
      * \brief readFrame
      * Read a packet from 1 of the streams. use packet() to get the result packet. packet() returns last valid packet.
@@ -119,6 +129,7 @@ public:
      */
     bool seek(qreal q);
     AVFormatContext* formatContext();
+    const AVFormatContext* formatContext() const;
     QString formatName() const;
     QString formatLongName() const;
     // TODO: rename startPosition()
@@ -188,6 +199,22 @@ public:
      */
     void setOptions(const QVariantHash &dict);
     QVariantHash options() const;
+    /*!
+     * \brief setProbeCacheEnabled
+     * Cache codec parameters of network streams found by avformat_find_stream_info() and apply them when the same url is loaded again,
+     * so load() returns after the first packets instead of probing for seconds. The cache is saved in application data dir.
+     * If the first packets do not match the cached parameters, the entry is dropped and media is probed again.
+     * Default is disabled.
+     */
+    void setProbeCacheEnabled(bool value);
+    bool isProbeCacheEnabled() const;
+    /// true if the last load() used cached parameters
+    bool isProbeCacheHit() const;
+    /// "hits", "misses", "rejected", "entries" of all demuxers
+    static QVariantMap probeCacheStatistics();
+    /// ms from the start of the last load() until the input is opened / stream info is found. -1 if not reached
+    qint64 connectTime() const;
+    qint64 probeTime() const;
 Q_SIGNALS:
     void unloaded();
     void userInterrupted(); //NO direct connection because it's emit before interrupted happens
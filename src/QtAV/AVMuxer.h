@@ -33,6 +33,7 @@
 namespace QtAV {
 
 class MediaIO;
+class AVDemuxer;
 class VideoEncoder;
 class AudioEncoder;
 class  AVMuxer : public QObject
@@ -71,9 +72,16 @@ public:
     bool close();
     bool isOpen() const;
 
-    // TODO: copyAudioContext(void* avctx) for copy encoding without decoding
     void copyProperties(VideoEncoder* enc); //rename to setEncoder
     void copyProperties(AudioEncoder* enc);
+    /*!
+     * \brief copyProperties
+     * Copy codec parameters of demuxer's current audio and video streams to remux packets without decoding and encoding.
+     * Parameters are copied immediately, so demuxer can be closed later. A copied stream overrides the encoder of the same type.
+     * Packet timestamps passed to writeAudio()/writeVideo() are in seconds as usual, so do not pass packets created by Packet::fromAVPacket() directly.
+     * Call with null demuxer to clear copied streams. Call before open()
+     */
+    void copyProperties(const AVDemuxer* demuxer);
 
     void setOptions(const QVariantHash &dict);
     QVariantHash options() const;
@@ -86,6 +94,15 @@ public Q_SLOTS:
     //void writeHeader();
     //void writeTrailer();
 private:
+    /*!
+     * \brief writeCopiedPacket
+     * Write a packet of a stream copied by copyProperties(AVDemuxer*). pkt timestamps are in the source stream time base,
+     * and are rescaled to the output stream with rounding. Side data is written as is.
+     * The packet reference is taken by the muxer, pkt is blank after return.
+     * \return false if not written, e.g. the connection is closed
+     */
+    bool writeCopiedPacket(AVPacket* pkt, bool video);
+    friend class PassthroughOutput; // AVTranscoder passthrough mode
     class Private;
     QScopedPointer<Private> d;
 };
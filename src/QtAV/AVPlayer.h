@@ -38,12 +38,14 @@ QT_END_NAMESPACE
 namespace QtAV {
 
 class MediaIO;
+class AVDemuxer;
 class AudioOutput;
 class VideoRenderer;
 class Filter;
 class AudioFilter;
 class VideoFilter;
 class VideoCapture;
+class VideoFrameTap;
 /*!
  * \brief The AVPlayer class
  * Preload:
@@ -86,6 +88,7 @@ class  AVPlayer : public QObject
     Q_PROPERTY(int mediaDataTimerInterval READ mediaDataTimerInterval WRITE setMediaDataTimerInterval NOTIFY mediaDataTimerIntervalChanged)
     Q_PROPERTY(int disconnectTimeout READ disconnectTimeout WRITE setDisconnectTimeout NOTIFY disconnectTimeoutChanged)
     Q_PROPERTY(bool receivingFrames READ receivingFrames NOTIFY receivingFramesChanged)
+    Q_PROPERTY(bool autoReconnect READ autoReconnect WRITE setAutoReconnect NOTIFY autoReconnectChanged)
     Q_PROPERTY(unsigned int chapters READ chapters NOTIFY chaptersChanged)
     Q_ENUMS(State)
 public:
@@ -140,6 +143,32 @@ public:
      */
     void setAsyncLoad(bool value = true);
     bool isAsyncLoad() const;
+    /*!
+     * \brief setLoadLimits
+     * Async load of all players runs in a shared fixed size thread pool. Concurrent opens to the same network host are limited to perHost,
+     * and a host failed to open is retried with exponential backoff. stop() cancels a queued or running load.
+     * Default is 2x cpu cores (4~16) threads and 4 loads per host.
+     */
+    static void setLoadLimits(int threads, int perHost);
+    /*!
+     * \brief loadStatistics
+     * Counters and percentiles of queued time and open latency in ms of async loads of all players:
+     * "queued", "running", "succeeded", "failed", "canceled", "wait_p50", "wait_p90", "wait_p99", "open_p50", "open_p90", "open_p99"
+     */
+    static QVariantMap loadStatistics();
+    /*!
+     * \brief setDecoderPoolCapacity
+     * Decoders of all players are flushed and parked in a process wide pool when a stream is closed, and reused when a stream
+     * with the same decoder backend, codec, profile, size (sample rate and channels for audio), extradata and options is opened,
+     * e.g. switching cameras of the same model. Codec initialization and frame pool allocation are skipped.
+     * The oldest parked decoder is deleted if full. 0 disables the pool. Default is 0
+     * \param hardware park hardware decoders too. Their surfaces and devices stay allocated while parked,
+     * and a decoder parked by one player may be used by another player
+     */
+    static void setDecoderPoolCapacity(int value, bool hardware = false);
+    static int decoderPoolCapacity();
+    /// "hits", "misses", "parked", "evicted"
+    static QVariantMap decoderPoolStatistics();
     /*!
      * \brief setAutoLoad
      * true: current media source changed immediatly and stop current playback if new media source is set.
@@ -275,6 +304,15 @@ public:
      * \sa VideoCapture
      */
     VideoCapture *videoCapture() const;
+    /*!
+     * \brief addFrameTap
+     * Deliver sub-sampled and converted video frames to an analytics consumer without stalling playback.
+     * The tap is moved from its previous player. It's removed automatically when deleted. Not owned by player.
+     * \sa VideoFrameTap
+     */
+    void addFrameTap(VideoFrameTap* tap);
+    bool removeFrameTap(VideoFrameTap* tap);
+    QList<VideoFrameTap*> frameTaps() const;
     //TODO: no replay, replay without parsing the stream if it's already loaded. (not implemented). to force reload the stream, unload() then play()
     /*!
      * \brief play
@@ -330,6 +368,14 @@ public:
      */
     void setInterruptOnTimeout(bool value);
     bool isInterruptOnTimeout() const;
+    /*!
+     * \brief setProbeCacheEnabled
+     * Cache stream parameters of network streams in application data dir to open them faster next time.
+     * Default is disabled.
+     * \sa AVDemuxer::setProbeCacheEnabled()
+     */
+    void setProbeCacheEnabled(bool value);
+    bool isProbeCacheEnabled() const;
     /*!
      * \brief setFrameRate
      * Force the (video) frame rate to a given value.
@@ -341,8 +387,44 @@ public:
     qreal forcedFrameRate() const;
     void setRealtimeDecode(bool value);
     bool realtimeDecode() const;
+    /*!
+     * \brief setFastFirstFrame
+     * Display the first key frame as soon as it arrives without waiting for buffering and a/v sync,
+     * then continue with synced playback. Useful for live streams. Takes effect on the next play().
+     * Default is false.
+     */
+    void setFastFirstFrame(bool value);
+    bool fastFirstFrame() const;
+    /*!
+     * \brief setActivityDetection
+     * Estimate scene activity from compressed video packets without decoding: sizes of non-key packets compared with
+     * their long term level. If motionVectors is true, motion vectors exported by FFmpeg decoder are used too, which
+     * requires the frames to be decoded. activityChanged() is emitted when the scene becomes active or idle.
+     * Use with setKeyFramesOnly() to decode idle streams, e.g. tiles that are off screen, at a fraction of the cost.
+     * Default is false.
+     */
+    void setActivityDetection(bool value, bool motionVectors = false);
+    bool activityDetection() const;
+    /// score in [0, 1] to become active. Default is 0.3
+    void setActivityThreshold(qreal value);
+    qreal activityThreshold() const;
+    /// current activity score in [0, 1]
+    qreal activity() const;
+    bool isSceneActive() const;
+    /*!
+     * \brief setKeyFramesOnly
+     * Decode key frames only. Packets are still read, so activity detection and recording work. When disabled,
+     * full decoding resumes from the next key frame. Can be changed during playback. Default is false.
+     */
+    void setKeyFramesOnly(bool value);
+    bool keyFramesOnly() const;
     //Statistics& statistics();
     const Statistics& statistics() const;
+    /*!
+     * \brief demuxer
+     * Demuxer of current media, e.g. to copy stream parameters by AVMuxer::copyProperties(). Streams are valid after loaded.
+     */
+    const AVDemuxer* demuxer() const;
     /*!
      * \brief installFilter
      * Insert a filter at position 'index' of current filter list.
@@ -428,6 +510,15 @@ public:
     void setDisconnectTimeout(int value);
 
     bool receivingFrames() const;
+    /*!
+     * \brief setAutoReconnect
+     * Reopen a network stream when no frame is received in disconnectTimeout() seconds or the stream ends.
+     * Only the input is reopened and decoders are kept if codec parameters are not changed, otherwise the media is reloaded.
+     * A recording continues in the same file, or in a new segment file "name_N.ext" if codec parameters are changed.
+     * Reconnect statistics are available in mediaData(). Default is false.
+     */
+    void setAutoReconnect(bool value);
+    bool autoReconnect() const;
 
     void resetMediaData();
 
@@ -569,6 +660,12 @@ Q_SIGNALS:
     void muteChanged();
     void sourceChanged();
     void loaded(); // == mediaStatusChanged(QtAV::LoadedMedia)
+    /*!
+     * \brief loadFinished
+     * Emitted in loader thread when async load is finished, whether media is loaded or not.
+     * \param elapsed time of opening media in ms, not including the time waiting for a free loader
+     */
+    void loadFinished(bool success, qint64 elapsed);
     void mediaStatusChanged(QtAV::MediaStatus status); //explictly use QtAV::MediaStatus
     void mediaEndActionChanged(QtAV::MediaEndAction action);
     void firstKeyFrameReceived();
@@ -577,6 +674,9 @@ Q_SIGNALS:
     void mediaDataTimerIntervalChanged(int);
     void disconnectTimeoutChanged(int);
     void receivingFramesChanged(bool);
+    /// \sa setActivityDetection()
+    void activityChanged(bool active, qreal score);
+    void autoReconnectChanged();
     void recordFinished(bool success, const QString& format);
     /*!
      * \brief durationChanged emit when media is loaded/unloaded
@@ -634,6 +734,14 @@ Q_SIGNALS:
      */
     void internalSubtitleHeaderRead(const QByteArray& codec, const QByteArray& data);
     void internalSubtitlePacketRead(int track, const QtAV::Packet& packet);
+    /*!
+     * \brief internalAudioPacketRead
+     * internalVideoPacketRead
+     * Emitted in demux thread for every packet of current internal audio/video stream before decoding, only if connected.
+     * Use Qt::DirectConnection and return quickly. Used by AVTranscoder passthrough mode.
+     */
+    void internalAudioPacketRead(const QtAV::Packet& packet);
+    void internalVideoPacketRead(const QtAV::Packet& packet);
 private Q_SLOTS:
     void loadInternal(); // simply load
     void playInternal(); // simply play
@@ -653,6 +761,8 @@ private Q_SLOTS:
 protected:
     // TODO: set position check timer interval
     virtual void timerEvent(QTimerEvent *);
+    void connectNotify(const QMetaMethod& signal) Q_DECL_OVERRIDE;
+    void disconnectNotify(const QMetaMethod& signal) Q_DECL_OVERRIDE;
 private:
     /*!
      * \brief unload
@@ -65,6 +65,29 @@ public:
      */
     void setAsync(bool value = true);
     bool isAsync() const;
+    /*!
+     * \brief setPassthrough
+     * Remux demuxed packets of sourcePlayer() without decoding and encoding, e.g. container change or segmenting.
+     * Encoders are not required and not used in this mode. Every output is written in it's own thread,
+     * starts at a video key frame, and it's timestamps are rebased to 0. Default is disabled.
+     * Change it when transcoder is stopped.
+     */
+    void setPassthrough(bool value = true);
+    bool isPassthrough() const;
+    /*!
+     * \brief addOutputMedia
+     * Add an extra output for passthrough mode. Output 0 is always the one set by setOutputMedia().
+     * Use format to force a muxer, for example "segment" with option "segment_time", or "mpegts" for "udp://" or "tcp://" urls.
+     * \return output index
+     */
+    int addOutputMedia(const QString& url, const QString& format = QString(), const QVariantHash& options = QVariantHash());
+    void clearOutputMedia(); // remove extra outputs
+    int outputCount() const;
+    /*!
+     * \brief droppedPackets
+     * Packets dropped in passthrough mode because output thread can not write as fast as source. Output restarts at the next key frame.
+     */
+    qint64 droppedPackets(int output = 0) const;
     /*!
      * \brief createEncoder
      * Destroy old encoder and create a new one in filter chain. Filter has the ownership. You shall not manually open it. Transcoder will set the missing parameters open it.
@@ -119,6 +142,7 @@ Q_SIGNALS:
     void paused(bool value);
     void startTimeChanged(qint64 ms);
     void asyncChanged();
+    void passthroughChanged();
 
 public Q_SLOTS:
     void start();
@@ -141,8 +165,12 @@ private Q_SLOTS:
     void writeAudio(const QtAV::Packet& packet);
     void writeVideo(const QtAV::Packet& packet);
     void tryFinish();
+    void onOutputFinished();
+    void fanOutAudio(const QtAV::Packet& packet);
+    void fanOutVideo(const QtAV::Packet& packet);
 
 private:
+    bool startPassthrough();
     void stopInternal();
     class Private;
     QScopedPointer<Private> d;
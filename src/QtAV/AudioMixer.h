@@ -0,0 +1,89 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOMIXER_H
+#define QTAV_AUDIOMIXER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+#include <QtAV/AudioFormat.h>
+
+namespace QtAV {
+
+class AudioOutput;
+/*!
+ * \brief The AudioMixer class
+ * A process wide software mixer. AudioOutputs using the backend AudioMixer::backendName() are mixer inputs,
+ * they are mixed and played by one AudioOutput device:
+ *   player->audio()->setBackends(QStringList() << AudioMixer::backendName());
+ * Inputs are converted to format() once by their resampler, and mixed with their own volume, mute and pan.
+ * The device is opened when the first input is opened and closed when the last input is closed.
+ * The device paces all inputs, so each player's audio clock follows the same stream.
+ * Use "null" device backend for a deterministic device without real playback, e.g. in tests.
+ */
+class  AudioMixer : public QObject
+{
+    Q_OBJECT
+public:
+    static AudioMixer& instance();
+    static QString backendName();
+    ~AudioMixer();
+    /*!
+     * \brief setFormat
+     * Sample rate and channel layout of the device. Sample format is always float.
+     * Default is 48000Hz stereo. Takes effect when the device is opened next time.
+     */
+    void setFormat(int sampleRate, AudioFormat::ChannelLayout layout);
+    AudioFormat format() const;
+    /*!
+     * \brief setBackends
+     * Backends of the device. Default is the default priority of AudioOutput.
+     * Takes effect when the device is opened next time.
+     */
+    void setBackends(const QStringList& names);
+    QStringList backends() const;
+    /*!
+     * \brief setPan
+     * Pan of an input. -1: left, 0: center, 1: right. Only stereo device is affected.
+     * The value is reset when the input is closed.
+     */
+    void setPan(AudioOutput* input, qreal value);
+    qreal pan(AudioOutput* input) const;
+    int inputCount() const;
+    bool isRunning() const;
+    /*!
+     * \brief statistics
+     * "inputs", "periods": mixed periods, "underruns": periods an input has queued data for but not enough,
+     * "clipped": clipped samples
+     */
+    QVariantMap statistics() const;
+Q_SIGNALS:
+    void runningChanged(bool running);
+private:
+    AudioMixer();
+    class Private;
+    QScopedPointer<Private> d;
+    friend class AudioOutputMixer;
+};
+} //namespace QtAV
+#endif // QTAV_AUDIOMIXER_H
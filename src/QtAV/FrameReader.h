@@ -40,6 +40,8 @@ namespace QtAV {
  * while (r.hasVideoFrame()) { //get buffered frames
  *     reader->getVideoFrame();
  * }
+ * For batch processing, setPipelined(true) runs demux, decode and convert stages in their own threads.
+ * Pipeline options must be set before readMore(). seek() stops the pipeline and the next readMore() restarts it.
  * TODO: multiple tracks
  */
 class  FrameReader : public QObject
@@ -54,6 +56,38 @@ public:
     QString mediaUrl() const;
     void setVideoDecoders(const QStringList& names);
     QStringList videoDecoders() const;
+    /*!
+     * \brief setPipelined
+     * Demux, decode and convert in separate threads connected by queues. Default is false, i.e. demux and decode in 1 thread
+     */
+    void setPipelined(bool value);
+    bool isPipelined() const;
+    /// packets queued between demux and decode stage in pipelined mode. default is 16
+    void setPacketQueueSize(int value);
+    int packetQueueSize() const;
+    /// frames queued for getVideoFrame(), and between decode and convert stage. default is 4
+    void setFrameQueueSize(int value);
+    int frameQueueSize() const;
+    /*!
+     * \brief setDecoderThreads
+     * Number of decoders running in parallel in pipelined mode. Only used for intra-only codecs (e.g. MJPEG) whose packets
+     * can be decoded independently, and every decoder decodes in 1 thread. Default is 1
+     */
+    void setDecoderThreads(int value);
+    int decoderThreads() const;
+    /// number of convert threads in pipelined mode. default is 1
+    void setConverterThreads(int value);
+    int converterThreads() const;
+    /*!
+     * \brief setOutputFormat
+     * Convert and scale frames. Hardware decoded frames are copied to host memory.
+     * \param fmt VideoFormat::Format_Invalid: keep the decoded format
+     * \param size if width or height <= 0, it's computed from the other one and display aspect ratio.
+     * Both <= 0: keep the decoded size. The result size is even.
+     */
+    void setOutputFormat(VideoFormat::PixelFormat fmt, const QSize& size = QSize());
+    VideoFormat::PixelFormat outputFormat() const;
+    QSize outputSize() const;
     VideoFrame getVideoFrame();
     bool hasVideoFrame() const;
     bool hasEnoughVideoFrames() const;
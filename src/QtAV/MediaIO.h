@@ -37,6 +37,17 @@ namespace QtAV {
  *   properties:
  *     device - read only. example: io->device()
  *   protocols: "", "qrc"
+ * "ReadAhead": wraps another MediaIO and reads ahead into a ring buffer on a background thread
+ *   properties:
+ *     source - read/write. parameter: MediaIO*. the wrapped io, not owned
+ *     readAheadSize - read/write. ring buffer size in bytes
+ *     backwardSize - read/write. bytes kept behind current position for backward seeks
+ *     hitRatio, fillLevel - read only. statistics
+ *   protocols: "readahead". example: "readahead:/path/to/file", "readahead:qrc:/xxx"
+ * "MMap": memory mapped local file
+ *   properties:
+ *     variableSize - read/write. set true for a growing file, the file will be remapped when reaching the end
+ *   protocols: "mmap". example: "mmap:/path/to/file"
  */
 typedef int MediaIOId;
 class MediaIOPrivate;
@@ -52,7 +63,7 @@ public:
         Write
     };
 
-    /// Registered MediaIO::name(): "QIODevice", "QFile"
+    /// Registered MediaIO::name(): "QIODevice", "QFile", "ReadAhead", "MMap"
     static QStringList builtInNames();
     /*!
      * \brief createForProtocol
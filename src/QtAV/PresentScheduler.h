@@ -0,0 +1,118 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_PRESENTSCHEDULER_H
+#define QTAV_PRESENTSCHEDULER_H
+
+#include <QtCore/QScopedPointer>
+#include <QtAV/QtAV_Global.h>
+
+namespace QtAV {
+
+/*!
+ * \brief The PresentScheduler class
+ * Vsync aligned frame presentation. A renderer which can report buffer swaps (OpenGLWindowRenderer,
+ * OpenGLWidgetRenderer and QML VideoOutput) calls vsync() after each swap, and the video thread asks
+ * schedule() when to deliver a frame, so that the frame is painted in the refresh before the vsync nearest
+ * to its display time instead of whenever the decoder finishes. The measured delay from delivery to swap
+ * is used to deliver frames earlier, and is fed back to AVClock::videoLatency().
+ * Statistics are collected even if alignment is disabled, so both modes can be compared.
+ * Timestamps are in ns from now(). Thread safe.
+ */
+class  PresentScheduler
+{
+public:
+    enum {
+        HistogramZero = 2, //!< index of the on time bucket
+        HistogramSize = 8
+    };
+    class Report {
+    public:
+        Report();
+        qint64 presented; //!< presented frames with a known display time
+        qint64 early; //!< presented half a refresh or more before the display time
+        qint64 late; //!< presented half a refresh or more after the display time
+        qreal refreshInterval; //!< seconds
+        qreal latency; //!< average delay from delivery to swap, seconds
+        /*!
+         * average deviation of how long a frame stays on screen from its duration in the stream, seconds.
+         * e.g. 25fps on 60Hz can not be better than a 2:3 pulldown, i.e. ~0.0083s
+         */
+        qreal judder;
+        /*!
+         * histogram[HistogramZero+n]: frames presented n refreshes after their display time (rounded).
+         * The first and the last bucket are open ended.
+         */
+        qint64 histogram[HistogramSize];
+    };
+
+    PresentScheduler();
+    ~PresentScheduler();
+    /*!
+     * \brief setEnabled
+     * Align frame delivery to vsync. Default is false.
+     */
+    void setEnabled(bool value);
+    bool isEnabled() const;
+    /*!
+     * \brief setRefreshRate
+     * Refresh rate of the screen if known, e.g. QScreen::refreshRate(). Otherwise it's estimated from vsync().
+     * 0: estimate.
+     */
+    void setRefreshRate(qreal hz);
+    qreal refreshRate() const;
+    /*!
+     * \brief vsync
+     * Called by renderer after a buffer swap.
+     * \param pts timestamp of the frame on screen, or a negative value if unknown
+     */
+    void vsync(qint64 ns, qreal pts);
+    /*!
+     * \brief isActive
+     * Enabled and vsync() is called recently
+     */
+    bool isActive(qint64 ns) const;
+    /*!
+     * \brief leadTime
+     * How long before its display time a frame must be available to be scheduled, in seconds. 0 if not active.
+     */
+    qreal leadTime(qint64 ns) const;
+    /*!
+     * \brief schedule
+     * \param pts timestamp of the frame to deliver
+     * \param target the time the frame should be on screen
+     * \param ns current time
+     * \return the time to deliver the frame to the renderer. It's target if not active
+     */
+    qint64 schedule(qreal pts, qint64 target, qint64 ns);
+    qreal latency() const;
+    Report report() const;
+    /// clear report(). the measured latency is kept
+    void reset();
+    /// monotonic time in ns
+    static qint64 now();
+private:
+    class Private;
+    QScopedPointer<Private> d;
+    Q_DISABLE_COPY(PresentScheduler)
+};
+} //namespace QtAV
+#endif // QTAV_PRESENTSCHEDULER_H
@@ -38,6 +38,7 @@
 #include <QtAV/AudioEncoder.h>
 #include <QtAV/AudioDecoder.h>
 #include <QtAV/AudioFormat.h>
+#include <QtAV/AudioMixer.h>
 #include <QtAV/AudioOutput.h>
 #include <QtAV/AudioResampler.h>
 
@@ -61,6 +62,9 @@
 #include <QtAV/VideoFormat.h>
 #include <QtAV/VideoFrame.h>
 #include <QtAV/VideoFrameExtractor.h>
+#include <QtAV/VideoFrameTap.h>
+#include <QtAV/SharedFrameReader.h>
+#include <QtAV/SharedMemoryRenderer.h>
 #include <QtAV/VideoRenderer.h>
 #include <QtAV/VideoOutput.h>
 //The following renderer headers can be removed
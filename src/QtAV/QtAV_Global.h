@@ -74,6 +74,23 @@ enum LogLevel {
  * \param level can be: quiet, panic, fatal, error, warn, info, verbose, debug, trace
  */
  void setFFmpegLogLevel(const QByteArray& level);
+/*!
+ * \brief setTraceEnabled
+ * Record events of the playback pipeline, e.g. packet read, enqueue, decode, filter, convert, present, seek and
+ * buffer state, to per thread ring buffers. Events of each player are grouped by player, so cross thread stalls of
+ * a stream can be found among many players. It's almost free if disabled.
+ * Default is false, or true if environment variable QTAV_TRACE=1. Not available if built with QTAV_NO_TRACE.
+ */
+ void setTraceEnabled(bool value);
+ bool isTraceEnabled();
+/*!
+ * \brief saveTrace
+ * Save recent events as Chrome trace event format json, which can be opened by chrome://tracing or Perfetto UI.
+ * Recording is not paused. Events overwritten while copying are dropped.
+ * Events of the latest 16 finished threads are kept until clearTrace().
+ */
+ bool saveTrace(const QString& path);
+ void clearTrace();
 
 /// query the common options of avformat/avcodec that can be used by AVPlayer::setOptionsForXXX. Format/codec specified options are also included
  QString avformatOptions();
@@ -0,0 +1,74 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SHAREDFRAMEREADER_H
+#define QTAV_SHAREDFRAMEREADER_H
+
+#include <QtCore/QScopedPointer>
+#include <QtAV/VideoFrame.h>
+
+namespace QtAV {
+/*!
+ * \brief The SharedFrameReader class
+ * Reads frames exported by a SharedMemoryRenderer, usually in another process, without decoding or copying.
+ * \code
+ *   SharedFrameReader reader;
+ *   while (!reader.open(name))
+ *       QThread::msleep(100);
+ *   while (running) {
+ *       const VideoFrame f = reader.getVideoFrame(500);
+ *       if (f.isValid())
+ *           process(f);
+ *   } // f is released
+ * \endcode
+ * Not thread safe. Only supported on unix except android.
+ */
+class  SharedFrameReader
+{
+    Q_DISABLE_COPY(SharedFrameReader)
+public:
+    SharedFrameReader();
+    ~SharedFrameReader();
+    /*!
+     * \brief open
+     * Open the ring of SharedMemoryRenderer::name(). Returns false if the exporter has not received a frame yet.
+     */
+    bool open(const QString& name);
+    void close();
+    bool isOpen() const;
+    QString name() const;
+    /*!
+     * \brief getVideoFrame
+     * Returns the latest frame newer than the previous returned one. Wait at most timeout msecs (-1: forever) if there is no new frame.
+     * Returns an invalid frame if timed out. If the exporter recreated the ring, it's reopened.
+     * The frame data is in shared memory. The exporter does not overwrite the slot until the frame, and any copy or clone() of it,
+     * is destroyed, so do not hold more frames than SharedMemoryRenderer::slotCount() - 1.
+     * Meta data "latency" is ns from the frame is exported to it's returned.
+     */
+    VideoFrame getVideoFrame(int timeout = -1);
+    /// frames exported but not returned because the reader is slower than the exporter
+    qint64 skippedFrames() const;
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+} //namespace QtAV
+#endif // QTAV_SHAREDFRAMEREADER_H
@@ -0,0 +1,67 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SHAREDMEMORYRENDERER_H
+#define QTAV_SHAREDMEMORYRENDERER_H
+
+#include <QtAV/VideoRenderer.h>
+
+namespace QtAV {
+
+class SharedMemoryRendererPrivate;
+/*!
+ * \brief The SharedMemoryRenderer class
+ * Exports decoded frames to other processes, e.g. a video wall UI and an analytics service share 1 decoder.
+ * Add it to a player like other renderers: player.addVideoRenderer(&exporter). Read frames in another process with SharedFrameReader.
+ * Frames are written to a POSIX shared memory ring of fixed size slots, in the format the video thread delivers.
+ * A frame is copied once in the video thread into a slot no reader is using, and readers use it in place.
+ * If every slot is in use, the frame is dropped and counted in droppedFrames(). The ring is created when the first
+ * frame is received, and recreated if a larger frame comes.
+ * Only supported on unix except android.
+ */
+class  SharedMemoryRenderer : public VideoRenderer
+{
+    DPTR_DECLARE_PRIVATE(SharedMemoryRenderer)
+public:
+    SharedMemoryRenderer();
+    VideoRendererId id() const Q_DECL_OVERRIDE;
+    bool isSupported(VideoFormat::PixelFormat pixfmt) const Q_DECL_OVERRIDE;
+    /*!
+     * \brief setName
+     * Name of the shared memory object readers open. A ring of the same name created by other exporters is replaced.
+     * Default is "<pid>-<index>"
+     */
+    void setName(const QString& value);
+    QString name() const;
+    /*!
+     * \brief setSlotCount
+     * Number of frame slots. Readers holding frames longer need more slots. Default is 4.
+     * Takes effect when the ring is created.
+     */
+    void setSlotCount(int value);
+    int slotCount() const;
+protected:
+    bool receiveFrame(const VideoFrame& frame) Q_DECL_OVERRIDE;
+    void drawFrame() Q_DECL_OVERRIDE;
+};
+typedef SharedMemoryRenderer VideoRendererSharedMemory;
+} //namespace QtAV
+#endif // QTAV_SHAREDMEMORYRENDERER_H
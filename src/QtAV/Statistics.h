@@ -23,6 +23,7 @@
 #define QTAV_STATISTICS_H
 
 #include <QtAV/QtAV_Global.h>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QHash>
 #include <QtCore/QTime>
 #include <QtCore/QSharedData>
@@ -115,6 +116,28 @@ public:
         class Private;
         QExplicitlySharedDataPointer<Private> d;
     } video_only;
+    /*!
+     * \brief The Timeline class
+     * Time points of the current open in ms since the open started, -1 if not reached yet.
+     * Not cleared by reset(), but by start() when a new open starts.
+     */
+    class Timeline {
+    public:
+        Timeline();
+        void start();
+        bool isStarted() const;
+        qint64 elapsed() const;
+        /// set the point to elapsed() if not reached yet. \return true if the point is set
+        bool mark(qint64* point);
+
+        qint64 connected; // input opened
+        qint64 probed; // stream info found
+        qint64 first_packet;
+        qint64 first_decoded; // first video frame decoded
+        qint64 first_rendered; // first video frame delivered to renderers
+    private:
+        QElapsedTimer timer;
+    } timeline;
 
     double bandwidthRate = 0;
     double videoBandwidthRate = 0;
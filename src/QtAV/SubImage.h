@@ -33,12 +33,15 @@ struct SubImageSet;
 struct  SubImage {
     SubImage(int x = 0, int y = 0, int w = 0, int h = 0, int stride = 0);
     bool operator ==(const SubImage& o) const {
+        if (hash && o.hash && hash != o.hash)
+            return false;
         return x == o.x && y == o.y && w == o.w && h == o.h && stride == o.stride && color == o.color && data == o.data;
     }
     int x, y;
     int w, h;
     int stride;
     quint32 color; //ass only
+    uint hash; //hash of data. 0: not computed. images with the same non-zero hash and size can share the same data and texture region
     QByteArray data; //size = stride*h
 };
 
@@ -24,6 +24,8 @@
 #define QTAV_VIDEOCAPTURE_H
 
 #include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QScopedPointer>
 #include <QtGui/QImage>
 #include <QtAV/QtAV_Global.h>
 #include <QtAV/VideoFrame.h>
@@ -64,6 +66,8 @@ public:
     /*!
      * \brief setFormat
      *  Set saved format. can be "PNG", "jpg" etc. Not be used if save raw frame data.
+     *  "jpg", "jpeg" and "webp"(if FFmpeg is built with libwebp) are encoded from YUV frames by FFmpeg without
+     *  converting to RGB, which is much faster than "PNG", the default format.
      * \param format image format string like "png", "jpg"
      */
     void setSaveFormat(const QString& format);
@@ -85,6 +89,14 @@ public:
     QString captureName() const;
     void setCaptureDir(const QString& value);
     QString captureDir() const;
+    /*!
+     * \brief setMaxPendingTasks
+     * Max number of async capture tasks waiting or running in the process wide capture thread pool.
+     * A capture is dropped and failed() is emitted if the queue is full. Each task holds a copy of the frame.
+     * Default is 4*QThread::idealThreadCount(), at least 16.
+     */
+    static void setMaxPendingTasks(int value);
+    static int maxPendingTasks();
 public Q_SLOTS:
     void capture();
 Q_SIGNALS:
@@ -98,6 +110,7 @@ Q_SIGNALS:
     /*!
      * \brief imageCaptured
      * Emitted when captured video frame is converted to a QImage.
+     * The frame is converted only if this signal is connected or the save format requires QImage.
      * \param image
      */
     void imageCaptured(const QImage& image); //TODO: emit only if not original format is set?
@@ -137,5 +150,53 @@ private:
     VideoFrame frame;
 };
 
+/*!
+ * \brief The VideoCaptureBatch class
+ * Captures from many players at once, e.g. snapshots of all cameras, and measures latency of each capture.
+ */
+class  VideoCaptureBatch : public QObject
+{
+    Q_OBJECT
+public:
+    class Result {
+    public:
+        Result();
+        VideoCapture *capture;
+        bool ok;
+        QString path; //!< saved file. empty if VideoCapture.autoSave is false
+        qreal timestamp; //!< timestamp of the captured frame, in seconds. -1 if no frame
+        qint64 frameLatency; //!< msecs from request to the frame is taken in video thread. -1 if no frame
+        qint64 latency; //!< msecs from request to the frame is saved(or available if not autoSave) or failed
+    };
+    explicit VideoCaptureBatch(QObject *parent = 0);
+    ~VideoCaptureBatch();
+    /*!
+     * \brief capture
+     * Request all captures at the same time, e.g. videoCapture() of every player. Each one captures the frame
+     * displayed when its video thread handles the request. finished() is emitted when all are done, failed or timed out.
+     * A running batch is aborted. Other requests of the same captures before finished() are not distinguished.
+     */
+    void capture(const QList<VideoCapture*>& captures);
+    bool isRunning() const;
+    /*!
+     * \brief setTimeout
+     * Captures not done in value msecs are failed, e.g. the player is stopped. Default is 5000.
+     */
+    void setTimeout(int value);
+    int timeout() const;
+    /// results in the order of captures. Complete after finished()
+    QList<Result> results() const;
+    /// msecs from request to the last capture is done
+    qint64 elapsed() const;
+Q_SIGNALS:
+    void finished();
+private Q_SLOTS:
+    void abort();
+private:
+    void done(int batch, int index, bool ok, const QString& path = QString());
+    class Private;
+    QScopedPointer<Private> d;
+};
+
 } //namespace QtAV
 #endif // QTAV_VIDEOCAPTURE_H
@@ -98,15 +98,15 @@ public:
      * Return a QImage of current video frame, with given format, image size and region of interest.
      * If VideoFrame is constructed from an QImage, the target format, size and roi are the same, then no data copy.
      * \param dstSize result image size
-     * \param roi NOT implemented!
+     * \param roi interested region of source frame. see to()
      */
     QImage toImage(QImage::Format fmt = QImage::Format_ARGB32, const QSize& dstSize = QSize(), const QRectF& roi = QRect()) const;
     /*!
      * \brief to
      * The result frame data is always on host memory. If video frame data is already in host memory, and the target parameters are the same, then return the current frame.
      * \param pixfmt target pixel format
-     * \param dstSize target frame size
-     * \param roi interested region of source frame
+     * \param dstSize target frame size. default is roi size
+     * \param roi interested region of source frame in pixels. Left and top edges are aligned down to chroma samples
      */
     VideoFrame to(VideoFormat::PixelFormat pixfmt, const QSize& dstSize = QSize(), const QRectF& roi = QRect()) const;
     VideoFrame to(const VideoFormat& fmt, const QSize& dstSize = QSize(), const QRectF& roi = QRect()) const;
@@ -144,6 +144,13 @@ public:
     VideoFrame convert(const VideoFrame& frame, VideoFormat::PixelFormat fmt) const;
     VideoFrame convert(const VideoFrame& frame, QImage::Format fmt) const;
     VideoFrame convert(const VideoFrame& frame, int fffmt) const;
+    /*!
+     * \brief convert
+     * Convert and scale into the given planes in 1 pass, e.g. memory shared with a display server.
+     * Data and strides aligned to 16 or more make simd code paths of the converter possible.
+     * \param dstSize empty: the size of source frame
+     */
+    bool convert(const VideoFrame& frame, const VideoFormat& fmt, const QSize& dstSize, quint8 *const dst[], const int dstStride[]) const;
 private:
     mutable ImageConverter *m_cvt;
     int m_eq[3];
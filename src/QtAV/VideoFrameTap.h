@@ -0,0 +1,140 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_VIDEOFRAMETAP_H
+#define QTAV_VIDEOFRAMETAP_H
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSize>
+#include <QtAV/VideoFrame.h>
+
+namespace QtAV {
+
+class AVPlayer;
+/*!
+ * \brief The VideoFrameTap class
+ * Delivers decoded frames to an analytics consumer, e.g. an inference engine, without affecting playback.
+ * The consumer declares what it needs: frameRate(), frameSize() and pixelFormats(). Frames are sub-sampled in
+ * the video thread by timestamp, then converted and scaled once in a worker thread and put into a bounded queue.
+ * put() never blocks: if the previous frame is still being converted or the queue is full, a frame is dropped
+ * and counted in droppedFrames(). A frame already in an accepted format and size is queued without copy,
+ * it shares the decoder's buffer until the consumer releases it.
+ * Install a tap by AVPlayer::addFrameTap(). A tap is attached to 1 player at a time.
+ * \code
+ *   VideoFrameTap tap;
+ *   tap.setFrameRate(5);
+ *   tap.setFrameSize(QSize(640, 360));
+ *   tap.setPixelFormat(VideoFormat::Format_RGB24);
+ *   player.addFrameTap(&tap);
+ *   // consumer thread
+ *   while (running) {
+ *       VideoFrame f = tap.waitFrame(100);
+ *       if (f.isValid())
+ *           infer(f.constBits(), f.bytesPerLine());
+ *   }
+ * \endcode
+ * Thread safe.
+ */
+class  VideoFrameTap : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal frameRate READ frameRate WRITE setFrameRate NOTIFY frameRateChanged)
+    Q_PROPERTY(QSize frameSize READ frameSize WRITE setFrameSize NOTIFY frameSizeChanged)
+    Q_PROPERTY(int queueSize READ queueSize WRITE setQueueSize NOTIFY queueSizeChanged)
+public:
+    explicit VideoFrameTap(QObject *parent = 0);
+    ~VideoFrameTap();
+    /*!
+     * \brief setFrameRate
+     * Max frames per second of the stream timestamps. Frames are evenly picked from the decoded frames,
+     * a stream slower than value is not duplicated. value <= 0: every frame. Default is 0.
+     */
+    void setFrameRate(qreal value);
+    qreal frameRate() const;
+    /*!
+     * \brief setFrameSize
+     * Size of result frames. If width or height is <= 0, it's computed from the other one and the aspect ratio
+     * of source frame. Empty size (default): source frame size.
+     */
+    void setFrameSize(const QSize& value);
+    QSize frameSize() const;
+    /*!
+     * \brief setPixelFormats
+     * Formats the consumer accepts, in order of preference. If source format is one of them, frames are not converted.
+     * Otherwise converted to the first one. Empty (default): any format. Hardware decoded frames are always
+     * copied to host memory.
+     */
+    void setPixelFormats(const QList<VideoFormat::PixelFormat>& value);
+    QList<VideoFormat::PixelFormat> pixelFormats() const;
+    /// the same as setPixelFormats() with 1 format
+    void setPixelFormat(VideoFormat::PixelFormat value);
+    /*!
+     * \brief setQueueSize
+     * Max number of frames waiting for the consumer. The oldest frame is dropped if the queue is full. Default is 2.
+     */
+    void setQueueSize(int value);
+    int queueSize() const;
+    /*!
+     * \brief put
+     * Called by the video thread for every frame to display. Can also be used to feed frames from other sources,
+     * e.g. FrameReader. Does nothing but a timestamp check if the frame is not picked. Never blocks.
+     * \return true if the frame is picked by frameRate()
+     */
+    bool put(const VideoFrame& frame);
+    /*!
+     * \brief takeFrame
+     * Take the oldest frame in queue. Returns an invalid frame if queue is empty.
+     */
+    VideoFrame takeFrame();
+    /*!
+     * \brief waitFrame
+     * Take the oldest frame in queue, or wait at most timeout msecs for a new one.
+     */
+    VideoFrame waitFrame(unsigned long timeout);
+    int pendingFrames() const;
+    /// frames picked by frameRate() but dropped because the consumer or converter is too slow, or by reset()
+    qint64 droppedFrames() const;
+    /// frames taken by the consumer
+    qint64 deliveredFrames() const;
+    /// discard queued frames and restart sub-sampling. called when the player opens a new media
+    void reset();
+    AVPlayer* player() const;
+Q_SIGNALS:
+    /*!
+     * \brief frameAvailable
+     * Emitted in a worker thread when a frame is put into the queue. Use a queued connection or takeFrame()
+     * in the slot.
+     */
+    void frameAvailable();
+    void frameRateChanged();
+    void frameSizeChanged();
+    void queueSizeChanged();
+private:
+    void setPlayer(AVPlayer* value);
+    friend class AVPlayer;
+    friend class FrameTapTask;
+    class Private;
+    QScopedPointer<Private> d;
+};
+} //namespace QtAV
+#endif // QTAV_VIDEOFRAMETAP_H
@@ -72,6 +72,9 @@ public:
     QWidget* widget() Q_DECL_OVERRIDE Q_DECL_FINAL;
     QGraphicsItem* graphicsItem() Q_DECL_OVERRIDE Q_DECL_FINAL;
     OpenGLVideo* opengl() const Q_DECL_OVERRIDE;
+    qint64 presentedFrames() const Q_DECL_OVERRIDE;
+    qint64 droppedFrames() const Q_DECL_OVERRIDE;
+    PresentScheduler* presentScheduler() Q_DECL_OVERRIDE;
 Q_SIGNALS:
     void sourceAspectRatioChanged(qreal value) Q_DECL_OVERRIDE Q_DECL_FINAL;
     void regionOfInterestChanged() Q_DECL_OVERRIDE;
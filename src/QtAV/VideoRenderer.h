@@ -44,8 +44,10 @@ namespace QtAV {
 
 typedef int VideoRendererId;
 extern  VideoRendererId VideoRendererId_OpenGLWindow;
+extern  VideoRendererId VideoRendererId_SharedMemory;
 class Filter;
 class OpenGLVideo;
+class PresentScheduler;
 class VideoFormat;
 class VideoRendererPrivate;
 class  VideoRenderer : public AVOutput
@@ -204,6 +206,24 @@ public:
      * Currently you can only use it to set custom shader OpenGLVideo.setUserShader()
      */
     virtual OpenGLVideo* opengl() const { return NULL;}
+    /*!
+     * \brief presentedFrames
+     * Number of received frames which are painted
+     */
+    virtual qint64 presentedFrames() const;
+    /*!
+     * \brief droppedFrames
+     * Number of received frames replaced by a newer frame before painting, i.e. rendering is slower than decoding.
+     * They are not counted in Statistics.
+     */
+    virtual qint64 droppedFrames() const;
+    /*!
+     * \brief presentScheduler
+     * Vsync aligned presentation of this renderer. Only renderers reporting buffer swaps feed it,
+     * e.g. OpenGLWindowRenderer, OpenGLWidgetRenderer and QML VideoOutput.
+     * Alignment is disabled by default: presentScheduler()->setEnabled(true)
+     */
+    virtual PresentScheduler* presentScheduler();
 protected:
     VideoRenderer(VideoRendererPrivate &d);
     //TODO: batch drawBackground(color, region)=>loop drawBackground(color,rect)
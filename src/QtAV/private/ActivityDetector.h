@@ -0,0 +1,76 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_ACTIVITYDETECTOR_H
+#define QTAV_ACTIVITYDETECTOR_H
+
+#include <QtAV/QtAV_Global.h>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+
+namespace QtAV {
+
+class Packet;
+/*!
+ * \brief The ActivityDetector class
+ * Scene activity of a video stream estimated without decoding. Sizes of non-key packets are compared with their
+ * long term level, i.e. the encoder spends more bits when something moves. Motion vectors exported by the decoder
+ * are used too if frames are decoded.
+ * addPacket() is called in demux thread, addMotion() in video thread, others are thread safe.
+ */
+class Q_AV_PRIVATE_EXPORT ActivityDetector : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ActivityDetector(QObject *parent = 0);
+    /// score to become active. idle if the score is below threshold/2 for a while. default is 0.3
+    void setThreshold(qreal value);
+    qreal threshold() const;
+    void setMotionVectors(bool value);
+    bool motionVectors() const;
+    void reset();
+    void addPacket(const Packet& packet);
+    /// motion: mean motion vector length over the picture in pixels
+    void addMotion(qreal pts, qreal motion);
+    /// [0, 1]
+    qreal score() const;
+    bool isActive() const;
+Q_SIGNALS:
+    void activityChanged(bool active, qreal score);
+private:
+    void update(qreal pts); // mutex is locked
+
+    mutable QMutex mutex;
+    qreal thres;
+    bool mvs;
+    bool active;
+    int nb_packets;
+    qreal level; // short term size of non-key packets
+    qreal idle_level; // size level of idle scene. follows level down quickly and up slowly
+    qreal size_score;
+    qreal motion_score;
+    qreal motion_pts;
+    qreal active_pts; // last time the score is high enough to stay active
+    qreal last_pts;
+    qreal value;
+};
+} //namespace QtAV
+#endif // QTAV_ACTIVITYDETECTOR_H
@@ -57,6 +57,12 @@ public:
     virtual bool isSupported(AudioFormat::SampleFormat f) const { return !IsPlanar(f);}
     // 5, 6, 7 channels may not play
     virtual bool isSupported(AudioFormat::ChannelLayout cl) const { return int(cl) < int(AudioFormat::ChannelLayout_Unsupported);}
+    /*!
+     * \brief requiredFormat
+     * Valid if the backend accepts only the given format, including sample rate, e.g. mixer inputs.
+     * Audio data will be resampled to it.
+     */
+    virtual AudioFormat requiredFormat() const { return AudioFormat();}
     /*!
      * \brief The BufferControl enum
      * Used to adapt to different audio playback backend. Usually you don't need this in application level development.
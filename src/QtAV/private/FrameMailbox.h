@@ -0,0 +1,69 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_FRAMEMAILBOX_H
+#define QTAV_FRAMEMAILBOX_H
+
+#include <atomic>
+#include <QtAV/VideoFrame.h>
+
+namespace QtAV {
+/*!
+ * \brief The FrameMailbox class
+ * Latest frame mailbox between one producer (video thread) and one consumer (rendering thread). It's a lock-free
+ * triple buffer: the producer never waits for rendering, and a frame not taken before the next put() is dropped
+ * without copying. VideoFrame is implicitly shared, so put() and take() only copy the handle.
+ * Frames in the mailbox must not be modified, use VideoFrame::clone() to get a writable frame.
+ */
+class FrameMailbox
+{
+public:
+    FrameMailbox() : m_state(1), m_back(0), m_front(2) {}
+    /// Called by producer. Return true if the previous frame was not taken and is dropped
+    bool put(const VideoFrame& frame) {
+        m_slots[m_back] = frame;
+        const int prev = m_state.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = prev & kIndexMask;
+        if (!(prev & kFresh))
+            return false;
+        m_slots[m_back] = VideoFrame(); // release the dropped frame now, e.g. return a surface to decoder
+        return true;
+    }
+    /// Called by consumer. Return false if no new frame since last take()
+    bool take(VideoFrame* frame) {
+        if (!hasFrame())
+            return false;
+        const int prev = m_state.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & kIndexMask;
+        *frame = m_slots[m_front];
+        m_slots[m_front] = VideoFrame();
+        return true;
+    }
+    bool hasFrame() const { return !!(m_state.load(std::memory_order_acquire) & kFresh);}
+private:
+    enum { kIndexMask = 3, kFresh = 4 };
+    VideoFrame m_slots[3];
+    std::atomic<int> m_state; // index of the middle slot | kFresh
+    int m_back; // producer only
+    int m_front; // consumer only
+};
+} //namespace QtAV
+#endif // QTAV_FRAMEMAILBOX_H
@@ -0,0 +1,57 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SNAPSHOTENCODER_H
+#define QTAV_SNAPSHOTENCODER_H
+
+#include <QtAV/QtAV_Global.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace QtAV {
+class VideoFrame;
+/*!
+ * \brief The SnapshotEncoder class
+ * Encodes a decoded YUV frame to a JPEG or WebP image with libavcodec, without converting to RGB.
+ * Frames are converted to the color space and range the image format assumes: full range BT.601 for JPEG (JFIF),
+ * limited range BT.601 for WebP.
+ * Encoder contexts are reused for frames of the same size, format and quality. Thread safe.
+ */
+class Q_AV_PRIVATE_EXPORT SnapshotEncoder
+{
+public:
+    /*!
+     * \brief isSupported
+     * \param format "jpg", "jpeg" or "webp"(requires libwebp encoder), case insensitive
+     */
+    static bool isSupported(const QString& format);
+    /*!
+     * \brief encode
+     * Hardware decoded frames are mapped, YUV frames the encoder can not accept are converted to yuv420p in 1 pass.
+     * \param quality 0-100, -1: default(75)
+     * \return empty if failed or the frame is not YUV, e.g. RGB. Then use QImage
+     */
+    static QByteArray encode(const VideoFrame& frame, const QString& format, int quality = -1);
+    /// release idle encoder contexts
+    static void clear();
+};
+} //namespace QtAV
+#endif // QTAV_SNAPSHOTENCODER_H
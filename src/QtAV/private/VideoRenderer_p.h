@@ -23,6 +23,8 @@
 #define QAV_VIDEORENDERER_P_H
 
 #include <QtAV/private/AVOutput_p.h>
+#include <QtAV/private/FrameMailbox.h>
+#include <QtAV/PresentScheduler.h>
 #include <QtAV/VideoRenderer.h>
 #include <QtCore/QMutex>
 #include <QtCore/QRect>
@@ -61,6 +63,10 @@ public:
       , hue(0)
       , saturation(0)
       , bg_color(0, 0, 0)
+      , use_mailbox(false)
+      , frame_pending(false)
+      , presented_frames(0)
+      , dropped_frames(0)
       , orientation(0)
     {
         //conv.setInFormat(PIX_FMT_YUV420P);
@@ -101,6 +107,15 @@ public:
         return out_rect0 != out_rect;
     }
     virtual void setupQuality() {}
+    // called in video thread
+    void putFrame(const VideoFrame& frame) {
+        if (mailbox.put(frame))
+            ++dropped_frames;
+    }
+    // called in rendering thread after a buffer swap
+    void frameSwapped() {
+        scheduler.vsync(PresentScheduler::now(), video_frame.isValid() ? video_frame.timestamp() : -1);
+    }
     int rotation() const {
         if (!statistics)
             return orientation;
@@ -130,6 +145,16 @@ public:
 
     qreal brightness, contrast, hue, saturation;
     QColor bg_color;
+    /*!
+     * If true, receive() puts frames into mailbox without locking img_mutex and handlePaintEvent() takes the latest
+     * one and calls receiveFrame() in rendering thread. receiveFrame() should not request update, receive() does.
+     */
+    bool use_mailbox;
+    FrameMailbox mailbox;
+    std::atomic<bool> frame_pending; // a frame is received but not painted. used if no mailbox
+    std::atomic<qint64> presented_frames;
+    std::atomic<qint64> dropped_frames;
+    PresentScheduler scheduler;
 private:
     int orientation;
     friend class VideoRenderer;
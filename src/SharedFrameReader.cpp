@@ -0,0 +1,157 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#include "QtAV/SharedFrameReader.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThread>
+#include "utils/SharedFrameRing.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+// keeps the slot from being overwritten and the ring mapped while the frame is alive
+class SharedFrameLease
+{
+public:
+    SharedFrameLease(const QSharedPointer<SharedFrameRing>& r, int s) : ring(r), slot(s) {}
+    ~SharedFrameLease() { ring->release(slot); }
+private:
+    QSharedPointer<SharedFrameRing> ring;
+    int slot;
+};
+typedef QSharedPointer<SharedFrameLease> SharedFrameLeaseRef;
+} //namespace QtAV
+Q_DECLARE_METATYPE(QtAV::SharedFrameLeaseRef)
+
+namespace QtAV {
+
+class SharedFrameReader::Private
+{
+public:
+    Private() : last(0), skipped(0) {}
+    bool reopen() {
+        ring.reset(new SharedFrameRing());
+        last = 0;
+        if (!ring->open(name)) {
+            ring.clear();
+            return false;
+        }
+        return true;
+    }
+    VideoFrame frame(int s) {
+        const SharedFrameRing::Slot *slot = ring->slot(s);
+        quint8 *data = ring->slotData(s);
+        VideoFrame f(slot->width, slot->height, VideoFormat(VideoFormat::PixelFormat(slot->format)));
+        for (int i = 0; i < f.planeCount() && i < SharedFrameRing::kMaxPlanes; ++i) {
+            f.setBits(data + slot->offset[i], i);
+            f.setBytesPerLine(slot->stride[i], i);
+        }
+        f.setTimestamp(slot->timestamp);
+        f.setDisplayAspectRatio(slot->aspect_ratio);
+        f.setColorSpace(ColorSpace(slot->color_space));
+        f.setColorRange(ColorRange(slot->color_range));
+        f.setMetaData(QStringLiteral("shm_lease"), QVariant::fromValue(SharedFrameLeaseRef(new SharedFrameLease(ring, s))));
+        f.setMetaData(QStringLiteral("latency"), SharedFrameRing::now() - slot->publish_time);
+        return f;
+    }
+
+    QString name;
+    QSharedPointer<SharedFrameRing> ring;
+    quint64 last; // sequence of the last returned frame
+    qint64 skipped;
+};
+
+SharedFrameReader::SharedFrameReader()
+    : d(new Private())
+{}
+
+SharedFrameReader::~SharedFrameReader()
+{
+}
+
+bool SharedFrameReader::open(const QString &name)
+{
+    d->name = name;
+    return d->reopen();
+}
+
+void SharedFrameReader::close()
+{
+    d->ring.clear();
+    d->last = 0;
+}
+
+bool SharedFrameReader::isOpen() const
+{
+    return !!d->ring;
+}
+
+QString SharedFrameReader::name() const
+{
+    return d->name;
+}
+
+VideoFrame SharedFrameReader::getVideoFrame(int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (true) {
+        if (d->ring && d->ring->header()->closed.load(std::memory_order_acquire))
+            d->ring.clear();
+        if (!d->ring && !d->reopen()) {
+            // wait for the exporter to recreate it
+            if (timeout >= 0 && timer.elapsed() >= timeout)
+                return VideoFrame();
+            QThread::msleep(qBound<qint64>(1, timeout < 0 ? 10 : timeout - timer.elapsed(), 10));
+            continue;
+        }
+        SharedFrameRing::Header *h = d->ring->header();
+        const quint64 seq = h->sequence.load(std::memory_order_acquire);
+        if (seq > d->last) {
+            const int s = h->latest.load(std::memory_order_acquire);
+            if (s >= 0 && d->ring->acquire(s)) {
+                const quint64 q = d->ring->slot(s)->sequence.load(std::memory_order_relaxed);
+                if (q > d->last) {
+                    if (d->last > 0)
+                        d->skipped += q - d->last - 1;
+                    d->last = q;
+                    return d->frame(s);
+                }
+                d->ring->release(s);
+            }
+            // the exporter is writing the slot, or too many processes read it
+            if (timeout >= 0 && timer.elapsed() >= timeout)
+                return VideoFrame();
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const qint64 left = timeout < 0 ? -1 : timeout - timer.elapsed();
+        if (timeout >= 0 && left <= 0)
+            return VideoFrame();
+        d->ring->wait(seq, int(left));
+    }
+    return VideoFrame();
+}
+
+qint64 SharedFrameReader::skippedFrames() const
+{
+    return d->skipped;
+}
+} //namespace QtAV
@@ -114,6 +114,39 @@ qreal Statistics::VideoOnly::currentDisplayFPS() const
     return (qreal)d->history.size()/dt;
 }
 
+Statistics::Timeline::Timeline()
+    : connected(-1)
+    , probed(-1)
+    , first_packet(-1)
+    , first_decoded(-1)
+    , first_rendered(-1)
+{
+}
+
+void Statistics::Timeline::start()
+{
+    connected = probed = first_packet = first_decoded = first_rendered = -1;
+    timer.start();
+}
+
+bool Statistics::Timeline::isStarted() const
+{
+    return timer.isValid();
+}
+
+qint64 Statistics::Timeline::elapsed() const
+{
+    return timer.isValid() ? timer.elapsed() : -1;
+}
+
+bool Statistics::Timeline::mark(qint64 *point)
+{
+    if (!timer.isValid() || *point >= 0)
+        return false;
+    *point = timer.elapsed();
+    return true;
+}
+
 Statistics::Statistics()
 {
 }
@@ -19,21 +19,29 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ******************************************************************************/
 #include "QtAV/VideoCapture.h"
+#include <QtCore/QAtomicInt>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
 #include <QtCore/QRunnable>
+#include <QtCore/QThread>
 #include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #include <QtGui/QDesktopServices>
 #else
 #include <QtCore/QStandardPaths>
 #endif
+#include "QtAV/private/SnapshotEncoder.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
 
 Q_GLOBAL_STATIC(QThreadPool, videoCaptureThreadPool)
 static bool app_is_dieing = false;
+static QAtomicInt pending_tasks;
+static int max_pending_tasks = qMax(16, 4*QThread::idealThreadCount());
 // TODO: cancel if qapp is quit
 class CaptureTask : public QRunnable
 {
@@ -42,24 +50,38 @@ public:
         : cap(c)
         , save(true)
         , original_fmt(false)
+        , emit_image(true)
+        , pending(false)
         , quality(-1)
         , format(QStringLiteral("PNG"))
         , qfmt(QImage::Format_ARGB32)
     {
         setAutoDelete(true);
     }
+    ~CaptureTask() {
+        if (pending)
+            pending_tasks.deref();
+    }
     virtual void run() {
         if (app_is_dieing) {
             qDebug("app is dieing. cancel capture task %p", this);
             return;
         }
-        QImage image(frame.toImage());
-        if (image.isNull()) {
-            qWarning("Failed to convert to QImage");
-            QMetaObject::invokeMethod(cap, "failed");
-            return;
+        // encode yuv directly, no rgb conversion
+        QByteArray encoded;
+        if (save && !original_fmt && SnapshotEncoder::isSupported(format))
+            encoded = SnapshotEncoder::encode(frame, format, quality);
+        QImage image;
+        if (emit_image || (save && !original_fmt && encoded.isEmpty())) {
+            image = frame.toImage();
+            if (image.isNull()) {
+                qWarning("Failed to convert to QImage");
+                QMetaObject::invokeMethod(cap, "failed");
+                return;
+            }
+            if (emit_image)
+                QMetaObject::invokeMethod(cap, "imageCaptured", Q_ARG(QImage, image));
         }
-        QMetaObject::invokeMethod(cap, "imageCaptured", Q_ARG(QImage, image));
         if (!save)
             return;
         bool main_thread = QThread::currentThread() == qApp->thread();
@@ -97,14 +119,19 @@ public:
             QMetaObject::invokeMethod(cap, "saved", Q_ARG(QString, path));
             return;
         }
-        if (image.isNull())
-            return;
         path.append(format.toLower());
         qDebug("Saving capture to %s", qPrintable(path));
-        bool ok = image.save(path, format.toLatin1().constData(), quality);
+        bool ok = false;
+        if (!encoded.isEmpty()) {
+            QFile file(path);
+            ok = file.open(QIODevice::WriteOnly) && file.write(encoded) == encoded.size();
+        } else if (!image.isNull()) {
+            ok = image.save(path, format.toLatin1().constData(), quality);
+        }
         if (!ok) {
             qWarning("Failed to save capture");
             QMetaObject::invokeMethod(cap, "failed");
+            return;
         }
         QMetaObject::invokeMethod(cap, "saved", Q_ARG(QString, path));
     }
@@ -112,6 +139,8 @@ public:
     VideoCapture *cap;
     bool save;
     bool original_fmt;
+    bool emit_image;
+    bool pending; // counted in pending_tasks
     int quality;
     QString format, dir, name;
     QImage::Format qfmt;
@@ -186,6 +215,7 @@ void VideoCapture::handleAppQuit()
 #endif
     videoCaptureThreadPool()->setExpiryTimeout(0);
     videoCaptureThreadPool()->waitForDone();
+    SnapshotEncoder::clear();
 }
 
 void  VideoCapture::capture()
@@ -199,10 +229,20 @@ void VideoCapture::start()
     if (!frame.isValid() || !frame.constBits(0)) { // if frame is always cloned, then size is at least width*height
         qDebug("Captured frame from hardware decoder surface.");
     }
+    if (isAsync()) {
+        if (pending_tasks.fetchAndAddOrdered(1) >= max_pending_tasks) {
+            pending_tasks.deref();
+            qWarning("Too many pending capture tasks. Drop the capture @%.3f", frame.timestamp());
+            Q_EMIT failed();
+            return;
+        }
+    }
     CaptureTask *task = new CaptureTask(this);
+    task->pending = isAsync();
     // copy properties so the task will not be affect even if VideoCapture properties changed
     task->save = autoSave();
     task->original_fmt = original_fmt;
+    task->emit_image = receivers(SIGNAL(imageCaptured(QImage))) > 0;
     task->quality = qual;
     task->dir = dir;
     task->name = name;
@@ -269,6 +309,16 @@ QString VideoCapture::captureDir() const
     return dir;
 }
 
+void VideoCapture::setMaxPendingTasks(int value)
+{
+    max_pending_tasks = qMax(1, value);
+}
+
+int VideoCapture::maxPendingTasks()
+{
+    return max_pending_tasks;
+}
+
 /*
  * If the frame is not created for direct rendering, then the frame data is already deep copied, so detach is enough.
  * TODO: map frame from texture etc.
@@ -283,5 +333,180 @@ void VideoCapture::setVideoFrame(const VideoFrame &frame)
     this->frame = frame.clone(); // TODO: no clone, use detach()
 }
 
+VideoCaptureBatch::Result::Result()
+    : capture(0)
+    , ok(false)
+    , timestamp(-1)
+    , frameLatency(-1)
+    , latency(-1)
+{}
+
+class VideoCaptureBatch::Private
+{
+public:
+    Private()
+        : batch(0)
+        , pending(0)
+        , elapsed(0)
+    {
+        timer.setSingleShot(true);
+        timer.setInterval(5000);
+    }
+    void disconnectAll() {
+        foreach (const QMetaObject::Connection& c, connections) {
+            QObject::disconnect(c);
+        }
+        connections.clear();
+    }
+
+    mutable QMutex mutex;
+    int batch; // results of previous batches are ignored
+    int pending;
+    qint64 elapsed;
+    QElapsedTimer clock;
+    QTimer timer;
+    QList<VideoCaptureBatch::Result> results;
+    QList<QMetaObject::Connection> connections;
+};
+
+VideoCaptureBatch::VideoCaptureBatch(QObject *parent)
+    : QObject(parent)
+    , d(new Private())
+{
+    connect(&d->timer, SIGNAL(timeout()), SLOT(abort()));
+}
+
+VideoCaptureBatch::~VideoCaptureBatch()
+{
+    d->disconnectAll();
+}
+
+void VideoCaptureBatch::capture(const QList<VideoCapture *> &captures)
+{
+    if (isRunning())
+        abort();
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        const int batch = ++d->batch;
+        d->results.clear();
+        d->pending = captures.size();
+        d->elapsed = 0;
+        for (int i = 0; i < captures.size(); ++i) {
+            VideoCapture *cap = captures.at(i);
+            Result r;
+            r.capture = cap;
+            d->results.append(r);
+            // frameAvailable is emitted in video thread
+            d->connections.append(connect(cap, &VideoCapture::frameAvailable, this, [this, batch, i, cap](const VideoFrame& frame) {
+                {
+                    QMutexLocker lock(&d->mutex);
+                    Q_UNUSED(lock);
+                    if (batch != d->batch)
+                        return;
+                    Result &r = d->results[i];
+                    if (r.frameLatency >= 0)
+                        return;
+                    r.timestamp = frame.timestamp();
+                    r.frameLatency = d->clock.elapsed();
+                }
+                if (!cap->autoSave())
+                    done(batch, i, frame.isValid());
+            }, Qt::DirectConnection));
+            d->connections.append(connect(cap, &VideoCapture::saved, this, [this, batch, i](const QString& path) {
+                done(batch, i, true, path);
+            }));
+            d->connections.append(connect(cap, &VideoCapture::failed, this, [this, batch, i]() {
+                done(batch, i, false);
+            }));
+        }
+        d->clock.start();
+    }
+    if (captures.isEmpty()) {
+        Q_EMIT finished();
+        return;
+    }
+    d->timer.start();
+    foreach (VideoCapture *cap, captures) {
+        cap->capture();
+    }
+}
+
+bool VideoCaptureBatch::isRunning() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->pending > 0;
+}
+
+void VideoCaptureBatch::setTimeout(int value)
+{
+    d->timer.setInterval(value);
+}
+
+int VideoCaptureBatch::timeout() const
+{
+    return d->timer.interval();
+}
+
+QList<VideoCaptureBatch::Result> VideoCaptureBatch::results() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->results;
+}
+
+qint64 VideoCaptureBatch::elapsed() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->elapsed;
+}
+
+void VideoCaptureBatch::abort()
+{
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        if (d->pending <= 0)
+            return;
+        d->elapsed = d->clock.elapsed();
+        for (int i = 0; i < d->results.size(); ++i) {
+            Result &r = d->results[i];
+            if (r.latency < 0) {
+                r.ok = false;
+                r.latency = d->elapsed;
+            }
+        }
+        qWarning("VideoCaptureBatch: %d captures are not finished in %lldms", d->pending, d->elapsed);
+        d->pending = 0;
+        ++d->batch;
+        d->disconnectAll();
+    }
+    d->timer.stop();
+    Q_EMIT finished();
+}
+
+void VideoCaptureBatch::done(int batch, int index, bool ok, const QString &path)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (batch != d->batch)
+        return;
+    Result &r = d->results[index];
+    if (r.latency >= 0)
+        return;
+    r.ok = ok;
+    r.path = path;
+    r.latency = d->clock.elapsed();
+    if (--d->pending > 0)
+        return;
+    d->elapsed = r.latency;
+    d->disconnectAll();
+    // may be called in video thread
+    QMetaObject::invokeMethod(&d->timer, "stop", Qt::QueuedConnection);
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+}
+
 } //namespace QtAV
 
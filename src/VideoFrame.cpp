@@ -41,6 +41,50 @@ static const struct RegisterMetaTypes
 } _registerMetaTypes;
 }
 
+// a frame of region roi of a host memory frame. if !deep, planes are referenced, so f must be alive when the result is used
+static VideoFrame crop(const VideoFrame& f, const QRectF& roi, bool deep = false)
+{
+    const VideoFormat fmt(f.format());
+    QRect r(roi.toAlignedRect().intersected(QRect(0, 0, f.width(), f.height())));
+    if (r.isEmpty())
+        return VideoFrame();
+    // chroma planes are offset by whole samples
+    const int sx = 16/fmt.chromaWidth(16), sy = 16/fmt.chromaHeight(16);
+    r.setLeft(r.left()/sx*sx);
+    r.setTop(r.top()/sy*sy);
+    QByteArray buf;
+    if (deep) {
+        int bytes = 0;
+        for (int i = 0; i < fmt.planeCount(); ++i)
+            bytes += fmt.bytesPerLine(r.width(), i)*fmt.height(r.height(), i);
+        buf.resize(bytes);
+    }
+    uchar *dst = (uchar*)buf.data(); //must before buf is shared
+    VideoFrame c(r.width(), r.height(), fmt, buf);
+    for (int i = 0; i < fmt.planeCount(); ++i) {
+        const uchar *src = f.constBits(i) + fmt.height(r.top(), i)*f.bytesPerLine(i) + fmt.bytesPerLine(r.left(), i);
+        if (!deep) {
+            c.setBits((uchar*)src, i);
+            c.setBytesPerLine(f.bytesPerLine(i), i);
+            continue;
+        }
+        const int line = fmt.bytesPerLine(r.width(), i);
+        c.setBits(dst, i);
+        c.setBytesPerLine(line, i);
+        for (int y = 0; y < fmt.height(r.height(), i); ++y) {
+            memcpy(dst, src, line);
+            dst += line;
+            src += f.bytesPerLine(i);
+        }
+    }
+    if (fmt.hasPalette())
+        c.setMetaData(QStringLiteral("pallete"), f.metaData(QStringLiteral("pallete")));
+    c.setColorSpace(f.colorSpace());
+    c.setColorRange(f.colorRange());
+    c.setTimestamp(f.timestamp());
+    return c;
+}
+
 VideoFrame VideoFrame::fromGPU(const VideoFormat& fmt, int width, int height, int surface_h, quint8 *src[], int pitch[], bool optimized, bool swapUV)
 {
     Q_ASSERT(src[0] && pitch[0] > 0 && "VideoFrame::fromGPU: src[0] and pitch[0] must be set");
@@ -372,18 +416,25 @@ VideoFrame VideoFrame::to(const VideoFormat &fmt, const QSize& dstSize, const QR
         f.setDisplayAspectRatio(displayAspectRatio());
         f.setTimestamp(timestamp());
         if (si->map(HostMemorySurface, fmt, &f)) {
-            if ((!dstSize.isValid() ||dstSize == QSize(width(), height())) && (!roi.isValid() || roi == QRectF(0, 0, width(), height()))) //roi is not supported now
+            if ((!dstSize.isValid() ||dstSize == QSize(width(), height())) && (!roi.isValid() || roi == QRectF(0, 0, width(), height())))
                 return f;
             return f.to(fmt, dstSize, roi);
         }
         return VideoFrame();
     }
+    if (roi.isValid() && roi != QRectF(0, 0, width(), height())) {
+        const VideoFrame c(crop(*this, roi));
+        if (!c.isValid())
+            return VideoFrame();
+        // c.to() returns c if nothing to convert, but c does not own the data
+        if (fmt.pixelFormatFFmpeg() == pixelFormatFFmpeg()
+                && (dstSize.width() <= 0 || dstSize.width() == c.width()) && (dstSize.height() <= 0 || dstSize.height() == c.height()))
+            return crop(*this, roi, true);
+        return c.to(fmt, dstSize);
+    }
     const int w = dstSize.width() > 0 ? dstSize.width() : width();
     const int h = dstSize.height() > 0 ? dstSize.height() : height();
-    if (fmt.pixelFormatFFmpeg() == pixelFormatFFmpeg()
-            && w == width() && h == height()
-            // TODO: roi check.
-            )
+    if (fmt.pixelFormatFFmpeg() == pixelFormatFFmpeg() && w == width() && h == height())
         return *this;
     Q_D(const VideoFrame);
     ImageConverterSWS conv;
@@ -416,6 +467,28 @@ VideoFrame VideoFrame::to(VideoFormat::PixelFormat pixfmt, const QSize& dstSize,
     return to(VideoFormat(pixfmt), dstSize, roi);
 }
 
+bool VideoFrame::to(VideoFormat::PixelFormat pixfmt, quint8 *const dst[], const int dstStride[], const QSize& dstSize, const QRectF &roi) const
+{
+    return to(VideoFormat(pixfmt), dst, dstStride, dstSize, roi);
+}
+
+bool VideoFrame::to(const VideoFormat &fmt, quint8 *const dst[], const int dstStride[], const QSize& dstSize, const QRectF &roi) const
+{
+    VideoFrameConverter conv;
+    if (!roi.isValid() || roi == QRectF(0, 0, width(), height()))
+        return conv.convert(*this, fmt, dstSize, dst, dstStride);
+    if (!constBits(0)) { // hw surface. map to host first
+        const VideoFrame f(to(fmt));
+        if (!f.constBits(0))
+            return false;
+        return f.to(fmt, dst, dstStride, dstSize, roi);
+    }
+    const VideoFrame c(crop(*this, roi));
+    if (!c.isValid())
+        return false;
+    return conv.convert(c, fmt, dstSize, dst, dstStride);
+}
+
 void *VideoFrame::map(SurfaceType type, void *handle, int plane)
 {
     return map(type, handle, format(), plane);
@@ -496,6 +569,45 @@ VideoFrame VideoFrameConverter::convert(const VideoFrame& frame, QImage::Format
     return convert(frame, VideoFormat::pixelFormatFromImageFormat(fmt));
 }
 
+bool VideoFrameConverter::convert(const VideoFrame &frame, const VideoFormat &fmt, const QSize &dstSize, quint8 *const dst[], const int dstStride[]) const
+{
+    if (!frame.isValid() || !fmt.isValid())
+        return false;
+    if (!frame.constBits(0)) { // hw surface
+        const VideoFrame f(frame.to(fmt));
+        if (!f.constBits(0))
+            return false;
+        return convert(f, fmt, dstSize, dst, dstStride);
+    }
+    const int w = dstSize.width() > 0 ? dstSize.width() : frame.width();
+    const int h = dstSize.height() > 0 ? dstSize.height() : frame.height();
+    if (!m_cvt) {
+        m_cvt = new ImageConverterSWS();
+    }
+    m_cvt->setBrightness(m_eq[0]);
+    m_cvt->setContrast(m_eq[1]);
+    m_cvt->setSaturation(m_eq[2]);
+    m_cvt->setInFormat(frame.pixelFormatFFmpeg());
+    m_cvt->setOutFormat(fmt.pixelFormatFFmpeg());
+    m_cvt->setInSize(frame.width(), frame.height());
+    m_cvt->setOutSize(w, h);
+    m_cvt->setInRange(frame.colorRange());
+    const VideoFormat format(frame.format());
+    const int pal = format.hasPalette();
+    QVector<const uchar*> pitch(format.planeCount() + pal);
+    QVector<int> stride(format.planeCount() + pal);
+    for (int i = 0; i < format.planeCount(); ++i) {
+        pitch[i] = frame.constBits(i);
+        stride[i] = frame.bytesPerLine(i);
+    }
+    const QByteArray paldata(frame.metaData(QStringLiteral("pallete")).toByteArray());
+    if (pal > 0) {
+        pitch[1] = (const uchar*)paldata.constData();
+        stride[1] = paldata.size();
+    }
+    return m_cvt->convert(pitch.constData(), stride.constData(), dst, dstStride);
+}
+
 VideoFrame VideoFrameConverter::convert(const VideoFrame &frame, int fffmt) const
 {
     if (!frame.isValid() || fffmt == QTAV_PIX_FMT_C(NONE))
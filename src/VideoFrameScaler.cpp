@@ -0,0 +1,97 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#include "VideoFrameScaler.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+QSize VideoFrameScaler::outputSize(const VideoFrame &frame, const QSize &requested)
+{
+    int w = requested.width(), h = requested.height();
+    if (w <= 0 || h <= 0) {
+        qreal dar = frame.displayAspectRatio();
+        if (dar <= 0)
+            dar = qreal(frame.width())/qreal(frame.height());
+        if (w > 0)
+            h = qRound(qreal(w)/dar);
+        else if (h > 0)
+            w = qRound(qreal(h)*dar);
+        else
+            w = frame.width(), h = frame.height();
+    }
+    return QSize(qMax(2, w & ~1), qMax(2, h & ~1));
+}
+
+VideoFrame VideoFrameScaler::convert(const VideoFrame &frame, const VideoFormat &fmt, const QSize &size)
+{
+    VideoFrame in(frame);
+    if (!in.constBits(0)) {
+        in = frame.to(frame.format());
+        if (!in.isValid())
+            return VideoFrame();
+    }
+    if (in.pixelFormat() == fmt.pixelFormat() && QSize(in.width(), in.height()) == size)
+        return in;
+    enum { kAlign = ImageConverter::DataAlignment };
+    const int nb_planes = fmt.planeCount();
+    QVector<int> pitch(nb_planes);
+    QVector<int> offset(nb_planes);
+    int bytes = 0;
+    for (int i = 0; i < nb_planes; ++i) {
+        pitch[i] = (fmt.bytesPerLine(size.width(), i) + kAlign - 1) & ~(kAlign - 1);
+        offset[i] = bytes;
+        bytes += pitch[i]*fmt.height(size.height(), i);
+    }
+    QByteArray buf(bytes + kAlign - 1, Qt::Uninitialized);
+    quint8 *base = (quint8*)buf.data(); //must before buf is shared, otherwise data will be detached.
+    base += (kAlign - (quintptr(base) & (kAlign - 1))) & (kAlign - 1);
+    QVector<quint8*> bits(nb_planes);
+    for (int i = 0; i < nb_planes; ++i)
+        bits[i] = base + offset[i];
+    conv.setInFormat(in.pixelFormatFFmpeg());
+    conv.setInSize(in.width(), in.height());
+    conv.setInRange(in.colorRange());
+    conv.setOutFormat(fmt.pixelFormatFFmpeg());
+    conv.setOutSize(size.width(), size.height());
+    QVector<const quint8*> src(in.planeCount());
+    QVector<int> src_pitch(in.planeCount());
+    for (int i = 0; i < src.size(); ++i) {
+        src[i] = in.constBits(i);
+        src_pitch[i] = in.bytesPerLine(i);
+    }
+    if (!conv.convert(src.constData(), src_pitch.constData(), bits.constData(), pitch.constData())) {
+        qWarning() << "VideoFrameScaler failed to convert " << in.format() << "=>" << fmt;
+        return VideoFrame();
+    }
+    VideoFrame out(size.width(), size.height(), fmt, buf, kAlign);
+    out.setBits(bits);
+    out.setBytesPerLine(pitch);
+    out.setTimestamp(in.timestamp());
+    out.setDisplayAspectRatio(qreal(size.width())/qreal(size.height()));
+    if (fmt.isRGB()) {
+        out.setColorSpace(fmt.isPlanar() ? ColorSpace_GBR : ColorSpace_RGB);
+    } else {
+        out.setColorSpace(in.colorSpace());
+        out.setColorRange(in.colorRange());
+    }
+    return out;
+}
+} //namespace QtAV
@@ -0,0 +1,55 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_VIDEOFRAMESCALER_H
+#define QTAV_VIDEOFRAMESCALER_H
+
+#include <QtCore/QSize>
+#include "QtAV/VideoFrame.h"
+#include "ImageConverter.h"
+
+namespace QtAV {
+/*!
+ * \brief The VideoFrameScaler class
+ * Converts and scales frames into a new buffer for every frame, so the results can be queued while the next frame is
+ * converted (VideoFrameConverter reuses its output buffer). Hardware frames are copied to host memory first.
+ * Not thread safe. Use 1 scaler per thread.
+ */
+class VideoFrameScaler
+{
+public:
+    /*!
+     * \brief outputSize
+     * Output size for the requested size. If width or height <= 0, it is computed from the other one and the display
+     * aspect ratio of the frame. If both <= 0, frame size is used. The result is even because of subsampled chroma.
+     */
+    static QSize outputSize(const VideoFrame& frame, const QSize& requested);
+    /*!
+     * \brief convert
+     * Returns the frame itself (copied to host memory if necessary) if format and size are the same.
+     * An invalid frame is returned on error.
+     */
+    VideoFrame convert(const VideoFrame& frame, const VideoFormat& fmt, const QSize& size);
+private:
+    ImageConverterSWS conv;
+};
+} //namespace QtAV
+#endif // QTAV_VIDEOFRAMESCALER_H
@@ -0,0 +1,335 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#include "QtAV/VideoFrameTap.h"
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include "QtAV/AVPlayer.h"
+#include "VideoFrameScaler.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+// conversion threads shared by all taps. a tap converts 1 frame at a time
+Q_GLOBAL_STATIC(QThreadPool, frameTapThreadPool)
+
+class VideoFrameTap::Private
+{
+public:
+    Private(VideoFrameTap *tap)
+        : q(tap)
+        , player(0)
+        , fps(0)
+        , queue_size(2)
+        , busy(false)
+        , next_pts(-1)
+        , generation(0)
+        , dropped(0)
+        , delivered(0)
+    {}
+    // select the format and size for a source frame. returns false if frame can be queued as it is
+    bool target(const VideoFrame& frame, VideoFormat *fmt, QSize *size) const {
+        *fmt = frame.format();
+        if (!formats.isEmpty() && !formats.contains(fmt->pixelFormat()))
+            *fmt = VideoFormat(formats.first());
+        *size = VideoFrameScaler::outputSize(frame, size_out);
+        if (!frame.constBits(0)) // hw surface
+            return true;
+        return fmt->pixelFormat() != frame.pixelFormat() || *size != QSize(frame.width(), frame.height());
+    }
+    // gen: generation when the frame is picked
+    void enqueue(const VideoFrame& frame, int gen) {
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            if (gen != generation) { // picked before reset()
+                ++dropped;
+                return;
+            }
+            while (frames.size() >= queue_size) {
+                frames.dequeue();
+                ++dropped;
+            }
+            frames.enqueue(frame);
+            cond.wakeAll();
+        }
+        Q_EMIT q->frameAvailable();
+    }
+
+    VideoFrameTap *q;
+    mutable QMutex mutex;
+    QWaitCondition cond; // a frame is queued
+    QWaitCondition idle; // no frame is being converted
+    AVPlayer *player;
+    qreal fps;
+    QSize size_out;
+    QList<VideoFormat::PixelFormat> formats;
+    int queue_size;
+    bool busy; // a conversion task is running
+    VideoFrame pending; // the latest picked frame waiting for the running conversion
+    qreal next_pts; // timestamp of the next frame to pick. < 0: pick the next frame
+    int generation; // increased by reset()
+    QQueue<VideoFrame> frames;
+    qint64 dropped;
+    qint64 delivered;
+    VideoFrameScaler scaler; // only used by the running task
+};
+
+class FrameTapTask : public QRunnable
+{
+public:
+    FrameTapTask(VideoFrameTap::Private *p, const VideoFrame& f) : d(p), frame(f) {
+        setAutoDelete(true);
+    }
+    void run() Q_DECL_OVERRIDE {
+        while (frame.isValid()) {
+            VideoFormat fmt;
+            QSize size;
+            int gen = 0;
+            {
+                QMutexLocker lock(&d->mutex);
+                Q_UNUSED(lock);
+                d->target(frame, &fmt, &size);
+                gen = d->generation;
+            }
+            const VideoFrame out(d->scaler.convert(frame, fmt, size));
+            if (out.isValid())
+                d->enqueue(out, gen);
+            QMutexLocker lock(&d->mutex);
+            Q_UNUSED(lock);
+            frame = d->pending;
+            d->pending = VideoFrame();
+            if (!frame.isValid()) {
+                d->busy = false;
+                d->idle.wakeAll();
+            }
+        }
+    }
+private:
+    VideoFrameTap::Private *d;
+    VideoFrame frame;
+};
+
+VideoFrameTap::VideoFrameTap(QObject *parent)
+    : QObject(parent)
+    , d(new Private(this))
+{}
+
+VideoFrameTap::~VideoFrameTap()
+{
+    if (d->player)
+        d->player->removeFrameTap(this);
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->pending = VideoFrame();
+    while (d->busy)
+        d->idle.wait(&d->mutex);
+}
+
+void VideoFrameTap::setFrameRate(qreal value)
+{
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        if (d->fps == value)
+            return;
+        d->fps = value;
+        d->next_pts = -1;
+    }
+    Q_EMIT frameRateChanged();
+}
+
+qreal VideoFrameTap::frameRate() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->fps;
+}
+
+void VideoFrameTap::setFrameSize(const QSize &value)
+{
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        if (d->size_out == value)
+            return;
+        d->size_out = value;
+    }
+    Q_EMIT frameSizeChanged();
+}
+
+QSize VideoFrameTap::frameSize() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->size_out;
+}
+
+void VideoFrameTap::setPixelFormats(const QList<VideoFormat::PixelFormat> &value)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->formats = value;
+    d->formats.removeAll(VideoFormat::Format_Invalid);
+}
+
+QList<VideoFormat::PixelFormat> VideoFrameTap::pixelFormats() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->formats;
+}
+
+void VideoFrameTap::setPixelFormat(VideoFormat::PixelFormat value)
+{
+    setPixelFormats(QList<VideoFormat::PixelFormat>() << value);
+}
+
+void VideoFrameTap::setQueueSize(int value)
+{
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        value = qMax(1, value);
+        if (d->queue_size == value)
+            return;
+        d->queue_size = value;
+        while (d->frames.size() > d->queue_size) {
+            d->frames.dequeue();
+            ++d->dropped;
+        }
+    }
+    Q_EMIT queueSizeChanged();
+}
+
+int VideoFrameTap::queueSize() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->queue_size;
+}
+
+bool VideoFrameTap::put(const VideoFrame &frame)
+{
+    if (!frame.isValid())
+        return false;
+    const qreal t = frame.timestamp();
+    VideoFormat fmt;
+    QSize size;
+    bool convert = false;
+    int gen = 0;
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        if (d->fps > 0) {
+            const qreal dt = 1.0/d->fps;
+            if (d->next_pts < 0 || t < d->next_pts - 2.0*dt) // the first frame, or seeked backward
+                d->next_pts = t;
+            if (t + 0.001 < d->next_pts) // tolerate timestamp rounding
+                return false;
+            d->next_pts += dt;
+            if (d->next_pts <= t) // a gap, or seeked forward
+                d->next_pts = t + dt;
+        }
+        if (d->busy) {
+            // the latest frame wins
+            if (d->pending.isValid())
+                ++d->dropped;
+            d->pending = frame;
+            return true;
+        }
+        convert = d->target(frame, &fmt, &size);
+        d->busy = convert;
+        gen = d->generation;
+    }
+    if (convert)
+        frameTapThreadPool()->start(new FrameTapTask(d.data(), frame));
+    else
+        d->enqueue(frame, gen); // zero copy
+    return true;
+}
+
+VideoFrame VideoFrameTap::takeFrame()
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (d->frames.isEmpty())
+        return VideoFrame();
+    ++d->delivered;
+    return d->frames.dequeue();
+}
+
+VideoFrame VideoFrameTap::waitFrame(unsigned long timeout)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (d->frames.isEmpty())
+        d->cond.wait(&d->mutex, timeout);
+    if (d->frames.isEmpty())
+        return VideoFrame();
+    ++d->delivered;
+    return d->frames.dequeue();
+}
+
+int VideoFrameTap::pendingFrames() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->frames.size();
+}
+
+qint64 VideoFrameTap::droppedFrames() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->dropped;
+}
+
+qint64 VideoFrameTap::deliveredFrames() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->delivered;
+}
+
+void VideoFrameTap::reset()
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->dropped += d->frames.size() + d->pending.isValid();
+    d->frames.clear();
+    d->pending = VideoFrame();
+    d->next_pts = -1;
+    ++d->generation;
+}
+
+AVPlayer* VideoFrameTap::player() const
+{
+    return d->player;
+}
+
+void VideoFrameTap::setPlayer(AVPlayer *value)
+{
+    d->player = value;
+}
+} //namespace QtAV
@@ -21,17 +21,21 @@
 
 #include "VideoThread.h"
 #include "AVThread_p.h"
+#include "QtAV/private/ActivityDetector.h"
 #include "QtAV/Packet.h"
 #include "QtAV/AVClock.h"
 #include "QtAV/VideoCapture.h"
+#include "QtAV/VideoFrameTap.h"
 #include "QtAV/VideoDecoder.h"
 #include "QtAV/VideoRenderer.h"
+#include "QtAV/PresentScheduler.h"
 #include "QtAV/Statistics.h"
 #include "QtAV/Filter.h"
 #include "QtAV/FilterContext.h"
 #include "output/OutputSet.h"
 #include "QtAV/private/AVCompat.h"
 #include <QtCore/QFileInfo>
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 #include "AVPlayer.h"
 #include "codec/video/VideoDecoderFFmpegBase.h"
@@ -99,6 +103,26 @@ public:
     VideoFrame displayed_frame;
     bool wait_key_frame = false;
     VideoThread* q_ptr;
+    std::atomic<ActivityDetector*> activity{nullptr};
+    AVDecoder *mvs_decoder = nullptr; // export_mvs is set for
+    bool mvs_exported = false;
+    QList<VideoFrameTap*> taps; // protected by mutex
+
+    // motion vectors are exported by the decoder only if the detector requires
+    void updateActivity(AVDecoder *dec, const VideoFrame& frame) {
+        ActivityDetector *detector = activity.load(std::memory_order_relaxed);
+        const bool mvs = detector && detector->motionVectors();
+        if (dec != mvs_decoder || mvs != mvs_exported) {
+            dec->setProperty("export_mvs", mvs);
+            mvs_decoder = dec;
+            mvs_exported = mvs;
+        }
+        if (!mvs)
+            return;
+        const QVariant motion(frame.metaData(QStringLiteral("motion")));
+        if (motion.isValid())
+            detector->addMotion(frame.timestamp(), motion.toReal());
+    }
 };
 
 VideoThread::VideoThread(QObject *parent) :
@@ -108,6 +132,28 @@ VideoThread::VideoThread(QObject *parent) :
     connect(this,&VideoThread::firstKeyFrameReceived,player,&AVPlayer::firstKeyFrameReceived);
 }
 
+void VideoThread::setActivityDetector(ActivityDetector *detector)
+{
+    d_func().activity = detector;
+}
+
+void VideoThread::addFrameTap(VideoFrameTap *tap)
+{
+    DPTR_D(VideoThread);
+    QMutexLocker locker(&d.mutex);
+    Q_UNUSED(locker);
+    if (!d.taps.contains(tap))
+        d.taps.append(tap);
+}
+
+bool VideoThread::removeFrameTap(VideoFrameTap *tap)
+{
+    DPTR_D(VideoThread);
+    QMutexLocker locker(&d.mutex);
+    Q_UNUSED(locker);
+    return d.taps.removeOne(tap);
+}
+
 //it is called in main thread usually, but is being used in video thread,
 VideoCapture* VideoThread::setVideoCapture(VideoCapture *cap)
 {
@@ -242,13 +288,17 @@ bool VideoThread::decodePacket(Packet &pkt)
     if(!d.dec)
         return false;
     VideoDecoder *dec = static_cast<VideoDecoder*>(d.dec);
-    if (!dec->decode(pkt))
+    QTAV_TRACE_BEGIN(VideoDecode, d.statistics);
+    const bool decoded_ok = dec->decode(pkt);
+    QTAV_TRACE_END(VideoDecode, d.statistics, pkt.pts);
+    if (!decoded_ok)
         return false;
     if(pkt.hasKeyFrame)
         d.update_video_info(dec->frame());
     if (!pkt.isEOF())
         pkt.skip(pkt.data.size() - dec->undecodedSize());
     VideoFrame frame = dec->frame();
+    d.updateActivity(dec, frame);
 
     d.statistics->mutex.lock();
     d.statistics->totalFrames++;
@@ -274,6 +324,7 @@ void VideoThread::applyFilters(VideoFrame &frame)
     QMutexLocker locker(&d.mutex);
     Q_UNUSED(locker);
     if (!d.filters.isEmpty()) {
+        QTAV_TRACE_SCOPE(Filter, d.statistics);
         //sort filters by format. vo->defaultFormat() is the last
         foreach (Filter *filter, d.filters) {
             VideoFilter *vf = static_cast<VideoFilter*>(filter);
@@ -283,6 +334,10 @@ void VideoThread::applyFilters(VideoFrame &frame)
                 vf->apply(d.statistics, &frame);
         }
     }
+    // never blocks. conversion for taps runs in their own threads
+    foreach (VideoFrameTap *tap, d.taps) {
+        tap->put(frame);
+    }
 }
 
 // filters on vo will not change video frame, so it's safe to protect frame only in every individual vo
@@ -306,13 +361,16 @@ bool VideoThread::deliverVideoFrame(VideoFrame &frame)
             fmt = VideoFormat::Format_RGB32;
         else
             fmt = vo->preferredPixelFormat();
+        QTAV_TRACE_BEGIN(Convert, d.statistics);
         VideoFrame outFrame(d.conv.convert(frame, fmt));
+        QTAV_TRACE_END(Convert, d.statistics, frame.timestamp());
         if (!outFrame.isValid()) {
             d.outputSet->unlock();
             return false;
         }
         frame = outFrame;
     }
+    QTAV_TRACE(Deliver, d.statistics, frame.timestamp());
     d.outputSet->sendVideoFrame(frame); //TODO: group by format, convert group by group
     d.outputSet->unlock();
 
@@ -320,6 +378,42 @@ bool VideoThread::deliverVideoFrame(VideoFrame &frame)
     return true;
 }
 
+// vsync aligned presentation of the first renderer. see PresentScheduler
+static PresentScheduler* presentScheduler(OutputSet *outputSet)
+{
+    const QList<AVOutput *> outputs = outputSet->outputs();
+    if (outputs.isEmpty())
+        return 0;
+    return static_cast<VideoRenderer*>(outputs.first())->presentScheduler();
+}
+
+// how early a frame must be decoded before its display time
+static qreal presentLeadTime(OutputSet *outputSet)
+{
+    outputSet->lock();
+    PresentScheduler *ps = presentScheduler(outputSet);
+    const qreal lead = ps ? ps->leadTime(PresentScheduler::now()) : 0;
+    outputSet->unlock();
+    return lead;
+}
+
+// returns the time to deliver the frame
+static qint64 schedulePresent(OutputSet *outputSet, AVClock *clock, qreal pts, qint64 now)
+{
+    const qreal display_wait = (pts - clock->value())/clock->speed();
+    if (qAbs(display_wait) > 1.0)
+        return now;
+    outputSet->lock();
+    PresentScheduler *ps = presentScheduler(outputSet);
+    qint64 deliver = now;
+    if (ps) {
+        deliver = ps->schedule(pts, now + qint64(display_wait*1e9), now);
+        clock->updateVideoLatency(ps->latency());
+    }
+    outputSet->unlock();
+    return deliver;
+}
+
 //TODO: if output is null or dummy, the use duration to wait
 void VideoThread::run()
 {
@@ -361,6 +455,9 @@ void VideoThread::run()
     qint64 last_deliver_time = 0;
     int sync_id = 0;
     auto realtimeDecode = player->realtimeDecode();
+    // the 1st frame is rendered without waiting for clock, then sync as usual
+    bool fast_first_frame = player->fastFirstFrame();
+    bool first_decoded = true, first_rendered = true;
     while (!d.stop) {
         processNextTask();
 
@@ -466,6 +563,8 @@ void VideoThread::run()
         qreal diff = dts > 0 ? dts - d.clock->value() + v_a : v_a;
         if (pkt.isEOF())
             diff = qMin<qreal>(1.0, qMax<qreal>(d.delay, 1.0/d.statistics->video_only.currentDisplayFPS()));
+        else if (fast_first_frame)
+            diff = 0;
         if (diff < 0 && sync_video)
             diff = 0; // this ensures no frame drop
         if (diff > kSyncThreshold) {
@@ -513,8 +612,12 @@ void VideoThread::run()
         if (!sync_audio && diff > 0) {
             // wait to dts reaches
             // d.force_fps>0: wait after decoded before deliver
-            if (d.force_fps <= 0)// || !qFuzzyCompare(d.clock->speed(), 1.0))
-                waitAndCheck(diff*1000UL, dts); // TODO: count decoding and filter time, or decode immediately but wait for display
+            if (d.force_fps <= 0) {// || !qFuzzyCompare(d.clock->speed(), 1.0))
+                // vsync aligned renderer needs the frame earlier to choose the refresh
+                const qreal lead = sync_video ? 0 : presentLeadTime(d.outputSet);
+                if (diff > lead)
+                    waitAndCheck((diff - lead)*1000UL, dts); // TODO: count decoding and filter time, or decode immediately but wait for display
+            }
             diff = 0; // TODO: can not change delay!
         }
         // update here after wait. TODO: use decoded timestamp/guessed next pts?
@@ -541,7 +644,9 @@ void VideoThread::run()
         //audio packet not cleaned up?
         if (diff > 0 && diff < 1.0 && !seeking) {
             // can not change d.delay here! we need it to comapre to next loop
-            waitAndCheck(diff*1000UL, dts);
+            const qreal lead = presentLeadTime(d.outputSet);
+            if (diff > lead)
+                waitAndCheck((diff - lead)*1000UL, dts);
         }
         if (wait_key_frame) {
             if (!pkt.hasKeyFrame) {
@@ -590,7 +695,10 @@ void VideoThread::run()
         }
         if (dec_opt != dec_opt_old)
             dec->setOptions(*dec_opt);
-        if (!dec->decode(pkt)) {
+        QTAV_TRACE_BEGIN(VideoDecode, d.statistics);
+        const bool decoded_ok = dec->decode(pkt);
+        QTAV_TRACE_END(VideoDecode, d.statistics, pkt.pts);
+        if (!decoded_ok) {
             d.pts_history.push_back(d.pts_history.back());
             //qWarning("Decode video failed. undecoded: %d/%d", dec->undecodedSize(), pkt.data.size());
             if (pkt.isEOF()) {
@@ -620,6 +728,7 @@ void VideoThread::run()
         if (!pkt.isEOF())
             pkt.skip(pkt.data.size() - dec->undecodedSize());
         VideoFrame frame = dec->frame();
+        d.updateActivity(dec, frame);
 
         ///sample code for accessing ffmpeg decoder and avframe
 //        if(dec->name()=="FFmpeg")
@@ -643,6 +752,12 @@ void VideoThread::run()
             continue;
         }
         pkt_data = pkt.data.constData();
+        if (first_decoded) {
+            first_decoded = false;
+            QMutexLocker lock(&d.statistics->mutex);
+            Q_UNUSED(lock);
+            d.statistics->timeline.mark(&d.statistics->timeline.first_decoded);
+        }
         if (frame.timestamp() < 0)
             frame.setTimestamp(pkt.pts); // pkt.pts is wrong. >= real timestamp
         const qreal pts = frame.timestamp();
@@ -659,6 +774,7 @@ void VideoThread::run()
             d.render_pts0 = -1;
             qDebug("video seek finished @%f. id: %d", pts, sync_id);
             d.clock->syncEndOnce(sync_id);
+            QTAV_TRACE(SeekFinished, d.statistics, pts);
             Q_EMIT seekFinished(qint64(pts*1000.0));
             if (seek_count == -1)
                 seek_count = 1;
@@ -666,6 +782,7 @@ void VideoThread::run()
                 seek_count++;
         }
         if (skip_render) {
+            QTAV_TRACE(Drop, d.statistics, pts);
             qDebug("skip rendering @%.3f", pts);
             pkt = Packet();
             v_a = 0;
@@ -694,6 +811,12 @@ void VideoThread::run()
             if (delta > 0LL) { // limit up bound?
                 waitAndCheck((ulong)delta, -1); // wait and not compare pts-clock
             }
+        } else if (!seeking && !sync_video) {
+            // deliver in the refresh before the vsync nearest to pts, so the renderer paints it in time
+            const qint64 now = PresentScheduler::now();
+            const qint64 deliver = schedulePresent(d.outputSet, d.clock, pts, now);
+            if (deliver > now)
+                waitAndCheck(ulong((deliver - now)/1000000LL), pts);
         } else if (false) { //FIXME: may block a while when seeking
             const qreal display_wait = pts - clock()->value();
             if (!seeking && display_wait > 0.0) {
@@ -706,6 +829,13 @@ void VideoThread::run()
         // no return even if d.stop is true. ensure frame is displayed. otherwise playing an image may be failed to display
         if (!deliverVideoFrame(frame))
             continue;
+        fast_first_frame = false;
+        if (first_rendered) {
+            first_rendered = false;
+            QMutexLocker lock(&d.statistics->mutex);
+            Q_UNUSED(lock);
+            d.statistics->timeline.mark(&d.statistics->timeline.first_rendered);
+        }
         //qDebug("clock.diff: %.3f", d.clock->diff());
         if (d.force_dt > 0)
             last_deliver_time = QDateTime::currentMSecsSinceEpoch();
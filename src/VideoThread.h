@@ -28,8 +28,10 @@
 
 namespace QtAV {
 
+class ActivityDetector;
 class VideoCapture;
 class VideoFrame;
+class VideoFrameTap;
 class VideoThreadPrivate;
 class AVPlayer;
 class VideoThread : public AVThread
@@ -49,6 +51,11 @@ public:
     void setEQ(int b, int c, int s);
 
     bool decodePacket(Packet& pkt);
+    // motion vectors of decoded frames are added to the detector if it requires. thread safe
+    void setActivityDetector(ActivityDetector* detector);
+    // filtered frames are put into taps. thread safe
+    void addFrameTap(VideoFrameTap* tap);
+    bool removeFrameTap(VideoFrameTap* tap);
 
 public Q_SLOTS:
     void addCaptureTask();
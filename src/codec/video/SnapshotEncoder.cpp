@@ -0,0 +1,314 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/private/SnapshotEncoder.h"
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QScopedPointer>
+#include "QtAV/VideoFrame.h"
+#include "QtAV/private/AVCompat.h"
+#include "ImageConverter.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+namespace {
+static const int kDefaultQuality = 75;
+static const int kMaxIdle = 16;
+
+enum Codec {
+    Jpeg,
+    WebP,
+    Unknown
+};
+
+Codec codecFromFormat(const QString& format)
+{
+    const QString f(format.toLower());
+    if (f == QLatin1String("jpg") || f == QLatin1String("jpeg"))
+        return Jpeg;
+    if (f == QLatin1String("webp"))
+        return WebP;
+    return Unknown;
+}
+
+AVCodec* findEncoder(Codec c)
+{
+#if !AVCODEC_STATIC_REGISTER
+    avcodec_register_all();
+#endif
+    if (c == Jpeg)
+        return (AVCodec*)avcodec_find_encoder(QTAV_CODEC_ID(MJPEG));
+    if (c == WebP)
+        return (AVCodec*)avcodec_find_encoder_by_name("libwebp");
+    return 0;
+}
+
+struct Key {
+    bool operator==(const Key& o) const {
+        return codec == o.codec && width == o.width && height == o.height && pixfmt == o.pixfmt && quality == o.quality;
+    }
+    Codec codec;
+    int width, height;
+    AVPixelFormat pixfmt;
+    int quality;
+};
+
+struct Context {
+    Key key;
+    AVCodecContext *avctx;
+};
+
+// idle contexts. a context is used by one task at a time
+class ContextPool
+{
+public:
+    ~ContextPool() { clear(); }
+    AVCodecContext* take(const Key& key) {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        for (int i = idle.size() - 1; i >= 0; --i) {
+            if (idle.at(i).key == key)
+                return idle.takeAt(i).avctx;
+        }
+        return 0;
+    }
+    void give(const Key& key, AVCodecContext* avctx) {
+        Context c;
+        c.key = key;
+        c.avctx = avctx;
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        idle.append(c);
+        while (idle.size() > kMaxIdle) {
+            avcodec_free_context(&idle.first().avctx);
+            idle.removeFirst();
+        }
+    }
+    void clear() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        for (int i = 0; i < idle.size(); ++i)
+            avcodec_free_context(&idle[i].avctx);
+        idle.clear();
+    }
+private:
+    QMutex mutex;
+    QList<Context> idle;
+};
+Q_GLOBAL_STATIC(ContextPool, contextPool)
+
+AVCodecContext* openContext(const Key& key)
+{
+    AVCodec *codec = findEncoder(key.codec);
+    if (!codec)
+        return 0;
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    if (!avctx)
+        return 0;
+    avctx->width = key.width;
+    avctx->height = key.height;
+    avctx->pix_fmt = key.pixfmt;
+    avctx->time_base.num = 1;
+    avctx->time_base.den = 25;
+    avctx->thread_count = 1; // snapshots are encoded in parallel
+    avctx->color_range = key.codec == Jpeg ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+    avctx->colorspace = AVCOL_SPC_BT470BG;
+    AVDictionary *dict = 0;
+    if (key.codec == Jpeg) {
+        // quality 0~100 => qscale 31~2
+        const int qscale = qBound(2, 31 - key.quality*29/100, 31);
+        avctx->flags |= AV_CODEC_FLAG_QSCALE;
+        avctx->global_quality = FF_QP2LAMBDA*qscale;
+    } else if (key.codec == WebP) {
+        av_dict_set(&dict, "quality", QByteArray::number(key.quality).constData(), 0);
+    }
+    const int ret = avcodec_open2(avctx, codec, &dict);
+    av_dict_free(&dict);
+    if (ret < 0) {
+        qWarning("SnapshotEncoder failed to open %s encoder for %dx%d %s: %s", codec->name, key.width, key.height, av_get_pix_fmt_name(key.pixfmt), av_err2str(ret));
+        avcodec_free_context(&avctx);
+        return 0;
+    }
+    return avctx;
+}
+
+struct ScopedAVFrameDeleter
+{
+    static inline void cleanup(void *pointer) {
+        av_frame_free((AVFrame**)&pointer);
+    }
+};
+
+/*!
+ * bt709 yuv => bt601 yuv in place for 8bit yuv420p, i.e. bt601 rgb2yuv x bt709 yuv2rgb, 14bit fixed point.
+ * luma is corrected with the chroma of its 2x2 block. For limited range, luma correction is scaled by 219/224
+ */
+void bt709ToBT601(quint8 *const p[], const int stride[], int w, int h, bool full)
+{
+    const int yb = full ? 1664 : 1627, yr = full ? 3213 : 3141;
+    for (int j = 0; j < (h + 1)/2; ++j) {
+        quint8 *y0 = p[0] + 2*j*stride[0];
+        quint8 *y1 = 2*j + 1 < h ? y0 + stride[0] : y0;
+        quint8 *u = p[1] + j*stride[1];
+        quint8 *v = p[2] + j*stride[2];
+        for (int i = 0; i < (w + 1)/2; ++i) {
+            const int cb = u[i] - 128, cr = v[i] - 128;
+            const int dy = (yb*cb + yr*cr + 8192) >> 14;
+            const int x1 = 2*i + 1 < w ? 2*i + 1 : 2*i;
+            y0[2*i] = qBound(0, y0[2*i] + dy, 255);
+            if (x1 != 2*i)
+                y0[x1] = qBound(0, y0[x1] + dy, 255);
+            if (y1 != y0) {
+                y1[2*i] = qBound(0, y1[2*i] + dy, 255);
+                if (x1 != 2*i)
+                    y1[x1] = qBound(0, y1[x1] + dy, 255);
+            }
+            u[i] = qBound(0, 128 + ((16218*cb - 1813*cr + 8192) >> 14), 255);
+            v[i] = qBound(0, 128 + ((-1187*cb + 16112*cr + 8192) >> 14), 255);
+        }
+    }
+}
+
+// any yuv => 8bit bt601 yuv420p in the range the codec expects, with 1 swscale pass
+VideoFrame toBT601(const VideoFrame& frame, ColorSpace cs, bool full)
+{
+    ImageConverterSWS conv;
+    conv.setInFormat(frame.pixelFormatFFmpeg());
+    // swscale sets up range conversion for yuvj formats when the context is created
+    conv.setOutFormat(full ? QTAV_PIX_FMT_C(YUVJ420P) : QTAV_PIX_FMT_C(YUV420P));
+    conv.setInSize(frame.width(), frame.height());
+    conv.setOutSize(frame.width(), frame.height());
+    conv.setInRange(frame.colorRange() == ColorRange_Full ? ColorRange_Full : ColorRange_Limited);
+    conv.setOutRange(full ? ColorRange_Full : ColorRange_Limited);
+    const quint8 *src[] = { frame.constBits(0), frame.constBits(1), frame.constBits(2), frame.constBits(3) };
+    const int srcStride[] = { frame.bytesPerLine(0), frame.bytesPerLine(1), frame.bytesPerLine(2), frame.bytesPerLine(3) };
+    if (!conv.convert(src, srcStride))
+        return VideoFrame();
+    // swscale does not convert yuv matrix between yuv formats
+    if (cs == ColorSpace_BT709)
+        bt709ToBT601(conv.outPlanes().constData(), conv.outLineSizes().constData(), frame.width(), frame.height(), full);
+    VideoFrame f(frame.width(), frame.height(), VideoFormat(VideoFormat::Format_YUV420P), conv.outData(), ImageConverter::DataAlignment);
+    f.setBits(conv.outPlanes());
+    f.setBytesPerLine(conv.outLineSizes());
+    f.setColorSpace(ColorSpace_BT601);
+    f.setColorRange(full ? ColorRange_Full : ColorRange_Limited);
+    f.setTimestamp(frame.timestamp());
+    return f;
+}
+
+QByteArray encodeFrame(AVCodecContext* avctx, const VideoFrame& frame)
+{
+    QScopedPointer<AVFrame, ScopedAVFrameDeleter> f(av_frame_alloc());
+    f->format = avctx->pix_fmt;
+    f->width = frame.width();
+    f->height = frame.height();
+    f->pts = 0;
+    f->quality = avctx->global_quality;
+    f->color_range = avctx->color_range;
+    for (int i = 0; i < frame.planeCount(); ++i) {
+        f->linesize[i] = frame.bytesPerLine(i);
+        f->data[i] = (uint8_t*)frame.constBits(i);
+    }
+    QByteArray data;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = 0;
+    pkt.size = 0;
+#if AV_MODULE_CHECK(LIBAVCODEC, 57, 37, 0, 37, 100)
+    AV_ENSURE_OK(avcodec_send_frame(avctx, f.data()), QByteArray());
+    AV_ENSURE_OK(avcodec_receive_packet(avctx, &pkt), QByteArray());
+    data = QByteArray((const char*)pkt.data, pkt.size);
+#else
+    int got_packet = 0;
+    AV_ENSURE_OK(avcodec_encode_video2(avctx, &pkt, f.data(), &got_packet), QByteArray());
+    if (got_packet)
+        data = QByteArray((const char*)pkt.data, pkt.size);
+#endif
+    av_packet_unref(&pkt);
+    return data;
+}
+} //namespace
+
+bool SnapshotEncoder::isSupported(const QString &format)
+{
+    return !!findEncoder(codecFromFormat(format));
+}
+
+QByteArray SnapshotEncoder::encode(const VideoFrame &frame, const QString &format, int quality)
+{
+    const Codec c = codecFromFormat(format);
+    if (c == Unknown || !frame.isValid())
+        return QByteArray();
+    VideoFrame f(frame);
+    if (!f.constBits(0)) { // hw surface
+        f = f.to(VideoFormat::Format_YUV420P);
+        f.setColorSpace(frame.colorSpace());
+        f.setColorRange(frame.colorRange());
+    }
+    if (!f.isValid() || f.format().isRGB() || f.format().hasPalette())
+        return QByteArray();
+    ColorSpace cs = f.colorSpace();
+    if (cs == ColorSpace_Unknown) // the same as VideoShader
+        cs = f.width() >= 1280 || f.height() > 576 ? ColorSpace_BT709 : ColorSpace_BT601;
+    // viewers assume JFIF, i.e. full range bt601. WebP(VP8) is limited range bt601
+    const bool full = c == Jpeg;
+    const VideoFormat::PixelFormat pf = f.pixelFormat();
+    bool accepted = pf == VideoFormat::Format_YUV420P;
+    if (c == Jpeg)
+        accepted |= pf == VideoFormat::Format_YUV422P || pf == VideoFormat::Format_YUV444P;
+    // e.g. nv12, 10bit, range or matrix mismatch. yuv to yuv is much cheaper than yuv to rgb
+    if (!accepted || cs != ColorSpace_BT601 || (f.colorRange() == ColorRange_Full) != full) {
+        f = toBT601(f, cs, full);
+        if (!f.isValid())
+            return QByteArray();
+    }
+    Key key;
+    key.codec = c;
+    key.width = f.width();
+    key.height = f.height();
+    key.quality = quality < 0 ? kDefaultQuality : qMin(quality, 100);
+    key.pixfmt = (AVPixelFormat)f.pixelFormatFFmpeg();
+    if (c == Jpeg) {
+        switch (f.pixelFormat()) {
+        case VideoFormat::Format_YUV420P: key.pixfmt = QTAV_PIX_FMT_C(YUVJ420P); break;
+        case VideoFormat::Format_YUV422P: key.pixfmt = QTAV_PIX_FMT_C(YUVJ422P); break;
+        case VideoFormat::Format_YUV444P: key.pixfmt = QTAV_PIX_FMT_C(YUVJ444P); break;
+        default: break;
+        }
+    }
+    AVCodecContext *avctx = contextPool()->take(key);
+    if (!avctx)
+        avctx = openContext(key);
+    if (!avctx)
+        return QByteArray();
+    const QByteArray data(encodeFrame(avctx, f));
+    if (data.isEmpty()) // the context state is unknown
+        avcodec_free_context(&avctx);
+    else
+        contextPool()->give(key, avctx);
+    return data;
+}
+
+void SnapshotEncoder::clear()
+{
+    contextPool()->clear();
+}
+} //namespace QtAV
@@ -47,6 +47,7 @@ class VideoDecoderFFmpeg : public VideoDecoderFFmpegBase
     Q_PROPERTY(int threads READ threads WRITE setThreads) // 0 is auto
     Q_PROPERTY(ThreadFlags thread_type READ threadFlags WRITE setThreadFlags)
     Q_PROPERTY(MotionVectorVisFlags vismv READ motionVectorVisFlags WRITE setMotionVectorVisFlags)
+    Q_PROPERTY(bool export_mvs READ exportMotionVectors WRITE setExportMotionVectors) // motion vectors as frame metadata "motion"
     //Q_PROPERTY(BugFlags bug READ bugFlags WRITE setBugFlags)
     Q_ENUMS(StrictType)
     Q_ENUMS(DiscardType)
@@ -163,6 +164,8 @@ public:
     ThreadFlags threadFlags() const;
     void setMotionVectorVisFlags(MotionVectorVisFlags value);
     MotionVectorVisFlags motionVectorVisFlags() const;
+    void setExportMotionVectors(bool value);
+    bool exportMotionVectors() const;
     void setBugFlags(BugFlags value);
     BugFlags bugFlags() const;
     void setHwaccel(const QString& value);
@@ -200,6 +203,7 @@ public:
       , threads(0)
       , debug_mv(VideoDecoderFFmpeg::No)
       , bug(VideoDecoderFFmpeg::autodetect)
+      , export_mvs(false)
     {}
     bool open() Q_DECL_OVERRIDE {
         av_opt_set_int(codec_ctx, "skip_loop_filter", (int64_t)skip_loop_filter, 0);
@@ -210,6 +214,8 @@ public:
         av_opt_set_int(codec_ctx, "thread_type", (int64_t)thread_type, 0);
         av_opt_set_int(codec_ctx, "vismv", (int64_t)debug_mv, 0);
         av_opt_set_int(codec_ctx, "bug", (int64_t)bug, 0);
+        if (export_mvs)
+            av_opt_set(codec_ctx, "flags2", "+export_mvs", 0);
         //CODEC_FLAG_EMU_EDGE: deprecated in ffmpeg >=? & libav>=10. always set by ffmpeg
 #if 0
         if (fast) {
@@ -251,6 +257,7 @@ public:
     int threads;
     int debug_mv;
     int bug;
+    bool export_mvs;
     QString hwa;
 };
 
@@ -373,6 +380,19 @@ VideoDecoderFFmpeg::MotionVectorVisFlags VideoDecoderFFmpeg::motionVectorVisFlag
     return (MotionVectorVisFlags)d_func().debug_mv;
 }
 
+void VideoDecoderFFmpeg::setExportMotionVectors(bool value)
+{
+    DPTR_D(VideoDecoderFFmpeg);
+    d.export_mvs = value;
+    if (d.codec_ctx)
+        av_opt_set(d.codec_ctx, "flags2", value ? "+export_mvs" : "-export_mvs", 0);
+}
+
+bool VideoDecoderFFmpeg::exportMotionVectors() const
+{
+    return d_func().export_mvs;
+}
+
 void VideoDecoderFFmpeg::setBugFlags(BugFlags value)
 {
     DPTR_D(VideoDecoderFFmpeg);
@@ -410,6 +430,7 @@ void i18n() {
     QObject::tr("threads");
     QObject::tr("thread_type");
     QObject::tr("vismv");
+    QObject::tr("export_mvs");
     QObject::tr("bug");
 }
 //}
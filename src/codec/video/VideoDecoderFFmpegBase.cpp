@@ -21,6 +21,11 @@
 
 #include "VideoDecoderFFmpegBase.h"
 #include "QtAV/Packet.h"
+#include <QtCore/qmath.h>
+#if AV_MODULE_CHECK(LIBAVUTIL, 99, 0, 0, 54, 15, 100) // not in libav
+#include <libavutil/motion_vector.h>
+#define QTAV_HAVE_MOTION_VECTORS 1
+#endif
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -106,6 +111,29 @@ qreal VideoDecoderFFmpegBasePrivate::getDAR(AVFrame *f)
     return dar;
 }
 
+// mean length of motion vectors weighted by block area over the whole picture, in pixels. < 0 if not exported
+static qreal motionOf(const AVFrame *f)
+{
+#ifdef QTAV_HAVE_MOTION_VECTORS
+    const AVFrameSideData *sd = av_frame_get_side_data(f, AV_FRAME_DATA_MOTION_VECTORS);
+    if (!sd)
+        return -1;
+    const AVMotionVector *mvs = (const AVMotionVector*)sd->data;
+    const int nb = sd->size/sizeof(AVMotionVector);
+    qreal motion = 0;
+    for (int i = 0; i < nb; ++i) {
+        const AVMotionVector &mv = mvs[i];
+        const int dx = mv.dst_x - mv.src_x, dy = mv.dst_y - mv.src_y;
+        if (dx || dy)
+            motion += qSqrt(qreal(dx*dx + dy*dy))*qreal(mv.w*mv.h);
+    }
+    return motion/qreal(qMax(1, f->width*f->height));
+#else
+    Q_UNUSED(f);
+    return -1;
+#endif
+}
+
 VideoDecoderFFmpegBase::VideoDecoderFFmpegBase(VideoDecoderFFmpegBasePrivate &d):
     VideoDecoder(d)
 {
@@ -162,6 +190,9 @@ VideoFrame VideoDecoderFFmpegBase::frame()
     frame.setTimestamp((double)d.frame->pkt_pts/1000.0);
     frame.setMetaData(QStringLiteral("avbuf"), QVariant::fromValue(AVFrameBuffersRef(new AVFrameBuffers(d.frame))));
     d.updateColorDetails(&frame);
+    const qreal motion = motionOf(d.frame);
+    if (motion >= 0)
+        frame.setMetaData(QStringLiteral("motion"), motion);
     if (frame.format().hasPalette()) {
         frame.setMetaData(QStringLiteral("pallete"), QByteArray((const char*)d.frame->data[1], 256*4));
     }
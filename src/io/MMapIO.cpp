@@ -0,0 +1,250 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/MediaIO.h"
+#include "QtAV/private/MediaIO_p.h"
+#include "QtAV/private/mkid.h"
+#include "QtAV/private/factory.h"
+#include <QtCore/QFile>
+#include <string.h>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "utils/Logger.h"
+
+namespace QtAV {
+/*!
+ * \brief The MMapIO class
+ * Maps a local file into memory and serves read() from the mapping, without a read syscall per AVIO buffer.
+ * The kernel is told the access is sequential and the data around current position will be needed soon.
+ * Set property "variableSize" to true for a growing file (e.g. still being recorded), then the file is remapped
+ * when reading reaches the end of the mapping.
+ * Usage: player.setFile("mmap:/path/to/file.mkv")
+ */
+class MMapIOPrivate;
+class MMapIO Q_DECL_FINAL: public MediaIO
+{
+    Q_OBJECT
+    Q_PROPERTY(bool variableSize READ isVariableSize WRITE setVariableSize)
+    DPTR_DECLARE_PRIVATE(MMapIO)
+public:
+    MMapIO();
+    QString name() const Q_DECL_OVERRIDE;
+    const QStringList& protocols() const Q_DECL_OVERRIDE;
+    bool isSeekable() const Q_DECL_OVERRIDE;
+    bool isVariableSize() const Q_DECL_OVERRIDE;
+    void setVariableSize(bool value);
+    qint64 read(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    bool seek(qint64 offset, int from) Q_DECL_OVERRIDE;
+    qint64 position() const Q_DECL_OVERRIDE;
+    qint64 size() const Q_DECL_OVERRIDE;
+protected:
+    void onUrlChanged() Q_DECL_OVERRIDE;
+private:
+    bool remap();
+    void advise();
+};
+typedef MMapIO MediaIOMMap;
+static const MediaIOId MediaIOId_MMap = mkid::id32base36_4<'M','M','a','p'>::value;
+static const char kMMapName[] = "MMap";
+FACTORY_REGISTER(MediaIO, MMap, kMMapName)
+
+// WILLNEED range ahead of current position
+static const qint64 kAdviseSize = 4*1024*1024;
+
+class MMapIOPrivate Q_DECL_FINAL: public MediaIOPrivate
+{
+public:
+    MMapIOPrivate()
+        : MediaIOPrivate()
+        , variable_size(false)
+        , data(0)
+        , mapped_size(0)
+        , pos(0)
+        , advised_end(0)
+    {}
+    ~MMapIOPrivate() {
+        if (data)
+            file.unmap(data);
+        if (file.isOpen())
+            file.close();
+    }
+    bool variable_size;
+    QFile file;
+    uchar *data;
+    qint64 mapped_size;
+    qint64 pos;
+    qint64 advised_end; // the end of last WILLNEED range
+};
+
+MMapIO::MMapIO() : MediaIO(*new MMapIOPrivate()) {}
+
+QString MMapIO::name() const { return QLatin1String(kMMapName);}
+
+const QStringList& MMapIO::protocols() const
+{
+    static QStringList p = QStringList() << QStringLiteral("mmap");
+    return p;
+}
+
+bool MMapIO::isSeekable() const
+{
+    return d_func().file.isOpen();
+}
+
+bool MMapIO::isVariableSize() const
+{
+    return d_func().variable_size;
+}
+
+void MMapIO::setVariableSize(bool value)
+{
+    d_func().variable_size = value;
+}
+
+qint64 MMapIO::read(char *data, qint64 maxSize)
+{
+    DPTR_D(MMapIO);
+    if (!d.file.isOpen())
+        return 0;
+    if (d.data && d.variable_size && d.pos >= d.mapped_size)
+        remap();
+    if (!d.data) // mapping is not supported. e.g. not enough address space
+        return d.file.read(data, maxSize);
+    const qint64 n = qMin(maxSize, d.mapped_size - d.pos);
+    if (n <= 0)
+        return 0;
+    memcpy(data, d.data + d.pos, n);
+    d.pos += n;
+    if (d.pos + kAdviseSize/2 > d.advised_end)
+        advise();
+    return n;
+}
+
+bool MMapIO::seek(qint64 offset, int from)
+{
+    DPTR_D(MMapIO);
+    if (!d.file.isOpen())
+        return false;
+    if (from == SEEK_END) {
+        offset = size() - offset;
+    } else if (from == SEEK_CUR) {
+        offset = d.pos + offset;
+    }
+    if (offset < 0)
+        return false;
+    if (offset > d.mapped_size && d.variable_size)
+        remap();
+    if (!d.data) {
+        if (!d.file.seek(offset))
+            return false;
+    }
+    d.pos = offset;
+    if (d.pos < d.advised_end - kAdviseSize || d.pos >= d.advised_end)
+        advise();
+    return true;
+}
+
+qint64 MMapIO::position() const
+{
+    DPTR_D(const MMapIO);
+    if (!d.data)
+        return d.file.pos();
+    return d.pos;
+}
+
+qint64 MMapIO::size() const
+{
+    DPTR_D(const MMapIO);
+    if (d.variable_size || !d.data)
+        return d.file.size();
+    return d.mapped_size;
+}
+
+void MMapIO::onUrlChanged()
+{
+    DPTR_D(MMapIO);
+    if (d.data) {
+        d.file.unmap(d.data);
+        d.data = 0;
+    }
+    if (d.file.isOpen())
+        d.file.close();
+    d.mapped_size = d.pos = d.advised_end = 0;
+    QString path(url());
+    if (path.startsWith(QLatin1String("mmap:")))
+        path = path.mid(5);
+    d.file.setFileName(path);
+    if (path.isEmpty())
+        return;
+    if (!d.file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open [" << d.file.fileName() << "]: " << d.file.errorString();
+        return;
+    }
+    if (!remap())
+        qWarning("MMapIO: failed to map [%s]. fallback to read", path.toUtf8().constData());
+}
+
+bool MMapIO::remap()
+{
+    DPTR_D(MMapIO);
+    const qint64 file_size = d.file.size();
+    if (file_size <= 0)
+        return false;
+    if (d.data && file_size <= d.mapped_size)
+        return true;
+    if (d.data) {
+        d.file.unmap(d.data);
+        d.data = 0;
+        d.mapped_size = 0;
+    }
+    d.data = d.file.map(0, file_size);
+    if (!d.data) {
+        d.file.seek(d.pos);
+        return false;
+    }
+    d.mapped_size = file_size;
+#ifdef Q_OS_UNIX
+    posix_madvise(d.data, d.mapped_size, POSIX_MADV_SEQUENTIAL);
+#endif
+    d.advised_end = 0;
+    advise();
+    return true;
+}
+
+void MMapIO::advise()
+{
+    DPTR_D(MMapIO);
+    if (!d.data)
+        return;
+#ifdef Q_OS_UNIX
+    static const qint64 kPageSize = sysconf(_SC_PAGESIZE);
+    const qint64 from = d.pos & ~(kPageSize - 1); // address must be page aligned
+    const qint64 to = qMin(d.pos + kAdviseSize, d.mapped_size);
+    if (to > from)
+        posix_madvise(d.data + from, to - from, POSIX_MADV_WILLNEED);
+#endif
+    d.advised_end = qMin(d.pos + kAdviseSize, d.mapped_size);
+}
+
+} //namespace QtAV
+#include "MMapIO.moc"
@@ -32,6 +32,8 @@ FACTORY_DEFINE(MediaIO)
 
 extern bool RegisterMediaIOQIODevice_Man();
 extern bool RegisterMediaIOQFile_Man();
+extern bool RegisterMediaIOReadAhead_Man();
+extern bool RegisterMediaIOMMap_Man();
 extern bool RegisterMediaIOWinRT_Man();
 void MediaIO::registerAll()
 {
@@ -41,6 +43,8 @@ void MediaIO::registerAll()
     done = true;
     RegisterMediaIOQIODevice_Man();
     RegisterMediaIOQFile_Man();
+    RegisterMediaIOReadAhead_Man();
+    RegisterMediaIOMMap_Man();
 #ifdef Q_OS_WINRT
     RegisterMediaIOWinRT_Man();
 #endif
@@ -0,0 +1,415 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/MediaIO.h"
+#include "QtAV/private/MediaIO_p.h"
+#include "QtAV/private/mkid.h"
+#include "QtAV/private/factory.h"
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <limits.h>
+#include <string.h>
+#include "utils/Logger.h"
+
+namespace QtAV {
+/*!
+ * \brief The ReadAheadIO class
+ * Wraps another MediaIO and reads ahead into a large ring buffer on a background thread, so the demuxer does not
+ * block on every small read of a slow device (network share, SD card etc.).
+ * Data behind the current position is kept in the ring as long as possible (at least backwardSize bytes), so short
+ * backward seeks (e.g. container probing, index lookup) are served from memory.
+ * Usage:
+ *   player.setFile("readahead:/path/to/file.mkv"); // or "readahead:qrc:/xxx" etc.
+ *   or io->setProperty("source", QVariant::fromValue<QtAV::MediaIO*>(mediaIO)) and AVPlayer::setIODevice(io)
+ */
+class ReadAheadIOPrivate;
+class ReadAheadIO Q_DECL_FINAL: public MediaIO
+{
+    Q_OBJECT
+    Q_PROPERTY(QtAV::MediaIO* source READ source WRITE setSource)
+    Q_PROPERTY(int readAheadSize READ readAheadSize WRITE setReadAheadSize)
+    Q_PROPERTY(int backwardSize READ backwardSize WRITE setBackwardSize)
+    Q_PROPERTY(qreal hitRatio READ hitRatio)
+    Q_PROPERTY(qreal fillLevel READ fillLevel)
+    DPTR_DECLARE_PRIVATE(ReadAheadIO)
+public:
+    ReadAheadIO();
+    ~ReadAheadIO();
+    QString name() const Q_DECL_OVERRIDE;
+    const QStringList& protocols() const Q_DECL_OVERRIDE;
+    /*!
+     * \brief setSource
+     * The wrapped io. Not owned. An io created from url "readahead:xxx" is owned.
+     */
+    void setSource(MediaIO* io);
+    MediaIO* source() const;
+    /// ring buffer size in bytes. default is 8MB. takes effect when the source is changed
+    void setReadAheadSize(int value);
+    int readAheadSize() const;
+    /// bytes behind current position always kept in the ring for backward seeks. default is 1/8 of readAheadSize()
+    void setBackwardSize(int value);
+    int backwardSize() const;
+    /// ratio of read() and seek() calls served from memory without waiting for the source
+    qreal hitRatio() const;
+    /// ratio of read ahead bytes to ring size
+    qreal fillLevel() const;
+
+    bool isSeekable() const Q_DECL_OVERRIDE;
+    bool isVariableSize() const Q_DECL_OVERRIDE;
+    qint64 read(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    bool seek(qint64 offset, int from) Q_DECL_OVERRIDE;
+    qint64 position() const Q_DECL_OVERRIDE;
+    qint64 size() const Q_DECL_OVERRIDE;
+protected:
+    void onUrlChanged() Q_DECL_OVERRIDE;
+private:
+    void start();
+    void stop();
+    void fill();
+};
+typedef ReadAheadIO MediaIOReadAhead;
+static const MediaIOId MediaIOId_ReadAhead = mkid::id32base36_6<'R','e','a','d','A','h'>::value;
+static const char kReadAheadName[] = "ReadAhead";
+FACTORY_REGISTER(MediaIO, ReadAhead, kReadAheadName)
+
+static const int kReadAheadSizeDefault = 8*1024*1024;
+static const int kFillChunkSize = 256*1024;
+
+class ReadAheadIOPrivate Q_DECL_FINAL: public MediaIOPrivate
+{
+public:
+    ReadAheadIOPrivate()
+        : MediaIOPrivate()
+        , src(0)
+        , owns_src(false)
+        , ring_size(kReadAheadSizeDefault)
+        , backward_size(-1)
+        , start(0)
+        , end(0)
+        , pos(0)
+        , seek_to(-1)
+        , src_size(0)
+        , eof(false)
+        , stopped(true)
+        , filler(0)
+        , reads(0)
+        , hits(0)
+    {}
+    int backwardBytes() const {
+        return backward_size >= 0 ? qMin(backward_size, ring.size()/2) : ring.size()/8;
+    }
+
+    MediaIO *src;
+    bool owns_src;
+    int ring_size;
+    int backward_size;
+    QByteArray ring;
+    // file offsets of buffered data [start, end). offset o is at ring[o%ring.size()]. start <= pos <= end
+    qint64 start, end;
+    qint64 pos;
+    qint64 seek_to; // >=0: source must seek before next fill
+    qint64 src_size;
+    bool eof;
+    bool stopped;
+    QThread *filler;
+    mutable QMutex mutex;
+    QWaitCondition cond;
+    qint64 reads, hits;
+};
+
+ReadAheadIO::ReadAheadIO() : MediaIO(*new ReadAheadIOPrivate()) {}
+
+ReadAheadIO::~ReadAheadIO()
+{
+    setSource(0);
+}
+
+QString ReadAheadIO::name() const { return QLatin1String(kReadAheadName);}
+
+const QStringList& ReadAheadIO::protocols() const
+{
+    static QStringList p = QStringList() << QStringLiteral("readahead");
+    return p;
+}
+
+void ReadAheadIO::setSource(MediaIO *io)
+{
+    DPTR_D(ReadAheadIO);
+    if (d.src == io)
+        return;
+    stop();
+    if (d.owns_src)
+        delete d.src;
+    d.owns_src = false;
+    d.src = io;
+    if (!d.src)
+        return;
+    d.ring.resize(qMax(d.ring_size, kFillChunkSize));
+    d.start = d.end = d.pos = d.src->position();
+    d.seek_to = -1;
+    d.src_size = d.src->size();
+    d.eof = false;
+    d.reads = d.hits = 0;
+}
+
+MediaIO* ReadAheadIO::source() const
+{
+    return d_func().src;
+}
+
+void ReadAheadIO::setReadAheadSize(int value)
+{
+    d_func().ring_size = value > 0 ? value : kReadAheadSizeDefault;
+}
+
+int ReadAheadIO::readAheadSize() const
+{
+    return d_func().ring_size;
+}
+
+void ReadAheadIO::setBackwardSize(int value)
+{
+    d_func().backward_size = value;
+}
+
+int ReadAheadIO::backwardSize() const
+{
+    DPTR_D(const ReadAheadIO);
+    return d.ring.isEmpty() ? d.backward_size : d.backwardBytes();
+}
+
+qreal ReadAheadIO::hitRatio() const
+{
+    DPTR_D(const ReadAheadIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.reads <= 0)
+        return 0;
+    return qreal(d.hits)/qreal(d.reads);
+}
+
+qreal ReadAheadIO::fillLevel() const
+{
+    DPTR_D(const ReadAheadIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.ring.isEmpty())
+        return 0;
+    return qreal(d.end - d.pos)/qreal(d.ring.size());
+}
+
+bool ReadAheadIO::isSeekable() const
+{
+    DPTR_D(const ReadAheadIO);
+    return d.src && d.src->isSeekable();
+}
+
+bool ReadAheadIO::isVariableSize() const
+{
+    DPTR_D(const ReadAheadIO);
+    return d.src && d.src->isVariableSize();
+}
+
+qint64 ReadAheadIO::read(char *data, qint64 maxSize)
+{
+    DPTR_D(ReadAheadIO);
+    if (!d.src)
+        return 0;
+    start();
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.reads++;
+    if (d.pos < d.end)
+        d.hits++;
+    while (d.pos == d.end && !d.eof && !d.stopped)
+        d.cond.wait(&d.mutex);
+    const qint64 n = qMin<qint64>(maxSize, d.end - d.pos);
+    if (n <= 0)
+        return 0;
+    const int i = d.pos % d.ring.size();
+    const qint64 n1 = qMin<qint64>(n, d.ring.size() - i);
+    memcpy(data, d.ring.constData() + i, n1);
+    if (n1 < n)
+        memcpy(data + n1, d.ring.constData(), n - n1);
+    d.pos += n;
+    d.cond.wakeAll(); // space may be available for filling
+    return n;
+}
+
+bool ReadAheadIO::seek(qint64 offset, int from)
+{
+    DPTR_D(ReadAheadIO);
+    if (!d.src)
+        return false;
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (from == SEEK_END)
+        offset = d.src_size - offset;
+    else if (from == SEEK_CUR)
+        offset = d.pos + offset;
+    if (offset < 0)
+        return false;
+    d.reads++;
+    if (offset >= d.start && offset <= d.end) {
+        d.hits++;
+        d.pos = offset;
+        return true;
+    }
+    // out of the window. drop the buffered data, the filler will seek the source
+    d.start = d.end = d.pos = offset;
+    d.seek_to = offset;
+    d.eof = false;
+    d.cond.wakeAll();
+    return true;
+}
+
+qint64 ReadAheadIO::position() const
+{
+    DPTR_D(const ReadAheadIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.pos;
+}
+
+qint64 ReadAheadIO::size() const
+{
+    DPTR_D(const ReadAheadIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.src_size;
+}
+
+void ReadAheadIO::onUrlChanged()
+{
+    QString path(url());
+    if (path.startsWith(QLatin1String("readahead:")))
+        path = path.mid(10);
+    if (path.isEmpty()) {
+        setSource(0);
+        return;
+    }
+    MediaIO *io = MediaIO::createForUrl(path);
+    if (!io) { // local file
+        io = MediaIO::create("QFile");
+        io->setUrl(path);
+    }
+    setSource(io);
+    d_func().owns_src = true;
+}
+
+void ReadAheadIO::start()
+{
+    DPTR_D(ReadAheadIO);
+    if (d.filler)
+        return;
+    class Filler : public QThread {
+        ReadAheadIO *io;
+    public:
+        Filler(ReadAheadIO *p) : io(p) {}
+        void run() Q_DECL_OVERRIDE { io->fill();}
+    };
+    d.stopped = false;
+    d.filler = new Filler(this);
+    d.filler->start();
+}
+
+void ReadAheadIO::stop()
+{
+    DPTR_D(ReadAheadIO);
+    if (!d.filler)
+        return;
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        d.stopped = true;
+        d.cond.wakeAll();
+    }
+    d.filler->wait();
+    delete d.filler;
+    d.filler = 0;
+}
+
+void ReadAheadIO::fill()
+{
+    DPTR_D(ReadAheadIO);
+    // only this thread accesses the source io
+    const int kRingSize = d.ring.size();
+    while (true) {
+        qint64 seek_to = -1;
+        qint64 offset = 0;
+        int i = 0, n = 0;
+        {
+            QMutexLocker lock(&d.mutex);
+            Q_UNUSED(lock);
+            while (!d.stopped) {
+                if (d.seek_to >= 0) {
+                    seek_to = d.seek_to;
+                    d.seek_to = -1;
+                    break;
+                }
+                if (d.eof) {
+                    // a growing file may have new data later
+                    if (d.cond.wait(&d.mutex, d.src->isVariableSize() ? 200 : ULONG_MAX) || !d.src->isVariableSize())
+                        continue;
+                    d.eof = false;
+                }
+                // keep at least backwardBytes() behind pos for backward seeks
+                const qint64 keep_from = qMax(d.start, d.pos - d.backwardBytes());
+                const qint64 free_size = kRingSize - (d.end - keep_from);
+                if (free_size <= 0) {
+                    d.cond.wait(&d.mutex);
+                    continue;
+                }
+                offset = d.end;
+                i = d.end % kRingSize;
+                n = qMin<qint64>(qMin<qint64>(free_size, kFillChunkSize), kRingSize - i);
+                // drop the oldest data overwritten by this chunk
+                if (d.end + n - d.start > kRingSize)
+                    d.start = d.end + n - kRingSize;
+                break;
+            }
+            if (d.stopped)
+                return;
+        }
+        if (seek_to >= 0) {
+            if (!d.src->seek(seek_to, SEEK_SET))
+                qWarning("ReadAheadIO: failed to seek the source to %lld", seek_to);
+            continue;
+        }
+        // [end, end + n) is not readable, so it's safe to write without lock
+        const qint64 got = d.src->read(d.ring.data() + i, n);
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        if (d.end != offset || d.seek_to >= 0) // seeked out of the window while reading
+            continue;
+        if (got <= 0)
+            d.eof = true;
+        else
+            d.end += got;
+        if (d.src->isVariableSize())
+            d.src_size = d.src->size();
+        d.cond.wakeAll();
+    }
+}
+
+} //namespace QtAV
+#include "ReadAheadIO.moc"
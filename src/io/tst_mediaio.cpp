@@ -1,6 +1,7 @@
 #include <QtAV/MediaIO.h>
 #include <QtDebug>
 #include <QtTest/QTest>
+#include <QtCore/QTemporaryFile>
 using namespace QtAV;
 class tst_MediaIO : public QObject
 {
@@ -9,6 +10,7 @@ private slots:
     void create();
     void createForProtocol();
     void read();
+    void readAhead();
 };
 
 void tst_MediaIO::create() {
@@ -49,5 +51,44 @@ void tst_MediaIO::read() {
     delete in;
 }
 
+void tst_MediaIO::readAhead() {
+    // larger than the ring (at least 256KB) so that seeking to the beginning leaves the ring
+    QTemporaryFile f;
+    QVERIFY(f.open());
+    QByteArray data0(1024*1024, 0);
+    for (int i = 0; i < data0.size(); ++i)
+        data0[i] = char((i*7 + i/251) & 0xff);
+    QCOMPARE(f.write(data0), qint64(data0.size()));
+    f.flush();
+    const QString path(f.fileName());
+    MediaIO *in = MediaIO::createForUrl("readahead:" + path);
+    QVERIFY(in);
+    QCOMPARE(in->name(), QString("ReadAhead"));
+    in->setProperty("readAheadSize", 4096);
+    in->setUrl(QString()); // apply ring size
+    in->setUrl("readahead:" + path);
+    QCOMPARE(in->size(), qint64(data0.size()));
+    QByteArray data;
+    char buf[1000];
+    qint64 n = 0;
+    while ((n = in->read(buf, sizeof(buf))) > 0)
+        data.append(buf, n);
+    QCOMPARE(data, data0);
+    // short backward seek is served from the ring
+    qreal hit_ratio = in->property("hitRatio").toReal();
+    QVERIFY(in->seek(100, SEEK_END));
+    QCOMPARE(in->position(), qint64(data0.size() - 100));
+    QVERIFY(in->property("hitRatio").toReal() > hit_ratio);
+    QCOMPARE(in->read(buf, 100), qint64(100));
+    QCOMPARE(QByteArray(buf, 100), data0.right(100));
+    // seek out of the ring, the data is read from the source again
+    hit_ratio = in->property("hitRatio").toReal();
+    QVERIFY(in->seek(0));
+    QVERIFY(in->property("hitRatio").toReal() < hit_ratio);
+    QCOMPARE(in->read(buf, 100), qint64(100));
+    QCOMPARE(QByteArray(buf, 100), data0.left(100));
+    delete in;
+}
+
 QTEST_MAIN(tst_MediaIO)
 #include "tst_avinput.moc"
@@ -29,6 +29,8 @@ sse4_1|config_sse4_1|contains(TARGET_ARCH_SUB, sse4.1): CONFIG *= sse4_1 config_
 sse2|config_sse2|contains(TARGET_ARCH_SUB, sse2): CONFIG *= sse2 config_simd
 CONFIG(debug, debug|release): DEFINES += DEBUG
 #release: DEFINES += QT_NO_DEBUG_OUTPUT
+# qmake CONFIG+=no_trace: remove pipeline trace points
+no_trace: DEFINES += QTAV_NO_TRACE
 #var with '_' can not pass to pri?
 PROJECTROOT = $$PWD/..
 !include(libQtAV.pri): error("could not find libQtAV.pri")
@@ -425,6 +427,7 @@ winrt {
 # compat with old system
 # use old libva.so to link against
 glibc_compat: *linux*: LIBS += -lrt  # do not use clock_gettime in libc, GLIBC_2.17 is not available on old system
+unix:!mac:!android: LIBS *= -lrt # shm_open is in libc since glibc 2.34
 static_ffmpeg {
 # libs needed by mac static ffmpeg. corefoundation: vda, avdevice. coca: vf_coreimage
   mac|ios: LIBS += -liconv -lbz2 -llzma -lz -framework CoreFoundation -framework Security # -framework Cocoa Cocoa is not available on ios10
@@ -442,10 +445,17 @@ SOURCES += \
     subtitle/PlainText.cpp \
     subtitle/PlayerSubtitle.cpp \
     subtitle/Subtitle.cpp \
+    subtitle/SubtitleIndex.cpp \
     subtitle/SubtitleProcessor.cpp \
     subtitle/SubtitleProcessorFFmpeg.cpp \
     utils/GPUMemCopy.cpp \
+    utils/AudioConvert.cpp \
+    utils/Trace.cpp \
+    utils/DecoderPool.cpp \
+    utils/LoadScheduler.cpp \
     utils/Logger.cpp \
+    utils/ProbeCache.cpp \
+    utils/SharedFrameRing.cpp \
     AudioThread.cpp \
     utils/internal.cpp \
     AVThread.cpp \
@@ -462,9 +472,11 @@ SOURCES += \
     AVMuxer.cpp \
     AVDemuxer.cpp \
     AVDemuxThread.cpp \
+    ActivityDetector.cpp \
     ColorTransform.cpp \
     Frame.cpp \
     FrameReader.cpp \
+    SharedFrameReader.cpp \
     filter/Filter.cpp \
     filter/FilterContext.cpp \
     filter/FilterManager.cpp \
@@ -485,11 +497,16 @@ SOURCES += \
     VideoFrame.cpp \
     io/MediaIO.cpp \
     io/QIODeviceIO.cpp \
+    io/ReadAheadIO.cpp \
+    io/MMapIO.cpp \
     output/audio/AudioOutput.cpp \
     output/audio/AudioOutputBackend.cpp \
     output/audio/AudioOutputNull.cpp \
+    output/audio/AudioOutputMixer.cpp \
     output/video/VideoRenderer.cpp \
     output/video/VideoOutput.cpp \
+    output/video/PresentScheduler.cpp \
+    output/video/SharedMemoryRenderer.cpp \
     output/video/QPainterRenderer.cpp \
     output/AVOutput.cpp \
     output/OutputSet.cpp \
@@ -500,8 +517,11 @@ SOURCES += \
     codec/video/VideoDecoderFFmpegHW.cpp \
     codec/video/VideoEncoder.cpp \
     codec/video/VideoEncoderFFmpeg.cpp \
+    codec/video/SnapshotEncoder.cpp \
     VideoThread.cpp \
-    VideoFrameExtractor.cpp
+    VideoFrameExtractor.cpp \
+    VideoFrameScaler.cpp \
+    VideoFrameTap.cpp
 
 SDK_HEADERS *= \
     QtAV/QtAV \
@@ -512,6 +532,7 @@ SDK_HEADERS *= \
     QtAV/AudioDecoder.h \
     QtAV/AudioEncoder.h \
     QtAV/AudioFormat.h \
+    QtAV/AudioMixer.h \
     QtAV/AudioFrame.h \
     QtAV/AudioOutput.h \
     QtAV/AVDecoder.h \
@@ -526,6 +547,9 @@ SDK_HEADERS *= \
     QtAV/FrameReader.h \
     QtAV/QPainterRenderer.h \
     QtAV/Packet.h \
+    QtAV/PresentScheduler.h \
+    QtAV/SharedFrameReader.h \
+    QtAV/SharedMemoryRenderer.h \
     QtAV/AVError.h \
     QtAV/AVPlayer.h \
     QtAV/AVTranscoder.h \
@@ -540,6 +564,7 @@ SDK_HEADERS *= \
     QtAV/VideoFormat.h \
     QtAV/VideoFrame.h \
     QtAV/VideoFrameExtractor.h \
+    QtAV/VideoFrameTap.h \
     QtAV/FactoryDefine.h \
     QtAV/Statistics.h \
     QtAV/SubImage.h \
@@ -553,6 +578,9 @@ SDK_PRIVATE_HEADERS *= \
     QtAV/private/mkid.h \
     QtAV/private/prepost.h \
     QtAV/private/singleton.h \
+    QtAV/private/FrameMailbox.h \
+    QtAV/private/ActivityDetector.h \
+    QtAV/private/SnapshotEncoder.h \
     QtAV/private/PlayerSubtitle.h \
     QtAV/private/SubtitleProcessor.h \
     QtAV/private/AVCompat.h \
@@ -580,6 +608,7 @@ HEADERS *= \
     AudioThread.h \
     PacketBuffer.h \
     VideoThread.h \
+    VideoFrameScaler.h \
     ImageConverter.h \
     ImageConverter_p.h \
     codec/video/VideoDecoderFFmpegBase.h \
@@ -588,9 +617,16 @@ HEADERS *= \
     filter/FilterManager.h \
     subtitle/CharsetDetector.h \
     subtitle/PlainText.h \
+    subtitle/SubtitleIndex.h \
     utils/BlockingQueue.h \
     utils/GPUMemCopy.h \
+    utils/AudioConvert.h \
+    utils/DecoderPool.h \
+    utils/LoadScheduler.h \
     utils/Logger.h \
+    utils/ProbeCache.h \
+    utils/SharedFrameRing.h \
+    utils/Trace.h \
     utils/SharedPtr.h \
     utils/ring.h \
     utils/internal.h \
@@ -54,6 +54,7 @@ SubImagesRenderer::SubImagesRenderer()
     : m_geometry(new SubImagesGeometry())
     , m_renderer(new GeometryRenderer())
     , m_tex(0)
+    , m_tex_fmt(SubImageSet::Unknown)
 {}
 
 SubImagesRenderer::~SubImagesRenderer()
@@ -121,17 +122,32 @@ void SubImagesRenderer::uploadTexture(SubImagesGeometry *g)
     else //rgb32
         OpenGLHelper::videoFormatToGL(VideoFormat(VideoFormat::Format_ARGB32), &internal_fmt, &fmt, &data_type);
     DYGL(glBindTexture(GL_TEXTURE_2D, m_tex));
-    DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-    DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-    DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    DYGL(glTexImage2D(GL_TEXTURE_2D, 0, internal_fmt, g->width(), g->height(), 0, fmt, data_type, NULL));
+    const QSize tex_size(g->width(), g->height());
+    if (m_tex_size != tex_size || m_tex_fmt != g->images().format()) {
+        m_tex_size = tex_size;
+        m_tex_fmt = g->images().format();
+        m_tex_rects.clear();
+        m_tex_hashes.clear();
+        DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        DYGL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        DYGL(glTexImage2D(GL_TEXTURE_2D, 0, internal_fmt, g->width(), g->height(), 0, fmt, data_type, NULL));
+    }
     //glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    for (int i = 0; i < g->uploadRects().size(); ++i) {
-        const QRect& r = g->uploadRects().at(i);
+    const QVector<QRect>& rects = g->uploadRects();
+    QVector<uint> hashes(rects.size());
+    for (int i = 0; i < rects.size(); ++i) {
+        const QRect& r = rects.at(i);
         const SubImage& sub = g->images().images.at(i);
+        hashes[i] = sub.hash;
+        // only dirty regions are uploaded. unchanged glyph runs keep their texture region
+        if (sub.hash && i < m_tex_rects.size() && m_tex_rects.at(i) == r && m_tex_hashes.at(i) == sub.hash)
+            continue;
         DYGL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x(), r.y(), r.width(), r.height(), fmt, data_type, sub.data.constData()));
     }
+    m_tex_rects = rects;
+    m_tex_hashes = hashes;
     //glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     DYGL(glBindTexture(GL_TEXTURE_2D, 0));
 }
@@ -66,6 +66,11 @@ private:
     QRect m_rect;
 
     GLuint m_tex;
+    // texture content of the last upload. regions with the same rect and SubImage.hash are not uploaded again
+    QSize m_tex_size;
+    SubImageSet::Format m_tex_fmt;
+    QVector<QRect> m_tex_rects;
+    QVector<uint> m_tex_hashes;
     QOpenGLShaderProgram m_program;
 };
 } //namespace QtAV
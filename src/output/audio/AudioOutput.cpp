@@ -29,6 +29,7 @@
 #include <QtCore/QTime>
 typedef QTime QElapsedTimer;
 #endif
+#include "utils/AudioConvert.h"
 #include "utils/ring.h"
 #include "utils/Logger.h"
 
@@ -55,32 +56,25 @@ static inline void scale_samples_u8_small(quint8 *dst, const quint8 *src, int nb
         dst[i] = av_clip_uint8((((src[i] - 128) * volume + 128) >> 8) + 128);
 }
 
-static inline void scale_samples_s16(quint8 *dst, const quint8 *src, int nb_samples, int volume, float)
+static inline void scale_samples_s32(quint8 *dst, const quint8 *src, int nb_samples, int volume, float)
 {
-    int16_t *smp_dst       = (int16_t *)dst;
-    const int16_t *smp_src = (const int16_t *)src;
+    qint32 *smp_dst       = (qint32 *)dst;
+    const qint32 *smp_src = (const qint32 *)src;
     for (int i = 0; i < nb_samples; i++)
-        smp_dst[i] = av_clip_int16(((qint64)smp_src[i] * volume + 128) >> 8);
+        smp_dst[i] = av_clipl_int32((((qint64)smp_src[i] * volume + 128) >> 8));
 }
+/// from libavfilter/af_volume end
 
-static inline void scale_samples_s16_small(quint8 *dst, const quint8 *src, int nb_samples, int volume, float)
+static inline void scale_samples_s16_simd(quint8 *dst, const quint8 *src, int nb_samples, int, float volume)
 {
-    int16_t *smp_dst       = (int16_t *)dst;
-    const int16_t *smp_src = (const int16_t *)src;
-    for (int i = 0; i < nb_samples; i++)
-        smp_dst[i] = av_clip_int16((smp_src[i] * volume + 128) >> 8);
+    AudioConvert::scaleS16((qint16*)dst, (const qint16*)src, nb_samples, volume);
 }
 
-static inline void scale_samples_s32(quint8 *dst, const quint8 *src, int nb_samples, int volume, float)
+static inline void scale_samples_float_simd(quint8 *dst, const quint8 *src, int nb_samples, int, float volume)
 {
-    qint32 *smp_dst       = (qint32 *)dst;
-    const qint32 *smp_src = (const qint32 *)src;
-    for (int i = 0; i < nb_samples; i++)
-        smp_dst[i] = av_clipl_int32((((qint64)smp_src[i] * volume + 128) >> 8));
+    AudioConvert::scaleFloat((float*)dst, (const float*)src, nb_samples, volume);
 }
-/// from libavfilter/af_volume end
 
-//TODO: simd
 template<typename T>
 static inline void scale_samples(quint8 *dst, const quint8 *src, int nb_samples, int, float volume)
 {
@@ -101,13 +95,13 @@ scale_samples_func get_scaler(AudioFormat::SampleFormat fmt, qreal vol, int* vol
         return v < 0x1000000 ? scale_samples_u8_small : scale_samples_u8;
     case AudioFormat::SampleFormat_Signed16:
     case AudioFormat::SampleFormat_Signed16Planar:
-        return v < 0x10000 ? scale_samples_s16_small : scale_samples_s16;
+        return scale_samples_s16_simd;
     case AudioFormat::SampleFormat_Signed32:
     case AudioFormat::SampleFormat_Signed32Planar:
         return scale_samples_s32;
     case AudioFormat::SampleFormat_Float:
     case AudioFormat::SampleFormat_FloatPlanar:
-        return scale_samples<float>;
+        return scale_samples_float_simd;
     case AudioFormat::SampleFormat_Double:
     case AudioFormat::SampleFormat_DoublePlanar:
         return scale_samples<double>;
@@ -459,6 +453,12 @@ AudioFormat AudioOutput::setAudioFormat(const AudioFormat& format)
         d.scale_samples = NULL;
         return AudioFormat();
     }
+    const AudioFormat required(d.backend->requiredFormat());
+    if (required.isValid()) {
+        d.format = required;
+        d.updateSampleScaleFunc();
+        return required;
+    }
     if (d.backend->isSupported(format)) {
         d.format = format;
         d.updateSampleScaleFunc();
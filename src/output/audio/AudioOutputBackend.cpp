@@ -83,6 +83,8 @@ void AudioOutput_RegisterAll()
         return;
     extern bool RegisterAudioOutputBackendNull_Man();
     RegisterAudioOutputBackendNull_Man();
+    extern bool RegisterAudioOutputBackendMixer_Man();
+    RegisterAudioOutputBackendMixer_Man();
 #ifdef Q_OS_DARWIN
     extern bool RegisterAudioOutputBackendAudioToolbox_Man();
     RegisterAudioOutputBackendAudioToolbox_Man();
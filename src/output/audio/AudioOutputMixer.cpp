@@ -0,0 +1,439 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+#include "QtAV/private/AudioOutputBackend.h"
+#include "QtAV/private/mkid.h"
+#include "QtAV/private/factory.h"
+#include "QtAV/private/AVCompat.h"
+#include "utils/AudioConvert.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+static const char kName[] = "Mixer";
+static const int kPeriodFrames = 512;
+// fifo size of an input in periods of the input. data in fifo is the audio clock latency of the input
+static const int kInputPeriods = 4;
+
+/// gain and clip loops have no branches so that compilers can vectorize them (SSE/NEON)
+static inline void mix_samples(float *dst, const float *src, int nb_samples, float gain)
+{
+    for (int i = 0; i < nb_samples; ++i)
+        dst[i] += src[i] * gain;
+}
+
+static inline void mix_samples_stereo(float *dst, const float *src, int nb_frames, float left, float right)
+{
+    for (int i = 0; i < nb_frames; ++i) {
+        dst[2*i] += src[2*i] * left;
+        dst[2*i+1] += src[2*i+1] * right;
+    }
+}
+
+static inline int clip_samples(float *samples, int nb_samples)
+{
+    int clipped = 0;
+    for (int i = 0; i < nb_samples; ++i) {
+        const float v = samples[i];
+        clipped += (v > 1.0f) | (v < -1.0f);
+        samples[i] = std::min(1.0f, std::max(-1.0f, v));
+    }
+    return clipped;
+}
+
+class AudioOutputMixer : public AudioOutputBackend
+{
+public:
+    AudioOutputMixer(QObject *parent = 0);
+    ~AudioOutputMixer();
+    QString name() const Q_DECL_OVERRIDE { return QLatin1String(kName);}
+    bool open() Q_DECL_OVERRIDE;
+    bool close() Q_DECL_OVERRIDE;
+    // write() blocks if mixer does not take the previous data
+    BufferControl bufferControl() const Q_DECL_OVERRIDE { return Blocking;}
+    bool write(const QByteArray& data) Q_DECL_OVERRIDE;
+    bool play() Q_DECL_OVERRIDE { return true;}
+    bool clear() Q_DECL_OVERRIDE;
+    AudioFormat requiredFormat() const Q_DECL_OVERRIDE { return AudioMixer::instance().format();}
+    bool setVolume(qreal value) Q_DECL_OVERRIDE { m_volume = float(value); return true;}
+    qreal getVolume() const Q_DECL_OVERRIDE { return m_volume;}
+    bool setMute(bool value = true) Q_DECL_OVERRIDE { m_mute = value; return true;}
+    bool getMute() const Q_DECL_OVERRIDE { return m_mute;}
+
+    // called in mixer thread. return read samples
+    int read(float *dst, int nb_samples);
+    float gain() const { return m_mute ? 0.0f : m_volume.load();}
+    AudioOutput* owner() const { return m_owner;}
+private:
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+    QByteArray m_fifo;
+    int m_capacity;
+    bool m_open;
+    AudioOutput *m_owner;
+    std::atomic<float> m_volume{1.0f};
+    std::atomic<bool> m_mute{false};
+};
+
+typedef AudioOutputMixer AudioOutputBackendMixer;
+static const AudioOutputBackendId AudioOutputBackendId_Mixer = mkid::id32base36_5<'M', 'i', 'x', 'e', 'r'>::value;
+FACTORY_REGISTER(AudioOutputBackend, Mixer, kName)
+
+class AudioMixer::Private : public QThread
+{
+public:
+    Private(AudioMixer *mixer)
+        : q(mixer)
+        , sample_rate(48000)
+        , layout(AudioFormat::ChannelLayout_Stereo)
+        , backends(AudioOutputBackend::defaultPriority())
+        , device(0)
+        , stop(false)
+        , periods(0)
+        , underruns(0)
+        , clipped(0)
+    {}
+    ~Private() {
+        stop = true;
+        wait();
+        if (device) {
+            device->close();
+            delete device;
+        }
+    }
+    AudioFormat format() const {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        AudioFormat af;
+        af.setSampleFormat(AudioFormat::SampleFormat_Float);
+        af.setSampleRate(sample_rate);
+        af.setChannelLayout(layout);
+        return af;
+    }
+    bool addInput(AudioOutputMixer *input);
+    void removeInput(AudioOutputMixer *input);
+    void run() Q_DECL_OVERRIDE;
+
+    AudioMixer *q;
+    QMutex device_mutex; // open/close of device
+    mutable QMutex mutex;
+    int sample_rate;
+    AudioFormat::ChannelLayout layout;
+    QStringList backends;
+    QList<AudioOutputMixer*> inputs;
+    QHash<AudioOutput*, qreal> pans;
+    AudioOutput *device;
+    std::atomic<bool> stop;
+    qint64 periods, underruns, clipped;
+};
+
+bool AudioMixer::Private::addInput(AudioOutputMixer *input)
+{
+    QMutexLocker device_lock(&device_mutex);
+    Q_UNUSED(device_lock);
+    const AudioFormat af(format());
+    if (inputs.isEmpty()) {
+        if (!device)
+            device = new AudioOutput();
+        device->setBackends(backends);
+        device->setAudioFormat(af);
+        if (!device->open()) {
+            qWarning("failed to open audio mixer device");
+            return false;
+        }
+        const AudioFormat::SampleFormat f = device->audioFormat().sampleFormat();
+        if (device->audioFormat().sampleRate() != af.sampleRate() || device->audioFormat().channels() != af.channels()
+                || (f != AudioFormat::SampleFormat_Float && f != AudioFormat::SampleFormat_Signed16)) {
+            qWarning() << "audio mixer format is not supported by device: " << device->audioFormat();
+            device->close();
+            return false;
+        }
+        qDebug() << "audio mixer device: " << device->backend() << device->audioFormat();
+        stop = false;
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            inputs.append(input);
+        }
+        start(QThread::HighPriority);
+        Q_EMIT q->runningChanged(true);
+        return true;
+    }
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    inputs.append(input);
+    return true;
+}
+
+void AudioMixer::Private::removeInput(AudioOutputMixer *input)
+{
+    QMutexLocker device_lock(&device_mutex);
+    Q_UNUSED(device_lock);
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        if (!inputs.removeOne(input))
+            return;
+        // the AudioOutput may be destroyed after close
+        pans.remove(input->owner());
+        if (!inputs.isEmpty())
+            return;
+    }
+    stop = true;
+    wait();
+    device->close();
+    Q_EMIT q->runningChanged(false);
+}
+
+void AudioMixer::Private::run()
+{
+    const AudioFormat af(device->audioFormat());
+    const int channels = af.channels();
+    const int nb_samples = kPeriodFrames*channels;
+    const bool s16 = af.sampleFormat() == AudioFormat::SampleFormat_Signed16;
+    const bool null_device = device->backend().toLower() == QLatin1String("null");
+    QVector<float> mix(nb_samples), tmp(nb_samples);
+    QByteArray out(kPeriodFrames*af.bytesPerFrame(), 0);
+    qint64 n = 0;
+    while (!stop) {
+        std::fill(mix.begin(), mix.end(), 0.0f);
+        bool has_data = false;
+        int underrun = 0;
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            foreach (AudioOutputMixer *input, inputs) {
+                const int got = input->read(tmp.data(), nb_samples);
+                // an idle input, e.g. paused, has nothing queued
+                if (got > 0 && got < nb_samples)
+                    underrun++;
+                if (got <= 0)
+                    continue;
+                has_data = true;
+                const float gain = input->gain();
+                if (channels == 2) {
+                    // linear pan: only the other side is attenuated
+                    const float p = float(pans.value(input->owner(), 0.0));
+                    mix_samples_stereo(mix.data(), tmp.constData(), got/2, gain*std::min(1.0f, 1.0f - p), gain*std::min(1.0f, 1.0f + p));
+                } else {
+                    mix_samples(mix.data(), tmp.constData(), got, gain);
+                }
+            }
+        }
+        // null device does not block. wait for inputs instead of playing silence as fast as possible
+        if (!has_data && null_device) {
+            msleep(1);
+            continue;
+        }
+        const int c = clip_samples(mix.data(), nb_samples);
+        if (s16)
+            AudioConvert::floatToS16((qint16*)out.data(), mix.constData(), nb_samples);
+        else
+            memcpy(out.data(), mix.constData(), out.size());
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            periods++;
+            underruns += underrun;
+            clipped += c;
+        }
+        device->play(out, qreal(n*kPeriodFrames)/qreal(af.sampleRate()));
+        ++n;
+    }
+}
+
+AudioOutputMixer::AudioOutputMixer(QObject *parent)
+    : AudioOutputBackend(AudioOutput::SetVolume | AudioOutput::SetMute, parent)
+    , m_capacity(0)
+    , m_open(false)
+    , m_owner(0)
+{}
+
+AudioOutputMixer::~AudioOutputMixer()
+{
+    close();
+}
+
+bool AudioOutputMixer::open()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        Q_UNUSED(lock);
+        m_fifo.clear();
+        m_capacity = buffer_size*kInputPeriods;
+        m_owner = audio;
+        m_open = true;
+    }
+    if (AudioMixer::instance().d->addInput(this))
+        return true;
+    QMutexLocker lock(&m_mutex);
+    Q_UNUSED(lock);
+    m_open = false;
+    return false;
+}
+
+bool AudioOutputMixer::close()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        Q_UNUSED(lock);
+        if (!m_open)
+            return true;
+        m_open = false;
+        m_cond.wakeAll();
+    }
+    AudioMixer::instance().d->removeInput(this);
+    return true;
+}
+
+bool AudioOutputMixer::write(const QByteArray &data)
+{
+    QMutexLocker lock(&m_mutex);
+    Q_UNUSED(lock);
+    while (m_open && m_fifo.size() + data.size() > qMax(m_capacity, data.size())) {
+        if (!m_cond.wait(&m_mutex, 1000)) {
+            qWarning("audio mixer is stalled");
+            return false;
+        }
+    }
+    if (!m_open)
+        return false;
+    m_fifo.append(data);
+    return true;
+}
+
+bool AudioOutputMixer::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    Q_UNUSED(lock);
+    m_fifo.clear();
+    m_cond.wakeAll();
+    return true;
+}
+
+int AudioOutputMixer::read(float *dst, int nb_samples)
+{
+    QMutexLocker lock(&m_mutex);
+    Q_UNUSED(lock);
+    const int bytes = qMin<int>(nb_samples*sizeof(float), m_fifo.size() - m_fifo.size()%sizeof(float));
+    if (bytes <= 0)
+        return 0;
+    memcpy(dst, m_fifo.constData(), bytes);
+    m_fifo.remove(0, bytes);
+    m_cond.wakeAll();
+    return bytes/sizeof(float);
+}
+
+AudioMixer& AudioMixer::instance()
+{
+    static AudioMixer mixer;
+    return mixer;
+}
+
+QString AudioMixer::backendName()
+{
+    return QLatin1String(kName);
+}
+
+AudioMixer::AudioMixer()
+    : QObject(0)
+    , d(new Private(this))
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+}
+
+void AudioMixer::setFormat(int sampleRate, AudioFormat::ChannelLayout layout)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->sample_rate = sampleRate;
+    d->layout = layout;
+}
+
+AudioFormat AudioMixer::format() const
+{
+    return d->format();
+}
+
+void AudioMixer::setBackends(const QStringList &names)
+{
+    QMutexLocker lock(&d->device_mutex);
+    Q_UNUSED(lock);
+    d->backends = names;
+}
+
+QStringList AudioMixer::backends() const
+{
+    QMutexLocker lock(&d->device_mutex);
+    Q_UNUSED(lock);
+    return d->backends;
+}
+
+void AudioMixer::setPan(AudioOutput *input, qreal value)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->pans[input] = qBound<qreal>(-1.0, value, 1.0);
+}
+
+qreal AudioMixer::pan(AudioOutput *input) const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->pans.value(input, 0.0);
+}
+
+int AudioMixer::inputCount() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->inputs.size();
+}
+
+bool AudioMixer::isRunning() const
+{
+    return d->isRunning();
+}
+
+QVariantMap AudioMixer::statistics() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    QVariantMap stats;
+    stats[QStringLiteral("inputs")] = d->inputs.size();
+    stats[QStringLiteral("periods")] = d->periods;
+    stats[QStringLiteral("underruns")] = d->underruns;
+    stats[QStringLiteral("clipped")] = d->clipped;
+    return stats;
+}
+} //namespace QtAV
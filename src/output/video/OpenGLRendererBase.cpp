@@ -33,6 +33,7 @@ OpenGLRendererBasePrivate::OpenGLRendererBasePrivate(QPaintDevice* pd)
     : painter(new QPainter())
     , frame_changed(false)
 {
+    use_mailbox = true;
     filter_context = VideoFilterContext::create(VideoFilterContext::QtPainter);
     filter_context->paint_device = pd;
     filter_context->painter = painter;
@@ -77,9 +78,9 @@ OpenGLVideo* OpenGLRendererBase::opengl() const
 bool OpenGLRendererBase::receiveFrame(const VideoFrame& frame)
 {
     DPTR_D(OpenGLRendererBase);
+    // called in handlePaintEvent() with the latest frame in mailbox. receive() requests update
     d.video_frame = frame;
     d.frame_changed = true;
-    updateUi(); //can not call updateGL() directly because no event and paintGL() will in video thread
     return true;
 }
 
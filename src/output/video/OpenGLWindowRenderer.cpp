@@ -23,6 +23,7 @@
 #include "QtAV/private/OpenGLRendererBase_p.h"
 #include "QtAV/private/factory.h"
 #include <QResizeEvent>
+#include <QScreen>
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -40,6 +41,9 @@ OpenGLWindowRenderer::OpenGLWindowRenderer(UpdateBehavior updateBehavior, QWindo
     QOpenGLWindow(updateBehavior, parent)
   , OpenGLRendererBase(*new OpenGLWindowRendererPrivate(this))
 {
+    connect(this, &QOpenGLWindow::frameSwapped, [this]() {
+        d_func().frameSwapped();
+    });
 }
 
 VideoRendererId OpenGLWindowRenderer::id() const
@@ -71,6 +75,8 @@ void OpenGLWindowRenderer::resizeEvent(QResizeEvent *e)
 void OpenGLWindowRenderer::showEvent(QShowEvent *)
 {
     onShowEvent();
+    if (screen())
+        d_func().scheduler.setRefreshRate(screen()->refreshRate());
     resizeGL(width(), height());
 }
 } //namespace QtAV
@@ -0,0 +1,264 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/PresentScheduler.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QtMath>
+
+namespace QtAV {
+namespace {
+static const qint64 kIdle = 1000000000LL; // scheduling stops if no vsync in 1s, e.g. the window is hidden
+static const qint64 kMinInterval = 2000000LL;
+static const qint64 kMaxInterval = 100000000LL;
+static const int kMaxPending = 16;
+static const qreal kPtsEps = 1e-6;
+}
+
+PresentScheduler::Report::Report()
+    : presented(0)
+    , early(0)
+    , late(0)
+    , refreshInterval(0)
+    , latency(0)
+    , judder(0)
+{
+    for (int i = 0; i < HistogramSize; ++i)
+        histogram[i] = 0;
+}
+
+class PresentScheduler::Private
+{
+public:
+    Private()
+        : enabled(false)
+        , refresh_rate(0)
+        , estimated_interval(0)
+        , last_vsync(0)
+        , latency(-1)
+        , presented_pts(-1)
+        , present_time(0)
+        , present_target(0)
+        , judder_sum(0)
+        , judder_count(0)
+    {}
+    qint64 interval() const {
+        if (refresh_rate > 0)
+            return qint64(1e9/refresh_rate);
+        return estimated_interval;
+    }
+    bool isActive(qint64 ns) const {
+        return enabled && interval() > 0 && last_vsync > 0 && ns - last_vsync < kIdle;
+    }
+    // frames are delivered a quarter refresh after a vsync, and presented n refreshes later
+    qint64 phase() const { return interval()/4; }
+    int refreshesAhead() const {
+        if (latency < 0)
+            return 1;
+        return qMax(1, qRound(double(latency + phase())/double(interval())));
+    }
+
+    struct Pending {
+        qreal pts;
+        qint64 target;
+        qint64 deliver;
+    };
+
+    mutable QMutex mutex;
+    bool enabled;
+    qreal refresh_rate;
+    qint64 estimated_interval;
+    qint64 last_vsync;
+    qint64 latency; // delivery to swap. <0: unknown
+    QList<Pending> pending; // delivered but not presented frames
+    qreal presented_pts;
+    qint64 present_time;
+    qint64 present_target;
+    qint64 judder_sum;
+    qint64 judder_count;
+    Report report;
+};
+
+PresentScheduler::PresentScheduler()
+    : d(new Private())
+{}
+
+PresentScheduler::~PresentScheduler()
+{}
+
+void PresentScheduler::setEnabled(bool value)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->enabled = value;
+}
+
+bool PresentScheduler::isEnabled() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->enabled;
+}
+
+void PresentScheduler::setRefreshRate(qreal hz)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->refresh_rate = qMax<qreal>(0, hz);
+}
+
+qreal PresentScheduler::refreshRate() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    const qint64 iv = d->interval();
+    return iv > 0 ? 1e9/qreal(iv) : 0;
+}
+
+void PresentScheduler::vsync(qint64 ns, qreal pts)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (d->last_vsync > 0 && d->refresh_rate <= 0) {
+        // swaps may skip vsyncs if nothing changed, so a much shorter interval resets the estimation
+        const qint64 dt = ns - d->last_vsync;
+        if (dt > kMinInterval && dt < kMaxInterval) {
+            if (d->estimated_interval <= 0 || dt < d->estimated_interval*3/4)
+                d->estimated_interval = dt;
+            else if (dt < d->estimated_interval*5/4)
+                d->estimated_interval += (dt - d->estimated_interval)/8;
+        }
+    }
+    d->last_vsync = ns;
+    if (pts < 0 || (d->presented_pts >= 0 && qAbs(pts - d->presented_pts) < kPtsEps))
+        return;
+    d->presented_pts = pts;
+    int i = 0;
+    for (; i < d->pending.size(); ++i) {
+        if (qAbs(d->pending.at(i).pts - pts) < kPtsEps)
+            break;
+    }
+    if (i >= d->pending.size())
+        return;
+    const Private::Pending p(d->pending.at(i));
+    d->pending.erase(d->pending.begin(), d->pending.begin() + i + 1); // older frames are replaced before painted
+    const qint64 l = ns - p.deliver;
+    d->latency = d->latency < 0 ? l : d->latency + (l - d->latency)/8;
+    Report &r = d->report;
+    r.presented++;
+    const qint64 iv = d->interval();
+    if (iv > 0) {
+        const qint64 err = ns - p.target;
+        if (err*2 <= -iv)
+            r.early++;
+        else if (err*2 >= iv)
+            r.late++;
+        const int b = HistogramZero + qRound(double(err)/double(iv));
+        r.histogram[qBound<int>(0, b, HistogramSize - 1)]++;
+    }
+    if (d->present_time > 0) {
+        const qint64 duration = p.target - d->present_target;
+        if (duration > 0 && duration < kIdle) {
+            d->judder_sum += qAbs(ns - d->present_time - duration);
+            d->judder_count++;
+        }
+    }
+    d->present_time = ns;
+    d->present_target = p.target;
+}
+
+bool PresentScheduler::isActive(qint64 ns) const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->isActive(ns);
+}
+
+qreal PresentScheduler::leadTime(qint64 ns) const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (!d->isActive(ns))
+        return 0;
+    const qint64 iv = d->interval();
+    return qreal(d->refreshesAhead()*iv - d->phase() + iv/2)/1e9;
+}
+
+qint64 PresentScheduler::schedule(qreal pts, qint64 target, qint64 ns)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    qint64 deliver = ns;
+    if (d->isActive(ns)) {
+        // the vsync nearest to target, then back to the refresh the frame must be painted in
+        const qint64 iv = d->interval();
+        const qint64 k = qFloor(double(target - d->last_vsync)/double(iv) + 0.5);
+        const qint64 vsync = d->last_vsync + k*iv;
+        deliver = qMax(ns, vsync - d->refreshesAhead()*iv + d->phase());
+    }
+    Private::Pending p;
+    p.pts = pts;
+    p.target = target;
+    p.deliver = deliver;
+    d->pending.append(p);
+    while (d->pending.size() > kMaxPending)
+        d->pending.removeFirst();
+    return deliver;
+}
+
+qreal PresentScheduler::latency() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->latency < 0 ? 0 : qreal(d->latency)/1e9;
+}
+
+PresentScheduler::Report PresentScheduler::report() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    Report r(d->report);
+    r.refreshInterval = qreal(d->interval())/1e9;
+    r.latency = d->latency < 0 ? 0 : qreal(d->latency)/1e9;
+    r.judder = d->judder_count > 0 ? qreal(d->judder_sum)/qreal(d->judder_count)/1e9 : 0;
+    return r;
+}
+
+void PresentScheduler::reset()
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->presented_pts = -1;
+    d->present_time = d->present_target = 0;
+    d->judder_sum = d->judder_count = 0;
+    d->report = Report();
+}
+
+qint64 PresentScheduler::now()
+{
+    static const struct Timer {
+        Timer() { t.start(); }
+        QElapsedTimer t;
+    } timer; // thread safe initialization
+    return timer.t.nsecsElapsed();
+}
+} //namespace QtAV
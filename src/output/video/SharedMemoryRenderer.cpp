@@ -0,0 +1,174 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#include "QtAV/SharedMemoryRenderer.h"
+#include "QtAV/private/VideoRenderer_p.h"
+#include "QtAV/private/factory.h"
+#include "QtAV/private/mkid.h"
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <string.h>
+#include "utils/SharedFrameRing.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+VideoRendererId VideoRendererId_SharedMemory = mkid::id32base36_6<'S', 'h', 'a', 'r', 'e', 'M'>::value;
+FACTORY_REGISTER(VideoRenderer, SharedMemory, "SharedMemory")
+
+static QAtomicInt exporter_count;
+
+class SharedMemoryRendererPrivate : public VideoRendererPrivate
+{
+public:
+    SharedMemoryRendererPrivate()
+        : VideoRendererPrivate()
+        , nb_slots(4)
+        , sequence(0)
+    {
+        name = QStringLiteral("%1-%2").arg(QCoreApplication::applicationPid()).arg(exporter_count.fetchAndAddOrdered(1));
+    }
+    // returns a slot locked for writing, or -1 if every slot is being read
+    int lockFreeSlot() {
+        const int n = ring.header()->nb_slots;
+        const int start = ring.header()->latest.load(std::memory_order_relaxed) + 1;
+        for (int k = 0; k < n; ++k) {
+            const int i = (start + k) % n;
+            if (ring.lockWrite(i))
+                return i;
+        }
+        return -1;
+    }
+
+    QString name;
+    int nb_slots;
+    quint64 sequence; // of the last published frame
+    SharedFrameRing ring;
+};
+
+SharedMemoryRenderer::SharedMemoryRenderer()
+    : VideoRenderer(*new SharedMemoryRendererPrivate())
+{}
+
+VideoRendererId SharedMemoryRenderer::id() const
+{
+    return VideoRendererId_SharedMemory;
+}
+
+bool SharedMemoryRenderer::isSupported(VideoFormat::PixelFormat pixfmt) const
+{
+    return pixfmt != VideoFormat::Format_Invalid;
+}
+
+void SharedMemoryRenderer::setName(const QString &value)
+{
+    DPTR_D(SharedMemoryRenderer);
+    QMutexLocker locker(&d.img_mutex);
+    Q_UNUSED(locker);
+    if (d.name == value)
+        return;
+    d.name = value;
+    d.ring.close();
+}
+
+QString SharedMemoryRenderer::name() const
+{
+    DPTR_D(const SharedMemoryRenderer);
+    return d.name;
+}
+
+void SharedMemoryRenderer::setSlotCount(int value)
+{
+    d_func().nb_slots = qMax(1, value);
+}
+
+int SharedMemoryRenderer::slotCount() const
+{
+    return d_func().nb_slots;
+}
+
+bool SharedMemoryRenderer::receiveFrame(const VideoFrame &frame)
+{
+    DPTR_D(SharedMemoryRenderer);
+    d.frame_pending = false;
+    VideoFrame f(frame);
+    if (!f.constBits(0)) // hw surface
+        f = frame.to(frame.format());
+    const VideoFormat fmt(f.format());
+    if (!f.isValid() || !f.constBits(0) || fmt.planeCount() > SharedFrameRing::kMaxPlanes) {
+        ++d.dropped_frames;
+        return false;
+    }
+    // planes are packed with cache line aligned strides
+    const int nb_planes = fmt.planeCount();
+    int stride[SharedFrameRing::kMaxPlanes];
+    qint64 offset[SharedFrameRing::kMaxPlanes];
+    qint64 bytes = 0;
+    for (int i = 0; i < nb_planes; ++i) {
+        stride[i] = (fmt.bytesPerLine(f.width(), i) + 63) & ~63;
+        offset[i] = bytes;
+        bytes += qint64(stride[i])*f.planeHeight(i);
+    }
+    if (!d.ring.isOpen() || d.ring.header()->slot_size < bytes) {
+        if (!d.ring.create(d.name, d.nb_slots, bytes)) {
+            ++d.dropped_frames;
+            return false;
+        }
+        qDebug("SharedMemoryRenderer %s: %d slots of %lld bytes", qPrintable(d.name), d.nb_slots, bytes);
+    }
+    const int s = d.lockFreeSlot();
+    if (s < 0) {
+        d.ring.header()->dropped.fetch_add(1, std::memory_order_relaxed);
+        ++d.dropped_frames;
+        return false;
+    }
+    quint8 *data = d.ring.slotData(s);
+    SharedFrameRing::Slot *slot = d.ring.slot(s);
+    for (int i = 0; i < nb_planes; ++i) {
+        const quint8 *src = f.constBits(i);
+        quint8 *dst = data + offset[i];
+        const int h = f.planeHeight(i);
+        if (f.bytesPerLine(i) == stride[i]) {
+            memcpy(dst, src, size_t(stride[i])*h);
+            continue;
+        }
+        const int line = fmt.bytesPerLine(f.width(), i);
+        for (int y = 0; y < h; ++y)
+            memcpy(dst + y*stride[i], src + y*f.bytesPerLine(i), line);
+    }
+    slot->format = fmt.pixelFormat();
+    slot->width = f.width();
+    slot->height = f.height();
+    slot->color_space = f.colorSpace();
+    slot->color_range = f.colorRange();
+    for (int i = 0; i < SharedFrameRing::kMaxPlanes; ++i) {
+        slot->stride[i] = i < nb_planes ? stride[i] : 0;
+        slot->offset[i] = i < nb_planes ? offset[i] : 0;
+    }
+    slot->timestamp = f.timestamp();
+    slot->aspect_ratio = f.displayAspectRatio();
+    d.ring.publish(s, ++d.sequence);
+    ++d.presented_frames;
+    return true;
+}
+
+void SharedMemoryRenderer::drawFrame()
+{
+}
+} //namespace QtAV
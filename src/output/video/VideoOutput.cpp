@@ -205,11 +205,40 @@ bool VideoOutput::receiveFrame(const VideoFrame& frame)
     DPTR_D(VideoOutput);
     d.impl->d_func().source_aspect_ratio = d.source_aspect_ratio;
     d.impl->setInSize(frame.size());
-    QMutexLocker locker(&d.impl->d_func().img_mutex);
-    Q_UNUSED(locker); //TODO: double buffer for display/dec frame to avoid mutex
+    VideoRendererPrivate &dd = d.impl->d_func();
+    if (dd.use_mailbox) {
+        dd.putFrame(frame);
+        d.impl->updateUi();
+        return true;
+    }
+    QMutexLocker locker(&dd.img_mutex);
+    Q_UNUSED(locker);
+    if (dd.frame_pending.exchange(true))
+        ++dd.dropped_frames;
     return d.impl->receiveFrame(frame);
 }
 
+qint64 VideoOutput::presentedFrames() const
+{
+    if (!isAvailable())
+        return 0;
+    return d_func().impl->presentedFrames();
+}
+
+qint64 VideoOutput::droppedFrames() const
+{
+    if (!isAvailable())
+        return 0;
+    return d_func().impl->droppedFrames();
+}
+
+PresentScheduler* VideoOutput::presentScheduler()
+{
+    if (!isAvailable())
+        return VideoRenderer::presentScheduler();
+    return d_func().impl->presentScheduler();
+}
+
 void VideoOutput::drawBackground()
 {
     if (!isAvailable())
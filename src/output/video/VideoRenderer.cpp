@@ -27,6 +27,7 @@
 #include "QtAV/Statistics.h"
 #include "QtAV/private/factory.h"
 #include "QtAV/private/mkid.h"
+#include "utils/Trace.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -56,11 +57,33 @@ bool VideoRenderer::receive(const VideoFrame &frame)
     if (dar_old != d.source_aspect_ratio)
         sourceAspectRatioChanged(d.source_aspect_ratio);
     setInSize(frame.width(), frame.height());
+    if (d.use_mailbox) {
+        d.putFrame(frame);
+        updateUi();
+        return true;
+    }
     QMutexLocker locker(&d.img_mutex);
-    Q_UNUSED(locker); //TODO: double buffer for display/dec frame to avoid mutex
+    Q_UNUSED(locker);
+    if (d.frame_pending.exchange(true))
+        ++d.dropped_frames;
     return receiveFrame(frame);
 }
 
+qint64 VideoRenderer::presentedFrames() const
+{
+    return d_func().presented_frames;
+}
+
+qint64 VideoRenderer::droppedFrames() const
+{
+    return d_func().dropped_frames;
+}
+
+PresentScheduler* VideoRenderer::presentScheduler()
+{
+    return &d_func().scheduler;
+}
+
 bool VideoRenderer::setPreferredPixelFormat(VideoFormat::PixelFormat pixfmt)
 {
     DPTR_D(VideoRenderer);
@@ -471,6 +494,15 @@ void VideoRenderer::handlePaintEvent()
         //lock is required only when drawing the frame
         QMutexLocker locker(&d.img_mutex);
         Q_UNUSED(locker);
+        if (d.use_mailbox) {
+            VideoFrame frame;
+            if (d.mailbox.take(&frame)) {
+                ++d.presented_frames;
+                receiveFrame(frame);
+            }
+        } else if (d.frame_pending.exchange(false)) {
+            ++d.presented_frames;
+        }
         // do not apply filters if d.video_frame is already filtered. e.g. rendering an image and resize window to repaint
         if (!d.video_frame.metaData(QStringLiteral("gpu_filtered")).toBool() && !d.filters.isEmpty() && d.statistics) {
             // vo filter will not modify video frame, no lock required
@@ -505,7 +537,9 @@ void VideoRenderer::handlePaintEvent()
          * NOTE: if data is not copyed in receiveFrame(), you should always call drawFrame()
          */
         if (d.video_frame.isValid()) {
+            QTAV_TRACE_BEGIN(Present, d.statistics);
             drawFrame();
+            QTAV_TRACE_END(Present, d.statistics, d.video_frame.timestamp());
             //qDebug("render elapsed: %lld", et.elapsed());
             if (d.statistics) {
                 d.statistics->video_only.frameDisplayed(d.video_frame.timestamp());
@@ -29,6 +29,7 @@ SubImage::SubImage(int x, int y, int w, int h, int stride)
     , w(w)
     , h(h)
     , stride(stride)
+    , hash(0)
 {}
 
 SubImageSet::SubImageSet(int width, int height, Format format)
@@ -42,6 +42,7 @@ using QRegExp = QRegularExpression;
 #include <QtCore/QRegExp>
 #endif
 #include "subtitle/CharsetDetector.h"
+#include "subtitle/SubtitleIndex.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -60,7 +61,6 @@ public:
         , codec("AutoDetect")
         , t(0)
         , delay(0)
-        , current_count(0)
         , force_font_file(false)
     {}
     void reset() {
@@ -73,8 +73,7 @@ public:
         t = 0;
         frame = SubtitleFrame();
         frames.clear();
-        itf = frames.begin();
-        current_count = 0;
+        current_frames.clear();
     }
     // width/height == 0: do not create image
     // return true if both frame time and content(currently is text) changed
@@ -105,7 +104,7 @@ public:
     QList<SubtitleProcessor*> processors;
     QByteArray codec;
     QStringList engine_names;
-    QList<SubtitleFrame> frames;
+    SubtitleIndex frames;
     QUrl url;
     QByteArray raw_data;
     QString file_name;
@@ -120,11 +119,8 @@ public:
     QString current_text;
     QImage current_image;
     SubImageSet current_ass;
-    QList<SubtitleFrame>::iterator itf;
-    /* number of subtitle frames at current time.
-     * <0 means itf is the last. >0 means itf is the 1st
-     */
-    int current_count;
+    // subtitle frames at current time
+    QList<SubtitleFrame> current_frames;
     QMutex mutex;
 
     bool force_font_file;
@@ -500,17 +496,14 @@ QString Subtitle::getText() const
     Q_UNUSED(lock);
     if (!isLoaded())
         return QString();
-    if (!priv->current_count)
+    if (priv->current_frames.isEmpty())
         return QString();
     if (!priv->update_text)
         return priv->current_text;
     priv->update_text = false;
     priv->current_text.clear();
-    const int count = qAbs(priv->current_count);
-    QList<SubtitleFrame>::iterator it = priv->current_count > 0 ? priv->itf : priv->itf + (priv->current_count+1);
-    for (int i = 0; i < count; ++i) {
-        priv->current_text.append(it->text).append(QStringLiteral("\n"));
-        ++it;
+    foreach (const SubtitleFrame& f, priv->current_frames) {
+        priv->current_text.append(f.text).append(QStringLiteral("\n"));
     }
     priv->current_text = priv->current_text.trimmed();
     return priv->current_text;
@@ -525,7 +518,7 @@ QImage Subtitle::getImage(int width, int height, QRect* boundingRect)
     if (width == 0 || height == 0)
         return QImage();
 #if 0
-    if (!priv->current_count) //seems ok to use this code
+    if (priv->current_frames.isEmpty()) //seems ok to use this code
         return QImage();
     // always render the image to support animations
     if (!priv->update_image
@@ -596,20 +589,10 @@ bool Subtitle::processLine(const QByteArray &data, qreal pts, qreal duration)
     SubtitleFrame f = priv->processor->processLine(data, pts, duration);
     if (!f.isValid())
         return false; // TODO: if seek to previous position, an invalid frame is returned.
-    if (priv->frames.isEmpty() || priv->frames.last() < f) {
-        priv->frames.append(f);
-        priv->itf = priv->frames.begin();
-        return true;
-    }
-    // usually add to the end. TODO: test
-    QList<SubtitleFrame>::iterator it = priv->frames.end();
-    if (it != priv->frames.begin())
-        --it;
-    while (it != priv->frames.begin() && f < (*it)) {--it;}
-    if (it != priv->frames.begin()) // found in middle, insert before next
-        ++it;
-    priv->frames.insert(it, f);
-    priv->itf = it;
+    // usually add to the end. no resort, see SubtitleIndex
+    QMutexLocker lock(&priv->mutex);
+    Q_UNUSED(lock);
+    priv->frames.insert(f);
     return true;
 }
 
@@ -620,68 +603,23 @@ bool Subtitle::Private::prepareCurrentFrame()
 {
     if (frames.isEmpty())
         return false;
-    QList<SubtitleFrame>::iterator it = itf;
-    int found = 0;
-    const int old_current_count = current_count;
-    const qreal t = this->t - delay;
-    if (t < it->begin) {
-        while (it != frames.begin()) {
-            --it;
-            if (t > it->end) {
-                if (found > 0)
-                    break;
-                // no subtitle at that time. check previous text
-                if (old_current_count) {
-                    current_count = 0;
-                    return true;
-                }
-                return false;
-            }
-            if (t >= (*it).begin) {
-                if (found == 0)
-                    itf = it;
-                found++;
-            }
-        }
-        current_count = -found;
-        if (found > 0) {
-            frame = *it;
-            return true;
-        }
-        // no subtitle at that time. it == begin(). check previous text
-        if (old_current_count)
-            return true;
-        return false;
-    }
-    bool it_changed = false;
-    while (it != frames.end()) {
-        if (t > it->end) {
-            ++it;
-            it_changed = true;
-            continue;
-        }
-        if (t < it->begin) {
-            if (found > 0)
+    const QList<SubtitleFrame> fs(frames.framesAt(t - delay));
+    if (fs.size() == current_frames.size()) {
+        bool changed = false;
+        for (int i = 0; i < fs.size(); ++i) {
+            if (fs.at(i).begin != current_frames.at(i).begin || fs.at(i).end != current_frames.at(i).end) {
+                changed = true;
                 break;
-            // no subtitle at that time. check previous text
-            if (old_current_count) {
-                current_count = 0;
-                return true;
             }
-            return false;
         }
-        if (found == 0)
-            itf = it;
-        ++found;
-        ++it;
+        if (!changed)
+            return false;
     }
-    current_count = found;
-    if (found > 0)
-        return it_changed || current_count != old_current_count;
-    // no subtitle at that time, it == end(). check previous text
-    if (old_current_count)
-        return true;
-    return false;
+    // no subtitle at that time: changed if previous text is not empty
+    current_frames = fs;
+    if (!current_frames.isEmpty())
+        frame = current_frames.first();
+    return true;
 }
 
 QStringList Subtitle::Private::find()
@@ -814,12 +752,9 @@ bool Subtitle::Private::processRawData(const QByteArray &data)
     QList<SubtitleFrame> fs(processor->frames());
     if (fs.isEmpty())
         return false;
-    std::sort(fs.begin(), fs.end());
-    foreach (const SubtitleFrame& f, fs) {
-       frames.push_back(f);
-    }
-    itf = frames.begin();
-    frame = *itf;
+    frames.assign(fs);
+    current_frames.clear();
+    frame = SubtitleFrame();
     return true;
 }
 
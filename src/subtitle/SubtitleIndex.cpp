@@ -0,0 +1,165 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "SubtitleIndex.h"
+#include <algorithm>
+
+namespace QtAV {
+namespace {
+// merge the tail if it's larger than this. a query scans the tail linearly
+static const int kMaxTailSize = 64;
+
+static bool lessBegin(const SubtitleFrame& a, const SubtitleFrame& b)
+{
+    if (a.begin == b.begin)
+        return a.end < b.end;
+    return a.begin < b.begin;
+}
+} //namespace
+
+SubtitleIndex::SubtitleIndex()
+    : m_level(-1)
+{}
+
+void SubtitleIndex::clear()
+{
+    m_level = -1;
+    m_frames.clear();
+    m_max_end.clear();
+    m_tail.clear();
+}
+
+void SubtitleIndex::assign(const QList<SubtitleFrame> &frames)
+{
+    clear();
+    m_frames.reserve(frames.size());
+    foreach (const SubtitleFrame& f, frames) {
+        m_frames.append(f);
+    }
+    std::sort(m_frames.begin(), m_frames.end(), lessBegin);
+    buildIndex();
+}
+
+void SubtitleIndex::insert(const SubtitleFrame &frame)
+{
+    QVector<SubtitleFrame>::iterator it = std::upper_bound(m_tail.begin(), m_tail.end(), frame, lessBegin);
+    m_tail.insert(it, frame);
+    if (m_tail.size() > kMaxTailSize)
+        mergeTail();
+}
+
+QList<SubtitleFrame> SubtitleIndex::framesAt(qreal t)
+{
+    QList<SubtitleFrame> frames;
+    QVector<int> found;
+    const int n = m_frames.size();
+    if (m_level >= 0) {
+        // traverse the implicit tree. node x at level k has children x -/+ 2^(k-1). see cgranges by Heng Li
+        struct Node {
+            int x, k, w; // w: 0 if left child is not visited
+        } stack[64];
+        int top = 0;
+        const Node root = { (1 << m_level) - 1, m_level, 0 };
+        stack[top++] = root;
+        while (top) {
+            const Node z = stack[--top];
+            if (z.k <= 3) { // small subtree, scan directly
+                const int i0 = z.x >> z.k << z.k;
+                const int i1 = qMin(i0 + (1 << (z.k + 1)) - 1, n);
+                for (int i = i0; i < i1 && m_frames.at(i).begin <= t; ++i) {
+                    if (t <= m_frames.at(i).end)
+                        found.append(i);
+                }
+            } else if (z.w == 0) {
+                const int y = z.x - (1 << (z.k - 1));
+                const Node self = { z.x, z.k, 1 };
+                stack[top++] = self;
+                if (y >= n || m_max_end.at(y) >= t) {
+                    const Node left = { y, z.k - 1, 0 };
+                    stack[top++] = left;
+                }
+            } else if (z.x < n && m_frames.at(z.x).begin <= t) {
+                if (t <= m_frames.at(z.x).end)
+                    found.append(z.x);
+                const Node right = { z.x + (1 << (z.k - 1)), z.k - 1, 0 };
+                stack[top++] = right;
+            }
+        }
+        std::sort(found.begin(), found.end());
+    }
+    // merge the indexed results and the tail in begin order
+    int i = 0;
+    foreach (const SubtitleFrame& f, m_tail) {
+        if (f.begin > t)
+            break;
+        if (t > f.end)
+            continue;
+        while (i < found.size() && !lessBegin(f, m_frames.at(found.at(i))))
+            frames.append(m_frames.at(found.at(i++)));
+        frames.append(f);
+    }
+    while (i < found.size())
+        frames.append(m_frames.at(found.at(i++)));
+    return frames;
+}
+
+void SubtitleIndex::mergeTail()
+{
+    const int n = m_frames.size();
+    m_frames += m_tail;
+    m_tail.clear();
+    // frames from packets are almost in order, so it's usually a cheap merge
+    std::inplace_merge(m_frames.begin(), m_frames.begin() + n, m_frames.end(), lessBegin);
+    buildIndex();
+}
+
+void SubtitleIndex::buildIndex()
+{
+    const int n = m_frames.size();
+    m_max_end.resize(n);
+    m_level = -1;
+    if (n == 0)
+        return;
+    // leaves are even indices
+    int last_i = 0;
+    qreal last = 0;
+    for (int i = 0; i < n; i += 2) {
+        last_i = i;
+        last = m_max_end[i] = m_frames.at(i).end;
+    }
+    int k = 1;
+    for (; (1 << k) <= n; ++k) {
+        const int x = 1 << (k - 1);
+        const int i0 = (x << 1) - 1;
+        const int step = x << 2;
+        for (int i = i0; i < n; i += step) {
+            const qreal el = m_max_end.at(i - x);
+            const qreal er = i + x < n ? m_max_end.at(i + x) : last;
+            m_max_end[i] = qMax(m_frames.at(i).end, qMax(el, er));
+        }
+        last_i = (last_i >> k & 1) ? last_i - x : last_i + x;
+        if (last_i < n && m_max_end.at(last_i) > last)
+            last = m_max_end.at(last_i);
+    }
+    m_level = k - 1;
+}
+
+} //namespace QtAV
@@ -0,0 +1,63 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SUBTITLEINDEX_H
+#define QTAV_SUBTITLEINDEX_H
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtAV/Subtitle.h>
+
+namespace QtAV {
+
+/*!
+ * \brief The SubtitleIndex class
+ * Stores subtitle frames sorted by begin time with an implicit interval tree (augmented with max end time of each subtree)
+ * built on the sorted array, so all frames displayed at a given time are found in O(log(n)+k) even if frames overlap.
+ * Frames added by insert() go to a small unindexed tail first. The tail is merged into the sorted array when it's too large,
+ * so appending frames from demuxed packets never sorts the whole array.
+ */
+class SubtitleIndex
+{
+public:
+    SubtitleIndex();
+    void clear();
+    bool isEmpty() const { return m_frames.isEmpty() && m_tail.isEmpty();}
+    int size() const { return m_frames.size() + m_tail.size();}
+    void assign(const QList<SubtitleFrame>& frames);
+    void insert(const SubtitleFrame& frame);
+    /*!
+     * \brief framesAt
+     * \return frames with begin <= t <= end, sorted by begin time
+     */
+    QList<SubtitleFrame> framesAt(qreal t);
+private:
+    void mergeTail();
+    void buildIndex();
+
+    int m_level; // root level of the implicit tree. -1: empty
+    QVector<SubtitleFrame> m_frames; // sorted by begin
+    QVector<qreal> m_max_end; // max end time of the subtree whose root is the same index in m_frames
+    QVector<SubtitleFrame> m_tail;
+};
+
+} //namespace QtAV
+#endif // QTAV_SUBTITLEINDEX_H
@@ -24,6 +24,7 @@
 #include <QtCore/QEventLoop>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QHash>
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include "QtAV/Packet.h"
@@ -36,6 +37,7 @@
 //#define CAPI_LINK_ASS
 #include "capi/ass_api.h"
 #include <stdarg.h>
+#include <string.h>
 //#include <string>  //include after ass_api.h, stdio.h is included there in a different namespace
 
 namespace QtAV {
@@ -302,6 +304,11 @@ QString SubtitleProcessorLibASS::getText(qreal pts) const
     return text.trimmed();
 }
 
+static inline bool isSameBitmap(const SubImage& a, const SubImage& b)
+{
+    return a.hash == b.hash && a.w == b.w && a.h == b.h && a.stride == b.stride;
+}
+
 void renderASS32(QImage *image, ASS_Image *img, int dstX, int dstY);
 QImage SubtitleProcessorLibASS::getImage(qreal pts, QRect *boundingRect)
 { // ass dll is loaded if ass library is available
@@ -346,12 +353,15 @@ SubImageSet SubtitleProcessorLibASS::getSubImages(qreal pts, QRect *boundingRect
         return SubImageSet();
     int detect_change = 0;
     ASS_Image *img = ass_render_frame(m_renderer, m_track, (long long)(pts * 1000.0), &detect_change);
-    if (!detect_change && !m_assimages.isValid()) {
+    // m_assimages is always reset in getImage(), so a valid set here is the copied set from the last getSubImages() call
+    if (!detect_change && (!m_assimages.isValid() || (copy && !qimg))) {
         if (boundingRect)
             *boundingRect = m_bound;
         return m_assimages;
     }
     m_image = QImage();
+    // karaoke and animated tracks change every frame, but most glyph runs keep the same bitmap. reuse their copied data and let renderers keep the texture regions
+    const QVector<SubImage> prev_images(copy ? m_assimages.images : QVector<SubImage>());
     m_assimages.reset(frameWidth(), frameHeight(), SubImageSet::ASS);
     QRect rect(0, 0, 0, 0);
     ASS_Image *i = img;
@@ -365,9 +375,24 @@ SubImageSet SubtitleProcessorLibASS::getSubImages(qreal pts, QRect *boundingRect
         SubImage s(i->dst_x, i->dst_y, i->w, i->h, i->stride);
         s.color = i->color;
         if (copy) {
-            s.data.reserve(i->stride*i->h);
-            s.data.resize(i->stride*i->h);
-            memcpy(s.data.data(), i->bitmap, i->stride*(i->h-1) + i->w);
+            const int size = i->stride*(i->h-1) + i->w;
+            s.hash = qHashBits(i->bitmap, size) | 1; // 0 is reserved for "not computed"
+            const SubImage *same = 0;
+            const int n = m_assimages.images.size();
+            // images are usually in the same order as the last frame
+            if (n < prev_images.size() && isSameBitmap(prev_images.at(n), s))
+                same = &prev_images.at(n);
+            for (int k = 0; !same && k < prev_images.size(); ++k) {
+                if (isSameBitmap(prev_images.at(k), s))
+                    same = &prev_images.at(k);
+            }
+            if (same && same->data.size() >= size && memcmp(same->data.constData(), i->bitmap, size) == 0) {
+                s.data = same->data; // implicitly shared, no copy
+            } else {
+                s.data.reserve(i->stride*i->h);
+                s.data.resize(i->stride*i->h);
+                memcpy(s.data.data(), i->bitmap, size);
+            }
         } else {
             s.data = QByteArray::fromRawData((const char*)i->bitmap, i->stride*(i->h-1) + i->w);
         }
@@ -0,0 +1,372 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "utils/AudioConvert.h"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <QtCore/QVarLengthArray>
+#include "QtAV/AudioFormat.h"
+extern "C" {
+#include <libavutil/cpu.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AC_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) // gcc, clang. vc needs /arch:AVX2 for the whole file
+#define AC_AVX2 1
+#include <immintrin.h>
+#define AC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AC_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace QtAV {
+namespace AudioConvert {
+
+// frames converted in 1 pass. small enough to keep the temporary buffers in L1 cache
+static const int kChunkFrames = 256;
+
+#if AC_AVX2
+static bool detect_avx2()
+{
+    static const bool avx2 = !!(av_get_cpu_flags() & AV_CPU_FLAG_AVX2);
+    return avx2;
+}
+
+AC_TARGET_AVX2 static int floatToS16_avx2(qint16 *dst, const float *src, int nb_samples)
+{
+    const __m256 k = _mm256_set1_ps(32768.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= nb_samples; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), k), lo), hi);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), k), lo), hi);
+        // packs works in 128 bit lanes. restore the order
+        const __m256i p = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(p, 0xD8));
+    }
+    return i;
+}
+
+AC_TARGET_AVX2 static int scaleFloat_avx2(float *dst, const float *src, int nb_samples, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= nb_samples; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    return i;
+}
+#endif //AC_AVX2
+
+void s16ToFloat(float *dst, const qint16 *src, int nb_samples)
+{
+    int i = 0;
+#if AC_SSE2
+    const __m128 k = _mm_set1_ps(1.0f/32768.0f);
+    for (; i + 8 <= nb_samples; i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        // sign extend to 32 bit
+        const __m128i v0 = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i v1 = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v0), k));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(v1), k));
+    }
+#elif AC_NEON
+    for (; i + 8 <= nb_samples; i += 8) {
+        const int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f/32768.0f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f/32768.0f));
+    }
+#endif
+    for (; i < nb_samples; ++i)
+        dst[i] = float(src[i]) * (1.0f/32768.0f);
+}
+
+void floatToS16(qint16 *dst, const float *src, int nb_samples)
+{
+    int i = 0;
+#if AC_AVX2
+    if (detect_avx2())
+        i = floatToS16_avx2(dst, src, nb_samples);
+#endif
+#if AC_SSE2
+    const __m128 k = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= nb_samples; i += 8) {
+        // clamp before cvt, out of range values are converted to INT_MIN
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), k), lo), hi);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), k), lo), hi);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif AC_NEON && defined(__aarch64__) // vcvtnq (round to nearest) is armv8 only
+    for (; i + 8 <= nb_samples; i += 8) {
+        const int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32768.0f));
+        const int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+    for (; i < nb_samples; ++i)
+        dst[i] = qint16(lrintf(std::min(32767.0f, std::max(-32768.0f, src[i] * 32768.0f))));
+}
+
+void scaleFloat(float *dst, const float *src, int nb_samples, float gain)
+{
+    int i = 0;
+#if AC_AVX2
+    if (detect_avx2())
+        i = scaleFloat_avx2(dst, src, nb_samples, gain);
+#endif
+#if AC_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= nb_samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+#elif AC_NEON
+    for (; i + 4 <= nb_samples; i += 4)
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), gain));
+#endif
+    for (; i < nb_samples; ++i)
+        dst[i] = src[i] * gain;
+}
+
+void scaleS16(qint16 *dst, const qint16 *src, int nb_samples, float gain)
+{
+    int i = 0;
+#if AC_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= nb_samples; i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), g), lo), hi);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), g), lo), hi);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif AC_NEON && defined(__aarch64__)
+    for (; i + 8 <= nb_samples; i += 8) {
+        const int16x8_t v = vld1q_s16(src + i);
+        const int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), gain));
+        const int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), gain));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+    for (; i < nb_samples; ++i)
+        dst[i] = qint16(lrintf(std::min(32767.0f, std::max(-32768.0f, float(src[i]) * gain))));
+}
+
+void interleave2(float *dst, const float *left, const float *right, int nb_frames)
+{
+    int i = 0;
+#if AC_SSE2
+    for (; i + 4 <= nb_frames; i += 4) {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + 2*i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + 2*i + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif AC_NEON
+    for (; i + 4 <= nb_frames; i += 4) {
+        float32x4x2_t v;
+        v.val[0] = vld1q_f32(left + i);
+        v.val[1] = vld1q_f32(right + i);
+        vst2q_f32(dst + 2*i, v);
+    }
+#endif
+    for (; i < nb_frames; ++i) {
+        dst[2*i] = left[i];
+        dst[2*i+1] = right[i];
+    }
+}
+
+void deinterleave2(float *left, float *right, const float *src, int nb_frames)
+{
+    int i = 0;
+#if AC_SSE2
+    for (; i + 4 <= nb_frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(src + 2*i);
+        const __m128 b = _mm_loadu_ps(src + 2*i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#elif AC_NEON
+    for (; i + 4 <= nb_frames; i += 4) {
+        const float32x4x2_t v = vld2q_f32(src + 2*i);
+        vst1q_f32(left + i, v.val[0]);
+        vst1q_f32(right + i, v.val[1]);
+    }
+#endif
+    for (; i < nb_frames; ++i) {
+        left[i] = src[2*i];
+        right[i] = src[2*i+1];
+    }
+}
+
+static bool isSupported(AudioFormat::SampleFormat f)
+{
+    return f == AudioFormat::SampleFormat_Signed16 || f == AudioFormat::SampleFormat_Signed16Planar
+            || f == AudioFormat::SampleFormat_Float || f == AudioFormat::SampleFormat_FloatPlanar;
+}
+
+bool canConvert(const AudioFormat &in, const AudioFormat &out)
+{
+    if (!in.isValid() || !out.isValid())
+        return false;
+    if (in.sampleRate() != out.sampleRate())
+        return false;
+    if (!isSupported(in.sampleFormat()) || !isSupported(out.sampleFormat()))
+        return false;
+    if (in.channelLayoutFFmpeg() == out.channelLayoutFFmpeg())
+        return true;
+    // Left and Right layouts select a channel and are done by the resampler's channel map
+    const AudioFormat::ChannelLayout cin = in.channelLayout(), cout = out.channelLayout();
+    const bool in_mono = cin == AudioFormat::ChannelLayout_Mono || cin == AudioFormat::ChannelLayout_Center;
+    const bool out_mono = cout == AudioFormat::ChannelLayout_Mono || cout == AudioFormat::ChannelLayout_Center;
+    return (in_mono && cout == AudioFormat::ChannelLayout_Stereo) || (cin == AudioFormat::ChannelLayout_Stereo && out_mono);
+}
+
+// read frames [offset, offset + n) to interleaved float
+static void readFloat(float *dst, const quint8* const* in, const AudioFormat &fmt, int offset, int n, float *tmp)
+{
+    const int channels = fmt.channels();
+    switch (fmt.sampleFormat()) {
+    case AudioFormat::SampleFormat_Float:
+        memcpy(dst, (const float*)in[0] + offset*channels, n*channels*sizeof(float));
+        break;
+    case AudioFormat::SampleFormat_Signed16:
+        s16ToFloat(dst, (const qint16*)in[0] + offset*channels, n*channels);
+        break;
+    case AudioFormat::SampleFormat_FloatPlanar:
+    case AudioFormat::SampleFormat_Signed16Planar: {
+        const bool s16 = fmt.sampleFormat() == AudioFormat::SampleFormat_Signed16Planar;
+        const float *planes[2] = { 0, 0 };
+        for (int c = 0; c < channels; ++c) {
+            const float *p = (const float*)in[c] + offset;
+            if (s16) {
+                s16ToFloat(tmp + c*n, (const qint16*)in[c] + offset, n);
+                p = tmp + c*n;
+            }
+            if (channels <= 2) {
+                planes[c] = p;
+                continue;
+            }
+            for (int i = 0; i < n; ++i)
+                dst[i*channels + c] = p[i];
+        }
+        if (channels == 2)
+            interleave2(dst, planes[0], planes[1], n);
+        else if (channels == 1)
+            memcpy(dst, planes[0], n*sizeof(float));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// write interleaved float to frames [offset, offset + n)
+static void writeFloat(quint8* const* out, const AudioFormat &fmt, int offset, const float *src, int n, float *tmp)
+{
+    const int channels = fmt.channels();
+    switch (fmt.sampleFormat()) {
+    case AudioFormat::SampleFormat_Float:
+        memcpy((float*)out[0] + offset*channels, src, n*channels*sizeof(float));
+        break;
+    case AudioFormat::SampleFormat_Signed16:
+        floatToS16((qint16*)out[0] + offset*channels, src, n*channels);
+        break;
+    case AudioFormat::SampleFormat_FloatPlanar:
+    case AudioFormat::SampleFormat_Signed16Planar: {
+        const bool s16 = fmt.sampleFormat() == AudioFormat::SampleFormat_Signed16Planar;
+        float *planes[2] = { tmp, tmp + n };
+        if (!s16 && channels <= 2) {
+            planes[0] = (float*)out[0] + offset;
+            if (channels == 2)
+                planes[1] = (float*)out[1] + offset;
+        }
+        if (channels == 2) {
+            deinterleave2(planes[0], planes[1], src, n);
+        } else if (channels == 1) {
+            memcpy(planes[0], src, n*sizeof(float));
+        } else {
+            for (int c = 0; c < channels; ++c) {
+                float *p = s16 ? tmp : (float*)out[c] + offset;
+                for (int i = 0; i < n; ++i)
+                    p[i] = src[i*channels + c];
+                if (s16)
+                    floatToS16((qint16*)out[c] + offset, p, n);
+            }
+            break;
+        }
+        if (s16) {
+            for (int c = 0; c < channels; ++c)
+                floatToS16((qint16*)out[c] + offset, planes[c], n);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool convert(const quint8* const* in, const AudioFormat &inFormat, quint8* const* out, const AudioFormat &outFormat, int nb_samples)
+{
+    if (!canConvert(inFormat, outFormat))
+        return false;
+    const int cin = inFormat.channels(), cout = outFormat.channels();
+    if (inFormat.sampleFormat() == outFormat.sampleFormat() && cin == cout) {
+        const int planes = inFormat.planeCount();
+        const int bytes = nb_samples*inFormat.bytesPerSample()*(planes == 1 ? cin : 1);
+        for (int i = 0; i < planes; ++i)
+            memcpy(out[i], in[i], bytes);
+        return true;
+    }
+    const int channels = qMax(cin, cout);
+    // swresample mixes front left and right to center with 1/sqrt(2), and normalizes the sum to 1 for integer output
+    const float downmix = outFormat.isFloat() ? 0.70710678f : 0.5f;
+    QVarLengthArray<float, kChunkFrames*2> buf(kChunkFrames*channels);
+    QVarLengthArray<float, kChunkFrames*2> mixed(kChunkFrames*channels);
+    QVarLengthArray<float, kChunkFrames*2> tmp(kChunkFrames*channels);
+    for (int offset = 0; offset < nb_samples; offset += kChunkFrames) {
+        const int n = qMin(kChunkFrames, nb_samples - offset);
+        readFloat(buf.data(), in, inFormat, offset, n, tmp.data());
+        const float *src = buf.constData();
+        if (cin == 1 && cout == 2) {
+            interleave2(mixed.data(), src, src, n);
+            src = mixed.constData();
+        } else if (cin == 2 && cout == 1) {
+            float *m = mixed.data();
+            for (int i = 0; i < n; ++i)
+                m[i] = (src[2*i] + src[2*i+1]) * downmix;
+            src = m;
+        }
+        writeFloat(out, outFormat, offset, src, n, tmp.data());
+    }
+    return true;
+}
+
+} //namespace AudioConvert
+} //namespace QtAV
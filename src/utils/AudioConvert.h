@@ -0,0 +1,55 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOCONVERT_H
+#define QTAV_AUDIOCONVERT_H
+
+#include <QtCore/QtGlobal>
+
+namespace QtAV {
+class AudioFormat;
+/*!
+ * Sample format conversion without resampler for common cases.
+ * Kernels use SSE2 (and AVX2 if detected at runtime) on x86, NEON on arm, and scalar code otherwise.
+ * Sample format: S16, S16P, Float, FloatP. Channels: the same layout, mono to stereo and stereo to mono.
+ * Float to S16 is clipped without dither, the same as libswresample's default.
+ * Stereo to mono uses the same gain as libswresample: 0.707 for float output, 0.5 for S16 output.
+ */
+namespace AudioConvert {
+/// true if the same sample rate and the formats and channels above
+bool canConvert(const AudioFormat& in, const AudioFormat& out);
+/*!
+ * \brief convert
+ * \param in planes of input. 1 plane for packed formats
+ * \param out planes of output. each plane has enough space for nb_samples
+ * \param nb_samples samples per channel
+ */
+bool convert(const quint8* const* in, const AudioFormat& inFormat, quint8* const* out, const AudioFormat& outFormat, int nb_samples);
+// kernels
+void s16ToFloat(float* dst, const qint16* src, int nb_samples);
+void floatToS16(qint16* dst, const float* src, int nb_samples);
+void scaleFloat(float* dst, const float* src, int nb_samples, float gain);
+void scaleS16(qint16* dst, const qint16* src, int nb_samples, float gain);
+void interleave2(float* dst, const float* left, const float* right, int nb_frames);
+void deinterleave2(float* left, float* right, const float* src, int nb_frames);
+} //namespace AudioConvert
+} //namespace QtAV
+#endif // QTAV_AUDIOCONVERT_H
@@ -0,0 +1,209 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "DecoderPool.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include "QtAV/AudioDecoder.h"
+#include "QtAV/VideoDecoder.h"
+#include "QtAV/private/AVCompat.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+static void clearDecoderPool()
+{
+    DecoderPool::instance().clear();
+}
+
+DecoderPool& DecoderPool::instance()
+{
+    static DecoderPool pool;
+    return pool;
+}
+
+DecoderPool::DecoderPool()
+    : cap(0)
+    , hw(false)
+    , hits(0)
+    , misses(0)
+    , evicted(0)
+{
+    // hw decoders can not be released after the application is destroyed
+    qAddPostRoutine(clearDecoderPool);
+}
+
+void DecoderPool::setCapacity(int value, bool hardware)
+{
+    QList<AVDecoder*> removed;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        cap = qMax(0, value);
+        hw = hardware;
+        for (int i = entries.size() - 1; !hw && i >= 0; --i) {
+            if (isHardware(entries.at(i).decoder))
+                removed.append(entries.takeAt(i).decoder);
+        }
+        while (entries.size() > cap)
+            removed.append(entries.takeFirst().decoder);
+    }
+    qDeleteAll(removed);
+}
+
+int DecoderPool::capacity() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return cap;
+}
+
+bool DecoderPool::isHardwarePooled() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return hw;
+}
+
+bool DecoderPool::isHardware(AVDecoder *dec)
+{
+    VideoDecoder *vd = qobject_cast<VideoDecoder*>(dec);
+    if (!vd)
+        return false;
+    // FFmpeg decoder may use a hwaccel
+    return vd->id() != VideoDecoderId_FFmpeg || !vd->property("hwaccel").toString().isEmpty();
+}
+
+QByteArray DecoderPool::key(char type, int id, AVCodecContext *ctx)
+{
+    QByteArray data;
+    QDataStream s(&data, QIODevice::WriteOnly);
+    // pixel format and channel layout are not used because decoders change them
+    s << qint8(type) << qint32(id) << qint32(ctx->codec_id) << qint32(ctx->profile);
+    if (type == 'v')
+        s << qint32(ctx->width) << qint32(ctx->height);
+    else
+        s << qint32(ctx->sample_rate) << qint32(ctx->channels);
+    s << QByteArray::fromRawData((const char*)ctx->extradata, ctx->extradata_size);
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QByteArray DecoderPool::key(AVDecoder *dec, AVCodecContext *ctx)
+{
+    if (VideoDecoder *vd = qobject_cast<VideoDecoder*>(dec))
+        return key('v', vd->id(), ctx);
+    if (AudioDecoder *ad = qobject_cast<AudioDecoder*>(dec))
+        return key('a', ad->id(), ctx);
+    return QByteArray();
+}
+
+AVDecoder* DecoderPool::take(const QByteArray &k, const QVariantHash &options)
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    if (cap <= 0)
+        return 0;
+    // the latest first. it's more likely to be warm in cache
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        const Entry &e = entries.at(i);
+        if (e.key != k || e.decoder->options() != options)
+            continue;
+        AVDecoder *dec = e.decoder;
+        entries.removeAt(i);
+        hits++;
+        return dec;
+    }
+    misses++;
+    return 0;
+}
+
+VideoDecoder* DecoderPool::takeVideoDecoder(int id, AVCodecContext *ctx, const QVariantHash &options)
+{
+    if (!ctx)
+        return 0;
+    return static_cast<VideoDecoder*>(take(key('v', id, ctx), options));
+}
+
+AudioDecoder* DecoderPool::takeAudioDecoder(int id, AVCodecContext *ctx, const QVariantHash &options)
+{
+    if (!ctx)
+        return 0;
+    return static_cast<AudioDecoder*>(take(key('a', id, ctx), options));
+}
+
+void DecoderPool::park(AVDecoder *dec)
+{
+    if (!dec)
+        return;
+    dec->disconnect();
+    AVCodecContext *ctx = (AVCodecContext*)dec->codecContext();
+    if (capacity() <= 0 || !dec->isOpen() || !ctx || (isHardware(dec) && !isHardwarePooled())) {
+        delete dec;
+        return;
+    }
+    const QByteArray k(key(dec, ctx));
+    if (k.isEmpty()) {
+        delete dec;
+        return;
+    }
+    dec->flush(); // no frame of the old stream is output by the next user
+    AVDecoder *removed = 0;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        Entry e;
+        e.key = k;
+        e.decoder = dec;
+        entries.append(e);
+        if (entries.size() > cap) {
+            removed = entries.takeFirst().decoder;
+            evicted++;
+        }
+    }
+    delete removed; // out of lock. closing a hw decoder may take a while
+}
+
+void DecoderPool::clear()
+{
+    QList<Entry> removed;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        removed.swap(entries);
+    }
+    foreach (const Entry& e, removed) {
+        delete e.decoder;
+    }
+}
+
+QVariantMap DecoderPool::statistics() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    QVariantMap m;
+    m[QStringLiteral("hits")] = hits;
+    m[QStringLiteral("misses")] = misses;
+    m[QStringLiteral("parked")] = entries.size();
+    m[QStringLiteral("evicted")] = evicted;
+    return m;
+}
+} //namespace QtAV
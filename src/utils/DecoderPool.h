@@ -0,0 +1,90 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_DECODERPOOL_H
+#define QTAV_DECODERPOOL_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QVariant>
+
+struct AVCodecContext;
+namespace QtAV {
+class AVDecoder;
+class AudioDecoder;
+class VideoDecoder;
+/*!
+ * \brief The DecoderPool class
+ * Opened decoders parked by players when a stream is closed, keyed by decoder backend, codec id, profile,
+ * size (sample rate and channels for audio) and extradata. A parked decoder is reused if a stream with the same
+ * parameters is opened with the same options, so codec initialization and frame pool allocation are skipped.
+ * Extradata is a part of the key because parameter sets in it are parsed only when a codec is opened.
+ * Hardware decoders are not parked unless enabled by setCapacity(), because their surfaces and devices stay allocated
+ * and an interop decoder may be reused by another player.
+ * Parked decoders are deleted when the application quits.
+ */
+class DecoderPool
+{
+public:
+    static DecoderPool& instance();
+    /// 0 disables the pool. the oldest parked decoder is deleted if full. default is 0
+    void setCapacity(int value, bool hardware = false);
+    int capacity() const;
+    bool isHardwarePooled() const;
+    /*!
+     * \brief takeVideoDecoder
+     * \return a parked decoder of backend id opened for a stream like ctx, or null
+     */
+    VideoDecoder* takeVideoDecoder(int id, AVCodecContext* ctx, const QVariantHash& options);
+    AudioDecoder* takeAudioDecoder(int id, AVCodecContext* ctx, const QVariantHash& options);
+    /*!
+     * \brief park
+     * Flush and park a decoder which is no longer used. The pool takes the ownership. Signals are disconnected.
+     * The decoder is deleted if it's not open, the pool is disabled, or it's a hardware decoder and hardware pooling is disabled.
+     */
+    void park(AVDecoder* dec);
+    void clear();
+    /*!
+     * \brief statistics
+     * "hits", "misses", "parked", "evicted"
+     */
+    QVariantMap statistics() const;
+
+private:
+    DecoderPool();
+    static bool isHardware(AVDecoder* dec);
+    static QByteArray key(AVDecoder* dec, AVCodecContext* ctx);
+    static QByteArray key(char type, int id, AVCodecContext* ctx);
+    AVDecoder* take(const QByteArray& k, const QVariantHash& options);
+
+    struct Entry {
+        QByteArray key;
+        AVDecoder *decoder;
+    };
+    mutable QMutex mutex;
+    QList<Entry> entries; // the oldest first
+    int cap;
+    bool hw;
+    qint64 hits, misses, evicted;
+};
+} //namespace QtAV
+#endif //QTAV_DECODERPOOL_H
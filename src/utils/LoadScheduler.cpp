@@ -0,0 +1,305 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "LoadScheduler.h"
+#include <algorithm>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QUrl>
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+static const int kMaxSamples = 1024;
+static const qint64 kBackoffMin = 500; // ms
+static const qint64 kBackoffMax = 30000;
+
+class LoadRunnable : public QRunnable
+{
+public:
+    LoadRunnable(LoadScheduler* s, const LoadScheduler::Request& r)
+        : scheduler(s)
+        , request(r)
+    {
+        setAutoDelete(true);
+    }
+    void run() Q_DECL_OVERRIDE {
+        scheduler->run(request);
+    }
+private:
+    LoadScheduler *scheduler;
+    LoadScheduler::Request request;
+};
+
+static QString hostOf(const QString& url)
+{
+    const QUrl u(url);
+    if (u.host().isEmpty())
+        return QString();
+    return QStringLiteral("%1:%2").arg(u.host()).arg(u.port(-1));
+}
+
+static void addSample(QList<qint64> *samples, qint64 value)
+{
+    if (samples->size() >= kMaxSamples)
+        samples->removeFirst();
+    samples->append(value);
+}
+
+static qint64 percentile(QList<qint64> samples, qreal p)
+{
+    if (samples.isEmpty())
+        return -1;
+    std::sort(samples.begin(), samples.end());
+    return samples.at(qMin<int>(samples.size() - 1, samples.size()*p));
+}
+
+static void shutdownLoadScheduler()
+{
+    LoadScheduler::instance().shutdown();
+}
+
+LoadScheduler& LoadScheduler::instance()
+{
+    static LoadScheduler scheduler;
+    return scheduler;
+}
+
+LoadScheduler::LoadScheduler()
+    : QObject(0)
+    , backoff_timer(new QTimer(this))
+    , closed(false)
+    , running(0)
+    , max_per_host(4)
+    , succeeded(0)
+    , failed(0)
+    , canceled(0)
+{
+    clock.start();
+    // open is blocking io, so more threads than cores, but never 1 thread per stream
+    pool.setMaxThreadCount(qBound(4, QThread::idealThreadCount()*2, 16));
+    backoff_timer->setSingleShot(true);
+    connect(backoff_timer, SIGNAL(timeout()), SLOT(dispatch()));
+    // timer must live in a thread with event loop
+    if (QCoreApplication::instance())
+        moveToThread(QCoreApplication::instance()->thread());
+    // the static instance is destroyed after the application, when threads and timers must be gone
+    qAddPostRoutine(shutdownLoadScheduler);
+}
+
+LoadScheduler::~LoadScheduler()
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    queue.clear();
+}
+
+void LoadScheduler::shutdown()
+{
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        if (closed)
+            return;
+        closed = true;
+        canceled += queue.size();
+        queue.clear();
+    }
+    pool.waitForDone();
+    delete backoff_timer;
+    backoff_timer = 0;
+}
+
+void LoadScheduler::setMaxThreadCount(int value)
+{
+    pool.setMaxThreadCount(qMax(1, value));
+    dispatch();
+}
+
+int LoadScheduler::maxThreadCount() const
+{
+    return pool.maxThreadCount();
+}
+
+void LoadScheduler::setMaxLoadsPerHost(int value)
+{
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        max_per_host = qMax(1, value);
+    }
+    dispatch();
+}
+
+int LoadScheduler::maxLoadsPerHost() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return max_per_host;
+}
+
+void LoadScheduler::schedule(QObject *owner, const QString &url, const Task &task)
+{
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue.at(i).owner == owner) {
+                queue.removeAt(i);
+                canceled++;
+                break;
+            }
+        }
+        Request r;
+        r.owner = owner;
+        r.host = hostOf(url);
+        r.task = task;
+        r.queued.start();
+        queue.append(r);
+    }
+    dispatch();
+}
+
+bool LoadScheduler::cancel(QObject *owner, bool waitRunning)
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    bool removed = false;
+    for (int i = 0; i < queue.size(); ++i) {
+        if (queue.at(i).owner == owner) {
+            queue.removeAt(i);
+            canceled++;
+            removed = true;
+            break;
+        }
+    }
+    while (waitRunning && running_owners.contains(owner))
+        owner_finished.wait(&mutex);
+    return removed;
+}
+
+QVariantMap LoadScheduler::statistics() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    QVariantMap m;
+    m[QStringLiteral("queued")] = queue.size();
+    m[QStringLiteral("running")] = running;
+    m[QStringLiteral("succeeded")] = succeeded;
+    m[QStringLiteral("failed")] = failed;
+    m[QStringLiteral("canceled")] = canceled;
+    m[QStringLiteral("wait_p50")] = percentile(wait_ms, 0.5);
+    m[QStringLiteral("wait_p90")] = percentile(wait_ms, 0.9);
+    m[QStringLiteral("wait_p99")] = percentile(wait_ms, 0.99);
+    m[QStringLiteral("open_p50")] = percentile(open_ms, 0.5);
+    m[QStringLiteral("open_p90")] = percentile(open_ms, 0.9);
+    m[QStringLiteral("open_p99")] = percentile(open_ms, 0.99);
+    return m;
+}
+
+void LoadScheduler::resetStatistics()
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    succeeded = failed = canceled = 0;
+    wait_ms.clear();
+    open_ms.clear();
+}
+
+void LoadScheduler::dispatch()
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    if (closed)
+        return;
+    const qint64 now = clock.elapsed();
+    qint64 next_retry = -1;
+    for (int i = 0; i < queue.size() && running < pool.maxThreadCount();) {
+        const Request &r = queue.at(i);
+        if (!r.host.isEmpty()) {
+            HostState &h = hosts[r.host];
+            if (h.retry_at > now) {
+                if (next_retry < 0 || h.retry_at < next_retry)
+                    next_retry = h.retry_at;
+                ++i;
+                continue;
+            }
+            if (h.running >= max_per_host) {
+                ++i;
+                continue;
+            }
+            h.running++;
+        }
+        running++;
+        running_owners.append(r.owner);
+        pool.start(new LoadRunnable(this, queue.takeAt(i)));
+    }
+    // dispatch() can be called in loader threads, timer must start in it's own thread
+    if (next_retry >= 0)
+        QMetaObject::invokeMethod(backoff_timer, "start", Qt::QueuedConnection, Q_ARG(int, int(next_retry - now)));
+}
+
+void LoadScheduler::run(const Request &r)
+{
+    const qint64 waited = r.queued.elapsed();
+    QElapsedTimer timer;
+    timer.start();
+    const Result result = r.task();
+    finish(r, result, waited, timer.elapsed());
+}
+
+void LoadScheduler::finish(const Request &r, Result result, qint64 waited, qint64 elapsed)
+{
+    const QString &host = r.host;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        running--;
+        running_owners.removeOne(r.owner);
+        owner_finished.wakeAll();
+        if (!host.isEmpty()) {
+            HostState &h = hosts[host];
+            h.running--;
+            if (result == Succeeded) {
+                h.failures = 0;
+                h.retry_at = 0;
+            } else if (result == Failed) {
+                h.failures = qMin(h.failures + 1, 16);
+                h.retry_at = clock.elapsed() + qMin(kBackoffMax, kBackoffMin << (h.failures - 1));
+                qDebug("LoadScheduler: failed to open from %s. retry in %lld ms", qPrintable(host), h.retry_at - clock.elapsed());
+            }
+            if (h.running <= 0 && h.failures == 0)
+                hosts.remove(host);
+        }
+        if (result == Succeeded) {
+            succeeded++;
+            addSample(&wait_ms, waited);
+            addSample(&open_ms, elapsed);
+        } else if (result == Failed) {
+            failed++;
+        } else {
+            canceled++;
+        }
+    }
+    dispatch();
+}
+} //namespace QtAV
@@ -0,0 +1,125 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_LOADSCHEDULER_H
+#define QTAV_LOADSCHEDULER_H
+
+#include <functional>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtCore/QVariant>
+#include <QtCore/QWaitCondition>
+
+namespace QtAV {
+/*!
+ * \brief The LoadScheduler class
+ * Runs blocking media open tasks (avformat_open_input, avformat_find_stream_info) in a small fixed thread pool.
+ * Concurrent opens to the same network host are limited, and a host that failed to open is retried with exponential backoff,
+ * so reconnecting hundreds of streams after a network outage does not spawn hundreds of blocked threads.
+ * Cancel a running task by interrupting the demuxer, e.g. AVDemuxer::setInterruptStatus(-1), and queued tasks by cancel().
+ */
+class LoadScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum Result {
+        Failed,
+        Succeeded,
+        Canceled // interrupted by user. not a host failure
+    };
+    typedef std::function<Result()> Task;
+    static LoadScheduler& instance();
+    ~LoadScheduler();
+
+    void setMaxThreadCount(int value);
+    int maxThreadCount() const;
+    void setMaxLoadsPerHost(int value);
+    int maxLoadsPerHost() const;
+    /*!
+     * \brief schedule
+     * Queue a task to open url. Local files and custom io (url without host) are only limited by maxThreadCount()
+     * \param owner the object to cancel task for. A queued task of owner is replaced
+     */
+    void schedule(QObject* owner, const QString& url, const Task& task);
+    /*!
+     * \brief cancel
+     * Remove queued task of owner. Running task is not affected.
+     * \param waitRunning wait for the running task of owner to return, e.g. before owner is destroyed.
+     * Interrupt the task first. Never wait in a task.
+     * \return true if a queued task is removed
+     */
+    bool cancel(QObject* owner, bool waitRunning = false);
+    /*!
+     * \brief statistics
+     * "queued", "running", "succeeded", "failed", "canceled",
+     * "wait_p50", "wait_p90", "wait_p99": ms from schedule() to start,
+     * "open_p50", "open_p90", "open_p99": ms of running a task, for recent loads
+     */
+    QVariantMap statistics() const;
+    void resetStatistics();
+    /*!
+     * \brief shutdown
+     * Drop queued tasks, wait for running tasks and stop dispatching. Called when the application is destroyed
+     */
+    void shutdown();
+
+private Q_SLOTS:
+    void dispatch();
+
+private:
+    LoadScheduler();
+    struct Request {
+        QObject* owner;
+        QString host;
+        Task task;
+        QElapsedTimer queued;
+    };
+    struct HostState {
+        HostState() : running(0), failures(0), retry_at(0) {}
+        int running;
+        int failures;
+        qint64 retry_at; // clock ms
+    };
+    void run(const Request& r);
+    void finish(const Request& r, Result result, qint64 waited, qint64 elapsed);
+    friend class LoadRunnable;
+
+    mutable QMutex mutex;
+    QThreadPool pool;
+    QTimer *backoff_timer;
+    QElapsedTimer clock;
+    QList<Request> queue;
+    QList<QObject*> running_owners;
+    QWaitCondition owner_finished;
+    QHash<QString, HostState> hosts;
+    bool closed; // by shutdown()
+    int running;
+    int max_per_host;
+    qint64 succeeded, failed, canceled;
+    QList<qint64> wait_ms, open_ms; // recent samples
+};
+} //namespace QtAV
+#endif //QTAV_LOADSCHEDULER_H
@@ -0,0 +1,86 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_PROBECACHE_H
+#define QTAV_PROBECACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QVariant>
+
+struct AVFormatContext;
+namespace QtAV {
+/*!
+ * \brief The ProbeCache class
+ * Codec parameters found by avformat_find_stream_info() for network streams, keyed by url and a fingerprint of
+ * the stream layout known right after avformat_open_input() (format, codecs, extradata from SDP etc.).
+ * Applying the cached parameters lets avformat_find_stream_info() return after the first packets.
+ * Entries are saved in application data dir and loaded at first use. Urls are saved as hashes because they may contain credentials.
+ */
+class ProbeCache
+{
+public:
+    static ProbeCache& instance();
+    /// called after avformat_open_input()
+    static QByteArray fingerprint(AVFormatContext* ctx);
+    /// codec ids, profiles, video sizes and audio formats of ctx streams. called after apply()
+    static QByteArray checkedParameters(AVFormatContext* ctx);
+    /*!
+     * \brief isConsistent
+     * Check parameters against what demuxers and parsers found in packets read by avformat_find_stream_info()
+     * \param applied checkedParameters() after apply()
+     */
+    static bool isConsistent(AVFormatContext* ctx, const QByteArray& applied);
+    /*!
+     * \brief apply
+     * Fill codec parameters of ctx streams from cache and lower probe limits.
+     * \return false if no entry for url with the same fingerprint
+     */
+    bool apply(const QString& url, const QByteArray& fp, AVFormatContext* ctx);
+    /// called after a full avformat_find_stream_info()
+    void store(const QString& url, const QByteArray& fp, AVFormatContext* ctx);
+    /// remove a stale entry which was applied
+    void reject(const QString& url);
+    /*!
+     * \brief statistics
+     * "hits", "misses", "rejected", "entries"
+     */
+    QVariantMap statistics() const;
+
+private:
+    ProbeCache();
+    void load();
+    void save();
+    static QByteArray keyOf(const QString& url);
+    struct Entry {
+        Entry() : last_used(0) {}
+        QByteArray fingerprint;
+        QByteArray params; // serialized codec parameters of all streams
+        qint64 last_used; // ms since epoch
+    };
+    mutable QMutex mutex;
+    QHash<QByteArray, Entry> entries; // keyed by keyOf(url)
+    QString file;
+    qint64 hits, misses, rejected;
+};
+} //namespace QtAV
+#endif //QTAV_PROBECACHE_H
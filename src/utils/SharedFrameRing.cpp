@@ -0,0 +1,380 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#include "SharedFrameRing.h"
+#include <QtCore/QElapsedTimer>
+#include <new>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#if defined(Q_OS_UNIX) && !defined(Q_OS_ANDROID)
+#define QTAV_HAVE_SHM 1
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+static const quint32 kMagic = 0x46564151; // "QAVF"
+static const quint32 kVersion = 2;
+static const qint64 kHeaderSize = (sizeof(SharedFrameRing::Header) + 63) & ~63;
+static const qint64 kSlotHeaderSize = (sizeof(SharedFrameRing::Slot) + 63) & ~63;
+static const qint64 kPageSize = 4096;
+// atomics in shared memory must be lock free, i.e. plain integers
+Q_STATIC_ASSERT(sizeof(std::atomic<quint64>) == sizeof(quint64));
+Q_STATIC_ASSERT(sizeof(std::atomic<quint32>) == sizeof(quint32));
+
+static inline qint64 pageAligned(qint64 v)
+{
+    return (v + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+static inline qint64 dataOffset(int slots)
+{
+    return pageAligned(kHeaderSize + kSlotHeaderSize*slots);
+}
+
+static inline qint64 totalSize(int slots, qint64 slotSize)
+{
+    return dataOffset(slots) + pageAligned(slotSize)*slots;
+}
+
+static QByteArray shmName(const QString& name)
+{
+    return "/qtav-" + name.toUtf8();
+}
+
+static inline quint64 leaseOwner()
+{
+#if QTAV_HAVE_SHM
+    return quint64(getpid()) << 32;
+#else
+    return 0;
+#endif
+}
+
+static inline bool isRunning(quint64 lease)
+{
+#if QTAV_HAVE_SHM
+    // EPERM: running as another user
+    return kill(pid_t(lease >> 32), 0) == 0 || errno != ESRCH;
+#else
+    Q_UNUSED(lease);
+    return true;
+#endif
+}
+
+// decreases the frames held in lease if it's owned by owner, and frees the lease if none is held
+static bool unlease(std::atomic<quint64> &lease, quint64 owner)
+{
+    quint64 l = lease.load(std::memory_order_relaxed);
+    while ((l & ~0xffffffffULL) == owner && (l & 0xffffffffULL)) {
+        if (lease.compare_exchange_weak(l, l - 1 == owner ? 0 : l - 1, std::memory_order_release))
+            return true;
+    }
+    return false;
+}
+
+#ifdef Q_OS_LINUX
+static inline void futexWake(std::atomic<quint32> *f)
+{
+    syscall(SYS_futex, reinterpret_cast<int*>(f), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#endif
+
+SharedFrameRing::SharedFrameRing()
+    : m_owner(false)
+    , m_header(0)
+    , m_data(0)
+    , m_size(0)
+{}
+
+SharedFrameRing::~SharedFrameRing()
+{
+    close();
+}
+
+bool SharedFrameRing::create(const QString &name, int slots, qint64 slotSize)
+{
+    close();
+#if QTAV_HAVE_SHM
+    if (slots <= 0 || slotSize <= 0)
+        return false;
+    const QByteArray shm(shmName(name));
+    // readers of a previous writer of the same name reopen when they see closed
+    SharedFrameRing old;
+    if (old.open(name)) {
+        old.header()->closed.store(1, std::memory_order_release);
+        old.header()->futex.fetch_add(1, std::memory_order_release);
+#ifdef Q_OS_LINUX
+        futexWake(&old.header()->futex);
+#endif
+    }
+    old.close();
+    shm_unlink(shm.constData());
+    const int fd = shm_open(shm.constData(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        qWarning("SharedFrameRing failed to create %s: %s", shm.constData(), strerror(errno));
+        return false;
+    }
+    m_size = totalSize(slots, slotSize);
+    if (ftruncate(fd, m_size) != 0 || !map(fd)) {
+        qWarning("SharedFrameRing failed to allocate %lld bytes: %s", m_size, strerror(errno));
+        ::close(fd);
+        shm_unlink(shm.constData());
+        return false;
+    }
+    ::close(fd);
+    m_name = shm;
+    m_owner = true;
+    // the object is zero filled by ftruncate
+    m_header = new (m_data) Header();
+    m_header->nb_slots = slots;
+    m_header->pid = getpid();
+    m_header->slot_size = pageAligned(slotSize);
+    m_header->latest.store(-1);
+    for (int i = 0; i < slots; ++i)
+        new (slot(i)) Slot();
+    m_header->version = kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = kMagic;
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(slots);
+    Q_UNUSED(slotSize);
+    qWarning("SharedFrameRing is not supported on this platform");
+    return false;
+#endif
+}
+
+bool SharedFrameRing::open(const QString &name)
+{
+    close();
+#if QTAV_HAVE_SHM
+    const QByteArray shm(shmName(name));
+    const int fd = shm_open(shm.constData(), O_RDWR, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < kHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+    m_size = st.st_size;
+    const bool ok = map(fd);
+    ::close(fd);
+    if (!ok)
+        return false;
+    Header *h = reinterpret_cast<Header*>(m_data);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (h->magic != kMagic || h->version != kVersion || h->nb_slots <= 0
+            || totalSize(h->nb_slots, h->slot_size) > m_size) {
+        qWarning("SharedFrameRing %s is not compatible", shm.constData());
+        unmap();
+        return false;
+    }
+    m_name = shm;
+    m_header = h;
+    return true;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+void SharedFrameRing::close()
+{
+    if (!m_header) {
+        unmap();
+        return;
+    }
+#if QTAV_HAVE_SHM
+    if (m_owner) {
+        m_header->closed.store(1, std::memory_order_release);
+        m_header->futex.fetch_add(1, std::memory_order_release);
+#ifdef Q_OS_LINUX
+        futexWake(&m_header->futex);
+#endif
+        shm_unlink(m_name.constData());
+    }
+#endif
+    m_header = 0;
+    m_owner = false;
+    m_name.clear();
+    unmap();
+}
+
+SharedFrameRing::Slot* SharedFrameRing::slot(int i) const
+{
+    return reinterpret_cast<Slot*>(m_data + kHeaderSize + kSlotHeaderSize*i);
+}
+
+quint8* SharedFrameRing::slotData(int i) const
+{
+    return m_data + dataOffset(m_header->nb_slots) + m_header->slot_size*i;
+}
+
+bool SharedFrameRing::lockWrite(int i)
+{
+    Slot *s = slot(i);
+    // seq_cst store then loads, and the reverse in acquire(): at least one side sees the other
+    s->writing.store(1, std::memory_order_seq_cst);
+    for (int k = 0; k < kMaxLeases; ++k) {
+        quint64 l = s->leases[k].load(std::memory_order_seq_cst);
+        if (!l)
+            continue;
+        // the reader process exited without release
+        if (!isRunning(l) && s->leases[k].compare_exchange_strong(l, 0, std::memory_order_acquire)) {
+            qDebug("SharedFrameRing reclaimed %u frames of slot %d held by exited process %u", quint32(l), i, quint32(l >> 32));
+            continue;
+        }
+        s->writing.store(0, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void SharedFrameRing::publish(int i, quint64 seq)
+{
+    Slot *s = slot(i);
+    s->publish_time = now();
+    s->sequence.store(seq, std::memory_order_relaxed);
+    s->writing.store(0, std::memory_order_release);
+    m_header->latest.store(i, std::memory_order_relaxed);
+    m_header->sequence.store(seq, std::memory_order_release);
+    m_header->futex.fetch_add(1, std::memory_order_release);
+#ifdef Q_OS_LINUX
+    futexWake(&m_header->futex);
+#endif
+}
+
+void SharedFrameRing::unlockWrite(int i)
+{
+    slot(i)->writing.store(0, std::memory_order_release);
+}
+
+bool SharedFrameRing::acquire(int i)
+{
+    Slot *s = slot(i);
+    const quint64 owner = leaseOwner();
+    // the lease of this process, or a free one
+    for (int k = 0; k < kMaxLeases; ++k) {
+        std::atomic<quint64> &lease = s->leases[k];
+        quint64 l = lease.load(std::memory_order_relaxed);
+        while (!l || (l & ~0xffffffffULL) == owner) {
+            if (!lease.compare_exchange_weak(l, (l | owner) + 1, std::memory_order_seq_cst))
+                continue;
+            if (!s->writing.load(std::memory_order_seq_cst))
+                return true;
+            unlease(lease, owner);
+            return false;
+        }
+    }
+    return false;
+}
+
+void SharedFrameRing::release(int i)
+{
+    Slot *s = slot(i);
+    const quint64 owner = leaseOwner();
+    for (int k = 0; k < kMaxLeases; ++k) {
+        if (unlease(s->leases[k], owner))
+            return;
+    }
+}
+
+bool SharedFrameRing::wait(quint64 seq, int timeout)
+{
+    QElapsedTimer t;
+    t.start();
+    while (true) {
+        const quint32 f = m_header->futex.load(std::memory_order_acquire);
+        if (m_header->sequence.load(std::memory_order_acquire) != seq || m_header->closed.load(std::memory_order_acquire))
+            return true;
+        const qint64 left = timeout < 0 ? -1 : timeout - t.elapsed();
+        if (timeout >= 0 && left <= 0)
+            return false;
+#ifdef Q_OS_LINUX
+        struct timespec ts;
+        ts.tv_sec = left/1000;
+        ts.tv_nsec = (left%1000)*1000000L;
+        syscall(SYS_futex, reinterpret_cast<int*>(&m_header->futex), FUTEX_WAIT, f, left < 0 ? NULL : &ts, NULL, 0);
+#elif QTAV_HAVE_SHM
+        Q_UNUSED(f);
+        usleep(1000);
+#else
+        Q_UNUSED(f);
+        return false;
+#endif
+    }
+    return false;
+}
+
+qint64 SharedFrameRing::now()
+{
+#if QTAV_HAVE_SHM
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec)*1000000000LL + ts.tv_nsec;
+#else
+    static const struct Timer {
+        Timer() { t.start(); }
+        QElapsedTimer t;
+    } timer;
+    return timer.t.nsecsElapsed();
+#endif
+}
+
+bool SharedFrameRing::map(int fd)
+{
+#if QTAV_HAVE_SHM
+    void *p = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        m_data = 0;
+        return false;
+    }
+    m_data = (quint8*)p;
+    return true;
+#else
+    Q_UNUSED(fd);
+    return false;
+#endif
+}
+
+void SharedFrameRing::unmap()
+{
+#if QTAV_HAVE_SHM
+    if (m_data)
+        munmap(m_data, m_size);
+#endif
+    m_data = 0;
+    m_size = 0;
+}
+} //namespace QtAV
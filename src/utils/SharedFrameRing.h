@@ -0,0 +1,112 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SHAREDFRAMERING_H
+#define QTAV_SHAREDFRAMERING_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <atomic>
+
+namespace QtAV {
+/*!
+ * \brief The SharedFrameRing class
+ * A POSIX shared memory object of fixed size frame slots, written by 1 process and read by others.
+ * Layout: Header | Slot x nb_slots | slot data x nb_slots (page aligned).
+ * A slot is a lock free reader/writer lock: a reader process holds a lease in Slot.leases (pid and count of frames
+ * it holds), then checks Slot.writing. The writer sets Slot.writing, then claims the slot only if no lease is held.
+ * So the writer never waits for readers, it skips the slots in use, and readers can use the frame data in place
+ * without copy. Leases of a reader process that exited without release are reclaimed by the writer.
+ * Readers wait for new frames with a process shared futex on Linux, and poll on other systems.
+ * Both sides must be built with the same QtAV version, which is checked by Header.version.
+ */
+class SharedFrameRing
+{
+public:
+    enum { kMaxPlanes = 4, kMaxLeases = 8 };
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        qint32 nb_slots;
+        qint32 pid; // of the writer
+        qint64 slot_size; // capacity of frame data of each slot
+        std::atomic<quint64> sequence; // of the latest published frame. 0: none
+        std::atomic<qint32> latest; // slot of the latest published frame
+        std::atomic<quint32> futex; // increased when a frame is published. readers wait on it
+        std::atomic<qint32> closed; // the writer is gone, or the ring is replaced by a larger one
+        std::atomic<qint64> dropped; // frames not published because every slot is in use
+    };
+    struct Slot {
+        std::atomic<quint64> sequence; // of the frame in slot. 0: empty
+        std::atomic<qint32> writing;
+        std::atomic<quint64> leases[kMaxLeases]; // reader pid << 32 | frames held. 0: free
+        qint32 format; // VideoFormat::PixelFormat
+        qint32 width;
+        qint32 height;
+        qint32 color_space;
+        qint32 color_range;
+        qint32 stride[kMaxPlanes];
+        qint64 offset[kMaxPlanes]; // plane offset in slot data
+        double timestamp;
+        double aspect_ratio;
+        qint64 publish_time; // now() when published
+    };
+
+    SharedFrameRing();
+    ~SharedFrameRing();
+    /// writer. an existing object of the same name is replaced
+    bool create(const QString& name, int slots, qint64 slotSize);
+    /// reader
+    bool open(const QString& name);
+    /// marks closed and removes the name if it's the writer
+    void close();
+    bool isOpen() const { return !!m_header; }
+    Header* header() const { return m_header; }
+    Slot* slot(int i) const;
+    quint8* slotData(int i) const;
+    // writer side slot lock. returns false if the slot is being read by a running process
+    bool lockWrite(int i);
+    // publish the written frame in slot i, and wake readers
+    void publish(int i, quint64 seq);
+    void unlockWrite(int i);
+    // reader side slot lock. returns false if the slot is being written, or kMaxLeases other processes are reading it
+    bool acquire(int i);
+    void release(int i);
+    /*!
+     * \brief wait
+     * Wait at most timeout msecs until a frame newer than seq is published or the ring is closed
+     * \return false if timed out
+     */
+    bool wait(quint64 seq, int timeout);
+    /// monotonic clock in ns, comparable between processes
+    static qint64 now();
+private:
+    bool map(int fd);
+    void unmap();
+
+    QByteArray m_name; // shm object name
+    bool m_owner;
+    Header *m_header;
+    quint8 *m_data;
+    qint64 m_size;
+};
+} //namespace QtAV
+#endif // QTAV_SHAREDFRAMERING_H
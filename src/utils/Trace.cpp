@@ -0,0 +1,320 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "utils/Trace.h"
+#include <chrono>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include "QtAV/QtAV_Global.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+#ifndef QTAV_NO_TRACE
+namespace Trace {
+namespace {
+static const char* const kEventNames[] = {
+    "PacketRead",
+    "VideoEnqueue",
+    "AudioEnqueue",
+    "VideoQueue",
+    "AudioQueue",
+    "Buffering",
+    "Seek",
+    "SeekFinished",
+    "VideoDecode",
+    "AudioDecode",
+    "Filter",
+    "Convert",
+    "Wait",
+    "Deliver",
+    "Drop",
+    "Present",
+    "AudioWrite",
+};
+Q_STATIC_ASSERT(sizeof(kEventNames)/sizeof(kEventNames[0]) == EventCount);
+
+static const int kRecords = 4096; // per thread, 128KB
+static const int kMaxFinished = 16; // buffers of finished threads kept until clearTrace()
+
+struct Record {
+    qint64 ts; // ns
+    double value;
+    const void *key;
+    quint16 event;
+    quint16 phase;
+};
+
+// records and count are written by 1 thread only
+struct Buffer {
+    Buffer() : count(0), clear_at(0), alive(true), tid(0) {}
+    Record records[kRecords];
+    std::atomic<quint64> count;
+    std::atomic<quint64> clear_at; // count when clearTrace() is called. records before it are ignored
+    std::atomic<bool> alive;
+    quint64 tid;
+    QByteArray name;
+};
+
+class Registry {
+public:
+    Registry() : next_tid(1) {}
+    ~Registry() { qDeleteAll(buffers); }
+    QMutex mutex;
+    QList<Buffer*> buffers;
+    QHash<const void*, QString> names;
+    quint64 next_tid;
+};
+Q_GLOBAL_STATIC(Registry, registry)
+
+struct ThreadBuffer {
+    ThreadBuffer() : buffer(0) {}
+    ~ThreadBuffer() {
+        if (!buffer)
+            return;
+        Registry *reg = registry();
+        if (!reg) // exiting. deleted by registry
+            return;
+        QMutexLocker lock(&reg->mutex);
+        Q_UNUSED(lock);
+        buffer->alive = false; // keep events of finished threads until clearTrace()
+        // threads may be created and finished all the time. drop the oldest ones
+        int finished = 0;
+        for (int i = reg->buffers.size() - 1; i >= 0; --i) {
+            Buffer *b = reg->buffers.at(i);
+            if (b->alive || ++finished <= kMaxFinished)
+                continue;
+            delete b;
+            reg->buffers.removeAt(i);
+        }
+    }
+    Buffer *buffer;
+};
+thread_local ThreadBuffer thread_buffer;
+
+Buffer* threadBuffer()
+{
+    if (thread_buffer.buffer)
+        return thread_buffer.buffer;
+    Registry *reg = registry();
+    if (!reg) // exiting
+        return 0;
+    Buffer *b = new Buffer();
+    QThread *t = QThread::currentThread();
+    if (t)
+        b->name = t->objectName().isEmpty() ? QByteArray(t->metaObject()->className()) : t->objectName().toUtf8();
+    QMutexLocker lock(&reg->mutex);
+    Q_UNUSED(lock);
+    b->tid = reg->next_tid++;
+    reg->buffers.append(b);
+    thread_buffer.buffer = b;
+    return b;
+}
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QByteArray jsonString(const QString& s)
+{
+    QByteArray r("\"");
+    const QByteArray u(s.toUtf8());
+    for (int i = 0; i < u.size(); ++i) {
+        const char c = u.at(i);
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += c;
+        } else if ((uchar)c < 0x20) {
+            r += "\\u00";
+            r += QByteArray::number((int)c, 16).rightJustified(2, '0');
+        } else {
+            r += c;
+        }
+    }
+    r += '"';
+    return r;
+}
+} //namespace
+
+std::atomic<bool> enabled(qgetenv("QTAV_TRACE").toInt() > 0);
+
+void record(Event event, Phase phase, const void *key, double value)
+{
+    Buffer *b = threadBuffer();
+    if (!b)
+        return;
+    const quint64 n = b->count.load(std::memory_order_relaxed);
+    Record &r = b->records[n % kRecords];
+    r.ts = now();
+    r.value = value;
+    r.key = key;
+    r.event = event;
+    r.phase = phase;
+    b->count.store(n + 1, std::memory_order_release);
+}
+
+void setStreamName(const void *key, const QString &name)
+{
+    Registry *reg = registry();
+    if (!reg)
+        return;
+    QMutexLocker lock(&reg->mutex);
+    Q_UNUSED(lock);
+    reg->names[key] = name;
+}
+} //namespace Trace
+
+void setTraceEnabled(bool value)
+{
+    Trace::enabled = value;
+}
+
+bool isTraceEnabled()
+{
+    return Trace::enabled;
+}
+
+void clearTrace()
+{
+    Trace::Registry *reg = Trace::registry();
+    if (!reg)
+        return;
+    QMutexLocker lock(&reg->mutex);
+    Q_UNUSED(lock);
+    for (int i = reg->buffers.size() - 1; i >= 0; --i) {
+        Trace::Buffer *b = reg->buffers.at(i);
+        if (b->alive) {
+            // count is only written by the owner thread, otherwise a concurrent record() can undo the clear
+            b->clear_at = b->count.load(std::memory_order_acquire);
+        } else {
+            delete b;
+            reg->buffers.removeAt(i);
+        }
+    }
+}
+
+bool saveTrace(const QString &path)
+{
+    using namespace Trace;
+    Registry *reg = registry();
+    if (!reg)
+        return false;
+    // recording is not stopped, other threads may overwrite the oldest records while they are copied
+    struct Thread {
+        quint64 tid;
+        QByteArray name;
+        QVector<Record> records;
+    };
+    QList<Thread> threads;
+    QHash<const void*, QString> names;
+    {
+        QMutexLocker lock(&reg->mutex);
+        Q_UNUSED(lock);
+        names = reg->names;
+        foreach (Buffer *b, reg->buffers) {
+            const quint64 clear_at = b->clear_at.load(std::memory_order_acquire);
+            const quint64 n = b->count.load(std::memory_order_acquire);
+            const quint64 first = qMax(clear_at, n > quint64(kRecords) ? n - kRecords : 0);
+            Thread t;
+            t.tid = b->tid;
+            t.name = b->name;
+            t.records.reserve(int(n - first));
+            for (quint64 i = first; i < n; ++i)
+                t.records.append(b->records[i % kRecords]);
+            // drop records the owner may have overwritten while copying. record n2 is being written to slot of n2 - kRecords
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const quint64 n2 = b->count.load(std::memory_order_relaxed);
+            if (n2 + 1 > first + quint64(kRecords))
+                t.records.remove(0, qMin<int>(t.records.size(), int(n2 + 1 - kRecords - first)));
+            threads.append(t);
+        }
+    }
+
+    qint64 t0 = -1;
+    foreach (const Thread& t, threads) {
+        if (!t.records.isEmpty() && (t0 < 0 || t.records.first().ts < t0))
+            t0 = t.records.first().ts;
+    }
+    // a stream is a process, pid 0 is for events without a stream
+    QHash<const void*, int> pids;
+    pids[0] = 0;
+    QByteArray json("{\"traceEvents\":[\n");
+    json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"QtAV\"}}";
+    foreach (const Thread& t, threads) {
+        QSet<int> named; // pids of this thread
+        foreach (const Record& r, t.records) {
+            int pid = pids.value(r.key, -1);
+            if (pid < 0) {
+                pid = pids.size();
+                pids[r.key] = pid;
+                const QString name(names.value(r.key, QStringLiteral("stream %1").arg(pid)));
+                json += ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + QByteArray::number(pid)
+                        + ",\"args\":{\"name\":" + jsonString(name) + "}}";
+            }
+            const QByteArray ids = "\"pid\":" + QByteArray::number(pid) + ",\"tid\":" + QByteArray::number(t.tid);
+            if (!named.contains(pid)) {
+                named.insert(pid);
+                json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\"," + ids + ",\"args\":{\"name\":" + jsonString(QString::fromUtf8(t.name)) + "}}";
+            }
+            const char *name = kEventNames[r.event];
+            json += ",\n{\"name\":\"";
+            json += name;
+            json += "\"," + ids + ",\"ts\":" + QByteArray::number(double(r.ts - t0)/1000.0, 'f', 3);
+            const QByteArray value = QByteArray::number(qIsFinite(r.value) ? r.value : 0, 'g', 10); // nan is not valid json
+            switch (r.phase) {
+            case Begin:
+                json += ",\"ph\":\"B\"}";
+                break;
+            case End:
+                json += ",\"ph\":\"E\",\"args\":{\"value\":" + value + "}}";
+                break;
+            case Counter:
+                json += ",\"ph\":\"C\",\"args\":{\"" + QByteArray(name) + "\":" + value + "}}";
+                break;
+            default:
+                json += ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"value\":" + value + "}}";
+                break;
+            }
+        }
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Failed to open trace file %s: %s", qPrintable(path), qPrintable(f.errorString()));
+        return false;
+    }
+    return f.write(json) == json.size();
+}
+#else
+namespace Trace {
+void setStreamName(const void *, const QString &) {}
+} //namespace Trace
+void setTraceEnabled(bool) {}
+bool isTraceEnabled() { return false; }
+void clearTrace() {}
+bool saveTrace(const QString &) { return false; }
+#endif //QTAV_NO_TRACE
+} //namespace QtAV
@@ -0,0 +1,113 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2026 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV (from 2026)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_TRACE_H
+#define QTAV_TRACE_H
+
+#include <atomic>
+#include <QtCore/QString>
+
+/*!
+ * Pipeline tracing. Events are fixed size binary records in per thread ring buffers, no formatting and no lock
+ * when recording. Disabled by default, see QtAV::setTraceEnabled() and QtAV::saveTrace().
+ * Build with QTAV_NO_TRACE to remove all trace points.
+ * key: identifies the stream an event belongs to. It's the player's Statistics, so events of a player are
+ * grouped in one process track in the exported trace. 0 for events not related to a player.
+ */
+#ifndef QTAV_NO_TRACE
+#define QTAV_TRACE_ON() (QtAV::Trace::enabled.load(std::memory_order_relaxed))
+#define QTAV_TRACE(EVENT, KEY, VALUE) \
+    do { if (QTAV_TRACE_ON()) QtAV::Trace::record(QtAV::Trace::EVENT, QtAV::Trace::Instant, KEY, VALUE); } while (0)
+#define QTAV_TRACE_BEGIN(EVENT, KEY) \
+    do { if (QTAV_TRACE_ON()) QtAV::Trace::record(QtAV::Trace::EVENT, QtAV::Trace::Begin, KEY, 0); } while (0)
+#define QTAV_TRACE_END(EVENT, KEY, VALUE) \
+    do { if (QTAV_TRACE_ON()) QtAV::Trace::record(QtAV::Trace::EVENT, QtAV::Trace::End, KEY, VALUE); } while (0)
+#define QTAV_TRACE_COUNTER(EVENT, KEY, VALUE) \
+    do { if (QTAV_TRACE_ON()) QtAV::Trace::record(QtAV::Trace::EVENT, QtAV::Trace::Counter, KEY, VALUE); } while (0)
+#define QTAV_TRACE_SCOPE(EVENT, KEY) QtAV::Trace::Scope qtav_trace_scope_##EVENT(QtAV::Trace::EVENT, KEY)
+#else
+#define QTAV_TRACE_ON() false
+#define QTAV_TRACE(EVENT, KEY, VALUE) do {} while (0)
+#define QTAV_TRACE_BEGIN(EVENT, KEY) do {} while (0)
+#define QTAV_TRACE_END(EVENT, KEY, VALUE) do {} while (0)
+#define QTAV_TRACE_COUNTER(EVENT, KEY, VALUE) do {} while (0)
+#define QTAV_TRACE_SCOPE(EVENT, KEY) do {} while (0)
+#endif //QTAV_NO_TRACE
+
+namespace QtAV {
+namespace Trace {
+
+// names are in Trace.cpp
+enum Event {
+    PacketRead, //!< demuxer reads a packet. value: pts
+    VideoEnqueue, //!< put a packet to video queue, blocks if full. value: pts
+    AudioEnqueue,
+    VideoQueue, //!< counter: packets in video queue
+    AudioQueue,
+    Buffering, //!< counter: 1 if buffering
+    Seek, //!< value: position in seconds
+    SeekFinished,
+    VideoDecode, //!< value: pts of decoded frame
+    AudioDecode,
+    Filter,
+    Convert, //!< pixel format conversion before delivering to renderer
+    Wait, //!< av thread waits for clock
+    Deliver, //!< frame is sent to renderers. value: pts
+    Drop, //!< frame is not rendered. value: pts
+    Present, //!< renderer paints a frame. value: pts
+    AudioWrite, //!< write to audio device, blocks if device buffer is full. value: pts
+    EventCount
+};
+
+enum Phase {
+    Instant,
+    Begin,
+    End,
+    Counter
+};
+
+#ifndef QTAV_NO_TRACE
+extern std::atomic<bool> enabled;
+void record(Event event, Phase phase, const void* key, double value);
+
+class Scope
+{
+public:
+    Scope(Event e, const void* k) : event(e), key(k), on(QTAV_TRACE_ON()) {
+        if (on)
+            record(event, Begin, key, 0);
+    }
+    ~Scope() {
+        if (on)
+            record(event, End, key, 0);
+    }
+private:
+    Event event;
+    const void *key;
+    bool on;
+};
+#endif //QTAV_NO_TRACE
+
+/// name of a stream in the exported trace, e.g. the url
+void setStreamName(const void* key, const QString& name);
+} //namespace Trace
+} //namespace QtAV
+#endif // QTAV_TRACE_H
@@ -0,0 +1,166 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QList>
+#include <QtAV/Packet.h>
+#include <QtAV/private/ActivityDetector.h>
+#include <QtDebug>
+#include <random>
+
+using namespace QtAV;
+
+/*
+ * ActivityDetector with synthetic streams: 25fps packet sizes of an idle and a busy scene with a key frame every 2s,
+ * and motion vector lengths of decoded frames. Checks when activityChanged() is emitted.
+ */
+
+static const qreal kFps = 25.0;
+
+struct Change {
+    qreal pts;
+    bool active;
+};
+
+class Stream
+{
+public:
+    Stream(ActivityDetector *d) : detector(d), frame(0), rng(1234) {
+        QObject::connect(detector, &ActivityDetector::activityChanged, [this](bool active, qreal) {
+            const Change c = { pts(), active };
+            changes.append(c);
+        });
+    }
+    qreal pts() const { return qreal(frame)/kFps; }
+    // seconds of packets with mean size. key frames are 20x larger
+    void feed(qreal seconds, int size, qreal motion = -1) {
+        std::uniform_int_distribution<int> noise(-size/10, size/10);
+        for (int i = 0; i < int(seconds*kFps); ++i, ++frame) {
+            Packet pkt;
+            pkt.hasKeyFrame = frame % 50 == 0;
+            pkt.data = QByteArray((pkt.hasKeyFrame ? size*20 : size) + noise(rng), 0);
+            pkt.pts = pkt.dts = pts();
+            pkt.duration = 1.0/kFps;
+            detector->addPacket(pkt);
+            if (motion >= 0)
+                detector->addMotion(pts(), motion);
+        }
+    }
+    void seek(qreal t) { frame = int(t*kFps); }
+
+    ActivityDetector *detector;
+    int frame;
+    std::mt19937 rng;
+    QList<Change> changes;
+};
+
+static bool check(bool ok, const char* what)
+{
+    qDebug("%s: %s", ok ? "ok  " : "FAIL", what);
+    return ok;
+}
+
+// idle, busy, idle again
+static bool testPacketSize()
+{
+    ActivityDetector d;
+    Stream s(&d);
+    bool ok = true;
+    s.feed(20, 1000);
+    ok &= check(s.changes.isEmpty() && !d.isActive(), "idle scene with large key frames is not active");
+    ok &= check(d.score() < d.threshold()/2, "idle score is low");
+    const qreal busy_at = s.pts();
+    s.feed(5, 4000);
+    ok &= check(s.changes.size() == 1 && s.changes.first().active, "busy scene becomes active");
+    ok &= check(!s.changes.isEmpty() && s.changes.first().pts - busy_at < 0.5, "active within 0.5s");
+    ok &= check(d.isActive() && d.score() >= d.threshold(), "score is high when busy");
+    const qreal idle_at = s.pts();
+    s.feed(10, 1000);
+    ok &= check(s.changes.size() == 2 && !s.changes.last().active, "idle again");
+    if (s.changes.size() == 2) {
+        const qreal hold = s.changes.last().pts - idle_at;
+        qDebug("idle after %.2fs", hold);
+        ok &= check(hold >= 2.0 && hold < 4.0, "hysteresis: idle after 2s of low score");
+    }
+    return ok;
+}
+
+// short dips below the threshold keep the scene active
+static bool testHysteresis()
+{
+    ActivityDetector d;
+    Stream s(&d);
+    s.feed(20, 1000);
+    s.feed(3, 4000);
+    for (int i = 0; i < 5; ++i) {
+        s.feed(1, 1000);
+        s.feed(1, 4000);
+    }
+    bool ok = check(s.changes.size() == 1 && d.isActive(), "dips shorter than 2s do not toggle activity");
+    d.setThreshold(1.0);
+    s.feed(5, 2000);
+    ok &= check(!d.isActive(), "a higher threshold makes a moderate scene idle");
+    return ok;
+}
+
+// a scene busy for a long time becomes the new idle level, e.g. rain or a busy street
+static bool testAdaptation()
+{
+    ActivityDetector d;
+    Stream s(&d);
+    s.feed(20, 1000);
+    s.feed(60, 2000);
+    const bool ok = check(s.changes.size() == 2 && !d.isActive(), "a constantly busy scene becomes idle");
+    if (s.changes.size() == 2)
+        qDebug("adapted in %.1fs", s.changes.last().pts - s.changes.first().pts);
+    return ok;
+}
+
+static bool testMotionVectors()
+{
+    ActivityDetector d;
+    Stream s(&d);
+    bool ok = true;
+    s.feed(20, 1000, 5.0);
+    ok &= check(s.changes.isEmpty(), "motion is ignored if motion vectors are disabled");
+    d.setMotionVectors(true);
+    s.feed(2, 1000, 0.1);
+    ok &= check(s.changes.isEmpty(), "small motion is idle");
+    s.feed(2, 1000, 3.0);
+    ok &= check(s.changes.size() == 1 && d.isActive(), "motion without larger packets becomes active");
+    s.feed(5, 1000, 0.1);
+    ok &= check(s.changes.size() == 2 && !d.isActive(), "motion stops");
+    // motion of frames decoded long ago is stale
+    s.feed(1, 1000, 3.0);
+    s.feed(5, 1000);
+    ok &= check(!d.isActive(), "motion score expires without decoded frames");
+    return ok;
+}
+
+static bool testWarmupAndSeek()
+{
+    ActivityDetector d;
+    Stream s(&d);
+    bool ok = true;
+    s.feed(0.8, 5000); // fewer non-key packets than warmup
+    ok &= check(s.changes.isEmpty() && d.score() == 0, "no score while warming up");
+    s.feed(20, 1000);
+    s.feed(3, 4000);
+    ok &= check(d.isActive(), "active before seek");
+    s.seek(1);
+    s.feed(5, 1000);
+    ok &= check(!d.isActive(), "idle after seeking back, hold time counts from the seek");
+    d.reset();
+    ok &= check(!d.isActive() && d.score() == 0, "reset");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    bool ok = true;
+    ok &= testPacketSize();
+    ok &= testHysteresis();
+    ok &= testAdaptation();
+    ok &= testMotionVectors();
+    ok &= testWarmupAndSeek();
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <QtCore/qmath.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QScopedPointer>
+#include <QtAV/AudioFrame.h>
+#include <QtAV/AudioResampler.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+static AudioFormat makeFormat(AudioFormat::SampleFormat sf, int rate, AudioFormat::ChannelLayout cl)
+{
+    AudioFormat af;
+    af.setSampleFormat(sf);
+    af.setSampleRate(rate);
+    af.setChannelLayout(cl);
+    return af;
+}
+
+// a sine wave with different phase for each channel, stored as af
+static AudioFrame makeFrame(const AudioFormat& af, int samples)
+{
+    QByteArray data(af.bytesPerFrame()*samples, 0);
+    const int nb_planes = af.planeCount();
+    const int bpl = data.size()/nb_planes;
+    for (int c = 0; c < af.channels(); ++c) {
+        for (int i = 0; i < samples; ++i) {
+            const float v = 0.8f*float(qSin(2.0*M_PI*440.0*qreal(i)/qreal(af.sampleRate()) + c));
+            int idx = af.isPlanar() ? i : i*af.channels() + c;
+            char *p = data.data() + (af.isPlanar() ? c*bpl : 0);
+            if (af.isFloat())
+                ((float*)p)[idx] = v;
+            else
+                ((qint16*)p)[idx] = qint16(v*32767.0f);
+        }
+    }
+    AudioFrame f(af, data);
+    f.setTimestamp(1.0);
+    return f;
+}
+
+static float sampleAt(const AudioFrame& f, int ch, int i)
+{
+    const AudioFormat& af = f.format();
+    const uchar *p = f.constBits(af.isPlanar() ? ch : 0);
+    const int idx = af.isPlanar() ? i : i*af.channels() + ch;
+    if (af.isFloat())
+        return ((const float*)p)[idx];
+    return float(((const qint16*)p)[idx])/32768.0f;
+}
+
+// returns false if results of AudioConvert and libswresample differ
+static bool run(const char* name, const AudioFormat& in, int samples, const AudioFormat& out, int loops)
+{
+    const AudioFrame frame(makeFrame(in, samples));
+    QScopedPointer<AudioResampler> conv(AudioResampler::create(AudioResamplerId_FF));
+    if (!conv) {
+        qWarning("FFmpeg resampler is not available");
+        return false;
+    }
+    conv->setInAudioFormat(in);
+    conv->setOutAudioFormat(out);
+    conv->setInSampesPerChannel(samples);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < loops; ++i) {
+        const quint8* planes[8] = {0};
+        for (int p = 0; p < frame.planeCount(); ++p)
+            planes[p] = frame.constBits(p);
+        conv->convert(planes);
+    }
+    const qint64 swr_ns = timer.nsecsElapsed();
+    const AudioFrame ref(out, conv->outData());
+    AudioFrame f;
+    timer.restart();
+    for (int i = 0; i < loops; ++i)
+        f = frame.to(out); // no resampler is set, so AudioConvert is used
+    const qint64 simd_ns = timer.nsecsElapsed();
+    if (f.samplesPerChannel() != samples || ref.samplesPerChannel() != samples) {
+        qWarning("%s: wrong samples. %d, swr %d, expect %d", name, f.samplesPerChannel(), ref.samplesPerChannel(), samples);
+        return false;
+    }
+    float max_diff = 0;
+    for (int c = 0; c < out.channels(); ++c) {
+        for (int i = 0; i < samples; ++i)
+            max_diff = qMax(max_diff, qAbs(sampleAt(f, c, i) - sampleAt(ref, c, i)));
+    }
+    // 2 lsb of s16. swr rounds stereo to mono downmix and s16 differently
+    const bool ok = max_diff <= 2.0f/32768.0f;
+    printf("%-32s swr: %7.1f ns/frame, simd: %7.1f ns/frame, speedup: %5.2fx, max diff: %g %s\n", name
+           , qreal(swr_ns)/loops, qreal(simd_ns)/loops, qreal(swr_ns)/qreal(qMax<qint64>(1, simd_ns)), max_diff, ok ? "" : "MISMATCH");
+    fflush(0);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n loops]");
+    int loops = 20000;
+    const int idx = app.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0 && idx + 1 < app.arguments().size())
+        loops = qMax(1, app.arguments().at(idx + 1).toInt());
+    const AudioFormat::ChannelLayout mono = AudioFormat::ChannelLayout_Mono;
+    const AudioFormat::ChannelLayout stereo = AudioFormat::ChannelLayout_Stereo;
+    bool ok = true;
+    // aac decoder output
+    ok &= run("aac fltp 48k => s16", makeFormat(AudioFormat::SampleFormat_FloatPlanar, 48000, stereo), 1024
+              , makeFormat(AudioFormat::SampleFormat_Signed16, 48000, stereo), loops);
+    ok &= run("aac fltp 48k => flt", makeFormat(AudioFormat::SampleFormat_FloatPlanar, 48000, stereo), 1024
+              , makeFormat(AudioFormat::SampleFormat_Float, 48000, stereo), loops);
+    // g.711 decoder output, 20ms
+    ok &= run("g711 s16 mono 8k => s16 stereo", makeFormat(AudioFormat::SampleFormat_Signed16, 8000, mono), 160
+              , makeFormat(AudioFormat::SampleFormat_Signed16, 8000, stereo), loops);
+    ok &= run("g711 s16 mono 8k => flt stereo", makeFormat(AudioFormat::SampleFormat_Signed16, 8000, mono), 160
+              , makeFormat(AudioFormat::SampleFormat_Float, 8000, stereo), loops);
+    // opus decoder output, 20ms
+    ok &= run("opus flt 48k => s16", makeFormat(AudioFormat::SampleFormat_Float, 48000, stereo), 960
+              , makeFormat(AudioFormat::SampleFormat_Signed16, 48000, stereo), loops);
+    ok &= run("s16p stereo => s16 mono", makeFormat(AudioFormat::SampleFormat_Signed16Planar, 44100, stereo), 1152
+              , makeFormat(AudioFormat::SampleFormat_Signed16, 44100, mono), loops);
+    // downmix gain depends on output sample format
+    ok &= run("fltp stereo => flt mono", makeFormat(AudioFormat::SampleFormat_FloatPlanar, 48000, stereo), 1024
+              , makeFormat(AudioFormat::SampleFormat_Float, 48000, mono), loops);
+    ok &= run("s16 stereo => flt mono", makeFormat(AudioFormat::SampleFormat_Signed16, 48000, stereo), 960
+              , makeFormat(AudioFormat::SampleFormat_Float, 48000, mono), loops);
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+TEMPLATE = app
+CONFIG -= app_bundle
+
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+
+SOURCES += main.cpp
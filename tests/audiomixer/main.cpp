@@ -0,0 +1,90 @@
+#include <QtCore/qmath.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+#include <QtAV/AudioMixer.h>
+#include <QtAV/AudioOutput.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+// plays a sine wave to a mixer input in its own thread, like an AudioThread of a player
+class SineThread : public QThread
+{
+public:
+    SineThread(qreal freq, qreal volume, qreal pan, int msecs) : m_freq(freq), m_volume(volume), m_pan(pan), m_msecs(msecs) {}
+    qint64 frames = 0;
+protected:
+    void run() Q_DECL_OVERRIDE {
+        AudioOutput ao;
+        ao.setBackends(QStringList() << AudioMixer::backendName());
+        AudioFormat requested;
+        requested.setSampleFormat(AudioFormat::SampleFormat_Signed16);
+        requested.setSampleRate(44100);
+        requested.setChannelLayout(AudioFormat::ChannelLayout_Stereo);
+        const AudioFormat af = ao.setAudioFormat(requested); // mixer inputs always use the mixer format
+        ao.setVolume(m_volume);
+        AudioMixer::instance().setPan(&ao, m_pan);
+        if (!ao.open()) {
+            qWarning("failed to open mixer input");
+            return;
+        }
+        const int chunk = ao.bufferSamples();
+        QByteArray data(chunk*af.bytesPerFrame(), 0);
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < m_msecs) {
+            float *d = (float*)data.data();
+            for (int i = 0; i < chunk; ++i, ++frames) {
+                const float v = float(qSin(2.0*M_PI*m_freq*qreal(frames)/qreal(af.sampleRate())));
+                for (int c = 0; c < af.channels(); ++c)
+                    *d++ = v;
+            }
+            ao.play(data, qreal(frames)/qreal(af.sampleRate()));
+        }
+        ao.close();
+    }
+private:
+    qreal m_freq, m_volume, m_pan;
+    int m_msecs;
+};
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug() << "parameters: [-n inputs] [-ao " << AudioOutput::backendsAvailable().join(QLatin1String("|")) << "]";
+    qDebug() << "default device is null: the mixer is paced by inputs and the result is deterministic";
+    int n = 9;
+    int idx = app.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        n = qMax(1, app.arguments().at(idx + 1).toInt());
+    QString device = QStringLiteral("null");
+    idx = app.arguments().indexOf(QLatin1String("-ao"));
+    if (idx > 0)
+        device = app.arguments().at(idx + 1);
+    AudioMixer::instance().setBackends(QStringList() << device);
+    AudioMixer::instance().setFormat(48000, AudioFormat::ChannelLayout_Stereo);
+
+    QList<SineThread*> inputs;
+    for (int i = 0; i < n; ++i)
+        inputs.append(new SineThread(220.0*(i + 1), 1.0/qreal(n), qreal(i)/qreal(qMax(1, n - 1))*2.0 - 1.0, 3000));
+    QElapsedTimer timer;
+    timer.start();
+    foreach (SineThread *t, inputs)
+        t->start();
+    qint64 frames = 0;
+    foreach (SineThread *t, inputs) {
+        t->wait();
+        frames += t->frames;
+        delete t;
+    }
+    const QVariantMap stats = AudioMixer::instance().statistics();
+    qDebug() << n << "inputs," << frames << "frames in" << timer.elapsed() << "ms." << stats;
+    // gain is 1/n, sum of sines never clips
+    if (AudioMixer::instance().isRunning() || stats.value(QStringLiteral("periods")).toLongLong() <= 0
+            || stats.value(QStringLiteral("clipped")).toLongLong() > 0) {
+        qWarning("audio mixer test failed");
+        return 1;
+    }
+    return 0;
+}
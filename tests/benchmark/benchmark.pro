@@ -0,0 +1,9 @@
+TEMPLATE = app
+CONFIG -= app_bundle
+greaterThan(QT_MAJOR_VERSION, 5): QT += opengl
+
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+
+SOURCES += main.cpp
@@ -0,0 +1,598 @@
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/AVMuxer.h>
+#include <QtAV/LibAVFilter.h>
+#include <QtAV/OpenGLVideo.h>
+#include <QtAV/VideoDecoder.h>
+#include <QtAV/VideoEncoder.h>
+#include <QtAV/VideoFrame.h>
+#include <QtDebug>
+#include <algorithm>
+
+using namespace QtAV;
+
+/*
+ * Measures each stage of the pipeline in isolation and end to end on synthetic media generated locally, and writes json
+ * results to compare across commits. Stages:
+ *  encode: generate test pattern frames and encode them. not a playback stage, but media generation is timed anyway
+ *  mux: write the encoded packets to a container (AVMuxer)
+ *  demux: AVDemuxer::readFrame() of the whole file
+ *  decode: VideoDecoderFFmpeg, packets are read in memory before
+ *  convert: decoded frames to RGB32 (ImageConverterFF)
+ *  filter: LibAVFilterVideo
+ *  render: OpenGLVideo to an offscreen fbo, glFinish() for each frame. llvmpipe by default
+ *  e2e: demux, decode, convert and render one after another for each packet
+ */
+
+// latency of each output unit (packet or frame) and wall time of the stage
+class Stats
+{
+public:
+    Stats() : elapsed(0) {}
+    void add(qint64 ns) { samples.append(ns); }
+    void setElapsed(qint64 ns) { elapsed = ns; }
+    int count() const { return samples.size(); }
+    QJsonObject toJson() const {
+        QJsonObject o;
+        QVector<qint64> v(samples);
+        std::sort(v.begin(), v.end());
+        qint64 total = 0;
+        foreach (qint64 x, v)
+            total += x;
+        o[QStringLiteral("count")] = v.size();
+        o[QStringLiteral("ms")] = double(elapsed)/1e6;
+        o[QStringLiteral("fps")] = elapsed > 0 ? double(v.size())*1e9/double(elapsed) : 0.0;
+        o[QStringLiteral("avg_us")] = v.isEmpty() ? 0.0 : double(total)/double(v.size())/1e3;
+        o[QStringLiteral("p50_us")] = v.isEmpty() ? 0.0 : double(v.at(v.size()/2))/1e3;
+        o[QStringLiteral("p95_us")] = v.isEmpty() ? 0.0 : double(v.at(v.size()*95/100))/1e3;
+        o[QStringLiteral("max_us")] = v.isEmpty() ? 0.0 : double(v.last())/1e3;
+        return o;
+    }
+private:
+    QVector<qint64> samples;
+    qint64 elapsed;
+};
+
+struct Options {
+    int width;
+    int height;
+    int frames;
+    int max_frames; // decoded frames kept in memory as input of convert, filter and render
+    QString filter;
+    bool gl;
+};
+
+// moving color bars with some texture, like lavfi testsrc. width and height must be even
+static VideoFrame testFrame(int w, int h, int n)
+{
+    static const quint8 kBars[8][3] = { // yuv of white, yellow, cyan, green, magenta, red, blue, black
+        {235, 128, 128}, {210, 16, 146}, {170, 166, 16}, {145, 54, 34},
+        {106, 202, 222}, {81, 90, 240}, {41, 240, 110}, {16, 128, 128}
+    };
+    const int cw = w/2, ch = h/2;
+    QByteArray buf(w*h + cw*ch*2, 0);
+    quint8 *y = (quint8*)buf.data(); //must before buf is shared
+    quint8 *u = y + w*h;
+    quint8 *v = u + cw*ch;
+    VideoFrame f(w, h, VideoFormat(VideoFormat::Format_YUV420P), buf);
+    f.setBits(y, 0);
+    f.setBits(u, 1);
+    f.setBits(v, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(cw, 1);
+    f.setBytesPerLine(cw, 2);
+    const int shift = n*4;
+    for (int j = 0; j < h; ++j) {
+        for (int i = 0; i < w; ++i)
+            y[j*w + i] = kBars[((i + shift)*8/w) % 8][0] + ((i ^ j ^ n) & 0xf);
+    }
+    for (int j = 0; j < ch; ++j) {
+        for (int i = 0; i < cw; ++i) {
+            const int bar = ((i*2 + shift)*8/w) % 8;
+            u[j*cw + i] = kBars[bar][1];
+            v[j*cw + i] = kBars[bar][2];
+        }
+    }
+    // moving square
+    const int s = h/8;
+    const int x0 = (n*7) % (w - s), y0 = (n*3) % (h - s);
+    for (int j = y0; j < y0 + s; ++j)
+        memset(y + j*w + x0, 235, s);
+    f.setTimestamp(qreal(n)/VideoEncoder::defaultFrameRate());
+    return f;
+}
+
+struct Encoded {
+    VideoEncoder *encoder;
+    QList<Packet> packets;
+};
+
+static bool encode(const QString& codec, const Options& opt, Encoded *out, Stats *stats)
+{
+    static const struct {
+        const char* codec;
+        const char* encoders;
+    } kEncoders[] = {
+        { "h264", "libx264,h264" },
+        { "hevc", "libx265,hevc" },
+        { "mjpeg", "mjpeg" },
+    };
+    QStringList names;
+    for (size_t i = 0; i < sizeof(kEncoders)/sizeof(kEncoders[0]); ++i) {
+        if (codec == QLatin1String(kEncoders[i].codec))
+            names = QString::fromLatin1(kEncoders[i].encoders).split(QLatin1Char(','));
+    }
+    if (names.isEmpty())
+        names.append(codec);
+    VideoEncoder *venc = VideoEncoder::create("FFmpeg");
+    const QStringList supported(VideoEncoder::supportedCodecs());
+    bool found = false;
+    foreach (const QString& name, names) {
+        if (!supported.contains(name))
+            continue;
+        venc->setCodecName(name);
+        found = true;
+        break;
+    }
+    if (!found) {
+        qWarning("no encoder for %s", qPrintable(codec));
+        delete venc;
+        return false;
+    }
+    QVariantHash avcodec;
+    avcodec[QStringLiteral("preset")] = QStringLiteral("ultrafast"); // x264, x265. generating media is not what we measure
+    QVariantHash encopt;
+    encopt[QStringLiteral("avcodec")] = avcodec;
+    venc->setOptions(encopt);
+    venc->setWidth(opt.width);
+    venc->setHeight(opt.height);
+    venc->setFrameRate(VideoEncoder::defaultFrameRate());
+    venc->setBitRate(opt.width*opt.height*4);
+    if (!venc->open()) {
+        qWarning("failed to open encoder %s", qPrintable(venc->codecName()));
+        delete venc;
+        return false;
+    }
+    QElapsedTimer t, all;
+    all.start();
+    for (int i = 0; i <= opt.frames; ++i) {
+        VideoFrame frame;
+        if (i < opt.frames) {
+            frame = testFrame(opt.width, opt.height, i);
+            if (frame.pixelFormat() != venc->pixelFormat())
+                frame = frame.to(venc->pixelFormat());
+        }
+        t.start();
+        // an invalid frame to get delayed frames at last
+        while (venc->encode(frame)) {
+            stats->add(t.nsecsElapsed());
+            out->packets.append(venc->encoded());
+            if (frame.isValid())
+                break;
+            t.start();
+        }
+    }
+    stats->setElapsed(all.nsecsElapsed());
+    out->encoder = venc;
+    return !out->packets.isEmpty();
+}
+
+static bool mux(const QString& file, const Encoded& enc, Stats *stats)
+{
+    AVMuxer mux;
+    mux.setMedia(file);
+    mux.copyProperties(enc.encoder);
+    QElapsedTimer t, all;
+    all.start();
+    if (!mux.open()) {
+        qWarning("failed to open muxer for %s", qPrintable(file));
+        return false;
+    }
+    foreach (const Packet& pkt, enc.packets) {
+        t.start();
+        if (!mux.writeVideo(pkt))
+            return false;
+        stats->add(t.nsecsElapsed());
+    }
+    mux.close();
+    stats->setElapsed(all.nsecsElapsed());
+    return true;
+}
+
+static bool demux(const QString& file, QList<Packet> *packets, Stats *stats)
+{
+    AVDemuxer demux;
+    demux.setMedia(file);
+    QElapsedTimer t, all;
+    all.start();
+    if (!demux.load())
+        return false;
+    int errors = 0; // consecutive. a read error of truncated input does not set atEnd()
+    while (!demux.atEnd()) {
+        t.start();
+        if (!demux.readFrame()) {
+            if (demux.atEnd() || ++errors > 64)
+                break;
+            continue;
+        }
+        errors = 0;
+        stats->add(t.nsecsElapsed());
+        if (demux.stream() == demux.videoStream())
+            packets->append(demux.packet());
+    }
+    stats->setElapsed(all.nsecsElapsed());
+    return true;
+}
+
+static bool decode(const QString& file, const QList<Packet>& packets, int max_frames, QList<VideoFrame> *frames, Stats *stats)
+{
+    AVDemuxer demux; // only for codec parameters
+    demux.setMedia(file);
+    if (!demux.load())
+        return false;
+    QScopedPointer<VideoDecoder> dec(VideoDecoder::create("FFmpeg"));
+    dec->setCodecContext(demux.videoCodecContext());
+    if (!dec->open())
+        return false;
+    QElapsedTimer t, all;
+    all.start();
+    for (int i = 0; i <= packets.size(); ++i) {
+        const bool eof = i == packets.size();
+        const Packet pkt(eof ? Packet::createEOF() : packets.at(i));
+        t.start();
+        // drain decoded frames at eof
+        while (dec->decode(pkt)) {
+            const VideoFrame frame(dec->frame());
+            if (!frame.isValid())
+                break;
+            stats->add(t.nsecsElapsed());
+            if (frames->size() < max_frames)
+                frames->append(frame.clone());
+            if (!eof)
+                break;
+            t.start();
+        }
+    }
+    stats->setElapsed(all.nsecsElapsed());
+    return stats->count() > 0;
+}
+
+static void convert(const QList<VideoFrame>& frames, Stats *stats)
+{
+    VideoFrameConverter conv;
+    QElapsedTimer t, all;
+    all.start();
+    foreach (const VideoFrame& frame, frames) {
+        t.start();
+        if (conv.convert(frame, VideoFormat::Format_RGB32).isValid())
+            stats->add(t.nsecsElapsed());
+    }
+    stats->setElapsed(all.nsecsElapsed());
+}
+
+static void filter(const QList<VideoFrame>& frames, const QString& options, Stats *stats)
+{
+    LibAVFilterVideo f;
+    f.setOptions(options);
+    QElapsedTimer t, all;
+    all.start();
+    foreach (const VideoFrame& frame, frames) {
+        VideoFrame out(frame);
+        t.start();
+        f.apply(0, &out);
+        if (f.status() == LibAVFilter::ConfigureFailed) {
+            qWarning("invalid filter: %s", qPrintable(options));
+            return;
+        }
+        stats->add(t.nsecsElapsed());
+    }
+    stats->setElapsed(all.nsecsElapsed());
+}
+
+class Renderer
+{
+public:
+    Renderer() : functions(0), fbo(0) {}
+    ~Renderer() {
+        if (!context.isValid())
+            return;
+        context.makeCurrent(&surface);
+        video.setOpenGLContext(0);
+        delete fbo;
+        context.doneCurrent();
+    }
+    bool init(int w, int h) {
+        surface.create();
+        if (!context.create() || !context.makeCurrent(&surface)) {
+            qWarning("failed to create OpenGL context");
+            return false;
+        }
+        functions = context.functions();
+        fbo = new QOpenGLFramebufferObject(w, h);
+        fbo->bind();
+        video.setOpenGLContext(&context);
+        video.setProjectionMatrixToRect(QRectF(0, 0, w, h));
+        functions->glViewport(0, 0, w, h);
+        qDebug("GL_RENDERER: %s", (const char*)functions->glGetString(GL_RENDERER));
+        return true;
+    }
+    QString name() const {
+        return QString::fromLatin1((const char*)functions->glGetString(GL_RENDERER));
+    }
+    // upload and draw, wait for gpu
+    void render(const VideoFrame& frame) {
+        video.setCurrentFrame(frame);
+        video.render();
+        functions->glFinish();
+    }
+private:
+    QOffscreenSurface surface;
+    QOpenGLContext context;
+    QOpenGLFunctions *functions;
+    QOpenGLFramebufferObject *fbo;
+    OpenGLVideo video;
+};
+
+static void render(Renderer *r, const QList<VideoFrame>& frames, Stats *stats)
+{
+    QElapsedTimer t, all;
+    all.start();
+    foreach (const VideoFrame& frame, frames) {
+        t.start();
+        r->render(frame);
+        stats->add(t.nsecsElapsed());
+    }
+    stats->setElapsed(all.nsecsElapsed());
+}
+
+// latency: a packet read to its frame rendered
+static bool endToEnd(const QString& file, Renderer *r, Stats *stats)
+{
+    QElapsedTimer t, all;
+    all.start();
+    AVDemuxer demux;
+    demux.setMedia(file);
+    if (!demux.load())
+        return false;
+    QScopedPointer<VideoDecoder> dec(VideoDecoder::create("FFmpeg"));
+    dec->setCodecContext(demux.videoCodecContext());
+    if (!dec->open())
+        return false;
+    VideoFrameConverter conv;
+    bool eof = false;
+    while (!eof) {
+        t.start();
+        Packet pkt;
+        if (demux.atEnd()) {
+            pkt = Packet::createEOF();
+            eof = true;
+        } else {
+            if (!demux.readFrame() || demux.stream() != demux.videoStream())
+                continue;
+            pkt = demux.packet();
+        }
+        while (dec->decode(pkt)) {
+            const VideoFrame frame(dec->frame());
+            if (!frame.isValid())
+                break;
+            if (r)
+                r->render(frame);
+            else
+                conv.convert(frame, VideoFormat::Format_RGB32);
+            stats->add(t.nsecsElapsed());
+            if (!eof)
+                break;
+            t.start();
+        }
+    }
+    stats->setElapsed(all.nsecsElapsed());
+    return true;
+}
+
+// print fps changes of every stage. return false if any is slower than threshold percent
+static bool compare(const QJsonObject& result, const QString& baselineFile, double threshold)
+{
+    QFile f(baselineFile);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning("can not open baseline %s", qPrintable(baselineFile));
+        return false;
+    }
+    QHash<QString, QJsonObject> base;
+    foreach (const QJsonValue& m, QJsonDocument::fromJson(f.readAll()).object().value(QStringLiteral("media")).toArray())
+        base[m.toObject().value(QStringLiteral("name")).toString()] = m.toObject().value(QStringLiteral("stages")).toObject();
+    bool ok = true;
+    printf("%-16s %-8s %10s %10s %8s\n", "media", "stage", "base fps", "fps", "change");
+    foreach (const QJsonValue& m, result.value(QStringLiteral("media")).toArray()) {
+        const QString name(m.toObject().value(QStringLiteral("name")).toString());
+        if (!base.contains(name))
+            continue;
+        const QJsonObject stages(m.toObject().value(QStringLiteral("stages")).toObject());
+        const QJsonObject base_stages(base.value(name));
+        foreach (const QString& stage, stages.keys()) {
+            if (!base_stages.contains(stage))
+                continue;
+            const double fps0 = base_stages.value(stage).toObject().value(QStringLiteral("fps")).toDouble();
+            const double fps = stages.value(stage).toObject().value(QStringLiteral("fps")).toDouble();
+            if (fps0 <= 0)
+                continue;
+            const double change = (fps - fps0)*100.0/fps0;
+            const bool regressed = change < -threshold;
+            ok &= !regressed;
+            printf("%-16s %-8s %10.1f %10.1f %+7.1f%%%s\n", qPrintable(name), qPrintable(stage), fps0, fps, change, regressed ? " REGRESSION" : "");
+        }
+    }
+    fflush(0);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    // headless by default. mesa llvmpipe makes render results comparable between machines
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    bool hwgl = false;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "-hwgl") == 0)
+            hwgl = true;
+    }
+    if (!hwgl)
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+    QGuiApplication app(argc, argv);
+    qDebug("parameters: [-s 1280x720] [-n frames] [-c h264,hevc,mjpeg] [-f mkv,mp4,ts] [-vf hflip] [-d dir] [-o result.json] [-tag name] [-baseline old.json] [-threshold 10] [-nogl] [-hwgl]");
+    setLogLevel(LogWarning); // muxer and decoder debug messages would be measured
+    const QStringList args = app.arguments();
+    Options opt;
+    opt.width = 1280;
+    opt.height = 720;
+    opt.frames = 300;
+    opt.max_frames = 100;
+    opt.filter = QStringLiteral("hflip");
+    opt.gl = true;
+    QStringList codecs = QStringList() << QStringLiteral("h264") << QStringLiteral("hevc") << QStringLiteral("mjpeg");
+    QStringList containers = QStringList() << QStringLiteral("mkv") << QStringLiteral("mp4") << QStringLiteral("ts");
+    QString dir = QDir::tempPath() + QStringLiteral("/qtav_benchmark");
+    QString out, tag, baseline;
+    double threshold = 10;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args.at(i);
+        const bool has_value = i + 1 < args.size();
+        if (a == QLatin1String("-s") && has_value) {
+            const QStringList wh(args.at(++i).split(QLatin1Char('x')));
+            if (wh.size() == 2) {
+                opt.width = qMax(64, wh.at(0).toInt()) & ~1;
+                opt.height = qMax(64, wh.at(1).toInt()) & ~1;
+            }
+        } else if (a == QLatin1String("-n") && has_value) {
+            opt.frames = qMax(1, args.at(++i).toInt());
+        } else if (a == QLatin1String("-c") && has_value) {
+            codecs = args.at(++i).split(QLatin1Char(','));
+        } else if (a == QLatin1String("-f") && has_value) {
+            containers = args.at(++i).split(QLatin1Char(','));
+        } else if (a == QLatin1String("-vf") && has_value) {
+            opt.filter = args.at(++i);
+        } else if (a == QLatin1String("-d") && has_value) {
+            dir = args.at(++i);
+        } else if (a == QLatin1String("-o") && has_value) {
+            out = args.at(++i);
+        } else if (a == QLatin1String("-tag") && has_value) {
+            tag = args.at(++i);
+        } else if (a == QLatin1String("-baseline") && has_value) {
+            baseline = args.at(++i);
+        } else if (a == QLatin1String("-threshold") && has_value) {
+            threshold = args.at(++i).toDouble();
+        } else if (a == QLatin1String("-nogl")) {
+            opt.gl = false;
+        }
+    }
+    QDir().mkpath(dir);
+    Renderer renderer;
+    Renderer *r = 0;
+    if (opt.gl && renderer.init(opt.width, opt.height))
+        r = &renderer;
+
+    QJsonArray media;
+    foreach (const QString& codec, codecs) {
+        Encoded enc;
+        enc.encoder = 0;
+        Stats encode_stats;
+        printf("encoding %d %dx%d %s frames...\n", opt.frames, opt.width, opt.height, qPrintable(codec));
+        fflush(0);
+        if (!encode(codec, opt, &enc, &encode_stats)) {
+            delete enc.encoder;
+            continue;
+        }
+        foreach (const QString& container, containers) {
+            if (codec == QLatin1String("mjpeg") && container == QLatin1String("ts")) // not supported by mpegts
+                continue;
+            const QString name(codec + QLatin1Char('.') + container);
+            const QString file(dir + QLatin1Char('/') + name);
+            printf("%s\n", qPrintable(name));
+            fflush(0);
+            QJsonObject stages;
+            stages[QStringLiteral("encode")] = encode_stats.toJson();
+            Stats mux_stats, demux_stats, decode_stats;
+            if (!mux(file, enc, &mux_stats))
+                continue;
+            stages[QStringLiteral("mux")] = mux_stats.toJson();
+            QList<Packet> packets;
+            if (!demux(file, &packets, &demux_stats)) {
+                qWarning("failed to demux %s", qPrintable(file));
+                continue;
+            }
+            stages[QStringLiteral("demux")] = demux_stats.toJson();
+            QList<VideoFrame> frames;
+            if (!decode(file, packets, opt.max_frames, &frames, &decode_stats)) {
+                qWarning("failed to decode %s", qPrintable(file));
+                continue;
+            }
+            stages[QStringLiteral("decode")] = decode_stats.toJson();
+            Stats convert_stats, filter_stats, e2e_stats;
+            convert(frames, &convert_stats);
+            stages[QStringLiteral("convert")] = convert_stats.toJson();
+            if (!opt.filter.isEmpty()) {
+                filter(frames, opt.filter, &filter_stats);
+                stages[QStringLiteral("filter")] = filter_stats.toJson();
+            }
+            if (r) {
+                Stats render_stats;
+                render(r, frames, &render_stats);
+                stages[QStringLiteral("render")] = render_stats.toJson();
+            }
+            if (endToEnd(file, r, &e2e_stats))
+                stages[QStringLiteral("e2e")] = e2e_stats.toJson();
+            QJsonObject m;
+            m[QStringLiteral("name")] = name;
+            m[QStringLiteral("codec")] = codec;
+            m[QStringLiteral("encoder")] = enc.encoder->codecName();
+            m[QStringLiteral("container")] = container;
+            m[QStringLiteral("bytes")] = QFileInfo(file).size();
+            m[QStringLiteral("stages")] = stages;
+            media.append(m);
+            foreach (const QString& stage, stages.keys()) {
+                const QJsonObject s(stages.value(stage).toObject());
+                printf("  %-8s %6d in %9.1fms %9.1f fps, latency avg: %9.1fus p95: %9.1fus max: %9.1fus\n", qPrintable(stage)
+                       , s.value(QStringLiteral("count")).toInt(), s.value(QStringLiteral("ms")).toDouble(), s.value(QStringLiteral("fps")).toDouble()
+                       , s.value(QStringLiteral("avg_us")).toDouble(), s.value(QStringLiteral("p95_us")).toDouble(), s.value(QStringLiteral("max_us")).toDouble());
+            }
+            fflush(0);
+        }
+        delete enc.encoder;
+    }
+    QJsonObject result;
+    result[QStringLiteral("tag")] = tag;
+    result[QStringLiteral("date")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result[QStringLiteral("qtav")] = QtAV_Version_String_Long();
+    result[QStringLiteral("qt")] = QString::fromLatin1(qVersion());
+    result[QStringLiteral("gl_renderer")] = r ? r->name() : QString();
+    result[QStringLiteral("width")] = opt.width;
+    result[QStringLiteral("height")] = opt.height;
+    result[QStringLiteral("frames")] = opt.frames;
+    result[QStringLiteral("media")] = media;
+    const QByteArray json(QJsonDocument(result).toJson());
+    if (out.isEmpty()) {
+        printf("%s", json.constData());
+    } else {
+        QFile f(out);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+            qWarning("failed to write %s", qPrintable(out));
+            return 1;
+        }
+        printf("result: %s\n", qPrintable(out));
+    }
+    fflush(0);
+    if (!baseline.isEmpty() && !compare(result, baseline, threshold))
+        return 2;
+    return media.isEmpty() ? 1 : 0;
+}
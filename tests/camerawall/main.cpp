@@ -0,0 +1,444 @@
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QProcess>
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QWindow>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/AudioOutput.h>
+#include <QtAV/VideoRenderer.h>
+#include <QtDebug>
+#include <algorithm>
+#include <cmath>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace QtAV;
+
+/*
+ * How many streams can one box show. For each stream count in the ramp, N players in realtime decode mode play
+ * locally served streams, and per stream fps, lost/dropped frames, end to end latency, process RSS and CPU are
+ * measured after a warm up. The result is a saturation curve.
+ *
+ * Streams are served by ffmpeg processes looping a pre-encoded testsrc2 clip with -c copy, so serving is cheap and
+ * not measured (only this process is). Each stream has its own server:
+ *  udp: mpegts over udp unicast
+ *  http: mpegts over http, ffmpeg listens as a single client http server
+ *  rtsp: published to an external rtsp server given by -rtsp-server, e.g. mediamtx
+ * Server timestamps are wall clock (-use_wallclock_as_timestamps -copyts) for udp and http, so latency is the
+ * difference between the render time and the frame pts. Not available for rtsp because the server rewrites timestamps.
+ */
+
+static const VideoRendererId kProbeRendererId = 0x7072626e; // "prbn"
+
+// delivered frames and latency of a player. frames are not drawn
+class ProbeRenderer : public VideoRenderer
+{
+public:
+    ProbeRenderer() : frames(0) {}
+    VideoRendererId id() const Q_DECL_OVERRIDE { return kProbeRendererId; }
+    bool isSupported(VideoFormat::PixelFormat pixfmt) const Q_DECL_OVERRIDE { return pixfmt != VideoFormat::Format_Invalid; }
+    void reset() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        frames = 0;
+        latency_ms.clear();
+    }
+    qint64 frameCount() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        return frames;
+    }
+    QVector<double> latency() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        return latency_ms;
+    }
+protected:
+    bool receiveFrame(const VideoFrame& frame) Q_DECL_OVERRIDE {
+        // mpegts pts wraps at 2^33/90k seconds
+        static const double kWrap = 8589934592.0/90000.0;
+        double latency = std::fmod(double(QDateTime::currentMSecsSinceEpoch())/1000.0, kWrap) - frame.timestamp();
+        if (latency < -kWrap/2)
+            latency += kWrap;
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        ++frames;
+        if (qAbs(latency) < 60) // not wall clock timestamps otherwise
+            latency_ms.append(latency*1000.0);
+        return true;
+    }
+    void drawFrame() Q_DECL_OVERRIDE {}
+private:
+    QMutex mutex;
+    qint64 frames;
+    QVector<double> latency_ms;
+};
+
+struct Options {
+    QString ffmpeg;
+    QString protocol;
+    QString rtsp_server;
+    QStringList urls; // external streams, used instead of local servers
+    QString dir;
+    QString vo;
+    int width;
+    int height;
+    int fps;
+    int warmup;
+    int seconds;
+    int threads;
+    qint64 buffer;
+};
+
+static void wait(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, SLOT(quit()));
+    loop.exec();
+}
+
+// resident set size in bytes
+static qint64 rss()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/statm"));
+    if (!f.open(QIODevice::ReadOnly))
+        return 0;
+    const QList<QByteArray> v(f.readAll().split(' '));
+    if (v.size() < 2)
+        return 0;
+    return v.at(1).toLongLong()*sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// user + system time in us
+static qint64 cpuTime()
+{
+#ifdef Q_OS_UNIX
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+    return qint64(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)*1000000LL + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+#else
+    return 0;
+#endif
+}
+
+class Server
+{
+public:
+    Server(const Options& opt, int index, const QString& clip) {
+        if (!opt.urls.isEmpty()) {
+            url = opt.urls.at(index % opt.urls.size());
+            return;
+        }
+        const int port = 20000 + index*2;
+        QStringList args;
+        args << QStringLiteral("-hide_banner") << QStringLiteral("-loglevel") << QStringLiteral("error")
+             << QStringLiteral("-re") << QStringLiteral("-stream_loop") << QStringLiteral("-1");
+        if (opt.protocol != QLatin1String("rtsp"))
+            args << QStringLiteral("-use_wallclock_as_timestamps") << QStringLiteral("1");
+        args << QStringLiteral("-i") << clip << QStringLiteral("-c") << QStringLiteral("copy");
+        if (opt.protocol == QLatin1String("rtsp")) {
+            url = QStringLiteral("%1/cam%2").arg(opt.rtsp_server).arg(index);
+            args << QStringLiteral("-f") << QStringLiteral("rtsp") << url;
+        } else {
+            args << QStringLiteral("-copyts") << QStringLiteral("-muxdelay") << QStringLiteral("0") << QStringLiteral("-muxpreload") << QStringLiteral("0")
+                 << QStringLiteral("-f") << QStringLiteral("mpegts");
+            if (opt.protocol == QLatin1String("http")) {
+                url = QStringLiteral("http://127.0.0.1:%1/cam.ts").arg(port);
+                args << QStringLiteral("-listen") << QStringLiteral("1") << url;
+            } else {
+                url = QStringLiteral("udp://127.0.0.1:%1").arg(port);
+                args << url + QStringLiteral("?pkt_size=1316");
+            }
+        }
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(opt.ffmpeg, args);
+        if (!process.waitForStarted())
+            qWarning("failed to start %s", qPrintable(opt.ffmpeg));
+    }
+    ~Server() {
+        if (process.state() == QProcess::NotRunning)
+            return;
+        process.terminate();
+        if (!process.waitForFinished(2000))
+            process.kill();
+    }
+    QString url;
+private:
+    QProcess process;
+};
+
+// testsrc2 clip, 1 key frame per second and no b-frames like a camera
+static QString prepareClip(const Options& opt)
+{
+    const QString clip(QStringLiteral("%1/testsrc2_%2x%3_%4.ts").arg(opt.dir).arg(opt.width).arg(opt.height).arg(opt.fps));
+    if (QFile::exists(clip))
+        return clip;
+    QStringList args;
+    args << QStringLiteral("-hide_banner") << QStringLiteral("-loglevel") << QStringLiteral("error") << QStringLiteral("-y")
+         << QStringLiteral("-f") << QStringLiteral("lavfi")
+         << QStringLiteral("-i") << QStringLiteral("testsrc2=size=%1x%2:rate=%3").arg(opt.width).arg(opt.height).arg(opt.fps)
+         << QStringLiteral("-t") << QStringLiteral("20")
+         << QStringLiteral("-c:v") << QStringLiteral("libx264") << QStringLiteral("-preset") << QStringLiteral("veryfast")
+         << QStringLiteral("-tune") << QStringLiteral("zerolatency") << QStringLiteral("-pix_fmt") << QStringLiteral("yuv420p")
+         << QStringLiteral("-g") << QString::number(opt.fps) << QStringLiteral("-bf") << QStringLiteral("0")
+         << QStringLiteral("-b:v") << QStringLiteral("4M") << clip;
+    printf("generating %s\n", qPrintable(clip));
+    fflush(0);
+    if (QProcess::execute(opt.ffmpeg, args) != 0) {
+        qWarning("failed to generate test clip with %s", qPrintable(opt.ffmpeg));
+        return QString();
+    }
+    return clip;
+}
+
+struct Stream {
+    Server *server;
+    AVPlayer *player;
+    ProbeRenderer *probe;
+    VideoRenderer *vo;
+    qint64 presented;
+    qint64 dropped;
+    qint64 lost;
+};
+
+static qint64 mediaValue(AVPlayer *player, const char* key)
+{
+    return player->mediaData().value(QString::fromLatin1(key)).toLongLong();
+}
+
+static double percentile(QVector<double> v, int p)
+{
+    if (v.isEmpty())
+        return -1;
+    std::sort(v.begin(), v.end());
+    return v.at(qMin(v.size() - 1, v.size()*p/100));
+}
+
+static QJsonObject run(const Options& opt, const QString& clip, int n)
+{
+    QList<Stream> streams;
+    for (int i = 0; i < n; ++i) {
+        Stream s;
+        s.server = new Server(opt, i, clip);
+        s.player = new AVPlayer();
+        s.player->setRealtimeDecode(true);
+        s.player->setRelativeTimeMode(false);
+        s.player->audio()->setBackends(QStringList() << QStringLiteral("null"));
+        if (opt.buffer >= 0)
+            s.player->setBufferValue(opt.buffer);
+        if (opt.threads >= 0) {
+            QVariantHash ffopt, opts;
+            ffopt[QStringLiteral("threads")] = opt.threads;
+            opts[QStringLiteral("FFmpeg")] = ffopt;
+            s.player->setOptionsForVideoCodec(opts);
+        }
+        s.probe = new ProbeRenderer();
+        s.player->addVideoRenderer(s.probe);
+        s.vo = 0;
+        if (!opt.vo.isEmpty()) {
+            s.vo = VideoRenderer::create(opt.vo.toLatin1().constData());
+            if (s.vo) {
+                s.vo->resizeRenderer(opt.width/4, opt.height/4);
+                if (s.vo->qwindow())
+                    s.vo->qwindow()->show();
+                s.player->addVideoRenderer(s.vo);
+            } else {
+                qWarning("can not create renderer %s", qPrintable(opt.vo));
+            }
+        }
+        streams.append(s);
+    }
+    wait(500); // servers are listening
+    foreach (const Stream& s, streams) {
+        s.player->play(s.server->url);
+    }
+    wait(opt.warmup*1000);
+
+    for (int i = 0; i < streams.size(); ++i) {
+        Stream &s = streams[i];
+        s.probe->reset();
+        s.presented = s.vo ? s.vo->presentedFrames() : 0;
+        s.dropped = mediaValue(s.player, "droppedFrames");
+        s.lost = mediaValue(s.player, "lostFrames");
+    }
+    const qint64 cpu0 = cpuTime();
+    QElapsedTimer timer;
+    timer.start();
+    wait(opt.seconds*1000);
+    const double elapsed = double(timer.elapsed())/1000.0;
+    const double cpu = double(cpuTime() - cpu0)/1e4/elapsed; // percent of 1 core
+    const qint64 mem = rss();
+
+    QJsonArray per_stream;
+    QVector<double> all_latency;
+    double total_fps = 0, min_fps = -1;
+    qint64 total_dropped = 0, total_lost = 0;
+    int healthy = 0;
+    foreach (const Stream& s, streams) {
+        const double fps = double(s.probe->frameCount())/elapsed;
+        const QVector<double> latency(s.probe->latency());
+        all_latency += latency;
+        QJsonObject o;
+        o[QStringLiteral("url")] = s.server->url;
+        o[QStringLiteral("fps")] = fps;
+        if (s.vo)
+            o[QStringLiteral("presented_fps")] = double(s.vo->presentedFrames() - s.presented)/elapsed;
+        const qint64 dropped = mediaValue(s.player, "droppedFrames") - s.dropped;
+        const qint64 lost = mediaValue(s.player, "lostFrames") - s.lost;
+        o[QStringLiteral("dropped_frames")] = dropped;
+        o[QStringLiteral("lost_frames")] = lost;
+        o[QStringLiteral("latency_p50_ms")] = percentile(latency, 50);
+        o[QStringLiteral("latency_p95_ms")] = percentile(latency, 95);
+        per_stream.append(o);
+        total_fps += fps;
+        min_fps = min_fps < 0 ? fps : qMin(min_fps, fps);
+        total_dropped += dropped;
+        total_lost += lost;
+        if (fps >= 0.9*opt.fps)
+            ++healthy;
+    }
+    QJsonObject r;
+    r[QStringLiteral("streams")] = n;
+    r[QStringLiteral("healthy_streams")] = healthy; // at least 90% of source fps
+    r[QStringLiteral("total_fps")] = total_fps;
+    r[QStringLiteral("min_fps")] = min_fps;
+    r[QStringLiteral("dropped_frames")] = total_dropped;
+    r[QStringLiteral("lost_frames")] = total_lost;
+    r[QStringLiteral("latency_p50_ms")] = percentile(all_latency, 50);
+    r[QStringLiteral("latency_p95_ms")] = percentile(all_latency, 95);
+    r[QStringLiteral("rss_mb")] = double(mem)/1048576.0;
+    r[QStringLiteral("cpu_percent")] = cpu;
+    r[QStringLiteral("per_stream")] = per_stream;
+    printf("%6d %8d %10.1f %8.1f %8lld %8lld %10.1f %10.1f %8.1f %8.1f\n", n, healthy, total_fps, min_fps, total_dropped, total_lost
+           , percentile(all_latency, 50), percentile(all_latency, 95), double(mem)/1048576.0, cpu);
+    fflush(0);
+
+    foreach (const Stream& s, streams) {
+        s.player->stop();
+    }
+    wait(500);
+    foreach (const Stream& s, streams) {
+        delete s.player;
+        delete s.probe;
+        delete s.vo;
+        delete s.server;
+    }
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    qDebug("parameters: [-n 1,2,4,8,16,32] [-p udp|http|rtsp] [-rtsp-server rtsp://127.0.0.1:8554] [-url url1,url2]"
+           " [-s 1920x1080] [-r 25] [-w warmup seconds] [-t seconds] [-threads decoder threads] [-buffer packets] [-vo renderer] [-ffmpeg path] [-o result.json]");
+    qDebug("stops when less than half of the streams reach 90%% of source fps");
+    setLogLevel(LogWarning);
+    const QStringList args = app.arguments();
+    Options opt;
+    opt.ffmpeg = QStringLiteral("ffmpeg");
+    opt.protocol = QStringLiteral("udp");
+    opt.rtsp_server = QStringLiteral("rtsp://127.0.0.1:8554");
+    opt.dir = QDir::tempPath() + QStringLiteral("/qtav_camerawall");
+    opt.width = 1920;
+    opt.height = 1080;
+    opt.fps = 25;
+    opt.warmup = 5;
+    opt.seconds = 10;
+    opt.threads = -1;
+    opt.buffer = -1;
+    QList<int> ramp = QList<int>() << 1 << 2 << 4 << 8 << 16 << 32;
+    QString out;
+    for (int i = 1; i < args.size() - 1; ++i) {
+        const QString& a = args.at(i);
+        const QString& v = args.at(i + 1);
+        if (a == QLatin1String("-n")) {
+            ramp.clear();
+            foreach (const QString& x, v.split(QLatin1Char(','))) {
+                if (x.toInt() > 0)
+                    ramp.append(x.toInt());
+            }
+        } else if (a == QLatin1String("-p")) {
+            opt.protocol = v;
+        } else if (a == QLatin1String("-rtsp-server")) {
+            opt.rtsp_server = v;
+        } else if (a == QLatin1String("-url")) {
+            opt.urls = v.split(QLatin1Char(','));
+        } else if (a == QLatin1String("-s")) {
+            const QStringList wh(v.split(QLatin1Char('x')));
+            if (wh.size() == 2) {
+                opt.width = wh.at(0).toInt();
+                opt.height = wh.at(1).toInt();
+            }
+        } else if (a == QLatin1String("-r")) {
+            opt.fps = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-w")) {
+            opt.warmup = qMax(0, v.toInt());
+        } else if (a == QLatin1String("-t")) {
+            opt.seconds = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-threads")) {
+            opt.threads = v.toInt();
+        } else if (a == QLatin1String("-buffer")) {
+            opt.buffer = v.toLongLong();
+        } else if (a == QLatin1String("-vo")) {
+            opt.vo = v;
+        } else if (a == QLatin1String("-ffmpeg")) {
+            opt.ffmpeg = v;
+        } else if (a == QLatin1String("-o")) {
+            out = v;
+        } else {
+            continue;
+        }
+        ++i;
+    }
+    QDir().mkpath(opt.dir);
+    QString clip;
+    if (opt.urls.isEmpty()) {
+        clip = prepareClip(opt);
+        if (clip.isEmpty())
+            return 1;
+    }
+    printf("%6s %8s %10s %8s %8s %8s %10s %10s %8s %8s\n", "N", "healthy", "total fps", "min fps", "dropped", "lost", "p50(ms)", "p95(ms)", "RSS(MB)", "CPU%");
+    QJsonArray curve;
+    foreach (int n, ramp) {
+        const QJsonObject r(run(opt, clip, n));
+        curve.append(r);
+        if (r.value(QStringLiteral("healthy_streams")).toInt()*2 < n) // saturated
+            break;
+    }
+    QJsonObject result;
+    result[QStringLiteral("qtav")] = QtAV_Version_String_Long();
+    result[QStringLiteral("protocol")] = opt.urls.isEmpty() ? opt.protocol : QStringLiteral("external");
+    result[QStringLiteral("size")] = QStringLiteral("%1x%2").arg(opt.width).arg(opt.height);
+    result[QStringLiteral("fps")] = opt.fps;
+    result[QStringLiteral("renderer")] = opt.vo.isEmpty() ? QStringLiteral("null") : opt.vo;
+    result[QStringLiteral("decoder_threads")] = opt.threads;
+    result[QStringLiteral("buffer")] = opt.buffer;
+    result[QStringLiteral("curve")] = curve;
+    if (!out.isEmpty()) {
+        QFile f(out);
+        const QByteArray json(QJsonDocument(result).toJson());
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+            qWarning("failed to write %s", qPrintable(out));
+            return 1;
+        }
+        printf("result: %s\n", qPrintable(out));
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QTimer>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/VideoCapture.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+// snapshot all players at once, repeat rounds times
+class Runner : public QObject
+{
+public:
+    Runner(const QList<AVPlayer*>& players, int rounds)
+        : rounds_left(rounds)
+    {
+        foreach (AVPlayer *p, players) {
+            captures.append(p->videoCapture());
+        }
+        connect(&batch, &VideoCaptureBatch::finished, this, &Runner::report);
+    }
+    void start() {
+        batch.capture(captures);
+    }
+private:
+    void report() {
+        qint64 min = -1, max = 0, sum = 0;
+        int ok = 0;
+        foreach (const VideoCaptureBatch::Result& r, batch.results()) {
+            printf("  %s @%.3f frame: %lldms, done: %lldms %s\n", r.ok ? "ok" : "FAILED", r.timestamp, r.frameLatency, r.latency, qPrintable(r.path));
+            if (!r.ok)
+                continue;
+            ++ok;
+            sum += r.latency;
+            max = qMax(max, r.latency);
+            min = min < 0 ? r.latency : qMin(min, r.latency);
+        }
+        printf("batch of %d: %d saved in %lldms. latency min: %lldms, avg: %lldms, max: %lldms\n"
+               , captures.size(), ok, batch.elapsed(), min, ok ? sum/ok : 0, max);
+        fflush(0);
+        if (--rounds_left > 0)
+            QTimer::singleShot(500, this, &Runner::start);
+        else
+            qApp->quit();
+    }
+
+    int rounds_left;
+    QList<VideoCapture*> captures;
+    VideoCaptureBatch batch;
+};
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n players] [-f format] [-q quality] [-r rounds] [-o dir] file");
+    qDebug("format: jpg(default), webp, png etc.");
+    const QStringList args = app.arguments();
+    if (args.size() < 2) {
+        qWarning("no input file");
+        return 1;
+    }
+    int nb_players = 16;
+    int rounds = 3;
+    int quality = -1;
+    QString format = QStringLiteral("jpg");
+    QString dir = QDir::tempPath() + QStringLiteral("/qtav_capture");
+    for (int i = 1; i < args.size() - 2; ++i) {
+        if (args.at(i) == QLatin1String("-n"))
+            nb_players = qMax(1, args.at(++i).toInt());
+        else if (args.at(i) == QLatin1String("-f"))
+            format = args.at(++i);
+        else if (args.at(i) == QLatin1String("-q"))
+            quality = args.at(++i).toInt();
+        else if (args.at(i) == QLatin1String("-r"))
+            rounds = qMax(1, args.at(++i).toInt());
+        else if (args.at(i) == QLatin1String("-o"))
+            dir = args.at(++i);
+    }
+    qDebug("%d players, save as %s to %s", nb_players, qPrintable(format), qPrintable(dir));
+    QList<AVPlayer*> players;
+    for (int i = 0; i < nb_players; ++i) {
+        AVPlayer *player = new AVPlayer(&app);
+        player->setFile(args.last());
+        player->videoCapture()->setCaptureDir(dir);
+        player->videoCapture()->setCaptureName(QStringLiteral("player%1_").arg(i));
+        player->videoCapture()->setSaveFormat(format);
+        player->videoCapture()->setQuality(quality);
+        player->audio()->setBackends(QStringList() << QStringLiteral("null"));
+        player->play();
+        players.append(player);
+    }
+    Runner runner(players, rounds);
+    QTimer::singleShot(2000, &runner, &Runner::start); // wait for playback
+    const int ret = app.exec();
+    foreach (AVPlayer *player, players) {
+        player->stop();
+    }
+    return ret;
+}
@@ -0,0 +1,252 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtAV/AVMuxer.h>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/VideoEncoder.h>
+#include <QtAV/VideoRenderer.h>
+#include <QtDebug>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+using namespace QtAV;
+
+/*
+ * Source switch latency of AVPlayer with and without the decoder pool, like a camera tour. Clips with the same codec
+ * parameters are played one after another, and the time from play() to the first frame received by the renderer is
+ * measured. Stopping the previous source is not measured. The first frame must be the first frame of the new clip, i.e. no
+ * frame of the previous clip is left in a parked decoder.
+ */
+
+static const VideoRendererId kProbeRendererId = 0x7072626e; // "prbn"
+static const QSize kProbeSize(64, 36);
+
+class ProbeRenderer : public VideoRenderer
+{
+public:
+    ProbeRenderer() : frames(0) {}
+    VideoRendererId id() const Q_DECL_OVERRIDE { return kProbeRendererId; }
+    bool isSupported(VideoFormat::PixelFormat pixfmt) const Q_DECL_OVERRIDE { return pixfmt != VideoFormat::Format_Invalid; }
+    std::atomic<int> frames;
+    VideoFrame first; // downscaled rgb. set before frames is increased
+protected:
+    bool receiveFrame(const VideoFrame& frame) Q_DECL_OVERRIDE {
+        if (frames == 0)
+            first = frame.to(VideoFormat::Format_RGB32, kProbeSize);
+        ++frames;
+        return true;
+    }
+    void drawFrame() Q_DECL_OVERRIDE {}
+};
+
+// gradient with a moving square. n shifts the content, so clips are different
+static VideoFrame testFrame(int w, int h, int n)
+{
+    QByteArray buf(w*h*3/2, 0x80);
+    quint8 *y = (quint8*)buf.data(); //must before buf is shared
+    for (int j = 0; j < h; ++j) {
+        for (int i = 0; i < w; ++i)
+            y[j*w + i] = quint8((i + j + n*4) & 0xff);
+    }
+    const int s = h/8;
+    const int x0 = (n*7) % (w - s), y0 = (n*3) % (h - s);
+    for (int j = y0; j < y0 + s; ++j)
+        memset(y + j*w + x0, 235, s);
+    VideoFrame f(w, h, VideoFormat(VideoFormat::Format_YUV420P), buf);
+    f.setBits(y, 0);
+    f.setBits(y + w*h, 1);
+    f.setBits(y + w*h*5/4, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setTimestamp(qreal(n)/VideoEncoder::defaultFrameRate());
+    return f;
+}
+
+static bool generate(const QString& file, const QString& codec, const QSize& size, int frames, int offset)
+{
+    QScopedPointer<VideoEncoder> venc(VideoEncoder::create("FFmpeg"));
+    venc->setCodecName(codec);
+    QVariantHash avcodec;
+    avcodec[QStringLiteral("preset")] = QStringLiteral("ultrafast");
+    QVariantHash opt;
+    opt[QStringLiteral("avcodec")] = avcodec;
+    venc->setOptions(opt);
+    venc->setWidth(size.width());
+    venc->setHeight(size.height());
+    venc->setFrameRate(VideoEncoder::defaultFrameRate());
+    venc->setBitRate(size.width()*size.height()*4);
+    if (!venc->open()) {
+        qWarning("failed to open encoder %s", qPrintable(codec));
+        return false;
+    }
+    AVMuxer mux;
+    mux.setMedia(file);
+    mux.copyProperties(venc.data());
+    if (!mux.open())
+        return false;
+    for (int i = 0; i <= frames; ++i) {
+        VideoFrame frame;
+        if (i < frames) {
+            frame = testFrame(size.width(), size.height(), i + offset);
+            if (frame.pixelFormat() != venc->pixelFormat())
+                frame = frame.to(venc->pixelFormat());
+        }
+        while (venc->encode(frame)) {
+            mux.writeVideo(venc->encoded());
+            if (frame.isValid())
+                break;
+        }
+    }
+    mux.close();
+    return true;
+}
+
+static qint64 difference(const VideoFrame& a, const VideoFrame& b)
+{
+    if (!a.constBits(0) || !b.constBits(0) || a.size() != b.size())
+        return std::numeric_limits<qint64>::max();
+    qint64 d = 0;
+    for (int j = 0; j < a.height(); ++j) {
+        const quint8 *pa = a.constBits(0) + j*a.bytesPerLine(0);
+        const quint8 *pb = b.constBits(0) + j*b.bytesPerLine(0);
+        for (int i = 0; i < a.width()*4; ++i)
+            d += qAbs(int(pa[i]) - int(pb[i]));
+    }
+    return d;
+}
+
+// index of the reference nearest to the frame
+static int nearest(const VideoFrame& frame, const QVector<VideoFrame>& refs)
+{
+    int index = -1;
+    qint64 dmin = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < refs.size(); ++i) {
+        const qint64 d = difference(frame, refs.at(i));
+        if (d < dmin) {
+            dmin = d;
+            index = i;
+        }
+    }
+    return index;
+}
+
+static double percentile(QVector<double> v, int p)
+{
+    if (v.isEmpty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    return v.at(qMin(v.size() - 1, v.size()*p/100));
+}
+
+// ms from play() to the first frame of each switch. < 0: timeout. mismatches: first frames not from the new clip
+static QVector<double> tour(AVPlayer *player, ProbeRenderer *vo, const QStringList& files, const QVector<VideoFrame>& refs, int switches, int *mismatches)
+{
+    QVector<double> latency;
+    *mismatches = 0;
+    for (int i = 0; i < switches; ++i) {
+        player->stop();
+        vo->first = VideoFrame();
+        vo->frames = 0;
+        QElapsedTimer timer;
+        timer.start();
+        player->play(files.at(i % files.size()));
+        while (vo->frames == 0 && timer.elapsed() < 5000) {
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+        latency.append(vo->frames > 0 ? double(timer.nsecsElapsed())/1e6 : -1.0);
+        if (vo->frames > 0 && nearest(vo->first, refs) != i % files.size())
+            ++*mismatches;
+    }
+    player->stop();
+    return latency;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n switches] [-clips 4] [-size 1920x1080] [-codec h264] [-decoders FFmpeg,VAAPI...]");
+    const QStringList args(app.arguments());
+    int switches = 40;
+    int clips = 4;
+    QSize size(1920, 1080);
+    QString codec = QStringLiteral("h264");
+    QStringList decoders;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args.at(i);
+        const QString v = i + 1 < args.size() ? args.at(i + 1) : QString();
+        if (a == QLatin1String("-n")) {
+            switches = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-clips")) {
+            clips = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-size")) {
+            const QStringList wh(v.split(QLatin1Char('x')));
+            if (wh.size() == 2)
+                size = QSize(wh.at(0).toInt() & ~1, wh.at(1).toInt() & ~1);
+        } else if (a == QLatin1String("-codec")) {
+            codec = v;
+        } else if (a == QLatin1String("-decoders")) {
+            decoders = v.split(QLatin1Char(','));
+        } else {
+            continue;
+        }
+        ++i;
+    }
+    QStringList files;
+    QVector<VideoFrame> refs;
+    for (int i = 0; i < clips; ++i) {
+        const QString file = QDir::temp().filePath(QStringLiteral("decoderpool-%1-%2.mp4").arg(codec).arg(i));
+        if (!generate(file, codec, size, 50, i*100)) {
+            qWarning("failed to generate %s", qPrintable(file));
+            return 1;
+        }
+        files.append(file);
+        refs.append(testFrame(size.width(), size.height(), i*100).to(VideoFormat::Format_RGB32, kProbeSize));
+    }
+    ProbeRenderer vo;
+    AVPlayer player;
+    player.addVideoRenderer(&vo);
+    if (!decoders.isEmpty())
+        player.setVideoDecoderPriority(decoders);
+    bool ok = true;
+    QJsonObject result;
+    const int capacity[] = { 0, 16 };
+    for (size_t c = 0; c < sizeof(capacity)/sizeof(capacity[0]); ++c) {
+        AVPlayer::setDecoderPoolCapacity(capacity[c], true); // -decoders may select hardware decoders
+        const QVariantMap stats0(AVPlayer::decoderPoolStatistics());
+        int mismatches = 0;
+        const QVector<double> latency(tour(&player, &vo, files, refs, switches, &mismatches));
+        const QVariantMap stats(AVPlayer::decoderPoolStatistics());
+        const int timeouts = std::count(latency.begin(), latency.end(), -1.0);
+        QJsonObject r;
+        r[QStringLiteral("capacity")] = capacity[c];
+        r[QStringLiteral("switches")] = latency.size();
+        r[QStringLiteral("timeouts")] = timeouts;
+        r[QStringLiteral("mismatches")] = mismatches;
+        r[QStringLiteral("p50_ms")] = percentile(latency, 50);
+        r[QStringLiteral("p95_ms")] = percentile(latency, 95);
+        r[QStringLiteral("max_ms")] = percentile(latency, 100);
+        r[QStringLiteral("hits")] = stats.value(QStringLiteral("hits")).toLongLong() - stats0.value(QStringLiteral("hits")).toLongLong();
+        r[QStringLiteral("misses")] = stats.value(QStringLiteral("misses")).toLongLong() - stats0.value(QStringLiteral("misses")).toLongLong();
+        result[capacity[c] > 0 ? QStringLiteral("pooled") : QStringLiteral("cold")] = r;
+        printf("%s: switch to first frame p50 %.1fms p95 %.1fms, %d timeouts, %d first frames of other clips, pool hits %lld\n"
+               , capacity[c] > 0 ? "pooled" : "cold  ", percentile(latency, 50), percentile(latency, 95), timeouts, mismatches
+               , r.value(QStringLiteral("hits")).toVariant().toLongLong());
+        ok &= timeouts == 0 && mismatches == 0;
+        if (capacity[c] > 0)
+            ok &= r.value(QStringLiteral("hits")).toVariant().toLongLong() > 0;
+    }
+    printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+    foreach (const QString& file, files) {
+        QFile::remove(file);
+    }
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
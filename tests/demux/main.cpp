@@ -0,0 +1,57 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/Packet.h>
+
+using namespace QtAV;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    qDebug() << "help: ./demux -f file [-io protocols] [-n count]";
+    qDebug() << "-io: comma separated MediaIO protocols to compare, e.g. 'file,mmap,readahead'. 'file' is FFmpeg file protocol";
+    qDebug() << "-n: demux the file n times for each protocol";
+    qDebug() << "drop page cache (echo 3 >/proc/sys/vm/drop_caches) to measure cold reads";
+    QString file;
+    int idx = a.arguments().indexOf(QLatin1String("-f"));
+    if (idx > 0)
+        file = a.arguments().at(idx + 1);
+    if (file.isEmpty())
+        return 1;
+    QStringList ios = QStringList() << QStringLiteral("file") << QStringLiteral("mmap") << QStringLiteral("readahead");
+    idx = a.arguments().indexOf(QLatin1String("-io"));
+    if (idx > 0)
+        ios = a.arguments().at(idx + 1).split(QLatin1Char(','));
+    int count = 1;
+    idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = qMax(1, a.arguments().at(idx + 1).toInt());
+
+    foreach (const QString& io, ios) {
+        for (int n = 0; n < count; ++n) {
+            AVDemuxer demux;
+            demux.setMedia(io == QLatin1String("file") ? file : QStringLiteral("%1:%2").arg(io).arg(file));
+            QElapsedTimer timer;
+            timer.start();
+            if (!demux.load()) {
+                qWarning("%s: failed to load file: %s", io.toUtf8().constData(), file.toUtf8().constData());
+                break;
+            }
+            const qint64 t_load = timer.elapsed();
+            qint64 packets = 0, bytes = 0;
+            while (!demux.atEnd()) {
+                if (!demux.readFrame())
+                    continue;
+                ++packets;
+                bytes += demux.packet().data.size();
+            }
+            const qint64 t = qMax<qint64>(1, timer.elapsed());
+            printf("%-10s load: %lldms, demux: %lldms, %lld packets, %.1f packets/s, %.1f MB/s\n", io.toUtf8().constData()
+                   , t_load, t, packets, packets*1000.0/t, bytes*1000.0/t/1024.0/1024.0);
+            fflush(0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+#include <QtAV/private/FrameMailbox.h>
+#include <QtDebug>
+#include <atomic>
+
+using namespace QtAV;
+
+// video thread: put frames as fast as possible, or with an interval
+class Producer : public QThread
+{
+public:
+    Producer(FrameMailbox *mb, int count, int interval_us) : mailbox(mb), frames(count), interval(interval_us) {}
+    std::atomic<int> dropped{0};
+protected:
+    void run() Q_DECL_OVERRIDE {
+        for (int i = 1; i <= frames; ++i) {
+            VideoFrame f(4, 4, VideoFormat(VideoFormat::Format_Y8), QByteArray(16, 0));
+            f.setTimestamp(qreal(i));
+            f.setMetaData(QStringLiteral("id"), i);
+            if (mailbox->put(f))
+                ++dropped;
+            if (interval > 0)
+                usleep(interval);
+        }
+    }
+private:
+    FrameMailbox *mailbox;
+    int frames;
+    int interval;
+};
+
+// returns false if a frame is taken twice, out of order or corrupted
+static bool run(int frames, int producer_interval_us, int consumer_interval_us)
+{
+    FrameMailbox mailbox;
+    Producer producer(&mailbox, frames, producer_interval_us);
+    QElapsedTimer timer;
+    timer.start();
+    producer.start();
+    int taken = 0;
+    qreal last = 0;
+    bool ok = true;
+    while (true) {
+        const bool done = producer.isFinished();
+        VideoFrame f;
+        if (mailbox.take(&f)) {
+            ++taken;
+            if (f.timestamp() <= last) {
+                qWarning("frame %.0f after %.0f", f.timestamp(), last);
+                ok = false;
+            }
+            if (f.metaData(QStringLiteral("id")).toInt() != int(f.timestamp())) {
+                qWarning("corrupted frame %.0f", f.timestamp());
+                ok = false;
+            }
+            last = f.timestamp();
+        } else if (done) {
+            break;
+        }
+        if (consumer_interval_us > 0)
+            QThread::usleep(consumer_interval_us);
+    }
+    producer.wait();
+    // every frame is either taken or dropped
+    if (taken + producer.dropped != frames) {
+        qWarning("taken %d + dropped %d != %d", taken, int(producer.dropped), frames);
+        ok = false;
+    }
+    if (last != qreal(frames)) {
+        qWarning("last frame %.0f is not taken", last);
+        ok = false;
+    }
+    printf("producer %dus, consumer %dus: %d frames, presented: %d, dropped: %d, %lldms %s\n", producer_interval_us, consumer_interval_us
+           , frames, taken, int(producer.dropped), timer.elapsed(), ok ? "" : "FAILED");
+    fflush(0);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n frames]");
+    int frames = 200000;
+    const int idx = app.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0 && idx + 1 < app.arguments().size())
+        frames = qMax(1, app.arguments().at(idx + 1).toInt());
+    bool ok = true;
+    ok &= run(frames, 0, 0);
+    ok &= run(frames/100, 0, 100); // slow renderer: most frames are dropped
+    ok &= run(frames/100, 100, 0); // fast renderer: few drops
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QThread>
+#include <QtAV/AVMuxer.h>
+#include <QtAV/FrameReader.h>
+#include <QtAV/VideoEncoder.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+/*
+ * Throughput of FrameReader in frames/s. Every source is read in serial mode (demux and decode in 1 thread), in
+ * pipelined mode, and in pipelined mode with parallel decoders (intra-only codecs) and converters.
+ * Sources are generated locally (h264 and mjpeg, 1080p and 4K) unless files are given by -i.
+ * All runs of a source must get the same frames in the same order.
+ */
+
+// gradient with a moving square. width and height must be even
+static VideoFrame testFrame(int w, int h, int n)
+{
+    QByteArray buf(w*h*3/2, 0x80);
+    quint8 *y = (quint8*)buf.data(); //must before buf is shared
+    for (int j = 0; j < h; ++j) {
+        for (int i = 0; i < w; ++i)
+            y[j*w + i] = quint8((i + j + n*4) & 0xff);
+    }
+    const int s = h/8;
+    const int x0 = (n*7) % (w - s), y0 = (n*3) % (h - s);
+    for (int j = y0; j < y0 + s; ++j)
+        memset(y + j*w + x0, 235, s);
+    VideoFrame f(w, h, VideoFormat(VideoFormat::Format_YUV420P), buf);
+    f.setBits(y, 0);
+    f.setBits(y + w*h, 1);
+    f.setBits(y + w*h*5/4, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setTimestamp(qreal(n)/VideoEncoder::defaultFrameRate());
+    return f;
+}
+
+static bool generate(const QString& file, const QString& codec, const QSize& size, int frames)
+{
+    QScopedPointer<VideoEncoder> venc(VideoEncoder::create("FFmpeg"));
+    if (!VideoEncoder::supportedCodecs().contains(codec)) {
+        qWarning("no encoder %s", qPrintable(codec));
+        return false;
+    }
+    venc->setCodecName(codec);
+    QVariantHash avcodec;
+    avcodec[QStringLiteral("preset")] = QStringLiteral("ultrafast");
+    QVariantHash opt;
+    opt[QStringLiteral("avcodec")] = avcodec;
+    venc->setOptions(opt);
+    venc->setWidth(size.width());
+    venc->setHeight(size.height());
+    venc->setFrameRate(VideoEncoder::defaultFrameRate());
+    venc->setBitRate(size.width()*size.height()*4);
+    if (!venc->open()) {
+        qWarning("failed to open encoder %s", qPrintable(codec));
+        return false;
+    }
+    AVMuxer mux;
+    mux.setMedia(file);
+    mux.copyProperties(venc.data());
+    if (!mux.open()) {
+        qWarning("failed to open muxer for %s", qPrintable(file));
+        return false;
+    }
+    for (int i = 0; i <= frames; ++i) {
+        VideoFrame frame;
+        if (i < frames) {
+            frame = testFrame(size.width(), size.height(), i);
+            if (frame.pixelFormat() != venc->pixelFormat())
+                frame = frame.to(venc->pixelFormat());
+        }
+        // an invalid frame to get delayed packets at last
+        while (venc->encode(frame)) {
+            mux.writeVideo(venc->encoded());
+            if (frame.isValid())
+                break;
+        }
+    }
+    mux.close();
+    return true;
+}
+
+struct Run {
+    QString name;
+    bool pipelined;
+    int decoders;
+    int converters;
+};
+
+// timestamps of frames read
+static QJsonObject read(const QString& file, const Run& run, VideoFormat::PixelFormat fmt, int queue, QVector<qreal> *pts, QSize *size)
+{
+    FrameReader reader;
+    reader.setMedia(file);
+    reader.setPipelined(run.pipelined);
+    reader.setDecoderThreads(run.decoders);
+    reader.setConverterThreads(run.converters);
+    reader.setPacketQueueSize(queue*4);
+    reader.setFrameQueueSize(queue);
+    reader.setOutputFormat(fmt);
+    QElapsedTimer timer;
+    timer.start();
+    while (reader.readMore()) {
+        const VideoFrame f(reader.getVideoFrame());
+        if (!f)
+            continue;
+        if (pts->isEmpty())
+            *size = f.size();
+        pts->append(f.timestamp());
+    }
+    while (reader.hasVideoFrame()) {
+        const VideoFrame f(reader.getVideoFrame());
+        if (f)
+            pts->append(f.timestamp());
+    }
+    const qint64 ns = timer.nsecsElapsed();
+    QJsonObject o;
+    o[QStringLiteral("mode")] = run.name;
+    o[QStringLiteral("decoders")] = run.decoders;
+    o[QStringLiteral("converters")] = run.converters;
+    o[QStringLiteral("frames")] = pts->size();
+    o[QStringLiteral("ms")] = double(ns)/1e6;
+    o[QStringLiteral("fps")] = ns > 0 ? double(pts->size())*1e9/double(ns) : 0.0;
+    return o;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-i file1,file2...] [-n frames] [-codecs h264,mjpeg] [-sizes 1920x1080,3840x2160] [-threads N] [-format rgb32|rgb24|yuv420p|none] [-queue 4] [-o result.json]");
+    const QStringList args(app.arguments());
+    QStringList files;
+    QStringList codecs = QStringList() << QStringLiteral("h264") << QStringLiteral("mjpeg");
+    QList<QSize> sizes = QList<QSize>() << QSize(1920, 1080) << QSize(3840, 2160);
+    int frames = 240;
+    int threads = qMax(2, QThread::idealThreadCount());
+    int queue = 4;
+    VideoFormat::PixelFormat fmt = VideoFormat::Format_RGB32;
+    QString out;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args.at(i);
+        const QString v = i + 1 < args.size() ? args.at(i + 1) : QString();
+        if (a == QLatin1String("-i")) {
+            files = v.split(QLatin1Char(','));
+        } else if (a == QLatin1String("-n")) {
+            frames = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-codecs")) {
+            codecs = v.split(QLatin1Char(','));
+        } else if (a == QLatin1String("-sizes")) {
+            sizes.clear();
+            foreach (const QString& s, v.split(QLatin1Char(','))) {
+                const QStringList wh(s.split(QLatin1Char('x')));
+                if (wh.size() == 2)
+                    sizes.append(QSize(wh.at(0).toInt() & ~1, wh.at(1).toInt() & ~1));
+            }
+        } else if (a == QLatin1String("-threads")) {
+            threads = qMax(1, v.toInt());
+        } else if (a == QLatin1String("-format")) {
+            if (v == QLatin1String("rgb24"))
+                fmt = VideoFormat::Format_RGB24;
+            else if (v == QLatin1String("yuv420p"))
+                fmt = VideoFormat::Format_YUV420P;
+            else if (v == QLatin1String("none"))
+                fmt = VideoFormat::Format_Invalid;
+            else
+                fmt = VideoFormat::Format_RGB32;
+        } else if (a == QLatin1String("-queue")) {
+            queue = qMax(2, v.toInt());
+        } else if (a == QLatin1String("-o")) {
+            out = v;
+        } else {
+            continue;
+        }
+        ++i;
+    }
+    QStringList generated;
+    if (files.isEmpty()) {
+        foreach (const QString& codec, codecs) {
+            foreach (const QSize& size, sizes) {
+                const QString file = QDir::temp().filePath(QStringLiteral("framereader-%1-%2x%3.%4")
+                        .arg(codec).arg(size.width()).arg(size.height())
+                        .arg(codec == QLatin1String("mjpeg") ? QStringLiteral("avi") : QStringLiteral("mp4")));
+                qDebug("generating %s", qPrintable(file));
+                if (!generate(file, codec, size, frames))
+                    continue;
+                files.append(file);
+                generated.append(file);
+            }
+        }
+    }
+    const Run runs[] = {
+        { QStringLiteral("serial"), false, 1, 1 },
+        { QStringLiteral("pipelined"), true, 1, 1 },
+        { QStringLiteral("parallel"), true, threads, threads },
+    };
+    bool ok = !files.isEmpty();
+    QJsonArray results;
+    foreach (const QString& file, files) {
+        printf("%s\n", qPrintable(file));
+        QVector<qreal> pts0;
+        for (size_t i = 0; i < sizeof(runs)/sizeof(runs[0]); ++i) {
+            QVector<qreal> pts;
+            QSize size;
+            QJsonObject r(read(file, runs[i], fmt, queue, &pts, &size));
+            r[QStringLiteral("file")] = file;
+            r[QStringLiteral("width")] = size.width();
+            r[QStringLiteral("height")] = size.height();
+            r[QStringLiteral("format")] = fmt == VideoFormat::Format_Invalid ? QStringLiteral("decoded") : VideoFormat(fmt).name();
+            printf("  %-10s dec %2d conv %2d: %5d frames, %8.1f fps\n", qPrintable(runs[i].name)
+                   , runs[i].decoders, runs[i].converters, pts.size(), r.value(QStringLiteral("fps")).toDouble());
+            results.append(r);
+            if (pts.isEmpty()) {
+                qWarning("no frame is read from %s", qPrintable(file));
+                ok = false;
+            } else if (i == 0) {
+                pts0 = pts;
+            } else if (pts != pts0) {
+                qWarning("%s: frames are different from serial mode", qPrintable(runs[i].name));
+                ok = false;
+            }
+        }
+    }
+    if (!out.isEmpty()) {
+        QFile f(out);
+        if (f.open(QIODevice::WriteOnly))
+            f.write(QJsonDocument(results).toJson());
+    }
+    foreach (const QString& file, generated) {
+        QFile::remove(file);
+    }
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
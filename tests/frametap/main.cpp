@@ -0,0 +1,125 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtAV/VideoFrameTap.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+// yuv420p frame of solid color. the buffer is owned by the frame
+static VideoFrame solidFrame(int w, int h, quint8 y, quint8 u, quint8 v, qreal pts)
+{
+    const VideoFormat fmt(VideoFormat::Format_YUV420P);
+    QByteArray buf(w*h*3/2, 0);
+    quint8 *p = (quint8*)buf.data();
+    memset(p, y, w*h);
+    memset(p + w*h, u, w*h/4);
+    memset(p + w*h*5/4, v, w*h/4);
+    VideoFrame f(w, h, fmt, buf);
+    f.setBits(p, 0);
+    f.setBits(p + w*h, 1);
+    f.setBits(p + w*h*5/4, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setTimestamp(pts);
+    return f;
+}
+
+// 25fps source tapped at 5fps, no conversion: frames are evenly picked and not copied
+static bool testSubsample()
+{
+    VideoFrameTap tap;
+    tap.setFrameRate(5);
+    tap.setQueueSize(1000);
+    const VideoFrame src(solidFrame(64, 36, 16, 128, 128, 0));
+    int picked = 0;
+    for (int i = 0; i < 250; ++i) {
+        VideoFrame f(src);
+        f.setTimestamp(qreal(i)/25.0 + 10.0);
+        picked += tap.put(f);
+    }
+    bool ok = picked == 50 && tap.pendingFrames() == 50 && tap.droppedFrames() == 0;
+    qreal last = 0;
+    while (tap.pendingFrames() > 0) {
+        const VideoFrame f(tap.takeFrame());
+        if (f.constBits(0) != src.constBits(0)) {
+            qWarning("frame @%.3f is copied", f.timestamp());
+            ok = false;
+        }
+        if (last > 0 && qAbs(f.timestamp() - last - 0.2) > 0.01) {
+            qWarning("frame @%.3f after %.3f", f.timestamp(), last);
+            ok = false;
+        }
+        last = f.timestamp();
+    }
+    // seek backward restarts sub-sampling
+    VideoFrame f(src);
+    f.setTimestamp(1.0);
+    ok &= tap.put(f);
+    printf("sub-sample: picked %d/250 %s\n", picked, ok ? "" : "FAILED");
+    return ok;
+}
+
+// 1280x720 yuv420p => rgb24 640x(auto) in worker thread
+static bool testConvert()
+{
+    VideoFrameTap tap;
+    tap.setFrameSize(QSize(640, 0));
+    QList<VideoFormat::PixelFormat> fmts;
+    fmts << VideoFormat::Format_RGB24 << VideoFormat::Format_BGR24;
+    tap.setPixelFormats(fmts);
+    tap.put(solidFrame(1280, 720, 235, 128, 128, 1.0)); // white
+    const VideoFrame f(tap.waitFrame(2000));
+    bool ok = f.isValid() && f.pixelFormat() == VideoFormat::Format_RGB24 && f.width() == 640 && f.height() == 360;
+    if (ok) {
+        const quint8 *p = f.constBits(0) + f.bytesPerLine(0)*180 + 320*3;
+        ok = p[0] > 240 && p[1] > 240 && p[2] > 240 && qFuzzyCompare(f.timestamp(), 1.0);
+    }
+    printf("convert: %s %dx%d %s\n", qPrintable(f.format().name()), f.width(), f.height(), ok ? "" : "FAILED");
+    return ok;
+}
+
+// a consumer never takes frames: put() does not block, the queue is bounded and the latest frames are kept
+static bool testSlowConsumer(int frames)
+{
+    VideoFrameTap tap;
+    tap.setFrameSize(QSize(960, 540));
+    tap.setPixelFormat(VideoFormat::Format_RGB32);
+    tap.setQueueSize(2);
+    const VideoFrame src(solidFrame(1920, 1080, 128, 128, 128, 0));
+    QElapsedTimer timer;
+    qint64 max_put = 0;
+    for (int i = 1; i <= frames; ++i) {
+        VideoFrame f(src);
+        f.setTimestamp(qreal(i)/25.0);
+        timer.start();
+        tap.put(f);
+        max_put = qMax(max_put, timer.nsecsElapsed());
+    }
+    VideoFrame last;
+    for (VideoFrame f = tap.waitFrame(2000); f.isValid(); f = tap.waitFrame(500))
+        last = f;
+    bool ok = tap.pendingFrames() == 0 && last.isValid() && qFuzzyCompare(last.timestamp(), qreal(frames)/25.0)
+            && tap.droppedFrames() > 0 && tap.deliveredFrames() + tap.droppedFrames() == frames
+            && max_put < 5000000LL;
+    printf("slow consumer: %d frames, delivered %lld, dropped %lld, max put() %lldus %s\n", frames
+           , tap.deliveredFrames(), tap.droppedFrames(), max_put/1000LL, ok ? "" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n frames]");
+    int frames = 1000;
+    const int idx = app.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0 && idx + 1 < app.arguments().size())
+        frames = qMax(1, app.arguments().at(idx + 1).toInt());
+    bool ok = true;
+    ok &= testSubsample();
+    ok &= testConvert();
+    ok &= testSlowConsumer(frames);
+    fflush(0);
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
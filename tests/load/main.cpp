@@ -0,0 +1,78 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/AVPlayer.h>
+
+using namespace QtAV;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    qDebug() << "help: ./load -i url1,url2,... [-n count] [-t threads] [-host perHost]";
+    qDebug() << "open every url n times with async load and print open latency percentiles, e.g. against a local rtsp/http server";
+    qDebug() << "stream parameters are cached after the first open. run again to compare latency of cached probe";
+    QStringList urls;
+    int idx = a.arguments().indexOf(QLatin1String("-i"));
+    if (idx > 0)
+        urls = a.arguments().at(idx + 1).split(QLatin1Char(','));
+    if (urls.isEmpty())
+        return 1;
+    int count = 100;
+    idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = qMax(1, a.arguments().at(idx + 1).toInt());
+    int threads = 8;
+    idx = a.arguments().indexOf(QLatin1String("-t"));
+    if (idx > 0)
+        threads = a.arguments().at(idx + 1).toInt();
+    int per_host = 4;
+    idx = a.arguments().indexOf(QLatin1String("-host"));
+    if (idx > 0)
+        per_host = a.arguments().at(idx + 1).toInt();
+    AVPlayer::setLoadLimits(threads, per_host);
+
+    // destroy players while their loads are queued or running. must not crash
+    {
+        QList<AVPlayer*> dying;
+        foreach (const QString& url, urls) {
+            AVPlayer *player = new AVPlayer();
+            player->setAsyncLoad(true);
+            player->setFile(url);
+            player->load();
+            dying.append(player);
+        }
+        QThread::msleep(10);
+        qDeleteAll(dying);
+        qDebug("destroyed %d players while loading", dying.size());
+    }
+    QList<AVPlayer*> players;
+    int finished = 0, loaded = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        foreach (const QString& url, urls) {
+            AVPlayer *player = new AVPlayer(&a);
+            player->setAsyncLoad(true);
+            player->setProbeCacheEnabled(true);
+            player->setFile(url);
+            QObject::connect(player, &AVPlayer::loadFinished, &a, [&](bool ok, qint64) {
+                finished++;
+                loaded += ok;
+                if (finished < players.size())
+                    return;
+                qDebug("%d/%d loaded in %lld ms", loaded, finished, timer.elapsed());
+                qDebug() << AVPlayer::loadStatistics();
+                qDebug() << "probe cache:" << AVDemuxer::probeCacheStatistics();
+                a.quit();
+            }, Qt::QueuedConnection);
+            players.append(player);
+        }
+    }
+    foreach (AVPlayer *player, players) {
+        player->load();
+    }
+    return a.exec();
+}
@@ -0,0 +1,128 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+#include <QtAV/PresentScheduler.h>
+#include <QtDebug>
+#include <random>
+
+using namespace QtAV;
+
+/*
+ * Simulated playback without a real display: vsync at a fixed refresh rate, frames at a fixed frame rate.
+ * The video thread is ready to deliver a frame at its display time (or earlier by leadTime()) with some sleep error,
+ * the renderer paints after a delivery and the frame is on screen at the first vsync after painting, plus
+ * (depth - 1) refreshes for a queued render loop, e.g. Qt Quick threaded render loop.
+ */
+struct Simulation {
+    qreal refresh_rate;
+    qreal fps;
+    int depth;
+    qint64 render_time;
+    qint64 jitter; // max sleep error
+    bool known_rate; // QScreen::refreshRate() is available
+    bool continuous; // renderer swaps every vsync, e.g. an animating scene. otherwise only if a new frame is painted
+};
+
+struct Delivered {
+    qreal pts;
+    qint64 present;
+};
+
+static bool run(const Simulation &sim, bool aligned, int frames)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<qint64> sleep_err(0, sim.jitter);
+    const qint64 iv = qint64(1e9/sim.refresh_rate);
+    const qint64 frame_duration = qint64(1e9/sim.fps);
+    const qint64 t0 = 1000000000LL + 3300000LL; // vsync phase is not related to stream
+    qint64 next_vsync = 1000000000LL;
+    PresentScheduler ps;
+    ps.setEnabled(aligned);
+    if (sim.known_rate)
+        ps.setRefreshRate(sim.refresh_rate);
+    QList<Delivered> delivered;
+    qreal on_screen = -1;
+    qreal swapped = -1;
+    // all vsyncs before t
+    auto vsyncUntil = [&](qint64 t) {
+        while (next_vsync <= t) {
+            while (!delivered.isEmpty() && delivered.first().present <= next_vsync)
+                on_screen = delivered.takeFirst().pts;
+            if (sim.continuous || on_screen != swapped)
+                ps.vsync(next_vsync, on_screen);
+            swapped = on_screen;
+            next_vsync += iv;
+        }
+    };
+    const int warmup = 25;
+    qint64 busy = 0; // video thread
+    for (int i = 0; i < frames; ++i) {
+        if (i == warmup)
+            ps.reset();
+        const qint64 target = t0 + i*frame_duration;
+        const qreal pts = qreal(i)/sim.fps;
+        const qint64 lead = qint64(ps.leadTime(busy)*1e9);
+        qint64 now = qMax(busy, target - lead + sleep_err(rng));
+        vsyncUntil(now);
+        const qint64 deliver = ps.schedule(pts, target, now);
+        if (deliver > now)
+            now = deliver + sleep_err(rng);
+        vsyncUntil(now);
+        busy = now;
+        // painted after delivery, on screen at the vsync after painting
+        const qint64 painted = now + sim.render_time;
+        const qint64 n = (painted - next_vsync + iv - 1)/iv;
+        Delivered d;
+        d.pts = pts;
+        d.present = next_vsync + (n + sim.depth - 1)*iv;
+        // a newer frame replaces an older one not presented yet
+        while (!delivered.isEmpty() && delivered.last().present >= d.present)
+            delivered.removeLast();
+        delivered.append(d);
+    }
+    vsyncUntil(busy + 4*iv);
+    const PresentScheduler::Report r = ps.report();
+    QStringList hist;
+    for (int i = 0; i < PresentScheduler::HistogramSize; ++i)
+        hist << QString::number(r.histogram[i]);
+    printf("%.0fHz %.3ffps depth %d %s %s: refresh %.2fms, presented %lld, early %lld, late %lld, latency %.2fms, judder %.2fms, histogram(%d..): %s\n"
+           , sim.refresh_rate, sim.fps, sim.depth, sim.continuous ? "continuous" : "on demand", aligned ? "aligned" : "unaligned"
+           , r.refreshInterval*1000.0, r.presented, r.early, r.late, r.latency*1000.0, r.judder*1000.0
+           , -int(PresentScheduler::HistogramZero), hist.join(QStringLiteral(" ")).toUtf8().constData());
+    fflush(0);
+    if (!aligned)
+        return true;
+    // aligned: every frame at the vsync nearest to its display time, and no judder other than pulldown
+    const qreal pulldown = 1.0/sim.refresh_rate/2.0;
+    bool ok = r.presented > (frames - warmup)*9/10;
+    ok &= r.early + r.late <= r.presented/100;
+    ok &= r.judder <= pulldown + 0.001;
+    if (!ok)
+        qWarning("FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n frames]");
+    int frames = 2000;
+    const int idx = app.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0 && idx + 1 < app.arguments().size())
+        frames = qMax(100, app.arguments().at(idx + 1).toInt());
+    const Simulation sims[] = {
+        // rate, fps, depth, render, jitter, known rate, continuous
+        { 60, 25, 1, 3000000LL, 4000000LL, true, false },
+        { 60, 24000.0/1001.0, 1, 3000000LL, 4000000LL, true, false },
+        { 60, 30, 2, 5000000LL, 4000000LL, false, true },
+        { 144, 60, 1, 2000000LL, 2000000LL, true, false },
+        { 50, 25, 2, 8000000LL, 4000000LL, false, true },
+    };
+    bool ok = true;
+    for (const Simulation &sim : sims) {
+        ok &= run(sim, false, frames);
+        ok &= run(sim, true, frames);
+    }
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
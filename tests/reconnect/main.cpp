@@ -0,0 +1,195 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QDir>
+#include <QtCore/QEventLoop>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QTimer>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/AudioOutput.h>
+
+using namespace QtAV;
+
+// streams a local file in a loop as mpegts over tcp. killing the server simulates a network outage
+static void startServer(QProcess *server, const QString& file, int port)
+{
+    server->start(QStringLiteral("ffmpeg"), QStringList()
+                  << QStringLiteral("-re") << QStringLiteral("-stream_loop") << QStringLiteral("-1")
+                  << QStringLiteral("-i") << file
+                  << QStringLiteral("-c") << QStringLiteral("copy") << QStringLiteral("-f") << QStringLiteral("mpegts")
+                  << QStringLiteral("tcp://127.0.0.1:%1?listen").arg(port));
+    server->waitForStarted();
+}
+
+// serves 1 file over http with range requests, i.e. a VOD file with known duration
+class HttpFileServer : public QTcpServer
+{
+public:
+    HttpFileServer(const QString& file) : m_file(file) {}
+protected:
+    void incomingConnection(qintptr fd) Q_DECL_OVERRIDE {
+        QTcpSocket *sock = new QTcpSocket(this);
+        sock->setSocketDescriptor(fd);
+        QObject::connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+        QObject::connect(sock, &QTcpSocket::readyRead, [this, sock]() {
+            QByteArray &req = m_requests[sock];
+            req += sock->readAll();
+            if (!req.contains("\r\n\r\n"))
+                return;
+            QFile f(m_file);
+            f.open(QIODevice::ReadOnly);
+            const qint64 size = f.size();
+            qint64 from = 0;
+            const int i = req.indexOf("Range: bytes=");
+            if (i >= 0)
+                from = req.mid(i + 13, req.indexOf('-', i + 13) - i - 13).toLongLong();
+            m_requests.remove(sock);
+            QByteArray head(from > 0 ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n");
+            head += "Content-Type: application/octet-stream\r\nAccept-Ranges: bytes\r\n";
+            head += "Content-Length: " + QByteArray::number(size - from) + "\r\n";
+            if (from > 0)
+                head += "Content-Range: bytes " + QByteArray::number(from) + "-" + QByteArray::number(size - 1) + "/" + QByteArray::number(size) + "\r\n";
+            head += "Connection: close\r\n\r\n";
+            sock->write(head);
+            f.seek(from);
+            sock->write(f.readAll());
+            sock->disconnectFromHost();
+        });
+    }
+private:
+    QString m_file;
+    QHash<QTcpSocket*, QByteArray> m_requests;
+};
+
+// a http VOD file must end normally instead of reconnecting to the beginning
+static bool testVod(const QString& file, int port)
+{
+    HttpFileServer server(file);
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+        qWarning("failed to listen on port %d", port);
+        return false;
+    }
+    AVPlayer player;
+    player.setAutoReconnect(true);
+    player.setDisconnectTimeout(2);
+    player.audio()->setBackends(QStringList() << QStringLiteral("null"));
+    player.setFile(QStringLiteral("http://127.0.0.1:%1/%2").arg(port).arg(QFileInfo(file).fileName()));
+    QEventLoop loop;
+    bool end = false;
+    QObject::connect(&player, &AVPlayer::mediaStatusChanged, [&](QtAV::MediaStatus status) {
+        if (status != EndOfMedia)
+            return;
+        end = true;
+        loop.quit();
+    });
+    QObject::connect(&player, &AVPlayer::stopped, &loop, &QEventLoop::quit);
+    QTimer::singleShot(10*60*1000, &loop, &QEventLoop::quit);
+    player.play();
+    loop.exec();
+    const int reconnects = player.mediaData().value(QStringLiteral("reconnects")).toInt();
+    player.stop();
+    qDebug("http VOD end of media: %d, reconnects: %d", end, reconnects);
+    return end && reconnects == 0;
+}
+
+// the recording must continue after reconnects: 1 file, monotonic timestamps and beyond the first outage
+static bool checkRecording(const QString& file, qreal minDuration)
+{
+    AVDemuxer demux;
+    demux.setMedia(file);
+    if (!demux.load()) {
+        qWarning("failed to load recording %s", qPrintable(file));
+        return false;
+    }
+    qreal last_dts = -1;
+    bool monotonic = true;
+    int packets = 0;
+    while (!demux.atEnd()) {
+        if (!demux.readFrame())
+            continue;
+        if (demux.stream() != demux.videoStream())
+            continue;
+        const Packet pkt(demux.packet());
+        if (pkt.dts < last_dts)
+            monotonic = false;
+        last_dts = pkt.dts;
+        packets++;
+    }
+    qDebug("recording: %d video packets, %.2fs, monotonic: %d", packets, last_dts, monotonic);
+    return monotonic && last_dts >= minDuration;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    qDebug() << "help: ./reconnect -i file [-port port] [-n outages]";
+    qDebug() << "requires ffmpeg in PATH. the server is killed and restarted n times, the player should reconnect each time and the recording continues";
+    qDebug() << "the file is also played over http on port + 1 to check a VOD file ends without reconnecting";
+    int idx = a.arguments().indexOf(QLatin1String("-i"));
+    if (idx < 0)
+        return 1;
+    const QString file = a.arguments().at(idx + 1);
+    int port = 12345;
+    idx = a.arguments().indexOf(QLatin1String("-port"));
+    if (idx > 0)
+        port = a.arguments().at(idx + 1).toInt();
+    int outages = 3;
+    idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        outages = qMax(1, a.arguments().at(idx + 1).toInt());
+
+    if (!testVod(file, port + 1))
+        return 1;
+
+    QProcess server;
+    startServer(&server, file, port);
+    AVPlayer player;
+    player.setAutoReconnect(true);
+    player.setDisconnectTimeout(2);
+    player.setFile(QStringLiteral("tcp://127.0.0.1:%1").arg(port));
+    player.audio()->setBackends(QStringList() << QStringLiteral("null"));
+    int outage = 0;
+    QTimer killer;
+    killer.setInterval(8000);
+    QObject::connect(&killer, &QTimer::timeout, [&]() {
+        if (outage == outages) {
+            const QVariantMap data = player.mediaData();
+            const int reconnects = data.value(QStringLiteral("reconnects")).toInt();
+            qDebug("reconnects: %d/%d, receiving frames: %d, last outage: %lld ms, last reconnect: %lld ms"
+                   , reconnects, outages, player.receivingFrames()
+                   , data.value(QStringLiteral("lastOutageDuration")).toLongLong()
+                   , data.value(QStringLiteral("lastReconnectTime")).toLongLong());
+            player.stopRecording();
+            QEventLoop loop;
+            QObject::connect(&player, &AVPlayer::recordFinished, &loop, &QEventLoop::quit);
+            QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+            loop.exec();
+            // longer than the 8s before the first outage
+            const bool recorded = checkRecording(record_file, 8.0*outages*0.5);
+            a.exit(reconnects >= outages && player.receivingFrames() && recorded ? 0 : 1);
+            return;
+        }
+        ++outage;
+        qDebug("outage %d", outage);
+        server.kill();
+        server.waitForFinished();
+        QTimer::singleShot(1000, [&]() { startServer(&server, file, port); });
+    });
+    QObject::connect(&player, &AVPlayer::receivingFramesChanged, [](bool value) {
+        qDebug("receiving frames: %d", value);
+    });
+    const QString record_file(QDir::temp().filePath(QStringLiteral("reconnect-record.ts")));
+    QFile::remove(record_file);
+    player.play();
+    player.startRecording(record_file);
+    killer.start();
+    const int ret = a.exec();
+    player.stop();
+    server.kill();
+    server.waitForFinished();
+    return ret;
+}
@@ -0,0 +1,9 @@
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += network
+
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+
+SOURCES += main.cpp
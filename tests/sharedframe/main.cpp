@@ -0,0 +1,205 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtAV/SharedFrameReader.h>
+#include <QtAV/SharedMemoryRenderer.h>
+#include <QtDebug>
+#include <algorithm>
+#include <limits.h>
+#include <stdlib.h>
+
+using namespace QtAV;
+
+// frame index is written to the first 8 bytes of luma, and the last byte of every plane
+static VideoFrame makeFrame(int w, int h, qint64 index, QByteArray *buf)
+{
+    const VideoFormat fmt(VideoFormat::Format_YUV420P);
+    if (buf->size() != w*h*3/2)
+        *buf = QByteArray(w*h*3/2, 0x80);
+    quint8 *p = (quint8*)buf->data();
+    memcpy(p, &index, sizeof(index));
+    p[w*h - 1] = p[w*h*5/4 - 1] = p[w*h*3/2 - 1] = quint8(index);
+    VideoFrame f(w, h, fmt, *buf);
+    f.setBits(p, 0);
+    f.setBits(p + w*h, 1);
+    f.setBits(p + w*h*5/4, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setTimestamp(qreal(index)/25.0);
+    return f;
+}
+
+static double percentile(QVector<double> v, int p)
+{
+    if (v.isEmpty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    return v.at(qMin(v.size() - 1, v.size()*p/100));
+}
+
+// reader process: read until the last frame or no frame in 2s, print the result as json
+// leak > 0: exit without releasing after leak frames are held, like a crashed reader
+static int runReader(const QString& name, qint64 frames, int hold, int leak)
+{
+    SharedFrameReader reader;
+    QElapsedTimer timer;
+    timer.start();
+    while (!reader.open(name)) {
+        if (timer.elapsed() > 5000) {
+            qWarning("no exporter %s", qPrintable(name));
+            return 1;
+        }
+        QThread::msleep(5);
+    }
+    QVector<double> latency;
+    QList<VideoFrame> held; // hold frames like a slow consumer
+    qint64 received = 0, last = -1, errors = 0;
+    timer.start();
+    while (last < frames) {
+        const VideoFrame f(reader.getVideoFrame(2000));
+        if (!f.isValid())
+            break;
+        qint64 index = 0;
+        memcpy(&index, f.constBits(0), sizeof(index));
+        const quint8 tag = quint8(index);
+        const int w = f.width(), h = f.height();
+        if (index <= last || f.constBits(0)[f.bytesPerLine(0)*(h - 1) + w - 1] != tag
+                || f.constBits(1)[f.bytesPerLine(1)*(h/2 - 1) + w/2 - 1] != tag
+                || f.constBits(2)[f.bytesPerLine(2)*(h/2 - 1) + w/2 - 1] != tag)
+            ++errors;
+        last = index;
+        ++received;
+        latency.append(f.metaData(QStringLiteral("latency")).toLongLong()/1000.0);
+        if (hold > 0) {
+            held.append(f);
+            if (held.size() > hold)
+                held.removeFirst();
+        }
+        if (leak > 0 && held.size() >= leak)
+            _Exit(0);
+    }
+    const qint64 elapsed = timer.elapsed();
+    QJsonObject r;
+    r[QStringLiteral("received")] = received;
+    r[QStringLiteral("skipped")] = reader.skippedFrames();
+    r[QStringLiteral("errors")] = errors;
+    r[QStringLiteral("last")] = last;
+    r[QStringLiteral("fps")] = elapsed > 0 ? double(received)*1000.0/double(elapsed) : 0;
+    r[QStringLiteral("latency_p50_us")] = percentile(latency, 50);
+    r[QStringLiteral("latency_p95_us")] = percentile(latency, 95);
+    r[QStringLiteral("latency_max_us")] = percentile(latency, 100);
+    printf("%s\n", QJsonDocument(r).toJson(QJsonDocument::Compact).constData());
+    fflush(0);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-n frames] [-size 1920x1080] [-fps 0(unlimited)] [-slots 4] [-hold frames_held_by_reader]");
+    const QStringList args(app.arguments());
+    QString name = QStringLiteral("sharedframe-test-%1").arg(app.applicationPid());
+    qint64 frames = 1000;
+    QSize size(1920, 1080);
+    qreal fps = 0;
+    int slots = 4;
+    int hold = 0;
+    int leak = 0;
+    bool reader = false;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args.at(i);
+        const QString v = i + 1 < args.size() ? args.at(i + 1) : QString();
+        if (a == QLatin1String("-reader")) {
+            reader = true;
+            name = v;
+        } else if (a == QLatin1String("-n")) {
+            frames = qMax(1LL, v.toLongLong());
+        } else if (a == QLatin1String("-size")) {
+            const QStringList wh(v.split(QLatin1Char('x')));
+            if (wh.size() == 2)
+                size = QSize(wh.at(0).toInt() & ~1, wh.at(1).toInt() & ~1);
+        } else if (a == QLatin1String("-fps")) {
+            fps = v.toDouble();
+        } else if (a == QLatin1String("-slots")) {
+            slots = v.toInt();
+        } else if (a == QLatin1String("-hold")) {
+            hold = v.toInt();
+        } else if (a == QLatin1String("-leak")) {
+            leak = v.toInt();
+        } else {
+            continue;
+        }
+        ++i;
+    }
+    if (reader)
+        return runReader(name, frames, qMax(hold, leak), leak);
+
+    SharedMemoryRenderer exporter;
+    exporter.setName(name);
+    exporter.setSlotCount(slots);
+    QByteArray buf;
+    exporter.receive(makeFrame(size.width(), size.height(), 0, &buf)); // create the ring before the reader opens
+    QProcess child;
+    child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    child.start(app.applicationFilePath(), QStringList() << QStringLiteral("-reader") << name
+                << QStringLiteral("-n") << QString::number(frames) << QStringLiteral("-hold") << QString::number(hold));
+    if (!child.waitForStarted()) {
+        qWarning("failed to start reader process");
+        return 1;
+    }
+    QThread::msleep(200);
+    QVector<double> copy;
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 1; i <= frames; ++i) {
+        if (fps > 0) {
+            const qint64 wait = qint64(qreal(i)*1000.0/fps) - timer.elapsed();
+            if (wait > 0)
+                QThread::msleep(wait);
+        }
+        const VideoFrame f(makeFrame(size.width(), size.height(), i, &buf));
+        QElapsedTimer t;
+        t.start();
+        exporter.receive(f);
+        copy.append(t.nsecsElapsed()/1000.0);
+    }
+    const qint64 elapsed = timer.elapsed();
+    child.waitForFinished(10000);
+    const QJsonObject r(QJsonDocument::fromJson(child.readAllStandardOutput()).object());
+    const double mb = double(size.width()*size.height()*3/2)/1048576.0;
+    printf("%dx%d, %lld frames, %d slots, reader holds %d\n", size.width(), size.height(), frames, slots, hold);
+    printf("exporter: %.1f fps, %.0f MB/s, copy p50 %.0fus p95 %.0fus, dropped %lld\n"
+           , double(frames)*1000.0/double(qMax(1LL, elapsed)), double(frames)*mb*1000.0/double(qMax(1LL, elapsed))
+           , percentile(copy, 50), percentile(copy, 95), exporter.droppedFrames());
+    printf("reader: %s\n", QJsonDocument(r).toJson(QJsonDocument::Compact).constData());
+    bool ok = !r.isEmpty() && r.value(QStringLiteral("errors")).toInt() == 0
+            && r.value(QStringLiteral("last")).toVariant().toLongLong() == frames;
+
+    // a reader exits while holding every slot. the exporter must get the slots back
+    QProcess dead;
+    dead.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    dead.start(app.applicationFilePath(), QStringList() << QStringLiteral("-reader") << name
+               << QStringLiteral("-n") << QString::number(LLONG_MAX) << QStringLiteral("-leak") << QString::number(slots));
+    qint64 index = frames;
+    if (dead.waitForStarted()) {
+        timer.start();
+        while (dead.state() != QProcess::NotRunning && timer.elapsed() < 10000) {
+            exporter.receive(makeFrame(size.width(), size.height(), ++index, &buf));
+            dead.waitForFinished(5);
+        }
+    }
+    // the process must be reaped, a zombie is still alive
+    const bool exited = dead.waitForFinished(1000) || dead.state() == QProcess::NotRunning;
+    const qint64 dropped = exporter.droppedFrames();
+    for (int i = 0; i < slots*2; ++i)
+        exporter.receive(makeFrame(size.width(), size.height(), ++index, &buf));
+    printf("dead reader: exited %d, dropped %lld after exit\n", exited, exporter.droppedFrames() - dropped);
+    ok = ok && exited && exporter.droppedFrames() == dropped;
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
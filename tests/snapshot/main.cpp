@@ -0,0 +1,94 @@
+#include <QtCore/QCoreApplication>
+#include <QtGui/QImage>
+#include <QtGui/QImageReader>
+#include <QtAV/VideoFrame.h>
+#include <QtAV/private/SnapshotEncoder.h>
+#include <QtDebug>
+#include <string.h>
+
+using namespace QtAV;
+
+/*
+ * Encodes yuv420p frames of horizontal color bands in different color spaces and ranges, decodes the image with Qt
+ * and checks the rgb value in the middle of each band. Decoders assume full range bt601 for JPEG.
+ */
+
+static const int kWidth = 64;
+static const int kBand = 16; // rows. a jpeg macroblock row
+static const int kTolerance = 12;
+
+struct Band {
+    const char* name;
+    int y, cb, cr;
+};
+// black, white, gray, red, green
+static const QRgb kRgb[] = { qRgb(0, 0, 0), qRgb(255, 255, 255), qRgb(128, 128, 128), qRgb(255, 0, 0), qRgb(0, 255, 0) };
+static const Band kLimited709[] = { {"black", 16, 128, 128}, {"white", 235, 128, 128}, {"gray", 126, 128, 128}, {"red", 63, 102, 240}, {"green", 173, 42, 26} };
+static const Band kLimited601[] = { {"black", 16, 128, 128}, {"white", 235, 128, 128}, {"gray", 126, 128, 128}, {"red", 81, 90, 240}, {"green", 145, 54, 34} };
+static const Band kFull601[] = { {"black", 0, 128, 128}, {"white", 255, 128, 128}, {"gray", 128, 128, 128}, {"red", 76, 85, 255}, {"green", 150, 44, 21} };
+static const int kBands = sizeof(kRgb)/sizeof(kRgb[0]);
+
+static VideoFrame makeFrame(const Band* bands, ColorSpace cs, ColorRange range)
+{
+    const int w = kWidth, h = kBand*kBands;
+    QByteArray buf(w*h*3/2, 0);
+    quint8 *y = (quint8*)buf.data();
+    quint8 *u = y + w*h;
+    quint8 *v = u + w*h/4;
+    for (int b = 0; b < kBands; ++b) {
+        memset(y + b*kBand*w, bands[b].y, kBand*w);
+        memset(u + b*kBand/2*w/2, bands[b].cb, kBand/2*w/2);
+        memset(v + b*kBand/2*w/2, bands[b].cr, kBand/2*w/2);
+    }
+    VideoFrame f(w, h, VideoFormat(VideoFormat::Format_YUV420P), buf);
+    f.setBits(y, 0);
+    f.setBits(u, 1);
+    f.setBits(v, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setColorSpace(cs);
+    f.setColorRange(range);
+    return f;
+}
+
+static bool check(const char* name, const QString& format, const Band* bands, ColorSpace cs, ColorRange range)
+{
+    const QByteArray data(SnapshotEncoder::encode(makeFrame(bands, cs, range), format, 100));
+    const QImage img(QImage::fromData(data, format.toLatin1().constData()));
+    if (img.isNull()) {
+        printf("%s %s: encode or decode FAILED\n", name, qPrintable(format));
+        return false;
+    }
+    bool ok = img.width() == kWidth && img.height() == kBand*kBands;
+    for (int b = 0; ok && b < kBands; ++b) {
+        const QRgb c = img.pixel(kWidth/2, b*kBand + kBand/2);
+        const bool match = qAbs(qRed(c) - qRed(kRgb[b])) <= kTolerance
+                && qAbs(qGreen(c) - qGreen(kRgb[b])) <= kTolerance
+                && qAbs(qBlue(c) - qBlue(kRgb[b])) <= kTolerance;
+        if (!match)
+            printf("%s %s %s: (%d, %d, %d) FAILED\n", name, qPrintable(format), bands[b].name, qRed(c), qGreen(c), qBlue(c));
+        ok &= match;
+    }
+    printf("%s %s: %d bytes %s\n", name, qPrintable(format), data.size(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList formats;
+    formats << QStringLiteral("jpg");
+    if (SnapshotEncoder::isSupported(QStringLiteral("webp")) && QImageReader::supportedImageFormats().contains("webp"))
+        formats << QStringLiteral("webp");
+    bool ok = true;
+    foreach (const QString& f, formats) {
+        ok &= check("limited bt709", f, kLimited709, ColorSpace_BT709, ColorRange_Limited);
+        ok &= check("limited bt601", f, kLimited601, ColorSpace_BT601, ColorRange_Limited);
+        ok &= check("full bt601", f, kFull601, ColorSpace_BT601, ColorRange_Full);
+        ok &= check("unknown", f, kLimited601, ColorSpace_Unknown, ColorRange_Unknown); // small size: bt601
+    }
+    SnapshotEncoder::clear();
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
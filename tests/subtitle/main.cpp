@@ -1,9 +1,11 @@
 #include <QCoreApplication>
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtDebug>
 #include <QtCore/QTime>
 #include <QtAV/Subtitle.h>
+#include <stdlib.h>
 
 using namespace QtAV;
 
@@ -20,16 +22,84 @@ private slots:
     }
 };
 
+static QString srtTime(qint64 ms)
+{
+    return QString::asprintf("%02d:%02d:%02d,%03d", int(ms/3600000), int(ms/60000%60), int(ms/1000%60), int(ms%1000));
+}
+
+static int bench(Subtitle *sub, int n)
+{
+    if (n <= 0)
+        n = 10000;
+    const qint64 kDuration = 3*3600*1000;
+    QByteArray srt;
+    QVector<qint64> begin(n), end(n);
+    for (int k = 0; k < n; ++k) {
+        const qint64 t0 = kDuration*k/n;
+        // every 4th cue overlaps with the next 2 cues
+        const qint64 t1 = t0 + kDuration/n*(k%4 ? 1 : 3);
+        begin[k] = t0;
+        end[k] = t1;
+        srt += QString::fromLatin1("%1\n%2 --> %3\ncue %1\n\n").arg(k+1).arg(srtTime(t0)).arg(srtTime(t1)).toUtf8();
+    }
+    sub->setRawData(srt);
+    QElapsedTimer timer;
+    timer.start();
+    sub->load();
+    if (!sub->isLoaded())
+        return -1;
+    qDebug() << "process" << n << "cues elapsed: " << timer.elapsed() << "ms";
+    // compare with a linear scan of all cues. +0.5ms: never at a cue boundary
+    srand(1);
+    int mismatches = 0;
+    for (int k = 0; k < qMin(n, 2000); ++k) {
+        const qreal t = qreal(qint64(rand())*1000%kDuration) + 0.5;
+        QStringList expected;
+        for (int c = 0; c < n; ++c) {
+            if (begin.at(c) <= t && t <= end.at(c))
+                expected.append(QString::fromLatin1("cue %1").arg(c+1));
+        }
+        sub->setTimestamp(t/1000.0);
+        const QString text(sub->getText());
+        if (text != expected.join(QLatin1Char('\n'))) {
+            if (mismatches++ < 8)
+                qWarning() << "at" << t << "ms:" << text << "expected:" << expected;
+        }
+    }
+    if (mismatches > 0) {
+        qWarning("%d lookups do not match the linear scan. FAIL", mismatches);
+        return 1;
+    }
+    srand(0);
+    int changed = 0;
+    timer.restart();
+    for (int k = 0; k < n; ++k) {
+        sub->setTimestamp(qreal(qint64(rand())*1000%kDuration)/1000.0);
+        if (!sub->getText().isEmpty())
+            ++changed;
+    }
+    qDebug() << n << "random seeks elapsed: " << timer.nsecsElapsed()/1000 << "us. non-empty:" << changed;
+    timer.restart();
+    for (int k = 0; k < n; ++k) { // scrubbing
+        sub->setTimestamp(qreal(kDuration*k/n)/1000.0);
+        sub->getText();
+    }
+    qDebug() << n << "sequential steps elapsed: " << timer.nsecsElapsed()/1000 << "us";
+    qDebug("PASS");
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
-    qDebug() << "help: ./subtitle [-engine engine] [-f file] [-fuzzy] [-t sec] [-t1 sec] [-count n]";
+    qDebug() << "help: ./subtitle [-engine engine] [-f file] [-fuzzy] [-t sec] [-t1 sec] [-count n] [-bench n]";
     qDebug() << "-fuzzy: fuzzy match subtitle name";
     qDebug() << "-t: set subtitle begin time";
     qDebug() << "-t1: set subtitle end time";
     qDebug() << "-count: set subtitle frame count from t to t1";
     qDebug() << "-engine: subtitle processing engine, can be 'ffmpeg' and 'libass'";
     qDebug() << "-dir: add subtitle search directories";
+    qDebug() << "-bench: seek benchmark. generate a 3 hours srt with n overlapped cues and seek randomly n times";
     QString file;
     bool fuzzy = false;
     int t = -1, t1 = -1, count = 1;
@@ -66,6 +136,10 @@ int main(int argc, char *argv[])
         sub.setEngines(QStringList() << engine);
     qDebug() << "supported extensions: " << sub.supportedSuffixes();
 
+    i = a.arguments().indexOf(QLatin1String("-bench"));
+    if (i > 0)
+        return bench(&sub, i + 1 < a.arguments().size() ? a.arguments().at(i+1).toInt() : 0);
+
     if (file.isEmpty())
         return 0;
 
@@ -1,9 +1,26 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    activitydetector \
     ao \
+    audiomixer \
+    audioconvert \
+    benchmark \
+    camerawall \
+    capture \
     decoder \
+    decoderpool \
+    demux \
+    framemailbox \
+    framereader \
+    frametap \
+    load \
+    presentscheduler \
+    reconnect \
+    sharedframe \
+    snapshot \
     subtitle \
+    trace \
     transcode
 
 !no-widgets {
@@ -12,4 +29,5 @@ SUBDIRS += \
     qiodevice \
     qrc \
     playerthread
+  unix:!mac:!android: SUBDIRS += x11renderer
 }
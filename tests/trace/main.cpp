@@ -0,0 +1,50 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QTimer>
+#include <QtAV/AVPlayer.h>
+#include <QtDebug>
+
+using namespace QtAV;
+
+// play files without renderer for a while and save the trace. open the result in chrome://tracing or ui.perfetto.dev
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    qDebug("parameters: [-t seconds] [-o trace.json] file1 [file2 ...]");
+    const QStringList args = app.arguments();
+    int seconds = 10;
+    QString out = QDir::tempPath() + QStringLiteral("/qtav_trace.json");
+    QStringList files;
+    for (int i = 1; i < args.size(); ++i) {
+        if (args.at(i) == QLatin1String("-t") && i + 1 < args.size())
+            seconds = qMax(1, args.at(++i).toInt());
+        else if (args.at(i) == QLatin1String("-o") && i + 1 < args.size())
+            out = args.at(++i);
+        else
+            files.append(args.at(i));
+    }
+    if (files.isEmpty()) {
+        qWarning("no input file");
+        return 1;
+    }
+    setTraceEnabled(true);
+    if (!isTraceEnabled()) {
+        qWarning("QtAV is built without tracing");
+        return 1;
+    }
+    QList<AVPlayer*> players;
+    foreach (const QString& file, files) {
+        AVPlayer *player = new AVPlayer(&app);
+        player->play(file);
+        players.append(player);
+    }
+    QTimer::singleShot(seconds*1000, [&]{
+        const bool ok = saveTrace(out);
+        qDebug("trace %s: %s", ok ? "saved" : "NOT saved", qPrintable(out));
+        foreach (AVPlayer *player, players) {
+            player->stop();
+        }
+        app.exit(ok ? 0 : 1);
+    });
+    return app.exec();
+}
@@ -22,13 +22,101 @@
 #include <QtDebug>
 #include <QtCore/QDir>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
 #include <QtCore/QStringList>
 #include <QtAV>
 #include <QtAV/VideoEncoder.h>
 #include <QtAV/AVMuxer.h>
+#include <QtAV/AVTranscoder.h>
 
 using namespace QtAV;
 
+struct StreamCheck {
+    StreamCheck() : packets(0), last_dts(-1), monotonic(true) {}
+    int packets;
+    qreal last_dts;
+    bool monotonic;
+};
+
+// packets of video and audio stream. source packets are counted from the first video key frame
+static bool demuxPackets(const QString& file, StreamCheck *video, StreamCheck *audio, bool fromKeyFrame)
+{
+    AVDemuxer demux;
+    demux.setMedia(file);
+    if (!demux.load()) {
+        qWarning("Failed to load file: %s", file.toUtf8().constData());
+        return false;
+    }
+    qreal start = fromKeyFrame ? -1 : 0;
+    while (!demux.atEnd()) {
+        if (!demux.readFrame())
+            continue;
+        const Packet pkt(demux.packet());
+        const bool is_video = demux.stream() == demux.videoStream();
+        if (!is_video && demux.stream() != demux.audioStream())
+            continue;
+        if (start < 0) {
+            if (!is_video || !pkt.hasKeyFrame)
+                continue;
+            start = pkt.dts;
+        }
+        if (pkt.dts < start)
+            continue;
+        StreamCheck *c = is_video ? video : audio;
+        c->packets++;
+        if (pkt.dts < c->last_dts || pkt.pts < pkt.dts)
+            c->monotonic = false;
+        c->last_dts = pkt.dts;
+    }
+    return true;
+}
+
+// remux through AVTranscoder passthrough mode to 3 outputs and check every output
+static bool passthrough(const QString& file, const QString& outFile, const QString& fmt)
+{
+    StreamCheck src_video, src_audio;
+    if (!demuxPackets(file, &src_video, &src_audio, true))
+        return false;
+    const QString base(outFile.left(outFile.lastIndexOf(QLatin1Char('.'))));
+    QStringList outputs;
+    outputs << outFile << base + QStringLiteral("-1.mkv") << base + QStringLiteral("-2.ts");
+    AVPlayer player;
+    AVTranscoder transcoder;
+    transcoder.setMediaSource(&player);
+    transcoder.setPassthrough();
+    transcoder.setOutputMedia(outFile);
+    if (!fmt.isEmpty())
+        transcoder.setOutputFormat(fmt);
+    transcoder.addOutputMedia(outputs.at(1), QStringLiteral("matroska"));
+    transcoder.addOutputMedia(outputs.at(2), QStringLiteral("mpegts"));
+    QEventLoop loop;
+    QObject::connect(&transcoder, SIGNAL(stopped()), &loop, SLOT(quit()));
+    QElapsedTimer timer;
+    timer.start();
+    transcoder.start();
+    player.play(file);
+    loop.exec();
+    qDebug("passthrough to %d outputs, time: %lld ms", transcoder.outputCount(), timer.elapsed());
+    bool ok = transcoder.outputCount() == outputs.size();
+    for (int i = 0; i < outputs.size(); ++i) {
+        StreamCheck video, audio;
+        if (!demuxPackets(outputs.at(i), &video, &audio, false))
+            return false;
+        const qint64 dropped = transcoder.droppedPackets(i);
+        qDebug("output %d %s: video packets %d/%d, audio packets %d/%d, dropped %lld, monotonic: %d"
+               , i, outputs.at(i).toUtf8().constData(), video.packets, src_video.packets, audio.packets, src_audio.packets
+               , dropped, video.monotonic && audio.monotonic);
+        ok &= video.monotonic && audio.monotonic;
+        if (dropped == 0) {
+            ok &= video.packets == src_video.packets;
+            // audio before the first key frame is dropped, and rebased audio before 0 too
+            ok &= audio.packets <= src_audio.packets && audio.packets + 16 >= src_audio.packets;
+        }
+    }
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
@@ -87,6 +175,8 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (cv == QLatin1String("copy")) // remux without decoding
+        return passthrough(file, outFile, fmt) ? 0 : 1;
     dec->setCodecContext(demux.videoCodecContext());
     dec->open();
     QElapsedTimer timer;
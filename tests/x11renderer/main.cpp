@@ -0,0 +1,140 @@
+#include <QApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+#include <QWidget>
+#include <QtAV/VideoFrame.h>
+#include <QtAV/VideoRenderer.h>
+#include <QtAVWidgets>
+#include <QtDebug>
+#include <algorithm>
+
+using namespace QtAV;
+
+/*
+ * Frames/s of X11Renderer without GL. Run against Xvfb on a machine without display:
+ *   xvfb-run -s "-screen 0 1920x1080x24" ./x11renderer
+ * convert: VideoFrame::to() to a new frame, then copied to the destination. what X11Renderer did before
+ * direct: VideoFrameConverter converts and scales into the destination in 1 pass
+ * render: receive() and repaint(), i.e. convert into a shm image and XShmPutImage
+ */
+
+// moving gradient. width and height must be even
+static VideoFrame testFrame(int w, int h, int n, VideoFormat::PixelFormat fmt)
+{
+    QByteArray buf(w*h*3/2, 0x80);
+    quint8 *y = (quint8*)buf.data(); //must before buf is shared
+    for (int j = 0; j < h; ++j) {
+        for (int i = 0; i < w; ++i)
+            y[j*w + i] = quint8((i + j + n*4) & 0xff);
+    }
+    VideoFrame f(w, h, VideoFormat(VideoFormat::Format_YUV420P), buf);
+    f.setBits(y, 0);
+    f.setBits(y + w*h, 1);
+    f.setBits(y + w*h*5/4, 2);
+    f.setBytesPerLine(w, 0);
+    f.setBytesPerLine(w/2, 1);
+    f.setBytesPerLine(w/2, 2);
+    f.setTimestamp(qreal(n)/25.0);
+    if (fmt != f.pixelFormat())
+        return f.to(fmt);
+    return f;
+}
+
+static QSize parseSize(const QString& s, const QSize& def)
+{
+    const QStringList wh(s.split(QLatin1Char('x')));
+    if (wh.size() != 2)
+        return def;
+    return QSize(wh.at(0).toInt() & ~1, wh.at(1).toInt() & ~1);
+}
+
+static void report(const char* name, const QVector<qint64>& ns, qint64 elapsed)
+{
+    QVector<qint64> v(ns);
+    std::sort(v.begin(), v.end());
+    printf("%-8s %8.1f fps, p50 %6.2fms, p95 %6.2fms\n", name
+           , elapsed > 0 ? double(v.size())*1e9/double(elapsed) : 0.0
+           , v.isEmpty() ? 0.0 : double(v.at(v.size()/2))/1e6
+           , v.isEmpty() ? 0.0 : double(v.at(v.size()*95/100))/1e6);
+}
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv);
+    qDebug("parameters: [-n frames] [-size 1920x1080] [-window 1280x720] [-format yuv420p|rgb32]");
+    const QStringList args(app.arguments());
+    int frames = 300;
+    QSize size(1920, 1080);
+    QSize window(1280, 720);
+    VideoFormat::PixelFormat fmt = VideoFormat::Format_YUV420P;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args.at(i);
+        const QString v = i + 1 < args.size() ? args.at(i + 1) : QString();
+        if (a == QLatin1String("-n"))
+            frames = qMax(1, v.toInt());
+        else if (a == QLatin1String("-size"))
+            size = parseSize(v, size);
+        else if (a == QLatin1String("-window"))
+            window = parseSize(v, window);
+        else if (a == QLatin1String("-format"))
+            fmt = v == QLatin1String("rgb32") ? VideoFormat::Format_RGB32 : VideoFormat::Format_YUV420P;
+        else
+            continue;
+        ++i;
+    }
+    Widgets::registerRenderers();
+    VideoRenderer *vo = VideoRenderer::create(VideoRendererId_X11);
+    if (!vo || !vo->isAvailable() || !vo->widget()) {
+        qWarning("X11 renderer is not available");
+        return 1;
+    }
+    QVector<VideoFrame> input;
+    for (int i = 0; i < 8; ++i)
+        input.append(testFrame(size.width(), size.height(), i, fmt));
+    printf("%dx%d %s => %dx%d\n", size.width(), size.height(), qPrintable(VideoFormat(fmt).name()), window.width(), window.height());
+
+    // the same destination as an ximage: 32bpp, 16 aligned width
+    const int w = (window.width() + 15) & ~15;
+    const int pitch = w*4;
+    QByteArray dst_buf(pitch*window.height() + 16, 0);
+    quint8 *dst = (quint8*)dst_buf.data();
+    dst += (16 - (quintptr(dst) & 15)) & 15;
+    QVector<qint64> ns;
+    QElapsedTimer timer, t;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        t.start();
+        const VideoFrame f(input.at(i % input.size()).to(VideoFormat::Format_RGB32, QSize(w, window.height())));
+        VideoFrame::copyPlane(dst, pitch, f.constBits(0), f.bytesPerLine(0), pitch, window.height());
+        ns.append(t.nsecsElapsed());
+    }
+    report("convert", ns, timer.nsecsElapsed());
+
+    ns.clear();
+    VideoFrameConverter conv;
+    bool ok = true;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        t.start();
+        ok &= conv.convert(input.at(i % input.size()), VideoFormat(VideoFormat::Format_RGB32), QSize(w, window.height()), &dst, &pitch);
+        ns.append(t.nsecsElapsed());
+    }
+    report("direct", ns, timer.nsecsElapsed());
+
+    QWidget *widget = vo->widget();
+    widget->resize(window);
+    widget->show();
+    app.processEvents();
+    ns.clear();
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        t.start();
+        vo->receive(input.at(i % input.size()));
+        widget->repaint();
+        ns.append(t.nsecsElapsed());
+    }
+    report("render", ns, timer.nsecsElapsed());
+    delete vo;
+    qDebug("%s", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -24,6 +24,7 @@
 #include <QtGui/QGuiApplication>
 #include <QtGui/QResizeEvent>
 #include <QtGui/QScreen>
+#include <QtGui/QWindow>
 
 namespace QtAV {
 
@@ -46,6 +47,9 @@ OpenGLWidgetRenderer::OpenGLWidgetRenderer(QWidget *parent, Qt::WindowFlags f):
 {
     setAcceptDrops(true);
     setFocusPolicy(Qt::StrongFocus);
+    connect(this, &QOpenGLWidget::frameSwapped, [this]() {
+        d_func().frameSwapped();
+    });
 }
 
 void OpenGLWidgetRenderer::initializeGL()
@@ -84,6 +88,8 @@ void OpenGLWidgetRenderer::resizeEvent(QResizeEvent *e)
 void OpenGLWidgetRenderer::showEvent(QShowEvent *e)
 {
     onShowEvent(); // TODO: onShowEvent(w, h)?
+    if (window()->windowHandle() && window()->windowHandle()->screen())
+        d_func().scheduler.setRefreshRate(window()->windowHandle()->screen()->refreshRate());
     resizeGL(width(), height());
 }
 } //namespace QtAV
@@ -18,7 +18,7 @@
     License along with this library; if not, write to the Free Software
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ******************************************************************************/
-//TODO: ROI (xsubimage?), rotation. slow scale because of alignment? no xsync for shm
+//TODO: ROI (xsubimage?), rotation
 /*
  * X11 headers define 'Bool' type which is used in qmetatype.h. we must include X11 files at last, i.e. X11Renderer_p.h. otherwise compile error
 */
@@ -27,6 +27,7 @@
 #include "QtAV/FilterContext.h"
 #include <QWidget>
 #include <QResizeEvent>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/qmath.h>
 #include <QtDebug>
 //#error qtextstream.h must be included before any header file that defines Status. Xlib.h defines Status
@@ -35,11 +36,14 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/XShm.h>
-#include <unistd.h> //usleep
+#include <poll.h>
 //#include "QtAV/private/factory.h"
 //scale: http://www.opensource.apple.com/source/X11apps/X11apps-14/xmag/xmag-X11R7.0-1.0.1/Scale.c
 #define FFALIGN(x, a) (((x)+(a)-1)&~((a)-1))
-static const int kPoolSize = 2;
+// 1 image is being read by x server, 1 is shown and 1 is for the next frame
+static const int kPoolSize = 3;
+// wait for ShmCompletion at most kShmTimeout ms, then XSync
+static const int kShmTimeout = 50;
 namespace QtAV {
 class X11RendererPrivate;
 class X11Renderer: public QWidget, public VideoRenderer
@@ -152,7 +156,6 @@ public:
       , warn_bad_pitch(true)
       , num_adaptors(0)
       , ShmCompletionEvent(0)
-      , ShmCompletionWaitCount(0)
       , current_index(0)
       , next_index(0)
       , gc(NULL)
@@ -161,6 +164,8 @@ public:
     {
         XInitThreads();
         memset(ximage_pool, 0, sizeof(ximage_pool));
+        memset(shm_pool, 0, sizeof(shm_pool));
+        memset(shm_busy, 0, sizeof(shm_busy));
 #ifndef _XSHM_H_
         use_shm = false;
 #endif //_XSHM_H_
@@ -206,6 +211,9 @@ public:
         }
     }
     ~X11RendererPrivate() {
+        if (!display)
+            return;
+        XSync(display, False); // x server may still read shm images
         for (int i = 0; i < kPoolSize; ++i)
             destroyX11Image(i);
         XCloseDisplay(display);
@@ -217,7 +225,9 @@ public:
                 XShmDetach(display, &shm);
                 shmctl(shm.shmid, IPC_RMID, 0);
                 shmdt(shm.shmaddr);
+                shm.shmaddr = 0;
             }
+            shm_busy[index] = false;
         }
         XImage* ximage = ximage_pool[index];
         if (ximage) {
@@ -306,6 +316,51 @@ no_shm:
         ximage_data[index].resize(ximage->bytes_per_line*ximage->height + 32);
         return true;
     }
+    // the memory to draw: shm, or 16 aligned ximage_data
+    quint8* imageData(int index) {
+        if (use_shm)
+            return (quint8*)ximage_pool[index]->data;
+        quint8 *p = (quint8*)ximage_data[index].data();
+        return p + ((16 - (quintptr(p) & 15)) & 15);
+    }
+    void processShmEvents() {
+        XEvent ev;
+        while (XCheckTypedEvent(display, ShmCompletionEvent, &ev)) {
+            const ShmSeg seg = ((XShmCompletionEvent*)&ev)->shmseg;
+            for (int i = 0; i < kPoolSize; ++i) {
+                if (shm_pool[i].shmseg == seg)
+                    shm_busy[i] = false;
+            }
+        }
+    }
+    /*!
+     * wait until x server finishes reading the image by XShmPutImage before writing to it.
+     * if no ShmCompletion event in time (e.g. window is unmapped), XSync makes sure all requests are processed
+     */
+    void waitForImage(int index) {
+        if (!use_shm || !shm_busy[index])
+            return;
+        processShmEvents();
+        QElapsedTimer timer;
+        timer.start();
+        while (shm_busy[index]) {
+            const int left = kShmTimeout - int(timer.elapsed());
+            if (left <= 0)
+                break;
+            pollfd fd;
+            fd.fd = ConnectionNumber(display);
+            fd.events = POLLIN;
+            fd.revents = 0;
+            poll(&fd, 1, left);
+            processShmEvents();
+        }
+        if (!shm_busy[index])
+            return;
+        qDebug("no ShmCompletion for x11 image %d. XSync", index);
+        XSync(display, False);
+        processShmEvents();
+        memset(shm_busy, 0, sizeof(shm_busy));
+    }
     int resizeXImage(int index);
 
     bool use_shm; //TODO: set by user
@@ -314,7 +369,6 @@ no_shm:
     int bpp;
     int depth;
     int ShmCompletionEvent;
-    int ShmCompletionWaitCount;
     XVisualInfo vinfo;
     Display *display;
     int current_index;
@@ -322,11 +376,14 @@ no_shm:
     XImage *ximage_pool[kPoolSize];
     GC gc;
     XShmSegmentInfo shm_pool[kPoolSize];
+    bool shm_busy[kPoolSize]; // image is put and ShmCompletion is not received
     VideoFormat::PixelFormat pixfmt;
     // if the incoming image pitchs are different from ximage ones, use ximage pitchs and copy data in ximage_data
     QByteArray ximage_data[kPoolSize];
     VideoFrame frame_orig; // if renderer is resized, scale the original frame
     bool frame_changed;
+    VideoFrameConverter conv; // convert and scale into ximage directly
+
 };
 
 X11Renderer::X11Renderer(QWidget *parent, Qt::WindowFlags f):
@@ -388,41 +445,33 @@ int X11RendererPrivate::resizeXImage(int index)
     frame_changed = false;
     XImage* &ximage = ximage_pool[index];
     video_frame = frame_orig; // set before map!
-    VideoFrame interopFrame;
+    quint8 *dst = imageData(index);
+    ximage->data = (char*)dst;
     if (!frame_orig.constBits(0)) {
-        interopFrame = VideoFrame(ximage->width, ximage->height, pixelFormat(ximage));
-        interopFrame.setBits(use_shm ? (quint8*)ximage->data : (quint8*)ximage_data[index].constData());
+        VideoFrame interopFrame(ximage->width, ximage->height, pixelFormat(ximage));
+        interopFrame.setBits(dst);
         interopFrame.setBytesPerLine(ximage->bytes_per_line);
+        if (video_frame.map(UserSurface, &interopFrame, VideoFormat(VideoFormat::Format_RGB32))) //check pixel format and scale to ximage size&line_size
+            return true;
     }
     if (frame_orig.constBits(0)
-            || !video_frame.map(UserSurface, &interopFrame, VideoFormat(VideoFormat::Format_RGB32)) //check pixel format and scale to ximage size&line_size
-            ) {
-        if (!frame_orig.constBits(0) //always convert hw frames
-                || frame_orig.pixelFormat() != pixfmt || frame_orig.width() != ximage->width || frame_orig.height() != ximage->height)
-            video_frame = frame_orig.to(pixfmt, QSize(ximage->width, ximage->height));
-        else
-            video_frame = frame_orig;
-        if (video_frame.bytesPerLine(0) == ximage->bytes_per_line) {
-            if (use_shm) {
-                memcpy(ximage->data, video_frame.constBits(0), ximage->bytes_per_line*ximage->height);
-            } else {
-                ximage->data = (char*)video_frame.constBits(0);
-            }
-        } else { //copy line by line
-            if (warn_bad_pitch) {
-                warn_bad_pitch = false;
-                qDebug("bad pitch: %d - % ximage_data[%d].size: %d", ximage->bytes_per_line, video_frame.bytesPerLine(0), index, ximage_data[index].size());
-            }
-            quint8* dst = (quint8*)ximage->data;
-            if (!use_shm) {
-                dst = (quint8*)ximage_data[index].constData();
-                ximage->data = (char*)ximage_data[index].constData();
-            }
-            VideoFrame::copyPlane(dst, ximage->bytes_per_line, (const quint8*)video_frame.constBits(0), video_frame.bytesPerLine(0), ximage->bytes_per_line, ximage->height);
+            && frame_orig.pixelFormat() == pixfmt && frame_orig.width() == ximage->width && frame_orig.height() == ximage->height) {
+        if (!use_shm && frame_orig.bytesPerLine(0) == ximage->bytes_per_line) {
+            ximage->data = (char*)frame_orig.constBits(0);
+            return true;
         }
-    } else {
-        if (!use_shm)
-            ximage->data = (char*)ximage_data[index].constData();
+        if (frame_orig.bytesPerLine(0) != ximage->bytes_per_line && warn_bad_pitch) {
+            warn_bad_pitch = false;
+            qDebug("bad pitch: %d - %d", ximage->bytes_per_line, frame_orig.bytesPerLine(0));
+        }
+        VideoFrame::copyPlane(dst, ximage->bytes_per_line, frame_orig.constBits(0), frame_orig.bytesPerLine(0), ximage->bytes_per_line, ximage->height);
+        return true;
+    }
+    // convert and scale into ximage in 1 pass. width is 16 aligned and shm is page aligned, so sws can use simd
+    const int pitch = ximage->bytes_per_line;
+    if (!conv.convert(frame_orig, VideoFormat(pixfmt), QSize(ximage->width, ximage->height), &dst, &pitch)) {
+        qWarning() << "X11Renderer failed to convert " << frame_orig.format() << "=>" << pixfmt;
+        return false;
     }
     return true;
 }
@@ -452,6 +501,9 @@ void X11Renderer::drawFrame()
 {
     // TODO: interop
     DPTR_D(X11Renderer);
+    // never overwrite an image x server is still reading
+    if (d.frame_changed)
+        d.waitForImage(d.next_index);
     int ret = d.resizeXImage(d.next_index); // -1: image no change
     if (!ret)
         return;
@@ -460,29 +512,11 @@ void X11Renderer::drawFrame()
         setPreferredPixelFormat(d.pixfmt);
     }
 
-    if (d.use_shm) {
-        int wait_count = 0;
-        while (d.ShmCompletionWaitCount >= kPoolSize) {
-            if (wait_count++ > 100) {
-                qDebug("reset ShmCompletionWaitCount");
-                d.ShmCompletionWaitCount = 0;
-                break;
-            }
-            while (XPending(d.display)) {
-                XEvent ev;
-                XNextEvent(d.display, &ev);
-                if (ev.type == d.ShmCompletionEvent) {
-                    if (d.ShmCompletionWaitCount > 0)
-                        d.ShmCompletionWaitCount--;
-                }
-            }
-            usleep(1000);
-        }
-    }
     QRect roi = realROI();
     int idx = d.current_index; // ret<0, frame/vo no change. if host frame, no filters; >0: filters
     if (ret > 0) { // next ximage is ready
         idx = d.next_index;
+        d.current_index = idx;
         d.next_index = (d.next_index+1)%kPoolSize;
     }
     XImage* ximage = d.ximage_pool[idx];
@@ -491,7 +525,8 @@ void X11Renderer::drawFrame()
                       , roi.x(), roi.y()//, roi.width(), roi.height()
                       , d.out_rect.x(), d.out_rect.y(), d.out_rect.width(), d.out_rect.height()
                       , True /*true: send event*/);
-        d.ShmCompletionWaitCount++;
+        d.shm_busy[idx] = true;
+        XFlush(d.display); // ShmCompletion is sent after the request is processed
     } else {
         XPutImage(d.display, winId(), d.gc, ximage
                    , roi.x(), roi.y()//, roi.width(), roi.height()
@@ -108,7 +108,7 @@ config_xv {
 config_x11 {
   DEFINES *= QTAV_HAVE_X11=1
   SOURCES *= X11Renderer.cpp
-  LIBS *= -lX11
+  LIBS *= -lX11 -lXext #XShm
 }
 # QtAV/private/* may be used by developers to extend QtAV features without changing QtAV library
 # headers not in QtAV/ and it's subdirs are used only by QtAV internally